@@ -0,0 +1,435 @@
+#include "ActorSystem.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <new>
+
+static const char *const priority_names[NUM_ACTOR_PRIORITIES] = {"high", "normal", "low"};
+
+//*****************************************************************************
+// Actor
+
+Actor::Actor(const char *name)
+    : name_(name),
+      system_(nullptr),
+      mailbox_(nullptr),
+      capacity_(0),
+      head_(0),
+      count_(0),
+      scheduled_(false),
+      priority_(ACTOR_NORMAL),
+      core_(0),
+      next_(nullptr)
+{
+#if defined(ARDUINO)
+    lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+    resetStats();
+}
+
+Actor::~Actor()
+{
+    delete[] mailbox_;
+}
+
+void Actor::resetStats()
+{
+    stats_.sent = 0;
+    stats_.handled = 0;
+    stats_.dropped = 0;
+    stats_.max_depth = 0;
+    stats_.max_handler_us = 0;
+    stats_.handler_us = 0;
+    stats_.latency_us.reset();
+}
+
+//*****************************************************************************
+// System
+
+ActorSystem::ActorSystem() : num_actors_(0), batch_(DEFAULT_BATCH)
+{
+    for (uint32_t core = 0; core < PORT_NUM_CORES; core++)
+    {
+        RunQueue &queue = queues_[core];
+        for (uint32_t p = 0; p < NUM_ACTOR_PRIORITIES; p++)
+        {
+            queue.head[p] = nullptr;
+            queue.tail[p] = nullptr;
+        }
+#if defined(ARDUINO)
+        queue.lock = portMUX_INITIALIZER_UNLOCKED;
+        queue.ready = NULL;
+#else
+        queue.ready = 0;
+#endif
+        args_[core].system = this;
+        args_[core].core = core;
+        actors_per_core_[core] = 0;
+    }
+#if !defined(ARDUINO)
+    stopping_ = false;
+#endif
+}
+
+ActorSystem::~ActorSystem()
+{
+#if !defined(ARDUINO)
+    end();
+#endif
+}
+
+bool ActorSystem::attach(Actor *actor, uint32_t mailbox_size, ActorPriority priority, int core)
+{
+    if (num_actors_ >= MAX_ACTORS || mailbox_size == 0 || actor->system_ != nullptr || priority >= NUM_ACTOR_PRIORITIES)
+    {
+        return false;
+    }
+    actor->mailbox_ = new (std::nothrow) ActorMessage[mailbox_size];
+    if (actor->mailbox_ == nullptr)
+    {
+        return false;
+    }
+
+    if (core < 0 || core >= PORT_NUM_CORES)
+    {
+        core = 0;
+        for (uint32_t c = 1; c < PORT_NUM_CORES; c++)
+        {
+            if (actors_per_core_[c] < actors_per_core_[core])
+            {
+                core = (int)c;
+            }
+        }
+    }
+    actor->system_ = this;
+    actor->capacity_ = mailbox_size;
+    actor->priority_ = priority;
+    actor->core_ = (uint32_t)core;
+    actors_per_core_[core]++;
+    actors_[num_actors_++] = actor;
+    return true;
+}
+
+bool ActorSystem::send(Actor *actor, uint16_t type, uint32_t value, void *data)
+{
+    ActorMessage message = {type, value, data, (uint32_t)monotonicMicros()};
+    return push(actor, message, false, nullptr);
+}
+
+bool ActorSystem::push(Actor *actor, const ActorMessage &message, bool from_isr, ActorWoken *task_woken)
+{
+    if (actor->system_ != this)
+    {
+        return false;
+    }
+
+#if defined(ARDUINO)
+    if (from_isr)
+    {
+        portENTER_CRITICAL_ISR(&actor->lock_);
+    }
+    else
+    {
+        portENTER_CRITICAL(&actor->lock_);
+    }
+#else
+    std::unique_lock<std::mutex> guard(actor->lock_);
+#endif
+    bool accepted = actor->count_ < actor->capacity_;
+    bool schedule = false;
+    if (accepted)
+    {
+        actor->mailbox_[(actor->head_ + actor->count_) % actor->capacity_] = message;
+        actor->count_++;
+        actor->stats_.sent++;
+        if (actor->count_ > actor->stats_.max_depth)
+        {
+            actor->stats_.max_depth = actor->count_;
+        }
+        schedule = !actor->scheduled_;
+        actor->scheduled_ = true;
+    }
+    else
+    {
+        actor->stats_.dropped++;
+    }
+#if defined(ARDUINO)
+    if (from_isr)
+    {
+        portEXIT_CRITICAL_ISR(&actor->lock_);
+    }
+    else
+    {
+        portEXIT_CRITICAL(&actor->lock_);
+    }
+#else
+    guard.unlock();
+#endif
+
+    if (schedule)
+    {
+        enqueue(actor, from_isr, task_woken);
+    }
+    return accepted;
+}
+
+//*****************************************************************************
+// Run queues
+
+void ActorSystem::enqueue(Actor *actor, bool from_isr, ActorWoken *task_woken)
+{
+    RunQueue &queue = queues_[actor->core_];
+    uint32_t p = actor->priority_;
+    actor->next_ = nullptr;
+
+#if defined(ARDUINO)
+    if (from_isr)
+    {
+        portENTER_CRITICAL_ISR(&queue.lock);
+    }
+    else
+    {
+        portENTER_CRITICAL(&queue.lock);
+    }
+#else
+    std::lock_guard<std::mutex> guard(queue.lock);
+#endif
+    if (queue.tail[p] == nullptr)
+    {
+        queue.head[p] = actor;
+    }
+    else
+    {
+        queue.tail[p]->next_ = actor;
+    }
+    queue.tail[p] = actor;
+#if defined(ARDUINO)
+    if (from_isr)
+    {
+        portEXIT_CRITICAL_ISR(&queue.lock);
+        xSemaphoreGiveFromISR(queue.ready, task_woken);
+    }
+    else
+    {
+        portEXIT_CRITICAL(&queue.lock);
+        xSemaphoreGive(queue.ready);
+    }
+#else
+    queue.ready++;
+    queue.cond.notify_one();
+#endif
+}
+
+// Highest class first; caller holds the queue lock
+Actor *ActorSystem::dequeue(uint32_t core)
+{
+    RunQueue &queue = queues_[core];
+    for (uint32_t p = 0; p < NUM_ACTOR_PRIORITIES; p++)
+    {
+        Actor *actor = queue.head[p];
+        if (actor != nullptr)
+        {
+            queue.head[p] = actor->next_;
+            if (queue.head[p] == nullptr)
+            {
+                queue.tail[p] = nullptr;
+            }
+            return actor;
+        }
+    }
+    return nullptr;
+}
+
+// Up to batch_ messages, then back to the end of its class if more are waiting
+void ActorSystem::serve(Actor *actor)
+{
+    for (uint32_t n = 0; n <= batch_; n++)
+    {
+        ActorMessage message;
+#if defined(ARDUINO)
+        portENTER_CRITICAL(&actor->lock_);
+#else
+        std::unique_lock<std::mutex> guard(actor->lock_);
+#endif
+        bool more = actor->count_ > 0;
+        if (more && n < batch_)
+        {
+            message = actor->mailbox_[actor->head_];
+            actor->head_ = (actor->head_ + 1) % actor->capacity_;
+            actor->count_--;
+        }
+        else if (!more)
+        {
+            actor->scheduled_ = false;
+        }
+#if defined(ARDUINO)
+        portEXIT_CRITICAL(&actor->lock_);
+#else
+        guard.unlock();
+#endif
+        if (!more)
+        {
+            return;
+        }
+        if (n == batch_)
+        {
+            enqueue(actor, false, nullptr); // Still scheduled
+            return;
+        }
+
+        uint32_t start_us = (uint32_t)monotonicMicros();
+        actor->stats_.latency_us.record(start_us - message.sent_us);
+        actor->receive(message);
+        uint32_t run_us = (uint32_t)monotonicMicros() - start_us;
+        actor->stats_.handled++;
+        actor->stats_.handler_us += run_us;
+        if (run_us > actor->stats_.max_handler_us)
+        {
+            actor->stats_.max_handler_us = run_us;
+        }
+    }
+}
+
+//*****************************************************************************
+// Workers
+
+#if defined(ARDUINO)
+
+bool ActorSystem::sendFromISR(Actor *actor, uint16_t type, uint32_t value, void *data, BaseType_t *task_woken)
+{
+    ActorMessage message = {type, value, data, (uint32_t)monotonicMicros()};
+    return push(actor, message, true, task_woken);
+}
+
+void ActorSystem::workerLoop(uint32_t core)
+{
+    RunQueue &queue = queues_[core];
+    while (1)
+    {
+        xSemaphoreTake(queue.ready, portMAX_DELAY);
+        portENTER_CRITICAL(&queue.lock);
+        Actor *actor = dequeue(core);
+        portEXIT_CRITICAL(&queue.lock);
+        if (actor != nullptr)
+        {
+            serve(actor);
+        }
+    }
+}
+
+void ActorSystem::workerTask(void *parameters)
+{
+    WorkerArgs *args = (WorkerArgs *)parameters;
+    args->system->workerLoop(args->core);
+}
+
+bool ActorSystem::begin(uint32_t workers_per_core, uint32_t stack_size, UBaseType_t priority, uint32_t batch)
+{
+    batch_ = (batch > 0) ? batch : 1;
+    for (uint32_t core = 0; core < PORT_NUM_CORES; core++)
+    {
+        // Every actor is queued at most once at a time
+        queues_[core].ready = xSemaphoreCreateCounting(MAX_ACTORS, 0);
+        if (queues_[core].ready == NULL)
+        {
+            return false;
+        }
+        for (uint32_t w = 0; w < workers_per_core; w++)
+        {
+            char name[configMAX_TASK_NAME_LEN];
+            snprintf(name, sizeof(name), "Actors %lu", (unsigned long)core);
+            if (xTaskCreatePinnedToCore(workerTask, name, stack_size, &args_[core], priority, NULL, (BaseType_t)core) != pdPASS)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#else
+
+void ActorSystem::workerLoop(uint32_t core)
+{
+    RunQueue &queue = queues_[core];
+    while (1)
+    {
+        std::unique_lock<std::mutex> guard(queue.lock);
+        queue.cond.wait(guard, [this, &queue] { return queue.ready > 0 || stopping_; });
+        if (stopping_)
+        {
+            return;
+        }
+        queue.ready--;
+        Actor *actor = dequeue(core);
+        guard.unlock();
+        if (actor != nullptr)
+        {
+            serve(actor);
+        }
+    }
+}
+
+bool ActorSystem::begin(uint32_t workers_per_core, uint32_t batch)
+{
+    batch_ = (batch > 0) ? batch : 1;
+    stopping_ = false;
+    for (uint32_t core = 0; core < PORT_NUM_CORES; core++)
+    {
+        for (uint32_t w = 0; w < workers_per_core; w++)
+        {
+            threads_.emplace_back(&ActorSystem::workerLoop, this, core);
+        }
+    }
+    return true;
+}
+
+void ActorSystem::end()
+{
+    // Taking each lock after the store makes sure no worker is between its
+    // check and its wait when it is notified
+    stopping_.store(true);
+    for (uint32_t core = 0; core < PORT_NUM_CORES; core++)
+    {
+        std::lock_guard<std::mutex> guard(queues_[core].lock);
+        queues_[core].cond.notify_all();
+    }
+    for (size_t i = 0; i < threads_.size(); i++)
+    {
+        threads_[i].join();
+    }
+    threads_.clear();
+}
+
+#endif // ARDUINO
+
+//*****************************************************************************
+// Statistics
+
+void ActorSystem::printStats(LogHistogram::LineWriter write) const
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-12s %-6s %4s %8s %8s %7s %5s %9s %9s %9s %9s",
+             "actor", "class", "core", "sent", "handled", "dropped", "depth",
+             "lat p50", "lat p99", "lat max", "run mean");
+    write(line);
+    for (uint32_t i = 0; i < num_actors_; i++)
+    {
+        const Actor *actor = actors_[i];
+        const ActorStats &s = actor->stats_;
+        snprintf(line, sizeof(line), "%-12s %-6s %4lu %8lu %8lu %7lu %5lu %7luus %7luus %7luus %7luus",
+                 actor->name_,
+                 priority_names[actor->priority_],
+                 (unsigned long)actor->core_,
+                 (unsigned long)s.sent,
+                 (unsigned long)s.handled,
+                 (unsigned long)s.dropped,
+                 (unsigned long)s.max_depth,
+                 (unsigned long)s.latency_us.percentile(50),
+                 (unsigned long)s.latency_us.percentile(99),
+                 (unsigned long)s.latency_us.max(),
+                 (unsigned long)(s.handled ? s.handler_us / s.handled : 0));
+        write(line);
+    }
+}
@@ -0,0 +1,224 @@
+#ifndef ACTOR_SYSTEM_H
+#define ACTOR_SYSTEM_H
+
+// Actors with bounded mailboxes, run by a few worker tasks per core
+//
+// part9_isr_challenge.cpp gives each component a task with a 4096 B stack
+// although each one mostly sleeps until an event arrives. Here a component
+// is an Actor: an object with a mailbox and a receive() handler. A small
+// pool of workers per core runs the handlers:
+//
+//   class AverageActor : public Actor
+//   {
+//       void receive(const ActorMessage &message) override { ... }
+//   };
+//
+//   system.begin(1, 4096, 1);          // One worker per core
+//   system.attach(&average, 8, ACTOR_NORMAL, app_cpu);
+//   system.send(&average, MSG_BLOCK, count, block);
+//
+// Rules:
+//
+//   - An actor's messages are handled one at a time, in send order, each
+//     handler running to completion. Handlers must not block for long: the
+//     worker is shared with every other actor on its core.
+//   - Actors on a core are served by priority class (ACTOR_HIGH first),
+//     FIFO within a class. An actor with more messages goes back to the end
+//     of its class after batch messages, so a busy actor cannot starve its
+//     peers. A running handler is never preempted by a higher class.
+//   - A full mailbox drops the message: send() returns false and the
+//     actor's stats count it.
+//
+// Per-actor statistics: messages sent, handled, dropped, peak mailbox
+// depth, send-to-handler latency (histogram, us) and handler run time.
+// On the host workers are threads and there is no ISR send.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Histogram.h>
+#include <PortUtils.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+typedef BaseType_t ActorWoken;
+#else
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+typedef int ActorWoken;
+#endif
+
+static const int ACTOR_ANY_CORE = -1;
+
+enum ActorPriority
+{
+    ACTOR_HIGH = 0,
+    ACTOR_NORMAL,
+    ACTOR_LOW,
+    NUM_ACTOR_PRIORITIES
+};
+
+struct ActorMessage
+{
+    uint16_t type;
+    uint32_t value;
+    void *data;
+    uint32_t sent_us; // Stamped by send()
+};
+
+struct ActorStats
+{
+    uint32_t sent;
+    uint32_t handled;
+    uint32_t dropped;
+    uint32_t max_depth;
+    uint32_t max_handler_us;
+    uint64_t handler_us;
+    LogHistogram latency_us; // send() until receive() starts
+};
+
+class ActorSystem;
+
+class Actor
+{
+public:
+    explicit Actor(const char *name);
+    virtual ~Actor();
+
+    Actor(const Actor &) = delete;
+    Actor &operator=(const Actor &) = delete;
+
+    const char *name() const
+    {
+        return name_;
+    }
+
+    ActorPriority priority() const
+    {
+        return priority_;
+    }
+
+    // Only consistent while no message is in flight
+    const ActorStats &stats() const
+    {
+        return stats_;
+    }
+
+    void resetStats();
+
+protected:
+    // Runs on a worker, one message at a time
+    virtual void receive(const ActorMessage &message) = 0;
+
+private:
+    friend class ActorSystem;
+
+    const char *name_;
+    ActorSystem *system_;
+    ActorMessage *mailbox_;
+    uint32_t capacity_;
+    uint32_t head_;
+    uint32_t count_;
+    bool scheduled_; // In a run queue or being run
+    ActorPriority priority_;
+    uint32_t core_;
+    Actor *next_;    // Run queue link
+    ActorStats stats_;
+
+#if defined(ARDUINO)
+    portMUX_TYPE lock_;
+#else
+    std::mutex lock_;
+#endif
+};
+
+class ActorSystem
+{
+public:
+    static const uint32_t DEFAULT_BATCH = 4;
+
+    ActorSystem();
+    ~ActorSystem();
+
+    ActorSystem(const ActorSystem &) = delete;
+    ActorSystem &operator=(const ActorSystem &) = delete;
+
+#if defined(ARDUINO)
+    // workers_per_core workers pinned to every core
+    bool begin(uint32_t workers_per_core, uint32_t stack_size, UBaseType_t priority, uint32_t batch = DEFAULT_BATCH);
+#else
+    bool begin(uint32_t workers_per_core, uint32_t batch = DEFAULT_BATCH);
+
+    // Stop and join the workers; queued messages are not handled
+    void end();
+#endif
+
+    // Give the actor a mailbox and a home core (ACTOR_ANY_CORE: the core
+    // with the fewest actors). Before its first send.
+    bool attach(Actor *actor, uint32_t mailbox_size, ActorPriority priority = ACTOR_NORMAL, int core = ACTOR_ANY_CORE);
+
+    // False if the mailbox is full (the message is dropped)
+    bool send(Actor *actor, uint16_t type, uint32_t value = 0, void *data = nullptr);
+
+#if defined(ARDUINO)
+    bool sendFromISR(Actor *actor, uint16_t type, uint32_t value, void *data, BaseType_t *task_woken);
+#endif
+
+    // One line per attached actor, plus a header
+    void printStats(LogHistogram::LineWriter write) const;
+
+    uint32_t actorCount() const
+    {
+        return num_actors_;
+    }
+
+private:
+    static const uint32_t MAX_ACTORS = 128;
+
+    struct RunQueue
+    {
+        Actor *head[NUM_ACTOR_PRIORITIES];
+        Actor *tail[NUM_ACTOR_PRIORITIES];
+#if defined(ARDUINO)
+        portMUX_TYPE lock;
+        SemaphoreHandle_t ready; // One count per queued actor
+#else
+        std::mutex lock;
+        std::condition_variable cond;
+        uint32_t ready;
+#endif
+    };
+
+    struct WorkerArgs
+    {
+        ActorSystem *system;
+        uint32_t core;
+    };
+
+    bool push(Actor *actor, const ActorMessage &message, bool from_isr, ActorWoken *task_woken);
+    void enqueue(Actor *actor, bool from_isr, ActorWoken *task_woken);
+    Actor *dequeue(uint32_t core);
+    void serve(Actor *actor);
+    void workerLoop(uint32_t core);
+
+#if defined(ARDUINO)
+    static void workerTask(void *parameters);
+#endif
+
+    RunQueue queues_[PORT_NUM_CORES];
+    WorkerArgs args_[PORT_NUM_CORES];
+    Actor *actors_[MAX_ACTORS];
+    uint32_t actors_per_core_[PORT_NUM_CORES];
+    uint32_t num_actors_;
+    uint32_t batch_;
+
+#if !defined(ARDUINO)
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stopping_; // Read by the workers of every core
+#endif
+};
+
+#endif // ACTOR_SYSTEM_H
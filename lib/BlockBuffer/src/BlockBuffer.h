@@ -0,0 +1,258 @@
+#ifndef BLOCK_BUFFER_H
+#define BLOCK_BUFFER_H
+
+// Ping-pong / triple buffer for handing sample blocks from an ISR to a task
+//
+// The producer (usually an ISR) fills one block while the consumer owns
+// another. When a block is full, ownership changes with a single atomic
+// store/exchange on a small index and the consumer task is woken with a
+// direct task notification. Nothing is copied and interrupts are never
+// disabled, so block sizes of thousands of samples cost the same hand-off
+// time as ten.
+//
+// Double buffering (2 blocks): if the consumer still holds the previous
+// block when the next one fills, the new block is dropped and counted as an
+// overrun; the consumer always sees blocks in order.
+// Triple buffering (3 blocks): the producer never waits; an unread ready
+// block is replaced by the newer one (counted as an overrun), so the
+// consumer always gets the latest complete block.
+//
+// One producer and one consumer. push()/publish() are ISR safe.
+
+#include <atomic>
+#include <new>
+#include <stdint.h>
+
+#include <PortUtils.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+template <typename T>
+class BlockBuffer
+{
+public:
+    struct Block
+    {
+        T *samples;
+        uint32_t count;    // Valid samples
+        uint32_t sequence; // Block number, counts dropped blocks too
+        uint64_t first_us; // Timestamp of the first sample
+    };
+
+    BlockBuffer()
+        : storage_(nullptr), block_size_(0), num_blocks_(0), fill_(0), fill_count_(0),
+          sequence_(0), overruns_(0), consumer_(0)
+#if defined(ARDUINO)
+          ,
+          consumer_task_(NULL)
+#endif
+    {
+    }
+
+    ~BlockBuffer()
+    {
+        delete[] storage_;
+    }
+
+    // num_blocks is 2 (ping-pong) or 3 (triple). Allocates once.
+    bool begin(uint32_t block_size, uint32_t num_blocks)
+    {
+        if (block_size == 0 || (num_blocks != 2 && num_blocks != 3))
+        {
+            return false;
+        }
+        storage_ = new (std::nothrow) T[(size_t)block_size * num_blocks];
+        if (storage_ == nullptr)
+        {
+            return false;
+        }
+        block_size_ = block_size;
+        num_blocks_ = num_blocks;
+        for (uint32_t i = 0; i < num_blocks; i++)
+        {
+            blocks_[i].samples = storage_ + (size_t)i * block_size;
+            blocks_[i].count = 0;
+            blocks_[i].sequence = 0;
+            blocks_[i].first_us = 0;
+        }
+
+        // Producer fills block 0. Double: block 1 is free (ready_ clear).
+        // Triple: block 1 is the middle slot, block 2 belongs to the consumer.
+        fill_ = 0;
+        fill_count_ = 0;
+        ready_.store((num_blocks == 3) ? 1 : 0);
+        consumer_ = (num_blocks == 3) ? 2 : 1;
+        return true;
+    }
+
+#if defined(ARDUINO)
+    // Task to notify (xTaskNotifyGive) whenever a block becomes ready
+    void setConsumerTask(TaskHandle_t task)
+    {
+        consumer_task_ = task;
+    }
+#endif
+
+    uint32_t blockSize() const
+    {
+        return block_size_;
+    }
+
+    // Producer: samples in the block being filled
+    uint32_t pending() const
+    {
+        return fill_count_;
+    }
+
+    // Producer: append one sample. Returns true when this completed a block.
+    PORT_FORCE_INLINE bool push(T sample)
+    {
+        Block &block = blocks_[fill_];
+        if (fill_count_ == 0)
+        {
+            block.first_us = monotonicMicros();
+        }
+        block.samples[fill_count_++] = sample;
+        if (fill_count_ < block_size_)
+        {
+            return false;
+        }
+        publish();
+        return true;
+    }
+
+    // Producer: hand over the current (possibly partial) block
+    PORT_FORCE_INLINE void publish()
+    {
+        if (fill_count_ == 0)
+        {
+            return;
+        }
+        Block &block = blocks_[fill_];
+        block.count = fill_count_;
+        block.sequence = sequence_++;
+        fill_count_ = 0;
+
+        if (num_blocks_ == 2)
+        {
+            // The other block is free only once the consumer released it
+            if (ready_.load(std::memory_order_acquire) != 0)
+            {
+                overruns_ = overruns_ + 1;
+                return; // Refill the same block; this one is dropped
+            }
+            ready_.store(READY | fill_, std::memory_order_release);
+            fill_ ^= 1;
+        }
+        else
+        {
+            // Swap the full block into the middle slot, take the old middle
+            uint8_t old = ready_.exchange(READY | fill_, std::memory_order_acq_rel);
+            if (old & READY)
+            {
+                overruns_ = overruns_ + 1;
+            }
+            fill_ = old & INDEX_MASK;
+        }
+        notifyConsumer();
+    }
+
+    // Consumer: take the next ready block, or nullptr if none is ready.
+    // The block stays valid until release().
+    const Block *acquire()
+    {
+        if (num_blocks_ == 2)
+        {
+            uint8_t state = ready_.load(std::memory_order_acquire);
+            return (state & READY) ? &blocks_[state & INDEX_MASK] : nullptr;
+        }
+
+        if (!(ready_.load(std::memory_order_acquire) & READY))
+        {
+            return nullptr;
+        }
+        uint8_t old = ready_.exchange(consumer_, std::memory_order_acq_rel);
+        consumer_ = old & INDEX_MASK;
+        return &blocks_[consumer_];
+    }
+
+#if defined(ARDUINO)
+    // Consumer: block on the task notification until a block is ready
+    const Block *acquire(TickType_t wait)
+    {
+        const Block *block = acquire();
+        if (block == nullptr && ulTaskNotifyTake(pdTRUE, wait) > 0)
+        {
+            block = acquire();
+        }
+        return block;
+    }
+#endif
+
+    // Consumer: give the acquired block back to the producer
+    void release()
+    {
+        if (num_blocks_ == 2)
+        {
+            ready_.store(0, std::memory_order_release);
+        }
+        // Triple: the consumer block is swapped out by the next acquire()
+    }
+
+    uint32_t overruns() const
+    {
+        return overruns_;
+    }
+
+private:
+    static const uint8_t READY = 0x80;
+    static const uint8_t INDEX_MASK = 0x03;
+
+    PORT_FORCE_INLINE void notifyConsumer()
+    {
+#if defined(ARDUINO)
+        if (consumer_task_ == NULL)
+        {
+            return;
+        }
+        if (xPortInIsrContext())
+        {
+            BaseType_t task_woken = pdFALSE;
+            vTaskNotifyGiveFromISR(consumer_task_, &task_woken);
+            if (task_woken)
+            {
+                portYIELD_FROM_ISR();
+            }
+        }
+        else
+        {
+            xTaskNotifyGive(consumer_task_);
+        }
+#endif
+    }
+
+    T *storage_;
+    Block blocks_[3];
+    uint32_t block_size_;
+    uint32_t num_blocks_;
+
+    // Producer side
+    uint32_t fill_;
+    uint32_t fill_count_;
+    uint32_t sequence_;
+    volatile uint32_t overruns_;
+
+    // Shared: READY | index of the block waiting for the consumer
+    std::atomic<uint8_t> ready_;
+
+    // Consumer side (triple buffering)
+    uint8_t consumer_;
+
+#if defined(ARDUINO)
+    TaskHandle_t consumer_task_;
+#endif
+};
+
+#endif // BLOCK_BUFFER_H
@@ -0,0 +1,230 @@
+#include "BlockKernels.h"
+
+#include <string.h>
+
+//*****************************************************************************
+// Scalar reference
+
+static uint32_t sumScalar(const uint16_t *x, uint32_t n)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sum += x[i];
+    }
+    return sum;
+}
+
+static BlockMinMax minMaxScalar(const uint16_t *x, uint32_t n)
+{
+    BlockMinMax result = {0xFFFF, 0};
+    for (uint32_t i = 0; i < n; i++)
+    {
+        result.min = (x[i] < result.min) ? x[i] : result.min;
+        result.max = (x[i] > result.max) ? x[i] : result.max;
+    }
+    return result;
+}
+
+static void scaleOffsetScalar(const uint16_t *in, int16_t *out, uint32_t n, uint16_t offset, int16_t gain_q15)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        int32_t centered = (int16_t)(in[i] - offset);
+        out[i] = (int16_t)((centered * gain_q15) >> 15);
+    }
+}
+
+static int64_t dotScalar(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sum += (int32_t)a[i] * b[i];
+    }
+    return sum;
+}
+
+static uint32_t countAboveScalar(const uint16_t *x, uint32_t n, uint16_t threshold)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        count += (x[i] > threshold) ? 1 : 0;
+    }
+    return count;
+}
+
+const BlockKernelSet block_kernels_scalar = {
+    "scalar",
+    sumScalar,
+    minMaxScalar,
+    scaleOffsetScalar,
+    dotScalar,
+    countAboveScalar,
+};
+
+//*****************************************************************************
+// SWAR: uint16 lanes in a native word
+
+typedef uintptr_t swar_word_t;
+
+static const uint32_t LANES = sizeof(swar_word_t) / sizeof(uint16_t);
+static const swar_word_t LANE_ONES = (swar_word_t)0x0001000100010001ull;
+static const swar_word_t HIGH_BITS = (swar_word_t)0x8000800080008000ull;
+static const swar_word_t EVEN_LANES = (swar_word_t)0x0000FFFF0000FFFFull;
+
+// Samples to handle one by one before x is word aligned
+static uint32_t headCount(const uint16_t *x, uint32_t n)
+{
+    uint32_t misaligned = (uint32_t)(((uintptr_t)x % sizeof(swar_word_t)) / sizeof(uint16_t));
+    uint32_t head = (misaligned == 0) ? 0 : LANES - misaligned;
+    return (head < n) ? head : n;
+}
+
+static inline swar_word_t loadWord(const uint16_t *x)
+{
+    swar_word_t word;
+    memcpy(&word, __builtin_assume_aligned(x, sizeof(swar_word_t)), sizeof(word));
+    return word;
+}
+
+static inline uint16_t lane(swar_word_t word, uint32_t i)
+{
+    return (uint16_t)(word >> (16 * i));
+}
+
+// All-ones lanes where a >= b. Lanes must be below 0x8000: setting the top
+// bit of a keeps every lane's subtraction from borrowing from the next one.
+static inline swar_word_t lanesGreaterEqual(swar_word_t a, swar_word_t b)
+{
+    swar_word_t ge = (((a | HIGH_BITS) - b) & HIGH_BITS) >> 15;
+    return ge * 0xFFFF;
+}
+
+static uint32_t sumSwar(const uint16_t *x, uint32_t n)
+{
+    uint32_t head = headCount(x, n);
+    uint32_t total = sumScalar(x, head);
+    x += head;
+    n -= head;
+
+    // Even and odd lanes are added into 32-bit lanes
+    swar_word_t acc = 0;
+    uint32_t words = n / LANES;
+    for (uint32_t i = 0; i < words; i++)
+    {
+        swar_word_t word = loadWord(x + i * LANES);
+        acc += (word & EVEN_LANES) + ((word >> 16) & EVEN_LANES);
+    }
+    total += (uint32_t)acc;
+    if (sizeof(swar_word_t) == 8)
+    {
+        total += (uint32_t)((uint64_t)acc >> 32);
+    }
+    return total + sumScalar(x + words * LANES, n - words * LANES);
+}
+
+static BlockMinMax minMaxSwar(const uint16_t *x, uint32_t n)
+{
+    uint32_t head = headCount(x, n);
+    uint32_t words = (n - head) / LANES;
+    if (words == 0)
+    {
+        return minMaxScalar(x, n);
+    }
+
+    const uint16_t *body = x + head;
+    swar_word_t lo = loadWord(body);
+    swar_word_t hi = lo;
+    swar_word_t seen = 0;
+    for (uint32_t i = 0; i < words; i++)
+    {
+        swar_word_t word = loadWord(body + i * LANES);
+        swar_word_t ge_hi = lanesGreaterEqual(word, hi);
+        swar_word_t ge_lo = lanesGreaterEqual(word, lo);
+        hi = (word & ge_hi) | (hi & ~ge_hi);
+        lo = (lo & ge_lo) | (word & ~ge_lo);
+        seen |= word;
+    }
+
+    // A lane at or above 0x8000 breaks the compare trick
+    if (seen & HIGH_BITS)
+    {
+        return minMaxScalar(x, n);
+    }
+
+    BlockMinMax result = minMaxScalar(x, head);
+    for (uint32_t i = 0; i < LANES; i++)
+    {
+        result.min = (lane(lo, i) < result.min) ? lane(lo, i) : result.min;
+        result.max = (lane(hi, i) > result.max) ? lane(hi, i) : result.max;
+    }
+    BlockMinMax tail = minMaxScalar(body + words * LANES, n - head - words * LANES);
+    result.min = (tail.min < result.min) ? tail.min : result.min;
+    result.max = (tail.max > result.max) ? tail.max : result.max;
+    return result;
+}
+
+static uint32_t countAboveSwar(const uint16_t *x, uint32_t n, uint16_t threshold)
+{
+    if (threshold >= 0x7FFF)
+    {
+        return countAboveScalar(x, n, threshold);
+    }
+
+    uint32_t head = headCount(x, n);
+    uint32_t words = (n - head) / LANES;
+    const uint16_t *body = x + head;
+
+    // x > t  <=>  x >= t + 1; each lane counts its hits
+    swar_word_t limit = (swar_word_t)(threshold + 1) * LANE_ONES;
+    swar_word_t seen = 0;
+    uint32_t count = 0;
+    uint32_t i = 0;
+    while (i < words)
+    {
+        // Flush before a 16-bit lane counter can wrap
+        uint32_t chunk_end = (words - i > 0xFFFF) ? i + 0xFFFF : words;
+        swar_word_t acc = 0;
+        for (; i < chunk_end; i++)
+        {
+            swar_word_t word = loadWord(body + i * LANES);
+            acc += (((word | HIGH_BITS) - limit) & HIGH_BITS) >> 15;
+            seen |= word;
+        }
+        for (uint32_t l = 0; l < LANES; l++)
+        {
+            count += lane(acc, l);
+        }
+    }
+
+    if (seen & HIGH_BITS)
+    {
+        return countAboveScalar(x, n, threshold);
+    }
+    return count + countAboveScalar(x, head, threshold) +
+           countAboveScalar(body + words * LANES, n - head - words * LANES, threshold);
+}
+
+const BlockKernelSet block_kernels_swar = {
+    "swar",
+    sumSwar,
+    minMaxSwar,
+    scaleOffsetScalar, // Lane multiplies do not pack into a word
+    dotScalar,
+    countAboveSwar,
+};
+
+//*****************************************************************************
+// Selection
+
+const BlockKernelSet *blockKernelsBest()
+{
+    const BlockKernelSet *simd = blockKernelsSimd();
+    if (simd != nullptr)
+    {
+        return simd;
+    }
+    return (sizeof(swar_word_t) >= 8) ? &block_kernels_swar : &block_kernels_scalar;
+}
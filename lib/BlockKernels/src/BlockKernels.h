@@ -0,0 +1,83 @@
+#ifndef BLOCK_KERNELS_H
+#define BLOCK_KERNELS_H
+
+// Block reductions and conversions over sample buffers
+//
+// Every kernel exists in up to three variants with identical results:
+//
+//   scalar - plain loops, the reference
+//   swar   - "SIMD within a register": several uint16 lanes per native
+//            word (2 on the ESP32, 4 on 64-bit hosts), no intrinsics.
+//            scaleOffset and dot need lane multiplies that do not pack into
+//            a general-purpose register; their SWAR entries are the scalar
+//            loops
+//   simd   - SSE2 / AVX2 on x86 hosts (AVX2 when built with -mavx2)
+//
+// blockKernelsBest() picks SIMD when built, else SWAR on 64-bit hosts and
+// scalar on 32-bit targets, where a word only holds two lanes. The
+// blockSum()/blockMinMax()/... wrappers call it. The variant sets are
+// exposed so benchmarks can compare them.
+//
+// Limits shared by all variants:
+//   sum         - n <= 65536 (the 32-bit result cannot overflow)
+//   scaleOffset - out = ((in - offset) * gain_q15) >> 15; in - offset must
+//                 fit int16
+//   dot         - pairs of (-32768, -32768) are not allowed (the SSE2
+//                 multiply-add overflows on exactly that product)
+//
+// The esp-dsp s16 kernels saturate to Q15 results, so they cannot produce
+// these exact integer reductions, and the classic ESP32 has no SIMD unit. On
+// the target the choice is between scalar and SWAR.
+
+#include <stdint.h>
+
+struct BlockMinMax
+{
+    uint16_t min;
+    uint16_t max;
+};
+
+struct BlockKernelSet
+{
+    const char *name;
+    uint32_t (*sum)(const uint16_t *x, uint32_t n);
+    BlockMinMax (*minMax)(const uint16_t *x, uint32_t n);
+    void (*scaleOffset)(const uint16_t *in, int16_t *out, uint32_t n, uint16_t offset, int16_t gain_q15);
+    int64_t (*dot)(const int16_t *a, const int16_t *b, uint32_t n);
+    uint32_t (*countAbove)(const uint16_t *x, uint32_t n, uint16_t threshold); // x > threshold
+};
+
+extern const BlockKernelSet block_kernels_scalar;
+extern const BlockKernelSet block_kernels_swar;
+
+// nullptr when the target has no SIMD variant
+const BlockKernelSet *blockKernelsSimd();
+
+const BlockKernelSet *blockKernelsBest();
+
+static inline uint32_t blockSum(const uint16_t *x, uint32_t n)
+{
+    return blockKernelsBest()->sum(x, n);
+}
+
+static inline BlockMinMax blockMinMax(const uint16_t *x, uint32_t n)
+{
+    return blockKernelsBest()->minMax(x, n);
+}
+
+static inline void blockScaleOffset(const uint16_t *in, int16_t *out, uint32_t n, uint16_t offset, int16_t gain_q15)
+{
+    blockKernelsBest()->scaleOffset(in, out, n, offset, gain_q15);
+}
+
+static inline int64_t blockDot(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    return blockKernelsBest()->dot(a, b, n);
+}
+
+static inline uint32_t blockCountAbove(const uint16_t *x, uint32_t n, uint16_t threshold)
+{
+    return blockKernelsBest()->countAbove(x, n, threshold);
+}
+
+#endif // BLOCK_KERNELS_H
@@ -0,0 +1,255 @@
+#include "BlockKernels.h"
+
+#if defined(__SSE2__)
+
+#include <immintrin.h>
+
+// x86 host variant. SSE2 is always present on x86-64; AVX2 doubles the
+// vector width when the build enables it (-mavx2). Unsigned 16-bit compares
+// use the usual trick of flipping the sign bit and comparing signed.
+
+static inline uint32_t horizontalSum32(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+//*****************************************************************************
+// sum
+
+static uint32_t sumSimd(const uint16_t *x, uint32_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    uint32_t i = 0;
+
+#if defined(__AVX2__)
+    __m256i acc256 = _mm256_setzero_si256();
+    const __m256i zero256 = _mm256_setzero_si256();
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(x + i));
+        acc256 = _mm256_add_epi32(acc256, _mm256_unpacklo_epi16(v, zero256));
+        acc256 = _mm256_add_epi32(acc256, _mm256_unpackhi_epi16(v, zero256));
+    }
+    acc = _mm_add_epi32(_mm256_castsi256_si128(acc256), _mm256_extracti128_si256(acc256, 1));
+#endif
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(x + i));
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+    }
+
+    uint32_t sum = horizontalSum32(acc);
+    for (; i < n; i++)
+    {
+        sum += x[i];
+    }
+    return sum;
+}
+
+//*****************************************************************************
+// min / max
+
+static BlockMinMax minMaxSimd(const uint16_t *x, uint32_t n)
+{
+    BlockMinMax result = {0xFFFF, 0};
+    uint32_t i = 0;
+
+    if (n >= 8)
+    {
+        // Signed compares on sign-flipped values
+        const __m128i flip = _mm_set1_epi16((short)0x8000);
+        __m128i lo = _mm_set1_epi16(0x7FFF);
+        __m128i hi = _mm_set1_epi16((short)0x8000);
+
+#if defined(__AVX2__)
+        if (n >= 16)
+        {
+            __m256i lo256 = _mm256_set1_epi16((short)0xFFFF);
+            __m256i hi256 = _mm256_setzero_si256();
+            for (; i + 16 <= n; i += 16)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i *)(x + i));
+                lo256 = _mm256_min_epu16(lo256, v);
+                hi256 = _mm256_max_epu16(hi256, v);
+            }
+            __m128i lo128 = _mm_xor_si128(flip, _mm256_castsi256_si128(lo256));
+            __m128i hi128 = _mm_xor_si128(flip, _mm256_castsi256_si128(hi256));
+            lo = _mm_min_epi16(lo, _mm_min_epi16(lo128, _mm_xor_si128(flip, _mm256_extracti128_si256(lo256, 1))));
+            hi = _mm_max_epi16(hi, _mm_max_epi16(hi128, _mm_xor_si128(flip, _mm256_extracti128_si256(hi256, 1))));
+        }
+#endif
+
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(x + i)), flip);
+            lo = _mm_min_epi16(lo, v);
+            hi = _mm_max_epi16(hi, v);
+        }
+
+        uint16_t lanes_lo[8];
+        uint16_t lanes_hi[8];
+        _mm_storeu_si128((__m128i *)lanes_lo, _mm_xor_si128(lo, flip));
+        _mm_storeu_si128((__m128i *)lanes_hi, _mm_xor_si128(hi, flip));
+        for (uint32_t l = 0; l < 8; l++)
+        {
+            result.min = (lanes_lo[l] < result.min) ? lanes_lo[l] : result.min;
+            result.max = (lanes_hi[l] > result.max) ? lanes_hi[l] : result.max;
+        }
+    }
+
+    for (; i < n; i++)
+    {
+        result.min = (x[i] < result.min) ? x[i] : result.min;
+        result.max = (x[i] > result.max) ? x[i] : result.max;
+    }
+    return result;
+}
+
+//*****************************************************************************
+// scale and offset
+
+// ((in - offset) * gain) >> 15 per lane, from the high and low product halves
+static inline __m128i scaleLanes(__m128i in, __m128i offset, __m128i gain)
+{
+    __m128i centered = _mm_sub_epi16(in, offset);
+    __m128i lo = _mm_mullo_epi16(centered, gain);
+    __m128i hi = _mm_mulhi_epi16(centered, gain);
+    return _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+}
+
+static void scaleOffsetSimd(const uint16_t *in, int16_t *out, uint32_t n, uint16_t offset, int16_t gain_q15)
+{
+    uint32_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i offset256 = _mm256_set1_epi16((short)offset);
+    const __m256i gain256 = _mm256_set1_epi16(gain_q15);
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i centered = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i *)(in + i)), offset256);
+        __m256i lo = _mm256_mullo_epi16(centered, gain256);
+        __m256i hi = _mm256_mulhi_epi16(centered, gain256);
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_or_si256(_mm256_slli_epi16(hi, 1), _mm256_srli_epi16(lo, 15)));
+    }
+#endif
+
+    const __m128i offset128 = _mm_set1_epi16((short)offset);
+    const __m128i gain128 = _mm_set1_epi16(gain_q15);
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm_storeu_si128((__m128i *)(out + i), scaleLanes(v, offset128, gain128));
+    }
+
+    for (; i < n; i++)
+    {
+        int32_t centered = (int16_t)(in[i] - offset);
+        out[i] = (int16_t)((centered * gain_q15) >> 15);
+    }
+}
+
+//*****************************************************************************
+// dot product
+
+// Sign-extend the four 32-bit lanes of v and add them to two 64-bit lanes
+static inline __m128i addWidened(__m128i acc, __m128i v)
+{
+    __m128i sign = _mm_srai_epi32(v, 31);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+}
+
+static int64_t dotSimd(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    __m128i acc = _mm_setzero_si128();
+    uint32_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i products = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                             _mm256_loadu_si256((const __m256i *)(b + i)));
+        acc = addWidened(acc, _mm256_castsi256_si128(products));
+        acc = addWidened(acc, _mm256_extracti128_si256(products, 1));
+    }
+#endif
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i products = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)),
+                                          _mm_loadu_si128((const __m128i *)(b + i)));
+        acc = addWidened(acc, products);
+    }
+
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    int64_t sum = lanes[0] + lanes[1];
+    for (; i < n; i++)
+    {
+        sum += (int32_t)a[i] * b[i];
+    }
+    return sum;
+}
+
+//*****************************************************************************
+// threshold count
+
+static uint32_t countAboveSimd(const uint16_t *x, uint32_t n, uint16_t threshold)
+{
+    const __m128i flip = _mm_set1_epi16((short)0x8000);
+    const __m128i limit = _mm_xor_si128(_mm_set1_epi16((short)threshold), flip);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    while (i + 8 <= n)
+    {
+        // Compare masks are -1 per hit; flush before a 16-bit lane wraps
+        __m128i acc = _mm_setzero_si128();
+        uint32_t chunk_end = (n - i > 8u * 0x7FFF) ? i + 8u * 0x7FFF : n;
+        for (; i + 8 <= chunk_end; i += 8)
+        {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(x + i)), flip);
+            acc = _mm_sub_epi16(acc, _mm_cmpgt_epi16(v, limit));
+        }
+        count += horizontalSum32(_mm_add_epi32(_mm_unpacklo_epi16(acc, zero), _mm_unpackhi_epi16(acc, zero)));
+    }
+
+    for (; i < n; i++)
+    {
+        count += (x[i] > threshold) ? 1 : 0;
+    }
+    return count;
+}
+
+static const BlockKernelSet block_kernels_simd = {
+#if defined(__AVX2__)
+    "avx2",
+#else
+    "sse2",
+#endif
+    sumSimd,
+    minMaxSimd,
+    scaleOffsetSimd,
+    dotSimd,
+    countAboveSimd,
+};
+
+const BlockKernelSet *blockKernelsSimd()
+{
+    return &block_kernels_simd;
+}
+
+#else // No SIMD variant for this target
+
+const BlockKernelSet *blockKernelsSimd()
+{
+    return nullptr;
+}
+
+#endif // __SSE2__
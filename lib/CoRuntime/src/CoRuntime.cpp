@@ -0,0 +1,452 @@
+#include "CoRuntime.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+#if !defined(ARDUINO)
+#include <chrono>
+
+#include <PortUtils.h>
+#endif
+
+enum
+{
+    CO_LIST_NONE = 0,
+    CO_LIST_POLL,
+    CO_LIST_NOTIFY
+};
+
+static std::atomic<size_t> frame_bytes(0);
+static thread_local CoExecutor *current_executor = nullptr;
+
+static inline uint32_t nowTicks()
+{
+#if defined(ARDUINO)
+    return (uint32_t)xTaskGetTickCount();
+#else
+    return (uint32_t)(monotonicMicros() / 1000u);
+#endif
+}
+
+static inline uint32_t msToTicks(uint32_t ms)
+{
+#if defined(ARDUINO)
+    return (uint32_t)pdMS_TO_TICKS(ms);
+#else
+    return ms;
+#endif
+}
+
+//*****************************************************************************
+// Frames
+
+void CoTask::promise_type::unhandled_exception()
+{
+    abort();
+}
+
+void *CoTask::promise_type::operator new(size_t size) noexcept
+{
+    void *frame = ::operator new(size, std::nothrow);
+    if (frame != nullptr)
+    {
+        frame_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return frame;
+}
+
+void CoTask::promise_type::operator delete(void *frame, size_t size) noexcept
+{
+    frame_bytes.fetch_sub(size, std::memory_order_relaxed);
+    ::operator delete(frame);
+}
+
+size_t CoExecutor::frameBytes()
+{
+    return frame_bytes.load(std::memory_order_relaxed);
+}
+
+CoExecutor *CoExecutor::current()
+{
+    return current_executor;
+}
+
+//*****************************************************************************
+// Executor
+
+CoExecutor::CoExecutor()
+    : ready_head_(nullptr),
+      ready_tail_(nullptr),
+      ready_count_(0),
+      poll_head_(nullptr),
+      notify_head_(nullptr),
+      wheel_(nowTicks()),
+      pending_bits_(0),
+      live_(0),
+      switches_(0)
+#if defined(ARDUINO)
+      ,
+      task_(NULL)
+#else
+      ,
+      incoming_bits_(0),
+      woken_(false)
+#endif
+{
+}
+
+CoExecutor::~CoExecutor()
+{
+    // Coroutines spawned but never run; ones suspended elsewhere are not reachable
+    while (ready_head_ != nullptr)
+    {
+        CoWaiter *waiter = ready_head_;
+        ready_head_ = waiter->next;
+        waiter->handle.destroy();
+    }
+}
+
+bool CoExecutor::spawn(CoTask &&task)
+{
+    if (!task.valid())
+    {
+        return false;
+    }
+    std::coroutine_handle<CoTask::promise_type> handle = task.release();
+    CoWaiter *waiter = &handle.promise().waiter;
+    waiter->handle = handle;
+    live_++;
+    schedule(waiter);
+    return true;
+}
+
+void CoExecutor::schedule(CoWaiter *waiter)
+{
+    waiter->next = nullptr;
+    if (ready_tail_ == nullptr)
+    {
+        ready_head_ = waiter;
+    }
+    else
+    {
+        ready_tail_->next = waiter;
+    }
+    ready_tail_ = waiter;
+    ready_count_++;
+}
+
+void CoExecutor::run()
+{
+    CoExecutor *outer = current_executor;
+    current_executor = this;
+#if defined(ARDUINO)
+    task_ = xTaskGetCurrentTaskHandle();
+#endif
+
+    while (live_ > 0)
+    {
+        wheel_.advance(nowTicks());
+        deliverBits();
+        pollWaits();
+
+        // Everything ready now runs once; what it readies runs next round
+        for (uint32_t n = ready_count_; n > 0 && ready_head_ != nullptr; n--)
+        {
+            CoWaiter *waiter = ready_head_;
+            ready_head_ = waiter->next;
+            if (ready_head_ == nullptr)
+            {
+                ready_tail_ = nullptr;
+            }
+            ready_count_--;
+
+            std::coroutine_handle<> handle = waiter->handle;
+            switches_++;
+            handle.resume();
+            if (handle.done())
+            {
+                handle.destroy();
+                live_--;
+            }
+        }
+
+        if (ready_head_ == nullptr && live_ > 0)
+        {
+            uint32_t ticks = wheel_.ticksUntilNext();
+            if (poll_head_ != nullptr && ticks > 1)
+            {
+                ticks = 1;
+            }
+            idle(ticks);
+        }
+    }
+
+    current_executor = outer;
+}
+
+//*****************************************************************************
+// Timed waits
+
+void CoExecutor::onTimer(WheelTimerHandle_t timer)
+{
+    CoTimedWait *wait = (CoTimedWait *)timer->id;
+    wait->executor->finish(wait, false);
+}
+
+void CoExecutor::arm(CoTimedWait *wait, uint32_t ms)
+{
+    wait->executor = this;
+    wait->list = CO_LIST_NONE;
+    wait->ok = false;
+    TimingWheel::initTimer(&wait->timer, nullptr, msToTicks(ms), false, wait, onTimer);
+    if (ms != CO_FOREVER)
+    {
+        wheel_.start(&wait->timer);
+    }
+}
+
+void CoExecutor::link(CoTimedWait **head, CoTimedWait *wait, uint8_t list)
+{
+    wait->list = list;
+    wait->prev_wait = nullptr;
+    wait->next_wait = *head;
+    if (*head != nullptr)
+    {
+        (*head)->prev_wait = wait;
+    }
+    *head = wait;
+}
+
+void CoExecutor::unlink(CoTimedWait *wait)
+{
+    CoTimedWait **head = (wait->list == CO_LIST_POLL) ? &poll_head_ : &notify_head_;
+    if (wait->list == CO_LIST_NONE)
+    {
+        return;
+    }
+    if (wait->prev_wait != nullptr)
+    {
+        wait->prev_wait->next_wait = wait->next_wait;
+    }
+    else
+    {
+        *head = wait->next_wait;
+    }
+    if (wait->next_wait != nullptr)
+    {
+        wait->next_wait->prev_wait = wait->prev_wait;
+    }
+    wait->list = CO_LIST_NONE;
+}
+
+// Timer fired (ok false) or the wait was satisfied (ok true)
+void CoExecutor::finish(CoTimedWait *wait, bool ok)
+{
+    wheel_.stop(&wait->timer);
+    unlink(wait);
+    wait->ok = ok;
+    schedule(wait);
+}
+
+void CoExecutor::sleep(CoTimedWait *wait, uint32_t ms)
+{
+    if (ms == 0)
+    {
+        schedule(wait);
+        return;
+    }
+    arm(wait, ms);
+}
+
+void CoExecutor::waitPoll(CoTimedWait *wait, uint32_t timeout_ms)
+{
+    arm(wait, timeout_ms);
+    link(&poll_head_, wait, CO_LIST_POLL);
+}
+
+void CoExecutor::waitNotify(CoTimedWait *wait, uint32_t timeout_ms)
+{
+    arm(wait, timeout_ms);
+    link(&notify_head_, wait, CO_LIST_NOTIFY);
+}
+
+void CoExecutor::pollWaits()
+{
+    CoTimedWait *wait = poll_head_;
+    while (wait != nullptr)
+    {
+        CoTimedWait *next = wait->next_wait;
+        if (wait->poll(wait->object, wait->item))
+        {
+            finish(wait, true);
+        }
+        wait = next;
+    }
+}
+
+//*****************************************************************************
+// Notifications
+
+bool CoExecutor::takeBits(uint32_t mask, uint32_t *bits)
+{
+    deliverBits();
+    *bits = pending_bits_ & mask;
+    pending_bits_ &= ~mask;
+    return *bits != 0;
+}
+
+void CoExecutor::deliverBits()
+{
+#if defined(ARDUINO)
+    uint32_t bits = 0;
+    if (xTaskNotifyWait(0, UINT32_MAX, &bits, 0) == pdTRUE)
+    {
+        pending_bits_ |= bits;
+    }
+#else
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_bits_ |= incoming_bits_;
+        incoming_bits_ = 0;
+        woken_ = false;
+    }
+#endif
+
+    CoTimedWait *wait = notify_head_;
+    while (wait != nullptr && pending_bits_ != 0)
+    {
+        CoTimedWait *next = wait->next_wait;
+        uint32_t bits = pending_bits_ & wait->bits;
+        if (bits != 0)
+        {
+            pending_bits_ &= ~bits;
+            wait->bits = bits;
+            finish(wait, true);
+        }
+        wait = next;
+    }
+}
+
+#if defined(ARDUINO)
+
+void CoExecutor::notify(uint32_t bits)
+{
+    if (task_ != NULL)
+    {
+        xTaskNotify(task_, bits, eSetBits);
+    }
+}
+
+void CoExecutor::notifyFromISR(uint32_t bits, BaseType_t *task_woken)
+{
+    if (task_ != NULL)
+    {
+        xTaskNotifyFromISR(task_, bits, eSetBits, task_woken);
+    }
+}
+
+// Blocks until the next timer, a notification or wake()
+void CoExecutor::idle(uint32_t ticks)
+{
+    uint32_t bits = 0;
+    TickType_t wait = (ticks == TimingWheel::NO_EXPIRY) ? portMAX_DELAY : (TickType_t)ticks;
+    if (xTaskNotifyWait(0, UINT32_MAX, &bits, wait) == pdTRUE)
+    {
+        pending_bits_ |= bits;
+    }
+}
+
+static void executorTask(void *parameters)
+{
+    CoExecutor *executor = (CoExecutor *)parameters;
+    executor->run();
+    vTaskDelete(NULL);
+}
+
+bool CoExecutor::start(const char *name, uint32_t stack_size, UBaseType_t priority, BaseType_t core)
+{
+    return xTaskCreatePinnedToCore(executorTask, name, stack_size, this, priority, &task_, core) == pdPASS;
+}
+
+static bool takeSemaphore(void *object, void *)
+{
+    return xSemaphoreTake((SemaphoreHandle_t)object, 0) == pdTRUE;
+}
+
+static bool receiveItem(void *object, void *item)
+{
+    return xQueueReceive((QueueHandle_t)object, item, 0) == pdTRUE;
+}
+
+CoPoll coTake(SemaphoreHandle_t sem, uint32_t timeout_ms)
+{
+    return CoPoll(takeSemaphore, sem, nullptr, timeout_ms);
+}
+
+CoPoll coReceive(QueueHandle_t queue, void *item, uint32_t timeout_ms)
+{
+    return CoPoll(receiveItem, queue, item, timeout_ms);
+}
+
+#else
+
+void CoExecutor::notify(uint32_t bits)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    incoming_bits_ |= bits;
+    woken_ = true;
+    cond_.notify_one();
+}
+
+void CoExecutor::idle(uint32_t ticks)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (ticks == TimingWheel::NO_EXPIRY)
+    {
+        cond_.wait(lock, [this] { return woken_; });
+    }
+    else
+    {
+        cond_.wait_for(lock, std::chrono::milliseconds(ticks), [this] { return woken_; });
+    }
+}
+
+#endif // ARDUINO
+
+//*****************************************************************************
+// Semaphore
+
+// Runs inside await_suspend, so the executor is the waiter's own
+void CoSemaphore::enqueue(CoWaiter *waiter)
+{
+    executor_ = CoExecutor::current();
+    waiter->next = nullptr;
+    if (tail_ == nullptr)
+    {
+        head_ = waiter;
+    }
+    else
+    {
+        tail_->next = waiter;
+    }
+    tail_ = waiter;
+}
+
+void CoSemaphore::give()
+{
+    CoWaiter *waiter = head_;
+    if (waiter == nullptr)
+    {
+        count_++;
+        return;
+    }
+    head_ = waiter->next;
+    if (head_ == nullptr)
+    {
+        tail_ = nullptr;
+    }
+    // current() is null outside run(), e.g. in setup()
+    executor_->schedule(waiter);
+}
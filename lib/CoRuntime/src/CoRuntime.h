@@ -0,0 +1,473 @@
+#ifndef CO_RUNTIME_H
+#define CO_RUNTIME_H
+
+// Stackless C++20 coroutines on one FreeRTOS task
+//
+// Every philosopher in src/main.cpp and every producer in part7_semaphore.cpp
+// is a task: a TCB plus 1-2 KB of stack, so a few dozen fill the ESP32's
+// SRAM. A coroutine keeps only its frame (the locals that live across a
+// co_await) on the heap, and all of them run on the stack of the one task
+// that hosts the CoExecutor:
+//
+//   CoTask philosopher(int num)
+//   {
+//       co_await chopstick[num].take();
+//       co_await coDelay(10);
+//       chopstick[num].give();
+//   }
+//
+//   executor.spawn(philosopher(i));
+//   executor.run(); // Until every coroutine has returned
+//
+// Coroutines are cooperative: one runs until its next co_await. Awaitables,
+// valid inside a coroutine run by an executor:
+//
+//   coYield()                          back of the ready queue
+//   coDelay(ms)                        sleep, on a TimingWheel
+//   CoSemaphore::take()                counting semaphore between coroutines
+//                                      of the same executor, FIFO hand-off
+//   coNotified(mask, ms)               bits sent with notify() from other
+//                                      tasks or ISRs; returns them, 0 on
+//                                      timeout
+//   coTake(sem, ms), coReceive(q, item, ms)
+//                                      FreeRTOS semaphore / queue (target
+//                                      only); true if taken in time
+//
+// Kernel objects cannot wake the executor by themselves: coTake() and
+// coReceive() waiters are retried once per tick while the executor idles,
+// so they see a give up to a tick late unless the giver also calls
+// executor.wake().
+//
+// spawn() and CoSemaphore are for the executor's own task (or before it
+// runs); notify() and wake() are for everyone else. On the host the
+// executor runs on the calling thread and time is in ms of monotonicMicros().
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <TimingWheel.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+static const uint32_t CO_FOREVER = UINT32_MAX;
+
+class CoExecutor;
+
+// A suspended coroutine on the ready queue or a semaphore's wait queue
+struct CoWaiter
+{
+    CoWaiter *next;
+    std::coroutine_handle<> handle;
+};
+
+// A suspension that can time out: delay, notification or kernel object
+struct CoTimedWait : CoWaiter
+{
+    CoTimedWait *prev_wait; // Poll or notify list
+    CoTimedWait *next_wait;
+    WheelTimer timer;
+    CoExecutor *executor;
+    bool (*poll)(void *object, void *item);
+    void *object;
+    void *item;
+    uint32_t bits; // Notify: bits waited for, then bits received
+    uint8_t list;
+    bool ok;
+};
+
+//*****************************************************************************
+// Coroutine type
+
+class CoTask
+{
+public:
+    struct promise_type
+    {
+        CoWaiter waiter; // Scheduling entry for the first resume
+
+        CoTask get_return_object()
+        {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        static CoTask get_return_object_on_allocation_failure()
+        {
+            return CoTask();
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception();
+
+        // Frames come from the heap; counted for frameBytes()
+        static void *operator new(size_t size) noexcept;
+        static void operator delete(void *frame, size_t size) noexcept;
+    };
+
+    CoTask() : handle_(nullptr)
+    {
+    }
+
+    CoTask(CoTask &&other) noexcept : handle_(other.handle_)
+    {
+        other.handle_ = nullptr;
+    }
+
+    ~CoTask()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    CoTask(const CoTask &) = delete;
+    CoTask &operator=(const CoTask &) = delete;
+
+    // False if the frame could not be allocated
+    bool valid() const
+    {
+        return (bool)handle_;
+    }
+
+    std::coroutine_handle<promise_type> release()
+    {
+        std::coroutine_handle<promise_type> handle = handle_;
+        handle_ = nullptr;
+        return handle;
+    }
+
+private:
+    explicit CoTask(std::coroutine_handle<promise_type> handle) : handle_(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+//*****************************************************************************
+// Executor
+
+class CoExecutor
+{
+public:
+    CoExecutor();
+    ~CoExecutor();
+
+    CoExecutor(const CoExecutor &) = delete;
+    CoExecutor &operator=(const CoExecutor &) = delete;
+
+    // Take ownership and queue it; false if the frame allocation failed
+    bool spawn(CoTask &&task);
+
+    // Run coroutines on the calling task until none is left
+    void run();
+
+#if defined(ARDUINO)
+    // run() in a new task, which deletes itself when done
+    bool start(const char *name, uint32_t stack_size, UBaseType_t priority, BaseType_t core);
+
+    // Set bits for coNotified() waiters; wakes the executor
+    void notifyFromISR(uint32_t bits, BaseType_t *task_woken);
+#endif
+
+    // From any task: set bits for coNotified() waiters and wake the executor
+    void notify(uint32_t bits);
+
+    // Re-poll coTake()/coReceive() now, e.g. after giving their semaphore
+    void wake()
+    {
+        notify(0);
+    }
+
+    // Coroutines spawned and not finished
+    uint32_t live() const
+    {
+        return live_;
+    }
+
+    // Resumes so far
+    uint32_t switches() const
+    {
+        return switches_;
+    }
+
+    // Heap held by coroutine frames, all executors
+    static size_t frameBytes();
+
+    // The executor running the calling coroutine
+    static CoExecutor *current();
+
+    // For awaitables
+    void schedule(CoWaiter *waiter);
+    void sleep(CoTimedWait *wait, uint32_t ms);
+    void waitPoll(CoTimedWait *wait, uint32_t timeout_ms);
+    void waitNotify(CoTimedWait *wait, uint32_t timeout_ms);
+    bool takeBits(uint32_t mask, uint32_t *bits);
+
+private:
+    static void onTimer(WheelTimerHandle_t timer);
+
+    void arm(CoTimedWait *wait, uint32_t ms);
+    void link(CoTimedWait **head, CoTimedWait *wait, uint8_t list);
+    void unlink(CoTimedWait *wait);
+    void finish(CoTimedWait *wait, bool ok);
+    void pollWaits();
+    void deliverBits();
+    void idle(uint32_t ticks);
+
+    CoWaiter *ready_head_;
+    CoWaiter *ready_tail_;
+    uint32_t ready_count_;
+    CoTimedWait *poll_head_;
+    CoTimedWait *notify_head_;
+    TimingWheel wheel_;
+    uint32_t pending_bits_;
+    uint32_t live_;
+    uint32_t switches_;
+
+#if defined(ARDUINO)
+    TaskHandle_t task_;
+#else
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    uint32_t incoming_bits_; // Guarded by mutex_
+    bool woken_;
+#endif
+};
+
+//*****************************************************************************
+// Awaitables
+
+class CoYield
+{
+public:
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        waiter_.handle = handle;
+        CoExecutor::current()->schedule(&waiter_);
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+
+private:
+    CoWaiter waiter_;
+};
+
+class CoDelay
+{
+public:
+    explicit CoDelay(uint32_t ms) : ms_(ms)
+    {
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        wait_.handle = handle;
+        CoExecutor::current()->sleep(&wait_, ms_);
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+
+private:
+    uint32_t ms_;
+    CoTimedWait wait_;
+};
+
+class CoNotified
+{
+public:
+    CoNotified(uint32_t mask, uint32_t timeout_ms) : mask_(mask), timeout_ms_(timeout_ms), bits_(0)
+    {
+        wait_.ok = false;
+    }
+
+    bool await_ready()
+    {
+        return CoExecutor::current()->takeBits(mask_, &bits_) || timeout_ms_ == 0;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        wait_.handle = handle;
+        wait_.bits = mask_;
+        CoExecutor::current()->waitNotify(&wait_, timeout_ms_);
+    }
+
+    uint32_t await_resume() const noexcept
+    {
+        return bits_ ? bits_ : (wait_.ok ? wait_.bits : 0);
+    }
+
+private:
+    uint32_t mask_;
+    uint32_t timeout_ms_;
+    uint32_t bits_;
+    CoTimedWait wait_;
+};
+
+// Retries poll(object, item) while the executor runs, until true or timeout
+class CoPoll
+{
+public:
+    CoPoll(bool (*poll)(void *object, void *item), void *object, void *item, uint32_t timeout_ms)
+        : poll_(poll), object_(object), item_(item), timeout_ms_(timeout_ms), now_(false)
+    {
+        wait_.ok = false;
+    }
+
+    bool await_ready()
+    {
+        now_ = poll_(object_, item_);
+        return now_ || timeout_ms_ == 0;
+    }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        wait_.handle = handle;
+        wait_.poll = poll_;
+        wait_.object = object_;
+        wait_.item = item_;
+        CoExecutor::current()->waitPoll(&wait_, timeout_ms_);
+    }
+
+    bool await_resume() const noexcept
+    {
+        return now_ || wait_.ok;
+    }
+
+private:
+    bool (*poll_)(void *object, void *item);
+    void *object_;
+    void *item_;
+    uint32_t timeout_ms_;
+    bool now_;
+    CoTimedWait wait_;
+};
+
+inline CoYield coYield()
+{
+    return CoYield();
+}
+
+inline CoDelay coDelay(uint32_t ms)
+{
+    return CoDelay(ms);
+}
+
+inline CoNotified coNotified(uint32_t mask, uint32_t timeout_ms = CO_FOREVER)
+{
+    return CoNotified(mask, timeout_ms);
+}
+
+#if defined(ARDUINO)
+CoPoll coTake(SemaphoreHandle_t sem, uint32_t timeout_ms = CO_FOREVER);
+
+// The item must stay valid until the co_await returns (a coroutine local)
+CoPoll coReceive(QueueHandle_t queue, void *item, uint32_t timeout_ms = CO_FOREVER);
+#endif
+
+//*****************************************************************************
+// Semaphore between coroutines of one executor
+
+class CoSemaphore
+{
+public:
+    explicit CoSemaphore(uint32_t count = 0) : count_(count), head_(nullptr), tail_(nullptr), executor_(nullptr)
+    {
+    }
+
+    class Take
+    {
+    public:
+        explicit Take(CoSemaphore *sem) : sem_(sem)
+        {
+        }
+
+        bool await_ready() noexcept
+        {
+            return sem_->tryTake();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            waiter_.handle = handle;
+            sem_->enqueue(&waiter_);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+
+    private:
+        CoSemaphore *sem_;
+        CoWaiter waiter_;
+    };
+
+    Take take()
+    {
+        return Take(this);
+    }
+
+    bool tryTake()
+    {
+        if (count_ > 0)
+        {
+            count_--;
+            return true;
+        }
+        return false;
+    }
+
+    // Hands the count straight to the first waiter, if any, on the executor
+    // that waiter suspended on. Not thread safe: call it from that
+    // executor's coroutines, or while the executor is not running.
+    void give();
+
+    uint32_t count() const
+    {
+        return count_;
+    }
+
+private:
+    void enqueue(CoWaiter *waiter);
+
+    uint32_t count_;
+    CoWaiter *head_;
+    CoWaiter *tail_;
+    CoExecutor *executor_; // Where the waiters suspended
+};
+
+#endif // CO_RUNTIME_H
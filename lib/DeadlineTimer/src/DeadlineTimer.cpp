@@ -0,0 +1,211 @@
+#include "DeadlineTimer.h"
+
+// Settings
+static const uint32_t rescue_stack_size = 2048;
+
+// Globals: timers waiting for the helper task to re-arm them
+static portMUX_TYPE rescue_mux = portMUX_INITIALIZER_UNLOCKED;
+static DeadlineTimer *rescue_head = nullptr;
+static TaskHandle_t rescue_task = NULL;
+static bool rescue_starting = false;
+
+DeadlineTimer::DeadlineTimer()
+    : timer_(NULL),
+      callback_(nullptr),
+      id_(nullptr),
+      timeout_(0),
+      deadline_(0),
+      armed_(false),
+      cancelled_(false),
+      daemon_commands_(0),
+      coalesced_(0),
+      rescues_(0),
+      rescue_next_(nullptr),
+      rescue_queued_(false)
+{
+}
+
+// One helper for all deadline timers, started by the first begin()
+static bool startRescueTask(TaskFunction_t function)
+{
+    portENTER_CRITICAL(&rescue_mux);
+    bool start = !rescue_starting;
+    rescue_starting = true;
+    portEXIT_CRITICAL(&rescue_mux);
+    if (!start)
+    {
+        return true;
+    }
+
+    // Same priority as the daemon, so the daemon drains the queue in between
+    if (xTaskCreate(function, "DeadlineRescue", rescue_stack_size, NULL, configTIMER_TASK_PRIORITY, &rescue_task) != pdPASS)
+    {
+        portENTER_CRITICAL(&rescue_mux);
+        rescue_starting = false;
+        portEXIT_CRITICAL(&rescue_mux);
+        return false;
+    }
+    return true;
+}
+
+bool DeadlineTimer::begin(const char *name, TickType_t timeout, DeadlineCallbackFunction_t callback, void *id)
+{
+    callback_ = callback;
+    id_ = id;
+    timeout_ = (timeout > 0) ? timeout : 1;
+
+    if (!startRescueTask(rescueTask))
+    {
+        return false;
+    }
+
+    // One-shot; the ID lets the static daemon callback find this object
+    timer_ = xTimerCreate(name, timeout_, pdFALSE, this, onExpiry);
+    return timer_ != NULL;
+}
+
+void DeadlineTimer::touch()
+{
+    touch(timeout_);
+}
+
+void DeadlineTimer::touch(TickType_t timeout)
+{
+    timeout_ = (timeout > 0) ? timeout : 1;
+    cancelled_.store(false);
+    deadline_.store(xTaskGetTickCount() + timeout_);
+
+    // Only the touch that finds the timer idle talks to the daemon
+    if (!armed_.exchange(true))
+    {
+        rearm(timeout_, portMAX_DELAY);
+    }
+    else
+    {
+        coalesced_ = coalesced_ + 1;
+    }
+}
+
+void DeadlineTimer::cancel()
+{
+    // The daemon callback sees the flag and goes idle without firing
+    cancelled_.store(true);
+}
+
+TickType_t DeadlineTimer::remainingTicks() const
+{
+    if (!armed_.load() || cancelled_.load())
+    {
+        return 0;
+    }
+    int32_t remain = (int32_t)(deadline_.load() - xTaskGetTickCount());
+    return (remain > 0) ? (TickType_t)remain : 0;
+}
+
+// xTimerChangePeriod() also starts a dormant timer
+bool DeadlineTimer::rearm(TickType_t ticks, TickType_t block_time)
+{
+    daemon_commands_ = daemon_commands_ + 1;
+    return xTimerChangePeriod(timer_, ticks, block_time) == pdPASS;
+}
+
+// Runs in the timer daemon task; armed_ stays set while the helper owns it
+void DeadlineTimer::queueRescue()
+{
+    portENTER_CRITICAL(&rescue_mux);
+    if (!rescue_queued_)
+    {
+        rescue_queued_ = true;
+        rescue_next_ = rescue_head;
+        rescue_head = this;
+    }
+    portEXIT_CRITICAL(&rescue_mux);
+    rescues_ = rescues_ + 1;
+
+    // A notification does not go through the daemon queue
+    xTaskNotifyGive(rescue_task);
+}
+
+// Not the daemon, so it may wait for room. The expiry that follows decides
+// again whether to fire, re-arm or honour a cancel.
+void DeadlineTimer::rescue()
+{
+    while (1)
+    {
+        int32_t remain = (int32_t)(deadline_.load() - xTaskGetTickCount());
+        if (rearm((remain > 0) ? (TickType_t)remain : 1, 1))
+        {
+            return;
+        }
+    }
+}
+
+void DeadlineTimer::rescueTask(void *parameters)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (1)
+        {
+            portENTER_CRITICAL(&rescue_mux);
+            DeadlineTimer *timer = rescue_head;
+            if (timer != nullptr)
+            {
+                rescue_head = timer->rescue_next_;
+                timer->rescue_queued_ = false;
+            }
+            portEXIT_CRITICAL(&rescue_mux);
+            if (timer == nullptr)
+            {
+                break;
+            }
+            timer->rescue();
+        }
+    }
+}
+
+// Runs in the timer daemon task
+void DeadlineTimer::onExpiry(TimerHandle_t xTimer)
+{
+    DeadlineTimer *self = (DeadlineTimer *)pvTimerGetTimerID(xTimer);
+    TickType_t now = xTaskGetTickCount();
+
+    if (self->cancelled_.load())
+    {
+        self->armed_.store(false);
+        return;
+    }
+
+    // Deadline moved while we were waiting: sleep for the remainder. The
+    // daemon must not block on its own queue, hence the zero block time. If
+    // the queue is full the helper task re-arms instead.
+    int32_t remain = (int32_t)(self->deadline_.load() - now);
+    if (remain > 0)
+    {
+        if (!self->rearm((TickType_t)remain, 0))
+        {
+            self->queueRescue();
+        }
+        return;
+    }
+
+    self->armed_.store(false);
+
+    // A touch() may have landed between the check above and clearing the
+    // flag. If the deadline is in the future again the timer must stay
+    // armed (either by that touch or by us) and the callback must not run.
+    remain = (int32_t)(self->deadline_.load() - now);
+    if (remain > 0)
+    {
+        if (!self->armed_.exchange(true) && !self->rearm((TickType_t)remain, 0))
+        {
+            self->queueRescue();
+        }
+        return;
+    }
+
+    if (self->callback_ != nullptr)
+    {
+        self->callback_(self);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef DEADLINE_TIMER_H
+#define DEADLINE_TIMER_H
+
+// One-shot software timer with coalesced restarts ("deadline" mode)
+//
+// xTimerStart()/xTimerReset() post a command to the timer daemon queue on
+// every call, so restarting a timeout for every received byte floods it.
+// touch() only stores a new deadline in place. The FreeRTOS timer underneath
+// is armed once; when it fires before the current deadline the daemon simply
+// re-arms it for the remaining time. N touches therefore cost at most one
+// daemon command per expiry instead of N.
+//
+// touch() may be called from any task. The callback runs in the timer daemon
+// task, exactly like a TimerCallbackFunction_t.
+//
+// The daemon must not block on its own queue, so a re-arm it cannot post
+// (queue full) is handed to a helper task shared by all deadline timers,
+// which waits for room. The deadline is never dropped.
+
+#include <Arduino.h>
+#include <atomic>
+
+class DeadlineTimer;
+typedef void (*DeadlineCallbackFunction_t)(DeadlineTimer *timer);
+
+class DeadlineTimer
+{
+public:
+    DeadlineTimer();
+
+    // Create the underlying one-shot FreeRTOS timer. Returns false on failure.
+    bool begin(const char *name, TickType_t timeout, DeadlineCallbackFunction_t callback, void *id = nullptr);
+
+    // Push the deadline to now + timeout, arming the timer if it is idle
+    void touch();
+
+    // Push the deadline and change the timeout used by later touches
+    void touch(TickType_t timeout);
+
+    // Cancel a pending deadline; the callback will not run
+    void cancel();
+
+    bool isArmed() const
+    {
+        return armed_.load();
+    }
+
+    // Ticks left until the deadline, 0 if idle or already due
+    TickType_t remainingTicks() const;
+
+    TickType_t deadline() const
+    {
+        return deadline_.load();
+    }
+
+    void *getId() const
+    {
+        return id_;
+    }
+
+    // The underlying one-shot FreeRTOS timer
+    TimerHandle_t handle() const
+    {
+        return timer_;
+    }
+
+    // Commands this timer has posted to the timer daemon queue
+    uint32_t daemonCommands() const
+    {
+        return daemon_commands_;
+    }
+
+    // touch() calls that only moved the deadline in place
+    uint32_t coalescedTouches() const
+    {
+        return coalesced_;
+    }
+
+    // Re-arms the daemon found no room for and left to the helper task
+    uint32_t rescuedRearms() const
+    {
+        return rescues_;
+    }
+
+private:
+    static void onExpiry(TimerHandle_t xTimer);
+    static void rescueTask(void *parameters);
+    bool rearm(TickType_t ticks, TickType_t block_time);
+    void queueRescue();
+    void rescue();
+
+    TimerHandle_t timer_;
+    DeadlineCallbackFunction_t callback_;
+    void *id_;
+    TickType_t timeout_;
+    std::atomic<TickType_t> deadline_;
+    std::atomic<bool> armed_;
+    std::atomic<bool> cancelled_;
+    volatile uint32_t daemon_commands_;
+    volatile uint32_t coalesced_;
+    volatile uint32_t rescues_;
+    DeadlineTimer *rescue_next_; // Helper task's list, under its lock
+    bool rescue_queued_;
+};
+
+#endif // DEADLINE_TIMER_H
@@ -0,0 +1,354 @@
+#include "DeadlockDetector.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <PortUtils.h>
+
+static void defaultReporter(const char *line)
+{
+#if defined(ARDUINO)
+    Serial.println(line);
+#else
+    printf("%s\n", line);
+#endif
+}
+
+DeadlockDetector::DeadlockDetector(HolderFunction holder)
+    : holder_(holder), reporter_(defaultReporter), recovery_(nullptr), recovery_context_(nullptr), num_locks_(0),
+      next_wait_id_(0), num_reported_(0), interval_ms_(100)
+{
+    for (uint32_t i = 0; i < MAX_WAITERS; i++)
+    {
+        slots_[i].task.store(nullptr, std::memory_order_relaxed);
+        slots_[i].lock.store(nullptr, std::memory_order_relaxed);
+        slots_[i].task_name = nullptr;
+        slots_[i].wait_id = 0;
+    }
+    memset(&stats_, 0, sizeof(stats_));
+#if defined(ARDUINO)
+    lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+}
+
+bool DeadlockDetector::addLock(void *lock, const char *name)
+{
+    bool ok = false;
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&lock_);
+#else
+    std::lock_guard<std::mutex> guard(lock_);
+#endif
+    uint32_t n = num_locks_.load(std::memory_order_relaxed);
+    if (n < MAX_LOCKS)
+    {
+        lock_names_[n].lock = lock;
+        lock_names_[n].name = name;
+        num_locks_.store(n + 1, std::memory_order_release);
+        ok = true;
+    }
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&lock_);
+#endif
+    return ok;
+}
+
+const char *DeadlockDetector::lockName(void *lock) const
+{
+    uint32_t n = num_locks_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (lock_names_[i].lock == lock)
+        {
+            return lock_names_[i].name;
+        }
+    }
+    return "?";
+}
+
+//*****************************************************************************
+// Waiting side
+
+int32_t DeadlockDetector::waitBegin(void *task, const char *task_name, void *lock)
+{
+    for (uint32_t i = 0; i < MAX_WAITERS; i++)
+    {
+        void *expected = nullptr;
+        if (slots_[i].task.load(std::memory_order_relaxed) == nullptr &&
+            slots_[i].task.compare_exchange_strong(expected, task, std::memory_order_acquire))
+        {
+            // The monitor skips the slot until the lock is set
+            slots_[i].task_name = task_name;
+            slots_[i].wait_id = next_wait_id_.fetch_add(1, std::memory_order_relaxed);
+            slots_[i].lock.store(lock, std::memory_order_release);
+            return (int32_t)i;
+        }
+    }
+    return NO_SLOT;
+}
+
+void DeadlockDetector::waitEnd(int32_t slot)
+{
+    if (slot == NO_SLOT)
+    {
+        return;
+    }
+    slots_[slot].lock.store(nullptr, std::memory_order_relaxed);
+    slots_[slot].task.store(nullptr, std::memory_order_release);
+}
+
+bool DeadlockDetector::stillWaiting(void *task, void *lock) const
+{
+    for (uint32_t i = 0; i < MAX_WAITERS; i++)
+    {
+        if (slots_[i].task.load(std::memory_order_acquire) == task)
+        {
+            return slots_[i].lock.load(std::memory_order_acquire) == lock;
+        }
+    }
+    return false;
+}
+
+//*****************************************************************************
+// Monitor
+
+uint32_t DeadlockDetector::cycleKey(const DeadlockCycle &cycle, const uint32_t *wait_ids) const
+{
+    // Sum over the waits: the same for every rotation of the cycle, new when
+    // the same tasks deadlock again on the same locks
+    uint32_t key = cycle.length;
+    for (uint32_t i = 0; i < cycle.length; i++)
+    {
+        key += ((uint32_t)(uintptr_t)cycle.tasks[i] * 2654435761u) ^ (uint32_t)(uintptr_t)cycle.locks[i] ^
+               (wait_ids[i] * 0x9E3779B9u);
+    }
+    return key;
+}
+
+uint32_t DeadlockDetector::scan()
+{
+    void *tasks[MAX_WAITERS];
+    void *locks[MAX_WAITERS];
+    const char *names[MAX_WAITERS];
+    uint32_t wait_ids[MAX_WAITERS];
+    int8_t next[MAX_WAITERS];
+    uint8_t state[MAX_WAITERS]; // 0 unvisited, 1 on the current walk, 2 done
+    uint8_t path[MAX_WAITERS];
+    DeadlockCycle found[MAX_REPORTED];
+    uint32_t keys[MAX_REPORTED];
+    uint32_t num_found = 0;
+
+    uint32_t start = cpuCycleCount();
+
+    // Snapshot of who waits for what
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < MAX_WAITERS; i++)
+    {
+        void *task = slots_[i].task.load(std::memory_order_acquire);
+        void *lock = slots_[i].lock.load(std::memory_order_acquire);
+        if (task != nullptr && lock != nullptr)
+        {
+            tasks[n] = task;
+            locks[n] = lock;
+            names[n] = slots_[i].task_name;
+            wait_ids[n] = slots_[i].wait_id;
+            state[n] = 0;
+            n++;
+        }
+    }
+
+    // Edge i -> j: the lock task i waits for is held by task j
+    for (uint32_t i = 0; i < n; i++)
+    {
+        void *holder = holder_(locks[i]);
+        next[i] = -1;
+        for (uint32_t j = 0; j < n && holder != nullptr; j++)
+        {
+            if (tasks[j] == holder)
+            {
+                next[i] = (int8_t)j;
+                break;
+            }
+        }
+    }
+
+    // Every node has at most one successor: walk from each unvisited node
+    // until the walk ends, joins an earlier walk or meets itself
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t len = 0;
+        int32_t at = (int32_t)i;
+        while (at >= 0 && state[at] == 0)
+        {
+            state[at] = 1;
+            path[len++] = (uint8_t)at;
+            at = next[at];
+        }
+        if (at >= 0 && state[at] == 1 && num_found < MAX_REPORTED)
+        {
+            uint32_t first = 0;
+            while (path[first] != (uint32_t)at)
+            {
+                first++;
+            }
+            DeadlockCycle &cycle = found[num_found];
+            uint32_t ids[DeadlockCycle::MAX_LENGTH];
+            cycle.length = 0;
+            bool stable = true;
+            for (uint32_t k = first; k < len && cycle.length < DeadlockCycle::MAX_LENGTH; k++)
+            {
+                uint32_t node = path[k];
+                uint32_t succ = (uint32_t)next[node];
+                // Re-check: a stale snapshot can show a cycle that never was
+                stable = stable && stillWaiting(tasks[node], locks[node]) && holder_(locks[node]) == tasks[succ];
+                cycle.tasks[cycle.length] = tasks[node];
+                cycle.task_names[cycle.length] = names[node];
+                cycle.locks[cycle.length] = locks[node];
+                cycle.lock_names[cycle.length] = lockName(locks[node]);
+                ids[cycle.length] = wait_ids[node];
+                cycle.length++;
+            }
+            if (stable)
+            {
+                keys[num_found++] = cycleKey(cycle, ids);
+            }
+        }
+        for (uint32_t k = 0; k < len; k++)
+        {
+            state[path[k]] = 2;
+        }
+    }
+
+    uint32_t elapsed = cpuCycleCount() - start;
+
+    // Report what was not there at the previous scan
+    uint32_t new_cycles = 0;
+    for (uint32_t c = 0; c < num_found; c++)
+    {
+        bool seen = false;
+        for (uint32_t r = 0; r < num_reported_; r++)
+        {
+            seen = seen || reported_[r] == keys[c];
+        }
+        if (!seen)
+        {
+            new_cycles++;
+            report(found[c]);
+            if (recovery_ != nullptr)
+            {
+                recovery_(found[c], recovery_context_);
+            }
+        }
+    }
+    memcpy(reported_, keys, num_found * sizeof(keys[0]));
+    num_reported_ = num_found;
+
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&lock_);
+#else
+    std::lock_guard<std::mutex> guard(lock_);
+#endif
+    stats_.scans++;
+    stats_.cycles += new_cycles;
+    stats_.max_waiters = (n > stats_.max_waiters) ? n : stats_.max_waiters;
+    stats_.last_scan_cycles = elapsed;
+    stats_.max_scan_cycles = (elapsed > stats_.max_scan_cycles) ? elapsed : stats_.max_scan_cycles;
+    stats_.total_scan_cycles += elapsed;
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&lock_);
+#endif
+    return new_cycles;
+}
+
+void DeadlockDetector::report(const DeadlockCycle &cycle) const
+{
+    char line[128];
+    if (reporter_ == nullptr)
+    {
+        return;
+    }
+    snprintf(line, sizeof(line), "DEADLOCK: %lu tasks waiting in a cycle", (unsigned long)cycle.length);
+    reporter_(line);
+    for (uint32_t i = 0; i < cycle.length; i++)
+    {
+        uint32_t holder = (i + 1) % cycle.length;
+        snprintf(line, sizeof(line), "  %s waits for \"%s\", held by %s",
+                 cycle.task_names[i] ? cycle.task_names[i] : "?",
+                 cycle.lock_names[i],
+                 cycle.task_names[holder] ? cycle.task_names[holder] : "?");
+        reporter_(line);
+    }
+}
+
+DeadlockDetectorStats DeadlockDetector::stats() const
+{
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&lock_);
+    DeadlockDetectorStats s = stats_;
+    portEXIT_CRITICAL(&lock_);
+#else
+    std::lock_guard<std::mutex> guard(lock_);
+    DeadlockDetectorStats s = stats_;
+#endif
+    s.interval_ms = interval_ms_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void DeadlockDetector::resetStats()
+{
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&lock_);
+#else
+    std::lock_guard<std::mutex> guard(lock_);
+#endif
+    memset(&stats_, 0, sizeof(stats_));
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&lock_);
+#endif
+}
+
+//*****************************************************************************
+// FreeRTOS monitor task
+
+#if defined(ARDUINO)
+
+bool DeadlockDetector::begin(uint32_t interval_ms, UBaseType_t priority, BaseType_t core)
+{
+    setInterval(interval_ms);
+    return xTaskCreatePinnedToCore(taskEntry, "Deadlock", 3072, this, priority, NULL, core) == pdPASS;
+}
+
+void DeadlockDetector::setInterval(uint32_t interval_ms)
+{
+    interval_ms_.store(interval_ms > 0 ? interval_ms : 1, std::memory_order_relaxed);
+}
+
+void DeadlockDetector::taskEntry(void *parameters)
+{
+    DeadlockDetector *detector = (DeadlockDetector *)parameters;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(detector->interval_ms_.load(std::memory_order_relaxed)));
+        detector->scan();
+    }
+}
+
+BaseType_t DeadlockDetector::take(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+    // Uncontended: nothing to publish
+    if (xSemaphoreTake(mutex, 0) == pdTRUE)
+    {
+        return pdTRUE;
+    }
+    if (ticks == 0)
+    {
+        return pdFALSE;
+    }
+    int32_t slot = waitBegin(xTaskGetCurrentTaskHandle(), pcTaskGetName(NULL), mutex);
+    BaseType_t taken = xSemaphoreTake(mutex, ticks);
+    waitEnd(slot);
+    return taken;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,153 @@
+#ifndef DEADLOCK_DETECTOR_H
+#define DEADLOCK_DETECTOR_H
+
+// Wait-for-graph deadlock detector
+//
+// FreeRTOS knows who holds a mutex (xSemaphoreGetMutexHolder()) but not who
+// is blocked on it, so tasks take monitored mutexes through take(), which
+// publishes "task T waits for lock L" in a slot for the length of the wait.
+// A low-priority monitor periodically scans the slots: T waits for L, L is
+// held by T', T' waits for L', ... and a chain that comes back to T is a
+// deadlock. Each task waits for at most one lock, so the scan is linear in
+// the number of waiting tasks.
+//
+// A cycle is reported once (through the Reporter, Serial by default), then
+// handed to the optional recovery callback, e.g. to xTaskAbortDelay() one
+// of the tasks so its take() fails and it can back off.
+//
+// The core is portable: locks and tasks are opaque pointers and the holder
+// of a lock comes from a callback, so the host build can drive it with
+// std::mutex and threads.
+
+#include <atomic>
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <mutex>
+#endif
+
+struct DeadlockCycle
+{
+    static const uint32_t MAX_LENGTH = 8;
+
+    uint32_t length;
+    void *tasks[MAX_LENGTH];           // tasks[i] waits for locks[i] ...
+    const char *task_names[MAX_LENGTH];
+    void *locks[MAX_LENGTH];           // ... which tasks[i + 1] holds
+    const char *lock_names[MAX_LENGTH];
+};
+
+struct DeadlockDetectorStats
+{
+    uint32_t scans;
+    uint32_t cycles;          // Distinct cycles reported
+    uint32_t max_waiters;     // Most tasks seen waiting in one scan
+    uint32_t last_scan_cycles;
+    uint32_t max_scan_cycles;
+    uint64_t total_scan_cycles;
+    uint32_t interval_ms;
+};
+
+class DeadlockDetector
+{
+public:
+    static const uint32_t MAX_WAITERS = 32;
+    static const uint32_t MAX_LOCKS = 32;
+    static const int32_t NO_SLOT = -1;
+
+    typedef void *(*HolderFunction)(void *lock);
+    typedef void (*Reporter)(const char *line);
+    typedef void (*RecoveryFunction)(const DeadlockCycle &cycle, void *context);
+
+    explicit DeadlockDetector(HolderFunction holder);
+
+    // Name must stay valid. Unregistered locks are reported as "?".
+    bool addLock(void *lock, const char *name);
+
+    void setReporter(Reporter reporter)
+    {
+        reporter_ = reporter;
+    }
+
+    void setRecovery(RecoveryFunction recovery, void *context)
+    {
+        recovery_ = recovery;
+        recovery_context_ = context;
+    }
+
+    // Waiting side: publish the wait before blocking, withdraw it after.
+    // Returns NO_SLOT (wait not monitored) when all slots are busy.
+    int32_t waitBegin(void *task, const char *task_name, void *lock);
+    void waitEnd(int32_t slot);
+
+    // One pass over the waiters. Returns the number of new cycles.
+    uint32_t scan();
+
+    DeadlockDetectorStats stats() const;
+    void resetStats();
+
+#if defined(ARDUINO)
+    // Start the monitor task, scanning every interval_ms
+    bool begin(uint32_t interval_ms, UBaseType_t priority, BaseType_t core);
+
+    // Applied after the current interval
+    void setInterval(uint32_t interval_ms);
+
+    // xSemaphoreTake() with the wait published to the monitor
+    BaseType_t take(SemaphoreHandle_t mutex, TickType_t ticks);
+#endif
+
+private:
+    struct WaitSlot
+    {
+        std::atomic<void *> task; // nullptr: free
+        std::atomic<void *> lock;
+        const char *task_name;
+        uint32_t wait_id; // Tells a new wait for the same lock from a standing one
+    };
+
+    struct LockName
+    {
+        void *lock;
+        const char *name;
+    };
+
+    static const uint32_t MAX_REPORTED = 8;
+
+    const char *lockName(void *lock) const;
+    bool stillWaiting(void *task, void *lock) const;
+    void report(const DeadlockCycle &cycle) const;
+    uint32_t cycleKey(const DeadlockCycle &cycle, const uint32_t *wait_ids) const;
+
+#if defined(ARDUINO)
+    static void taskEntry(void *parameters);
+#endif
+
+    HolderFunction holder_;
+    Reporter reporter_;
+    RecoveryFunction recovery_;
+    void *recovery_context_;
+
+    WaitSlot slots_[MAX_WAITERS];
+    LockName lock_names_[MAX_LOCKS];
+    std::atomic<uint32_t> num_locks_;
+    std::atomic<uint32_t> next_wait_id_;
+
+    // Cycles seen in the previous scan, so a standing deadlock is reported
+    // once and not at every interval
+    uint32_t reported_[MAX_REPORTED];
+    uint32_t num_reported_;
+
+    DeadlockDetectorStats stats_;
+    std::atomic<uint32_t> interval_ms_;
+
+#if defined(ARDUINO)
+    mutable portMUX_TYPE lock_;
+#else
+    mutable std::mutex lock_;
+#endif
+};
+
+#endif // DEADLOCK_DETECTOR_H
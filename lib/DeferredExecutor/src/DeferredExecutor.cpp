@@ -0,0 +1,248 @@
+#include "DeferredExecutor.h"
+
+#include <PortUtils.h>
+
+static void writeLine(const char *line)
+{
+    Serial.println(line);
+}
+
+DeferredExecutor::DeferredExecutor()
+    : num_lanes_(0),
+      budget_hook_(defaultBudgetHook)
+{
+}
+
+bool DeferredExecutor::begin(const DeferLaneConfig *lanes, uint32_t num_lanes, BaseType_t core)
+{
+    if (num_lanes == 0 || num_lanes > MAX_LANES)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < num_lanes; i++)
+    {
+        Lane *lane = &lanes_[i];
+        lane->owner = this;
+        lane->index = i;
+        lane->config = lanes[i];
+        lane->mux = portMUX_INITIALIZER_UNLOCKED;
+        lane->hist_sequence.store(0, std::memory_order_relaxed);
+        lane->queue = xQueueCreate(lanes[i].queue_length, sizeof(Item));
+        if (lane->queue == NULL)
+        {
+            return false;
+        }
+        num_lanes_ = i + 1;
+    }
+    resetStats();
+
+    for (uint32_t i = 0; i < num_lanes; i++)
+    {
+        if (xTaskCreatePinnedToCore(executorTask,
+                                    lanes_[i].config.name,
+                                    4096,
+                                    &lanes_[i],
+                                    lanes_[i].config.priority,
+                                    NULL,
+                                    core) != pdPASS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeferredExecutor::post(uint32_t lane,
+                            DeferredFunction_t function,
+                            void *parameters,
+                            uint32_t value,
+                            const char *name,
+                            TickType_t wait)
+{
+    if (lane >= num_lanes_)
+    {
+        return false;
+    }
+
+    Item item = {function, parameters, value, name, (uint32_t)monotonicMicros()};
+    if (xQueueSend(lanes_[lane].queue, &item, wait) != pdTRUE)
+    {
+        portENTER_CRITICAL(&lanes_[lane].mux);
+        lanes_[lane].stats.dropped++;
+        portEXIT_CRITICAL(&lanes_[lane].mux);
+        return false;
+    }
+    return true;
+}
+
+bool DeferredExecutor::postFromISR(uint32_t lane,
+                                   DeferredFunction_t function,
+                                   void *parameters,
+                                   uint32_t value,
+                                   const char *name,
+                                   BaseType_t *higher_priority_task_woken)
+{
+    if (lane >= num_lanes_)
+    {
+        return false;
+    }
+
+    Item item = {function, parameters, value, name, (uint32_t)monotonicMicros()};
+    if (xQueueSendFromISR(lanes_[lane].queue, &item, higher_priority_task_woken) != pdTRUE)
+    {
+        portENTER_CRITICAL_ISR(&lanes_[lane].mux);
+        lanes_[lane].stats.dropped++;
+        portEXIT_CRITICAL_ISR(&lanes_[lane].mux);
+        return false;
+    }
+    return true;
+}
+
+void DeferredExecutor::setBudget(uint32_t lane, uint32_t budget_us)
+{
+    if (lane < num_lanes_)
+    {
+        lanes_[lane].config.budget_us = budget_us;
+    }
+}
+
+bool DeferredExecutor::getStats(uint32_t lane, DeferLaneStats *stats)
+{
+    if (lane >= num_lanes_)
+    {
+        return false;
+    }
+    Lane *l = &lanes_[lane];
+    portENTER_CRITICAL(&l->mux);
+    stats->executed = l->stats.executed;
+    stats->dropped = l->stats.dropped;
+    stats->over_budget = l->stats.over_budget;
+    stats->worst_exec_us = l->stats.worst_exec_us;
+    stats->worst_name = l->stats.worst_name;
+    portEXIT_CRITICAL(&l->mux);
+
+    // The writer is inside a critical section while the sequence is odd, so
+    // it cannot be preempted there and the retry only spins briefly
+    while (1)
+    {
+        uint32_t before = l->hist_sequence.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+            stats->queue_delay = l->stats.queue_delay;
+            stats->exec_time = l->stats.exec_time;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (l->hist_sequence.load(std::memory_order_relaxed) == before)
+            {
+                return true;
+            }
+        }
+    }
+}
+
+void DeferredExecutor::resetStats()
+{
+    for (uint32_t i = 0; i < num_lanes_; i++)
+    {
+        portENTER_CRITICAL(&lanes_[i].mux);
+        lanes_[i].stats.executed = 0;
+        lanes_[i].stats.dropped = 0;
+        lanes_[i].stats.over_budget = 0;
+        lanes_[i].stats.worst_exec_us = 0;
+        lanes_[i].stats.worst_name = nullptr;
+        beginHistogramWrite(&lanes_[i]);
+        lanes_[i].stats.queue_delay.reset();
+        lanes_[i].stats.exec_time.reset();
+        endHistogramWrite(&lanes_[i]);
+        portEXIT_CRITICAL(&lanes_[i].mux);
+    }
+}
+
+void DeferredExecutor::beginHistogramWrite(Lane *lane)
+{
+    uint32_t seq = lane->hist_sequence.load(std::memory_order_relaxed);
+    lane->hist_sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void DeferredExecutor::endHistogramWrite(Lane *lane)
+{
+    uint32_t seq = lane->hist_sequence.load(std::memory_order_relaxed);
+    lane->hist_sequence.store(seq + 1, std::memory_order_release);
+}
+
+void DeferredExecutor::printStats()
+{
+    DeferLaneStats stats;
+    for (uint32_t i = 0; i < num_lanes_; i++)
+    {
+        getStats(i, &stats);
+        Serial.printf("Lane %lu (%s, prio %lu, budget %lu us): executed=%lu dropped=%lu over_budget=%lu worst=%lu us (%s)\n",
+                      (unsigned long)i,
+                      lanes_[i].config.name,
+                      (unsigned long)lanes_[i].config.priority,
+                      (unsigned long)lanes_[i].config.budget_us,
+                      (unsigned long)stats.executed,
+                      (unsigned long)stats.dropped,
+                      (unsigned long)stats.over_budget,
+                      (unsigned long)stats.worst_exec_us,
+                      stats.worst_name ? stats.worst_name : "-");
+        stats.queue_delay.printTo(writeLine, "  queue delay", "us");
+        stats.exec_time.printTo(writeLine, "  exec time", "us");
+    }
+}
+
+void DeferredExecutor::defaultBudgetHook(uint32_t lane, const char *name, uint32_t exec_us, uint32_t budget_us)
+{
+    Serial.printf("WARNING: deferred callback %s on lane %lu took %lu us (budget %lu us)\n",
+                  name ? name : "(unnamed)",
+                  (unsigned long)lane,
+                  (unsigned long)exec_us,
+                  (unsigned long)budget_us);
+}
+
+void DeferredExecutor::executorTask(void *parameters)
+{
+    Lane *lane = (Lane *)parameters;
+    Item item;
+
+    while (1)
+    {
+        xQueueReceive(lane->queue, &item, portMAX_DELAY);
+
+        // esp_timer based: the poster may have run on the other core, whose
+        // cycle counter is not synchronised with ours
+        uint32_t start = (uint32_t)monotonicMicros();
+        item.function(item.parameters, item.value);
+        uint32_t end = (uint32_t)monotonicMicros();
+
+        uint32_t delay_us = start - item.posted_us;
+        uint32_t exec_us = end - start;
+        uint32_t budget_us = lane->config.budget_us;
+        bool over = budget_us != 0 && exec_us > budget_us;
+
+        portENTER_CRITICAL(&lane->mux);
+        lane->stats.executed++;
+        beginHistogramWrite(lane);
+        lane->stats.queue_delay.record(delay_us);
+        lane->stats.exec_time.record(exec_us);
+        endHistogramWrite(lane);
+        if (exec_us >= lane->stats.worst_exec_us)
+        {
+            lane->stats.worst_exec_us = exec_us;
+            lane->stats.worst_name = item.name;
+        }
+        if (over)
+        {
+            lane->stats.over_budget++;
+        }
+        portEXIT_CRITICAL(&lane->mux);
+
+        // Report outside the lock; the hook may print
+        DeferBudgetHook_t hook = lane->owner->budget_hook_;
+        if (over && hook != nullptr)
+        {
+            hook(lane->index, item.name, exec_us, budget_us);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef DEFERRED_EXECUTOR_H
+#define DEFERRED_EXECUTOR_H
+
+// Priority-laned deferred callback executor
+//
+// Timer callbacks run inside the timer daemon and ISRs run with the CPU
+// borrowed from whatever was executing, so both should only hand work off.
+// post()/postFromISR() queue a small closure (function, pointer, value) on
+// one of several lanes. Each lane has its own queue and executor task at its
+// own priority, so a slow low-priority job never delays a high-priority one.
+//
+// Every lane measures queueing delay (post -> start) and execution time in
+// microseconds, and flags callbacks that run longer than the lane's budget.
+
+#include <Arduino.h>
+#include <Histogram.h>
+
+#include <atomic>
+
+// Same shape as the PendedFunction_t used by xTimerPendFunctionCall()
+typedef void (*DeferredFunction_t)(void *parameters, uint32_t value);
+
+struct DeferLaneConfig
+{
+    const char *name;
+    UBaseType_t priority;
+    uint32_t queue_length;
+    uint32_t budget_us; // 0 disables the budget check
+};
+
+struct DeferLaneStats
+{
+    uint32_t executed;
+    uint32_t dropped;         // post() found the lane queue full
+    uint32_t over_budget;     // callbacks that exceeded budget_us
+    uint32_t worst_exec_us;
+    const char *worst_name;   // label of the slowest callback so far
+    LogHistogram queue_delay; // us
+    LogHistogram exec_time;   // us
+};
+
+// Called from the lane's executor task after a callback overran its budget
+typedef void (*DeferBudgetHook_t)(uint32_t lane, const char *name, uint32_t exec_us, uint32_t budget_us);
+
+class DeferredExecutor
+{
+public:
+    static const uint32_t MAX_LANES = 4;
+
+    DeferredExecutor();
+
+    // Lane 0 is conventionally the most urgent; priorities come from config
+    bool begin(const DeferLaneConfig *lanes, uint32_t num_lanes, BaseType_t core);
+
+    // Queue a callback. name is an optional label used in budget reports.
+    bool post(uint32_t lane,
+              DeferredFunction_t function,
+              void *parameters,
+              uint32_t value = 0,
+              const char *name = nullptr,
+              TickType_t wait = 0);
+
+    bool postFromISR(uint32_t lane,
+                     DeferredFunction_t function,
+                     void *parameters,
+                     uint32_t value,
+                     const char *name,
+                     BaseType_t *higher_priority_task_woken);
+
+    void setBudget(uint32_t lane, uint32_t budget_us);
+
+    // Default hook prints a warning to Serial
+    void setBudgetHook(DeferBudgetHook_t hook)
+    {
+        budget_hook_ = hook;
+    }
+
+    // Copy of a lane's statistics. The counters are copied under the lane
+    // lock; the histograms are copied outside it under a sequence lock, so
+    // they may hold one callback more or less than the counters.
+    bool getStats(uint32_t lane, DeferLaneStats *stats);
+
+    void resetStats();
+
+    void printStats();
+
+private:
+    struct Item
+    {
+        DeferredFunction_t function;
+        void *parameters;
+        uint32_t value;
+        const char *name;
+        uint32_t posted_us;
+    };
+
+    struct Lane
+    {
+        DeferredExecutor *owner;
+        uint32_t index;
+        DeferLaneConfig config;
+        QueueHandle_t queue;
+        DeferLaneStats stats;
+        portMUX_TYPE mux;
+        std::atomic<uint32_t> hist_sequence; // Odd while the histograms are written
+    };
+
+    // Histogram writers hold the lane lock, so there is only ever one
+    static void beginHistogramWrite(Lane *lane);
+    static void endHistogramWrite(Lane *lane);
+
+    static void executorTask(void *parameters);
+    static void defaultBudgetHook(uint32_t lane, const char *name, uint32_t exec_us, uint32_t budget_us);
+
+    Lane lanes_[MAX_LANES];
+    uint32_t num_lanes_;
+    DeferBudgetHook_t budget_hook_;
+};
+
+#endif // DEFERRED_EXECUTOR_H
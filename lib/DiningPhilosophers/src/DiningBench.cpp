@@ -0,0 +1,321 @@
+#include "DiningBench.h"
+
+#include <stdio.h>
+
+#include <new>
+
+#include <PortUtils.h>
+
+#if !defined(ARDUINO)
+#include <pthread.h>
+
+#include <thread>
+#include <vector>
+#endif
+
+static const uint32_t poll_us = 10000;
+
+struct DiningTable
+{
+    DiningStrategy *strategy;
+    const DiningConfig *config;
+    DiningSemaphore start;
+    std::atomic<uint32_t> total_meals;
+    std::atomic<uint32_t> finished;
+    uint64_t start_us;
+};
+
+struct Philosopher
+{
+    DiningTable *table;
+    uint32_t index;
+    std::atomic<uint32_t> meals;
+    uint32_t timeouts;
+    uint64_t finish_us;
+    LogHistogram waits; // us
+};
+
+//*****************************************************************************
+// Philosopher
+
+static void dine(Philosopher *ph)
+{
+    DiningTable *table = ph->table;
+    DiningStrategy *strategy = table->strategy;
+    const DiningConfig *config = table->config;
+
+    table->start.take(DINING_FOREVER);
+    while (ph->meals.load(std::memory_order_relaxed) < config->meals && !strategy->aborted())
+    {
+        diningSleepUs(config->think_us);
+
+        uint64_t hungry_us = monotonicMicros();
+        bool eating = strategy->pickUp(ph->index);
+        while (!eating && !strategy->aborted())
+        {
+            ph->timeouts++;
+            diningSleepUs(config->think_us);
+            eating = strategy->pickUp(ph->index);
+        }
+        if (eating && strategy->aborted())
+        {
+            // Only got through because the others were pulled out
+            strategy->putDown(ph->index);
+            eating = false;
+        }
+        if (!eating)
+        {
+            break;
+        }
+        ph->waits.record((uint32_t)(monotonicMicros() - hungry_us));
+
+        diningSleepUs(config->eat_us);
+        strategy->putDown(ph->index);
+        ph->meals.fetch_add(1, std::memory_order_relaxed);
+        table->total_meals.fetch_add(1, std::memory_order_relaxed);
+    }
+    ph->finish_us = monotonicMicros();
+    table->finished.fetch_add(1, std::memory_order_release);
+}
+
+#if defined(ARDUINO)
+static void philosopherTask(void *parameters)
+{
+    dine((Philosopher *)parameters);
+    vTaskDelete(NULL);
+}
+#endif
+
+//*****************************************************************************
+// Runner
+
+DiningConfig diningDefaultConfig()
+{
+    DiningConfig config;
+    config.philosophers = 5;
+    config.meals = 20;
+    config.think_us = 5000;
+    config.eat_us = 10000;
+    config.placement = DINING_ONE_CORE;
+    config.stall_ms = 3000;
+    config.stack_size = 3072;
+    config.priority = 2;
+    return config;
+}
+
+const char *diningPlacementName(DiningPlacement placement)
+{
+    switch (placement)
+    {
+    case DINING_ONE_CORE:
+        return "one core";
+    case DINING_SPREAD:
+        return "spread";
+    default:
+        return "any core";
+    }
+}
+
+static float jainIndex(const uint32_t *meals, uint32_t n)
+{
+    double sum = 0;
+    double sum_sq = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sum += meals[i];
+        sum_sq += (double)meals[i] * meals[i];
+    }
+    return (sum_sq > 0) ? (float)(sum * sum / (n * sum_sq)) : 0.0f;
+}
+
+static bool spawn(Philosopher *ph, const DiningConfig &config, void *threads)
+{
+#if defined(ARDUINO)
+#if CONFIG_FREERTOS_UNICORE
+    static const BaseType_t app_cpu = 0;
+#else
+    static const BaseType_t app_cpu = 1;
+#endif
+    BaseType_t core = tskNO_AFFINITY;
+    if (config.placement == DINING_ONE_CORE)
+    {
+        core = app_cpu;
+    }
+    else if (config.placement == DINING_SPREAD)
+    {
+        core = (BaseType_t)(ph->index % portNUM_PROCESSORS);
+    }
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "Phil %lu", (unsigned long)ph->index);
+    return xTaskCreatePinnedToCore(philosopherTask, name, config.stack_size, ph, config.priority, NULL, core) == pdPASS;
+#else
+    std::vector<std::thread> *list = (std::vector<std::thread> *)threads;
+    list->emplace_back(dine, ph);
+    if (config.placement != DINING_ANY_CORE)
+    {
+        uint32_t cpus = std::thread::hardware_concurrency();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((config.placement == DINING_ONE_CORE || cpus == 0) ? 0 : ph->index % cpus, &set);
+        pthread_setaffinity_np(list->back().native_handle(), sizeof(set), &set);
+    }
+    return true;
+#endif
+}
+
+bool runDiningBench(DiningStrategy &strategy, const DiningConfig &config, DiningResult *result)
+{
+    uint32_t n = config.philosophers;
+    result->strategy = strategy.name();
+    result->philosophers = n;
+    result->meals = 0;
+    result->deadlocked = false;
+    if (n < 2 || !strategy.begin(n))
+    {
+        strategy.end();
+        return false;
+    }
+
+    DiningTable table;
+    table.strategy = &strategy;
+    table.config = &config;
+    table.total_meals.store(0);
+    table.finished.store(0);
+    Philosopher *phs = new (std::nothrow) Philosopher[n];
+    uint32_t *snapshot = new (std::nothrow) uint32_t[n];
+    if (phs == nullptr || snapshot == nullptr || !table.start.begin(n, 0))
+    {
+        delete[] phs;
+        delete[] snapshot;
+        strategy.end();
+        return false;
+    }
+
+#if defined(ARDUINO)
+    void *threads = nullptr;
+#else
+    std::vector<std::thread> thread_list;
+    void *threads = &thread_list;
+#endif
+    uint32_t spawned = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        phs[i].table = &table;
+        phs[i].index = i;
+        phs[i].meals.store(0);
+        phs[i].timeouts = 0;
+        phs[i].finish_us = 0;
+        phs[i].waits.reset();
+        if (spawn(&phs[i], config, threads))
+        {
+            spawned++;
+        }
+    }
+    if (spawned < n)
+    {
+        strategy.abort();
+    }
+
+    // Everyone starts together
+    table.start_us = monotonicMicros();
+    for (uint32_t i = 0; i < spawned; i++)
+    {
+        table.start.give();
+    }
+
+    // Watch for the first philosopher to finish and for a stalled table
+    bool have_snapshot = false;
+    uint32_t last_meals = 0;
+    uint64_t last_progress_us = table.start_us;
+    while (table.finished.load(std::memory_order_acquire) < spawned)
+    {
+        diningSleepUs(poll_us);
+        uint64_t now = monotonicMicros();
+        for (uint32_t i = 0; i < n && !have_snapshot; i++)
+        {
+            if (phs[i].meals.load(std::memory_order_relaxed) >= config.meals)
+            {
+                for (uint32_t j = 0; j < n; j++)
+                {
+                    snapshot[j] = phs[j].meals.load(std::memory_order_relaxed);
+                }
+                have_snapshot = true;
+            }
+        }
+
+        uint32_t meals = table.total_meals.load(std::memory_order_relaxed);
+        if (meals != last_meals)
+        {
+            last_meals = meals;
+            last_progress_us = now;
+        }
+        else if (!strategy.aborted() && now - last_progress_us > (uint64_t)config.stall_ms * 1000)
+        {
+            result->deadlocked = true;
+            strategy.abort();
+        }
+    }
+
+#if !defined(ARDUINO)
+    for (size_t i = 0; i < thread_list.size(); i++)
+    {
+        thread_list[i].join();
+    }
+#endif
+
+    // Results
+    LogHistogram waits;
+    waits.reset();
+    uint64_t end_us = table.start_us;
+    result->timeouts = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        waits.merge(phs[i].waits);
+        result->timeouts += phs[i].timeouts;
+        result->meals += phs[i].meals.load();
+        end_us = (phs[i].finish_us > end_us) ? phs[i].finish_us : end_us;
+        if (!have_snapshot)
+        {
+            snapshot[i] = phs[i].meals.load();
+        }
+    }
+    result->elapsed_us = (uint32_t)(end_us - table.start_us);
+    result->meals_per_s = result->elapsed_us ? result->meals * 1e6f / result->elapsed_us : 0.0f;
+    result->mean_wait_us = waits.mean();
+    result->p99_wait_us = waits.percentile(99);
+    result->max_wait_us = waits.max();
+    result->fairness = jainIndex(snapshot, n);
+
+    delete[] phs;
+    delete[] snapshot;
+    strategy.end();
+    return spawned == n;
+}
+
+//*****************************************************************************
+// Output
+
+void printDiningHeader(LogHistogram::LineWriter write)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%-11s %5s %7s %9s %9s %9s %9s %8s %8s %s",
+             "strategy", "phils", "meals", "meals/s", "mean us", "p99 us", "max us", "fairness", "timeouts", "");
+    write(line);
+}
+
+void printDiningResult(LogHistogram::LineWriter write, const DiningResult &result)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%-11s %5lu %7lu %9.1f %9lu %9lu %9lu %8.3f %8lu %s",
+             result.strategy,
+             (unsigned long)result.philosophers,
+             (unsigned long)result.meals,
+             result.meals_per_s,
+             (unsigned long)result.mean_wait_us,
+             (unsigned long)result.p99_wait_us,
+             (unsigned long)result.max_wait_us,
+             result.fairness,
+             (unsigned long)result.timeouts,
+             result.deadlocked ? "DEADLOCK" : "");
+    write(line);
+}
@@ -0,0 +1,72 @@
+#ifndef DINING_BENCH_H
+#define DINING_BENCH_H
+
+// Dining philosophers benchmark
+//
+// Runs one DiningStrategy with a table of philosophers, each thinking,
+// getting hungry, eating and putting the chopsticks down for a number of
+// meals. Measured per run:
+//
+//   meals/s      completed meals over the wall-clock time of the run
+//   wait         hungry until holding both chopsticks, mean / p99 / max,
+//                including failed attempts (timeouts)
+//   fairness     Jain's index over meals per philosopher at the moment the
+//                first philosopher finished: 1.0 all equal, 1/N one ate alone
+//   timeouts     pickUp() attempts that gave up
+//   deadlock     no meal for stall_ms: the run is aborted and flagged
+//
+// Philosophers are FreeRTOS tasks on the target and threads on the host.
+
+#include <stdint.h>
+
+#include <Histogram.h>
+
+#include "DiningStrategy.h"
+
+enum DiningPlacement
+{
+    DINING_ONE_CORE = 0, // All on the application core (core 0 on the host)
+    DINING_SPREAD,       // Philosopher i on core i % cores
+    DINING_ANY_CORE      // Left to the scheduler
+};
+
+struct DiningConfig
+{
+    uint32_t philosophers;
+    uint32_t meals;        // Per philosopher
+    uint32_t think_us;
+    uint32_t eat_us;
+    DiningPlacement placement;
+    uint32_t stall_ms;     // No meal for this long counts as a deadlock
+    uint32_t stack_size;   // Target only
+    uint32_t priority;     // Target only
+};
+
+struct DiningResult
+{
+    const char *strategy;
+    uint32_t philosophers;
+    uint32_t meals;
+    uint32_t elapsed_us;
+    float meals_per_s;
+    uint32_t mean_wait_us;
+    uint32_t p99_wait_us;
+    uint32_t max_wait_us;
+    float fairness;
+    uint32_t timeouts;
+    bool deadlocked;
+};
+
+// Defaults close to the part10 sketches: 5 philosophers, 10 ms meals
+DiningConfig diningDefaultConfig();
+
+// Run to completion (or deadlock). False if the table could not be set up.
+bool runDiningBench(DiningStrategy &strategy, const DiningConfig &config, DiningResult *result);
+
+const char *diningPlacementName(DiningPlacement placement);
+
+// Table output: header once, then one line per result
+void printDiningHeader(LogHistogram::LineWriter write);
+void printDiningResult(LogHistogram::LineWriter write, const DiningResult &result);
+
+#endif // DINING_BENCH_H
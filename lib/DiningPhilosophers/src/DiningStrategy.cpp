@@ -0,0 +1,357 @@
+#include "DiningStrategy.h"
+
+#include <new>
+
+bool DiningStrategy::take(DiningSemaphore &sem, uint32_t timeout_us)
+{
+    uint32_t waited = 0;
+    while (!aborted())
+    {
+        uint32_t slice = ABORT_SLICE_US;
+        if (timeout_us != DINING_FOREVER && timeout_us - waited < slice)
+        {
+            slice = timeout_us - waited;
+        }
+        if (sem.take(slice))
+        {
+            return true;
+        }
+        if (timeout_us != DINING_FOREVER)
+        {
+            waited += slice;
+            if (waited >= timeout_us)
+            {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+//*****************************************************************************
+// One mutex per chopstick
+
+bool ChopstickDining::begin(uint32_t philosophers)
+{
+    end();
+    philosophers_ = philosophers;
+    aborted_.store(false);
+    chopsticks_ = new (std::nothrow) DiningSemaphore[philosophers];
+    if (chopsticks_ == nullptr)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < philosophers; i++)
+    {
+        if (!chopsticks_[i].begin(1, 1, true))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ChopstickDining::end()
+{
+    delete[] chopsticks_;
+    chopsticks_ = nullptr;
+}
+
+bool ChopstickDining::takePair(uint32_t a, uint32_t b, uint32_t timeout_us, uint32_t pause_us)
+{
+    if (!take(chopsticks_[a], timeout_us))
+    {
+        return false;
+    }
+    diningSleepUs(pause_us);
+    if (!take(chopsticks_[b], timeout_us))
+    {
+        chopsticks_[a].give();
+        return false;
+    }
+    return true;
+}
+
+void ChopstickDining::givePair(uint32_t a, uint32_t b)
+{
+    chopsticks_[b].give();
+    chopsticks_[a].give();
+}
+
+//*****************************************************************************
+// Naive and hierarchy
+
+bool NaiveDining::pickUp(uint32_t p)
+{
+    return takePair(left(p), right(p), DINING_FOREVER, pause_us_);
+}
+
+void NaiveDining::putDown(uint32_t p)
+{
+    givePair(left(p), right(p));
+}
+
+bool HierarchyDining::pickUp(uint32_t p)
+{
+    uint32_t a = left(p);
+    uint32_t b = right(p);
+    return (a < b) ? takePair(a, b, DINING_FOREVER) : takePair(b, a, DINING_FOREVER);
+}
+
+void HierarchyDining::putDown(uint32_t p)
+{
+    uint32_t a = left(p);
+    uint32_t b = right(p);
+    if (a < b)
+    {
+        givePair(a, b);
+    }
+    else
+    {
+        givePair(b, a);
+    }
+}
+
+//*****************************************************************************
+// Arbitrator
+
+bool ArbitratorDining::begin(uint32_t philosophers)
+{
+    if (!ChopstickDining::begin(philosophers) || !eat_sem_.begin(1, 0))
+    {
+        return false;
+    }
+    eat_sem_.give();
+    return true;
+}
+
+bool ArbitratorDining::pickUp(uint32_t p)
+{
+    if (!take(eat_sem_, DINING_FOREVER))
+    {
+        return false;
+    }
+    if (!takePair(left(p), right(p), DINING_FOREVER))
+    {
+        eat_sem_.give();
+        return false;
+    }
+    return true;
+}
+
+void ArbitratorDining::putDown(uint32_t p)
+{
+    givePair(left(p), right(p));
+    eat_sem_.give();
+}
+
+//*****************************************************************************
+// Uniform chopsticks
+
+bool UniformDining::begin(uint32_t philosophers)
+{
+    end();
+    philosophers_ = philosophers;
+    aborted_.store(false);
+    chopstick_sem_ = new (std::nothrow) DiningSemaphore;
+    return chopstick_sem_ != nullptr && chopstick_sem_->begin(philosophers, philosophers);
+}
+
+void UniformDining::end()
+{
+    delete chopstick_sem_;
+    chopstick_sem_ = nullptr;
+}
+
+bool UniformDining::pickUp(uint32_t p)
+{
+    if (!take(*chopstick_sem_, DINING_FOREVER))
+    {
+        return false;
+    }
+    if (!take(*chopstick_sem_, DINING_FOREVER))
+    {
+        chopstick_sem_->give();
+        return false;
+    }
+    return true;
+}
+
+void UniformDining::putDown(uint32_t p)
+{
+    chopstick_sem_->give();
+    chopstick_sem_->give();
+}
+
+//*****************************************************************************
+// Timeout
+
+bool TimeoutDining::pickUp(uint32_t p)
+{
+    return takePair(left(p), right(p), timeout_us_);
+}
+
+void TimeoutDining::putDown(uint32_t p)
+{
+    givePair(left(p), right(p));
+}
+
+//*****************************************************************************
+// Waiter
+
+bool WaiterDining::begin(uint32_t philosophers)
+{
+    end();
+    philosophers_ = philosophers;
+    aborted_.store(false);
+    next_ticket_ = 0;
+    seats_ = new (std::nothrow) Seat[philosophers];
+    if (seats_ == nullptr)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < philosophers; i++)
+    {
+        seats_[i].state = SEAT_THINKING;
+        seats_[i].ticket = 0;
+        seats_[i].overtaken = 0;
+#if defined(ARDUINO)
+        seats_[i].task = nullptr;
+#else
+        seats_[i].wake.begin(1, 0);
+#endif
+    }
+    return true;
+}
+
+void WaiterDining::end()
+{
+    delete[] seats_;
+    seats_ = nullptr;
+}
+
+void WaiterDining::lock()
+{
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&lock_);
+#else
+    lock_.lock();
+#endif
+}
+
+void WaiterDining::unlock()
+{
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&lock_);
+#else
+    lock_.unlock();
+#endif
+}
+
+bool WaiterDining::grant(uint32_t p)
+{
+    Seat &seat = seats_[p];
+    if (seat.state != SEAT_HUNGRY)
+    {
+        return false;
+    }
+    Seat *neighbours[2] = {&seats_[(p + philosophers_ - 1) % philosophers_], &seats_[right(p)]};
+    bool starving = seat.overtaken >= max_overtakes_;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        const Seat *n = neighbours[i];
+        if (n->state == SEAT_EATING)
+        {
+            return false;
+        }
+        // A starving neighbour goes first, unless p is starving too and
+        // got hungry earlier (tickets wrap: compare by difference)
+        if (n->state == SEAT_HUNGRY && n->overtaken >= max_overtakes_ &&
+            (!starving || (int32_t)(n->ticket - seat.ticket) < 0))
+        {
+            return false;
+        }
+    }
+    seat.state = SEAT_EATING;
+    seat.overtaken = 0;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        if (neighbours[i]->state == SEAT_HUNGRY)
+        {
+            neighbours[i]->overtaken++;
+        }
+    }
+    return true;
+}
+
+void WaiterDining::wake(uint32_t p)
+{
+#if defined(ARDUINO)
+    xTaskNotifyGive(seats_[p].task);
+#else
+    seats_[p].wake.give();
+#endif
+}
+
+bool WaiterDining::pickUp(uint32_t p)
+{
+    Seat &seat = seats_[p];
+    lock();
+#if defined(ARDUINO)
+    seat.task = xTaskGetCurrentTaskHandle();
+#endif
+    seat.ticket = next_ticket_++;
+    seat.overtaken = 0;
+    seat.state = SEAT_HUNGRY;
+    bool eating = grant(p);
+    unlock();
+
+    while (!eating)
+    {
+        if (aborted())
+        {
+            lock();
+            eating = seat.state == SEAT_EATING;
+            if (!eating)
+            {
+                seat.state = SEAT_THINKING;
+            }
+            unlock();
+            if (eating)
+            {
+                putDown(p);
+            }
+            return false;
+        }
+#if defined(ARDUINO)
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ABORT_SLICE_US / 1000));
+#else
+        seat.wake.take(ABORT_SLICE_US);
+#endif
+        // Granted by a neighbour's putDown(); other wakes are spurious
+        eating = seat.state == SEAT_EATING;
+    }
+    return true;
+}
+
+void WaiterDining::putDown(uint32_t p)
+{
+    uint32_t l = (p + philosophers_ - 1) % philosophers_;
+    uint32_t r = right(p);
+
+    lock();
+    seats_[p].state = SEAT_THINKING;
+    // Left first: it may be the one the right neighbour defers to
+    bool wake_left = grant(l);
+    bool wake_right = grant(r);
+    unlock();
+
+    if (wake_left)
+    {
+        wake(l);
+    }
+    if (wake_right)
+    {
+        wake(r);
+    }
+}
@@ -0,0 +1,268 @@
+#ifndef DINING_STRATEGY_H
+#define DINING_STRATEGY_H
+
+// Dining philosophers strategies, one class per part10 solution
+//
+//   naive       left then right chopstick (src/main.cpp without the
+//               arbitrator), optionally pausing in between as the sketches
+//               do to force the deadlock; kept as the baseline
+//   hierarchy   lower-numbered chopstick first
+//               (part10_deadlock_challenge_hierachy.cpp)
+//   arbitrator  a binary semaphore grants permission to eat, one
+//               philosopher at a time (src/main.cpp)
+//   uniform     a counting semaphore of N chopsticks, take any two
+//               (part10_deadlock_challenge_uniform_chopstick.cpp); can still
+//               deadlock when all N hold one
+//   timeout     left then right with a timeout; on timeout put the left one
+//               back and try again later (part10_deadlock_timeout.cpp)
+//   waiter      Dijkstra's waiter: a state table grants eating to every
+//               philosopher whose neighbours are not eating, so all
+//               non-adjacent philosophers eat at once
+//
+// pickUp() blocks until philosopher p may eat, or returns false after a
+// timeout or abort() with nothing held. abort() stops every wait within
+// ABORT_SLICE_US so a deadlocked run can be wound down.
+
+#include <atomic>
+#include <stdint.h>
+
+#include "DiningSync.h"
+
+#if !defined(ARDUINO)
+#include <mutex>
+#endif
+
+class DiningStrategy
+{
+public:
+    static const uint32_t ABORT_SLICE_US = 50000;
+
+    DiningStrategy() : philosophers_(0), aborted_(false)
+    {
+    }
+
+    virtual ~DiningStrategy()
+    {
+    }
+
+    virtual const char *name() const = 0;
+
+    // Create the kernel objects for a table of philosophers
+    virtual bool begin(uint32_t philosophers) = 0;
+    virtual void end() = 0;
+
+    virtual bool pickUp(uint32_t p) = 0;
+    virtual void putDown(uint32_t p) = 0;
+
+    void abort()
+    {
+        aborted_.store(true);
+    }
+
+    bool aborted() const
+    {
+        return aborted_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    // sem.take() in slices, giving up early on abort()
+    bool take(DiningSemaphore &sem, uint32_t timeout_us);
+
+    uint32_t left(uint32_t p) const
+    {
+        return p;
+    }
+
+    uint32_t right(uint32_t p) const
+    {
+        return (p + 1) % philosophers_;
+    }
+
+    uint32_t philosophers_;
+    std::atomic<bool> aborted_;
+};
+
+// One mutex per chopstick, shared by the strategies below
+class ChopstickDining : public DiningStrategy
+{
+public:
+    ChopstickDining() : chopsticks_(nullptr)
+    {
+    }
+
+    ~ChopstickDining()
+    {
+        end();
+    }
+
+    bool begin(uint32_t philosophers) override;
+    void end() override;
+
+protected:
+    // Take a, pause, then b, each within timeout_us; nothing held on failure
+    bool takePair(uint32_t a, uint32_t b, uint32_t timeout_us, uint32_t pause_us = 0);
+    void givePair(uint32_t a, uint32_t b);
+
+    DiningSemaphore *chopsticks_;
+};
+
+class NaiveDining : public ChopstickDining
+{
+public:
+    explicit NaiveDining(uint32_t pause_us = 0) : pause_us_(pause_us)
+    {
+    }
+
+    const char *name() const override
+    {
+        return "naive";
+    }
+    bool pickUp(uint32_t p) override;
+    void putDown(uint32_t p) override;
+
+private:
+    uint32_t pause_us_;
+};
+
+class HierarchyDining : public ChopstickDining
+{
+public:
+    const char *name() const override
+    {
+        return "hierarchy";
+    }
+    bool pickUp(uint32_t p) override;
+    void putDown(uint32_t p) override;
+};
+
+class ArbitratorDining : public ChopstickDining
+{
+public:
+    const char *name() const override
+    {
+        return "arbitrator";
+    }
+    bool begin(uint32_t philosophers) override;
+    bool pickUp(uint32_t p) override;
+    void putDown(uint32_t p) override;
+
+private:
+    DiningSemaphore eat_sem_;
+};
+
+class UniformDining : public DiningStrategy
+{
+public:
+    UniformDining() : chopstick_sem_(nullptr)
+    {
+    }
+
+    ~UniformDining()
+    {
+        end();
+    }
+
+    const char *name() const override
+    {
+        return "uniform";
+    }
+    bool begin(uint32_t philosophers) override;
+    void end() override;
+    bool pickUp(uint32_t p) override;
+    void putDown(uint32_t p) override;
+
+private:
+    DiningSemaphore *chopstick_sem_;
+};
+
+class TimeoutDining : public ChopstickDining
+{
+public:
+    explicit TimeoutDining(uint32_t timeout_us = 1000000) : timeout_us_(timeout_us)
+    {
+    }
+
+    const char *name() const override
+    {
+        return "timeout";
+    }
+    bool pickUp(uint32_t p) override;
+    void putDown(uint32_t p) override;
+
+private:
+    uint32_t timeout_us_;
+};
+
+// A philosopher may start eating when neither neighbour is eating. Waiting
+// is bounded by counting overtakes: each time a neighbour starts eating
+// while p is hungry, p's count goes up, and once it reaches max_overtakes
+// p's neighbours must let it eat first (the older of two such neighbours
+// wins). So a hungry philosopher sees at most max_overtakes meals from
+// each side before its own. A strict FIFO rule would be simpler but turns
+// a ring of hungry philosophers into a queue that eats one at a time.
+//
+// putDown() re-tests both neighbours and wakes the ones that may now eat
+// with a task notification (a per-seat semaphore on the host). The table
+// is only touched in a short critical section; nobody sleeps holding it.
+class WaiterDining : public DiningStrategy
+{
+public:
+    explicit WaiterDining(uint32_t max_overtakes = 2)
+        : seats_(nullptr), next_ticket_(0), max_overtakes_(max_overtakes)
+    {
+#if defined(ARDUINO)
+        lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+    }
+
+    ~WaiterDining()
+    {
+        end();
+    }
+
+    const char *name() const override
+    {
+        return "waiter";
+    }
+    bool begin(uint32_t philosophers) override;
+    void end() override;
+    bool pickUp(uint32_t p) override;
+    void putDown(uint32_t p) override;
+
+private:
+    enum SeatState
+    {
+        SEAT_THINKING = 0,
+        SEAT_HUNGRY,
+        SEAT_EATING
+    };
+
+    struct Seat
+    {
+        volatile uint8_t state;
+        uint32_t ticket;    // Order of getting hungry
+        uint32_t overtaken; // Neighbour meals started while hungry
+#if defined(ARDUINO)
+        TaskHandle_t task;
+#else
+        DiningSemaphore wake;
+#endif
+    };
+
+    void lock();
+    void unlock();
+    // Under the lock: start p eating if it may. True if p was just granted.
+    bool grant(uint32_t p);
+    void wake(uint32_t p);
+
+    Seat *seats_;
+    uint32_t next_ticket_;
+    uint32_t max_overtakes_;
+#if defined(ARDUINO)
+    portMUX_TYPE lock_;
+#else
+    std::mutex lock_;
+#endif
+};
+
+#endif // DINING_STRATEGY_H
@@ -0,0 +1,131 @@
+#ifndef DINING_SYNC_H
+#define DINING_SYNC_H
+
+// Counting semaphore and sleep for the dining philosophers benchmark
+//
+// FreeRTOS semaphores on the target, std::mutex + condition variable on the
+// host, so the strategies in DiningStrategy.h are the same code on both.
+// A DiningSemaphore created as a mutex is a real FreeRTOS mutex (priority
+// inheritance, xSemaphoreGetMutexHolder()).
+
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+static const uint32_t DINING_FOREVER = UINT32_MAX;
+
+class DiningSemaphore
+{
+public:
+#if defined(ARDUINO)
+    DiningSemaphore() : handle_(nullptr)
+    {
+    }
+
+    ~DiningSemaphore()
+    {
+        if (handle_ != nullptr)
+        {
+            vSemaphoreDelete(handle_);
+        }
+    }
+
+    bool begin(uint32_t max_count, uint32_t initial, bool mutex = false)
+    {
+        handle_ = mutex ? xSemaphoreCreateMutex() : xSemaphoreCreateCounting(max_count, initial);
+        return handle_ != nullptr;
+    }
+
+    // Wait up to timeout_us (rounded up to whole ticks) for one count
+    bool take(uint32_t timeout_us)
+    {
+        TickType_t ticks = portMAX_DELAY;
+        if (timeout_us != DINING_FOREVER)
+        {
+            ticks = (TickType_t)(((uint64_t)timeout_us * configTICK_RATE_HZ + 999999) / 1000000);
+        }
+        return xSemaphoreTake(handle_, ticks) == pdTRUE;
+    }
+
+    void give()
+    {
+        xSemaphoreGive(handle_);
+    }
+
+    SemaphoreHandle_t handle() const
+    {
+        return handle_;
+    }
+
+private:
+    SemaphoreHandle_t handle_;
+#else
+    DiningSemaphore() : count_(0)
+    {
+    }
+
+    bool begin(uint32_t max_count, uint32_t initial, bool mutex = false)
+    {
+        count_ = mutex ? 1 : initial;
+        return true;
+    }
+
+    bool take(uint32_t timeout_us)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (timeout_us == DINING_FOREVER)
+        {
+            cond_.wait(lock, [this] { return count_ > 0; });
+        }
+        else if (!cond_.wait_for(lock, std::chrono::microseconds(timeout_us), [this] { return count_ > 0; }))
+        {
+            return false;
+        }
+        count_--;
+        return true;
+    }
+
+    void give()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count_++;
+        }
+        cond_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    uint32_t count_;
+#endif
+};
+
+// Think / eat time. Below a tick the target busy-waits.
+static inline void diningSleepUs(uint32_t us)
+{
+#if defined(ARDUINO)
+    if (us >= 1000000 / configTICK_RATE_HZ)
+    {
+        vTaskDelay(pdMS_TO_TICKS(us / 1000));
+    }
+    else if (us > 0)
+    {
+        delayMicroseconds(us);
+    }
+#else
+    if (us > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+#endif
+}
+
+#endif // DINING_SYNC_H
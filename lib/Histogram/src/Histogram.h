@@ -0,0 +1,186 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// Power-of-two bucket histogram for latency style measurements
+//
+// Bucket 0 counts the value 0, bucket b (b >= 1) counts values in
+// [2^(b-1), 2^b). The last bucket also takes everything larger. Recording is
+// O(1) and allocation free, so it can be used from tasks and ISRs (the caller
+// provides any locking it needs). Units are up to the caller, usually us or
+// CPU cycles.
+
+#include <stdint.h>
+#include <stdio.h>
+
+class LogHistogram
+{
+public:
+    static const uint32_t BUCKETS = 24;
+
+    // Receives one formatted line (no trailing newline) from printTo()
+    typedef void (*LineWriter)(const char *line);
+
+    LogHistogram()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (uint32_t i = 0; i < BUCKETS; i++)
+        {
+            buckets_[i] = 0;
+        }
+        count_ = 0;
+        sum_ = 0;
+        min_ = UINT32_MAX;
+        max_ = 0;
+    }
+
+    inline void record(uint32_t value)
+    {
+        buckets_[bucketOf(value)]++;
+        count_++;
+        sum_ += value;
+        if (value < min_)
+        {
+            min_ = value;
+        }
+        if (value > max_)
+        {
+            max_ = value;
+        }
+    }
+
+    static inline uint32_t bucketOf(uint32_t value)
+    {
+        if (value == 0)
+        {
+            return 0;
+        }
+        uint32_t bucket = 32 - (uint32_t)__builtin_clz(value);
+        return (bucket < BUCKETS) ? bucket : BUCKETS - 1;
+    }
+
+    // Smallest value that falls into the next bucket (exclusive upper bound)
+    static inline uint32_t bucketLimit(uint32_t bucket)
+    {
+        return (bucket == 0) ? 1 : ((bucket >= 32) ? UINT32_MAX : (1u << bucket));
+    }
+
+    uint32_t count() const
+    {
+        return count_;
+    }
+
+    uint32_t min() const
+    {
+        return count_ ? min_ : 0;
+    }
+
+    uint32_t max() const
+    {
+        return max_;
+    }
+
+    uint32_t mean() const
+    {
+        return count_ ? (uint32_t)(sum_ / count_) : 0;
+    }
+
+    uint32_t bucket(uint32_t index) const
+    {
+        return buckets_[index];
+    }
+
+    // Upper bound of the bucket holding the p-th percentile (0-100). The
+    // last bucket has no upper bound, so a percentile there is the maximum.
+    uint32_t percentile(uint32_t p) const
+    {
+        if (count_ == 0)
+        {
+            return 0;
+        }
+        uint64_t target = ((uint64_t)count_ * p + 99) / 100;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; i++)
+        {
+            seen += buckets_[i];
+            if (seen >= target)
+            {
+                if (i == BUCKETS - 1)
+                {
+                    return max_;
+                }
+                uint32_t limit = bucketLimit(i);
+                return (limit - 1 < max_) ? limit - 1 : max_;
+            }
+        }
+        return max_;
+    }
+
+    // Add another histogram's samples into this one
+    void merge(const LogHistogram &other)
+    {
+        for (uint32_t i = 0; i < BUCKETS; i++)
+        {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        if (other.count_ && other.min_ < min_)
+        {
+            min_ = other.min_;
+        }
+        if (other.max_ > max_)
+        {
+            max_ = other.max_;
+        }
+    }
+
+    // Summary line plus one line per non-empty bucket
+    void printTo(LineWriter write, const char *label, const char *unit) const
+    {
+        char line[96];
+        snprintf(line, sizeof(line), "%s: n=%lu min=%lu mean=%lu p99=%lu max=%lu %s",
+                 label,
+                 (unsigned long)count_,
+                 (unsigned long)min(),
+                 (unsigned long)mean(),
+                 (unsigned long)percentile(99),
+                 (unsigned long)max_,
+                 unit);
+        write(line);
+
+        for (uint32_t i = 0; i < BUCKETS; i++)
+        {
+            if (buckets_[i] == 0)
+            {
+                continue;
+            }
+            if (i == BUCKETS - 1)
+            {
+                snprintf(line, sizeof(line), "  >= %8lu          %8lu",
+                         (unsigned long)bucketLimit(i - 1),
+                         (unsigned long)buckets_[i]);
+            }
+            else
+            {
+                snprintf(line, sizeof(line), "  [%8lu, %8lu) %8lu",
+                         (unsigned long)((i == 0) ? 0 : bucketLimit(i - 1)),
+                         (unsigned long)bucketLimit(i),
+                         (unsigned long)buckets_[i]);
+            }
+            write(line);
+        }
+    }
+
+private:
+    uint32_t buckets_[BUCKETS];
+    uint32_t count_;
+    uint64_t sum_;
+    uint32_t min_;
+    uint32_t max_;
+};
+
+#endif // HISTOGRAM_H
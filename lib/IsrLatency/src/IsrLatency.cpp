@@ -0,0 +1,43 @@
+#include "IsrLatency.h"
+
+#include <stdio.h>
+
+static const char *const stage_names[LatencyStages::NUM_STAGES] = {"entry", "signal", "wake", "total"};
+
+LatencyStages::LatencyStages()
+{
+    reset();
+}
+
+void LatencyStages::reset()
+{
+    for (uint32_t i = 0; i < NUM_STAGES; i++)
+    {
+        stages_[i].reset();
+    }
+}
+
+void LatencyStages::record(const LatencyTrace &trace)
+{
+    // Unsigned differences stay correct across a counter wrap
+    stages_[STAGE_ENTRY].record(cyclesToNs(trace.entry - trace.alarm));
+    stages_[STAGE_SIGNAL].record(cyclesToNs(trace.signaled - trace.entry));
+    stages_[STAGE_WAKE].record(cyclesToNs(trace.resumed - trace.signaled));
+    stages_[STAGE_TOTAL].record(cyclesToNs(trace.resumed - trace.alarm));
+}
+
+const char *LatencyStages::stageName(uint32_t stage)
+{
+    return (stage < NUM_STAGES) ? stage_names[stage] : "?";
+}
+
+void LatencyStages::printTo(LogHistogram::LineWriter write, const char *label) const
+{
+    char line[64];
+    snprintf(line, sizeof(line), "--- %s ---", label);
+    write(line);
+    for (uint32_t i = 0; i < NUM_STAGES; i++)
+    {
+        stages_[i].printTo(write, stage_names[i], "ns");
+    }
+}
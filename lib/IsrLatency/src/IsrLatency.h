@@ -0,0 +1,67 @@
+#ifndef ISR_LATENCY_H
+#define ISR_LATENCY_H
+
+// Per-stage latency of a timer interrupt waking a task
+//
+// One LatencyTrace holds four cpuCycleCount() stamps for a single alarm:
+//
+//   alarm     - when the timer fired (reconstructed from the timer counter,
+//               which has run on since the alarm reloaded it)
+//   entry     - first instruction of the ISR
+//   signaled  - the give/notify/send call in the ISR has returned
+//   resumed   - the waiting task runs again
+//
+// LatencyStages turns traces into one LogHistogram per stage, in ns:
+//
+//   entry  = entry - alarm        interrupt entry latency
+//   signal = signaled - entry     cost of signalling from the ISR
+//   wake   = resumed - signaled   ISR exit, context switch, return from wait
+//   total  = resumed - alarm
+//
+// The stamps of one trace must come from the same core (see PortUtils.h).
+
+#include <stdint.h>
+
+#include <Histogram.h>
+#include <PortUtils.h>
+
+struct LatencyTrace
+{
+    uint32_t alarm;
+    uint32_t entry;
+    uint32_t signaled;
+    uint32_t resumed;
+};
+
+class LatencyStages
+{
+public:
+    enum Stage
+    {
+        STAGE_ENTRY = 0,
+        STAGE_SIGNAL,
+        STAGE_WAKE,
+        STAGE_TOTAL,
+        NUM_STAGES
+    };
+
+    LatencyStages();
+
+    void reset();
+    void record(const LatencyTrace &trace);
+
+    const LogHistogram &stage(uint32_t stage) const
+    {
+        return stages_[stage];
+    }
+
+    static const char *stageName(uint32_t stage);
+
+    // Every stage: summary line and buckets, values in ns
+    void printTo(LogHistogram::LineWriter write, const char *label) const;
+
+private:
+    LogHistogram stages_[NUM_STAGES];
+};
+
+#endif // ISR_LATENCY_H
@@ -0,0 +1,379 @@
+#include "JobScheduler.h"
+
+#include <stdio.h>
+
+JobScheduler::JobScheduler() : num_levels_(0)
+{
+    for (uint32_t i = 0; i < MAX_LEVELS; i++)
+    {
+        Level &level = levels_[i];
+        level.config.name = nullptr;
+        level.config.priority = 0;
+        level.config.stack_size = 0;
+        level.head = nullptr;
+        level.ready = 0;
+        level.stats.dispatched = 0;
+        level.stats.rejected = 0;
+        level.stats.max_ready = 0;
+        level.stats.max_run_us = 0;
+        level.scheduler = this;
+#if defined(ARDUINO)
+        level.lock = portMUX_INITIALIZER_UNLOCKED;
+        level.task = NULL;
+#else
+        level.signaled = false;
+#endif
+    }
+#if !defined(ARDUINO)
+    stopping_ = false;
+#endif
+}
+
+JobScheduler::~JobScheduler()
+{
+#if !defined(ARDUINO)
+    end();
+#endif
+}
+
+void JobScheduler::initJob(BasicJob *job,
+                           JobFunction_t function,
+                           void *parameters,
+                           uint32_t level,
+                           uint8_t priority,
+                           uint8_t max_activations,
+                           const char *name)
+{
+    job->function = function;
+    job->parameters = parameters;
+    job->name = name;
+    job->level = level;
+    job->priority = priority;
+    job->max_activations = (max_activations > 0) ? max_activations : 1;
+    job->activations = 0;
+    job->queued = false;
+    job->activated_us = 0;
+    job->runs = 0;
+    job->next = nullptr;
+}
+
+//*****************************************************************************
+// Ready queue (callers hold the level's lock)
+
+// Behind every job of the same or higher priority
+void JobScheduler::insert(Level &level, BasicJob *job)
+{
+    BasicJob **link = &level.head;
+    while (*link != nullptr && (*link)->priority >= job->priority)
+    {
+        link = &(*link)->next;
+    }
+    job->next = *link;
+    *link = job;
+    level.ready++;
+    if (level.ready > level.stats.max_ready)
+    {
+        level.stats.max_ready = level.ready;
+    }
+}
+
+bool JobScheduler::queue(Level &level, BasicJob *job, bool *wake)
+{
+    *wake = false;
+    if (job->activations >= job->max_activations)
+    {
+        level.stats.rejected++;
+        return false;
+    }
+    job->activations++;
+    if (!job->queued)
+    {
+        job->queued = true;
+        job->activated_us = (uint32_t)monotonicMicros();
+        insert(level, job);
+        *wake = true;
+    }
+    return true;
+}
+
+BasicJob *JobScheduler::next(Level &level)
+{
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&level.lock);
+#else
+    std::lock_guard<std::mutex> guard(level.lock);
+#endif
+    BasicJob *job = level.head;
+    if (job != nullptr)
+    {
+        level.head = job->next;
+        level.ready--;
+    }
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&level.lock);
+#endif
+    return job;
+}
+
+//*****************************************************************************
+// Dispatch
+
+void JobScheduler::run(Level &level, BasicJob *job)
+{
+    uint32_t start_us = (uint32_t)monotonicMicros();
+    level.stats.ready_us.record(start_us - job->activated_us);
+    level.stats.dispatched++;
+
+    job->function(job->parameters);
+
+    uint32_t end_us = (uint32_t)monotonicMicros();
+    if (end_us - start_us > level.stats.max_run_us)
+    {
+        level.stats.max_run_us = end_us - start_us;
+    }
+
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&level.lock);
+#else
+    std::lock_guard<std::mutex> guard(level.lock);
+#endif
+    job->runs++;
+    job->activations--;
+    if (job->activations > 0)
+    {
+        job->activated_us = end_us;
+        insert(level, job);
+    }
+    else
+    {
+        job->queued = false;
+    }
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&level.lock);
+#endif
+}
+
+uint32_t JobScheduler::pending(const BasicJob *job) const
+{
+    if (job->level >= num_levels_)
+    {
+        return 0;
+    }
+    const Level &level = levels_[job->level];
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&level.lock);
+    uint32_t activations = job->activations;
+    portEXIT_CRITICAL(&level.lock);
+#else
+    std::lock_guard<std::mutex> guard(level.lock);
+    uint32_t activations = job->activations;
+#endif
+    return activations;
+}
+
+#if defined(ARDUINO)
+
+bool JobScheduler::activate(BasicJob *job)
+{
+    if (job->level >= num_levels_)
+    {
+        return false;
+    }
+    Level &level = levels_[job->level];
+    bool wake;
+    portENTER_CRITICAL(&level.lock);
+    bool accepted = queue(level, job, &wake);
+    portEXIT_CRITICAL(&level.lock);
+    if (wake)
+    {
+        xTaskNotifyGive(level.task);
+    }
+    return accepted;
+}
+
+bool JobScheduler::activateFromISR(BasicJob *job, BaseType_t *task_woken)
+{
+    if (job->level >= num_levels_)
+    {
+        return false;
+    }
+    Level &level = levels_[job->level];
+    bool wake;
+    portENTER_CRITICAL_ISR(&level.lock);
+    bool accepted = queue(level, job, &wake);
+    portEXIT_CRITICAL_ISR(&level.lock);
+    if (wake)
+    {
+        vTaskNotifyGiveFromISR(level.task, task_woken);
+    }
+    return accepted;
+}
+
+// Every job of the level runs here, on this task's stack
+void JobScheduler::levelLoop(Level &level)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        BasicJob *job;
+        while ((job = next(level)) != nullptr)
+        {
+            run(level, job);
+        }
+    }
+}
+
+void JobScheduler::levelTask(void *parameters)
+{
+    Level *level = (Level *)parameters;
+    level->scheduler->levelLoop(*level);
+}
+
+bool JobScheduler::begin(const JobLevelConfig *levels, uint32_t num_levels, BaseType_t core)
+{
+    if (num_levels == 0 || num_levels > MAX_LEVELS)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < num_levels; i++)
+    {
+        levels_[i].config = levels[i];
+        if (xTaskCreatePinnedToCore(levelTask,
+                                    levels[i].name,
+                                    levels[i].stack_size,
+                                    &levels_[i],
+                                    (UBaseType_t)levels[i].priority,
+                                    &levels_[i].task,
+                                    core) != pdPASS)
+        {
+            // The levels already started wait for work that can never come
+            for (uint32_t j = 0; j < i; j++)
+            {
+                vTaskDelete(levels_[j].task);
+                levels_[j].task = NULL;
+            }
+            levels_[i].task = NULL;
+            return false;
+        }
+    }
+    num_levels_ = num_levels; // activate() needs every level's task
+    return true;
+}
+
+uint32_t JobScheduler::stackHighWater(uint32_t level) const
+{
+    if (level >= num_levels_ || levels_[level].task == NULL)
+    {
+        return 0;
+    }
+    return (uint32_t)uxTaskGetStackHighWaterMark(levels_[level].task);
+}
+
+#else
+
+bool JobScheduler::activate(BasicJob *job)
+{
+    if (job->level >= num_levels_)
+    {
+        return false;
+    }
+    Level &level = levels_[job->level];
+    std::lock_guard<std::mutex> guard(level.lock);
+    bool wake;
+    bool accepted = queue(level, job, &wake);
+    if (wake)
+    {
+        level.signaled = true;
+        level.cond.notify_one();
+    }
+    return accepted;
+}
+
+void JobScheduler::levelLoop(Level &level)
+{
+    while (1)
+    {
+        {
+            std::unique_lock<std::mutex> guard(level.lock);
+            level.cond.wait(guard, [this, &level] { return level.signaled || stopping_; });
+            if (stopping_)
+            {
+                return;
+            }
+            level.signaled = false;
+        }
+        BasicJob *job;
+        while ((job = next(level)) != nullptr)
+        {
+            run(level, job);
+        }
+    }
+}
+
+bool JobScheduler::begin(const JobLevelConfig *levels, uint32_t num_levels)
+{
+    if (num_levels == 0 || num_levels > MAX_LEVELS)
+    {
+        return false;
+    }
+    stopping_ = false;
+    for (uint32_t i = 0; i < num_levels; i++)
+    {
+        levels_[i].config = levels[i];
+    }
+    num_levels_ = num_levels;
+    for (uint32_t i = 0; i < num_levels; i++)
+    {
+        levels_[i].thread = std::thread(&JobScheduler::levelLoop, this, std::ref(levels_[i]));
+    }
+    return true;
+}
+
+void JobScheduler::end()
+{
+    // Taking each lock after the store makes sure no level thread is
+    // between its check and its wait when it is notified
+    stopping_.store(true);
+    for (uint32_t i = 0; i < num_levels_; i++)
+    {
+        std::lock_guard<std::mutex> guard(levels_[i].lock);
+        levels_[i].cond.notify_all();
+    }
+    for (uint32_t i = 0; i < num_levels_; i++)
+    {
+        if (levels_[i].thread.joinable())
+        {
+            levels_[i].thread.join();
+        }
+    }
+}
+
+#endif // ARDUINO
+
+//*****************************************************************************
+// Statistics
+
+void JobScheduler::printStats(LogHistogram::LineWriter write) const
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%-10s %4s %6s %10s %8s %6s %9s %9s %9s",
+             "level", "prio", "stack", "dispatched", "rejected", "ready",
+             "wait p50", "wait p99", "run max");
+    write(line);
+    for (uint32_t i = 0; i < num_levels_; i++)
+    {
+        const Level &level = levels_[i];
+        const JobLevelStats &s = level.stats;
+        snprintf(line, sizeof(line), "%-10s %4lu %6lu %10lu %8lu %6lu %7luus %7luus %7luus",
+                 level.config.name ? level.config.name : "-",
+                 (unsigned long)level.config.priority,
+                 (unsigned long)level.config.stack_size,
+                 (unsigned long)s.dispatched,
+                 (unsigned long)s.rejected,
+                 (unsigned long)s.max_ready,
+                 (unsigned long)s.ready_us.percentile(50),
+                 (unsigned long)s.ready_us.percentile(99),
+                 (unsigned long)s.max_run_us);
+        write(line);
+    }
+}
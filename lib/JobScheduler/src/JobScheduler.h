@@ -0,0 +1,173 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+// Run-to-completion jobs sharing one stack per priority level
+//
+// The producers of part7_semaphore.cpp, the philosophers of src/main.cpp
+// and remainTimeTask in part8_software_timer_challenge.cpp each get a task
+// and a stack, run, and vTaskDelete(NULL). A BasicJob is the same work
+// without a stack of its own: a function that runs to completion every
+// time it is activated, like an OSEK basic task.
+//
+//   static BasicJob producer_job[5];
+//
+//   JobScheduler::initJob(&producer_job[i], producer, (void *)i, 0);
+//   jobs.begin(levels, 2, app_cpu);
+//   jobs.activate(&producer_job[i]);     // Runs producer((void *)i) once
+//
+// Each level is one task with one stack, at the FreeRTOS priority given in
+// its JobLevelConfig, so a higher level preempts a lower one. Inside a level
+// jobs never preempt each other: the ready queue is ordered by job priority
+// (higher first, FIFO among equals) and the level runs them one after the
+// other on its stack. A job must not block; instead of waiting it is
+// activated again when its condition holds (from a timer, an ISR or another
+// job).
+//
+// A job keeps up to max_activations pending activations; activate() beyond
+// that is rejected and counted. A job with activations left goes back to
+// the ready queue behind its equal-priority peers after each run.
+//
+// On the host levels are threads, there is no ISR activation and level
+// priorities and stack sizes are not applied.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Histogram.h>
+#include <PortUtils.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+typedef void (*JobFunction_t)(void *parameters);
+
+struct BasicJob
+{
+    JobFunction_t function;
+    void *parameters;
+    const char *name;
+    uint32_t level;
+    uint8_t priority;        // Within the level, higher runs first
+    uint8_t max_activations;
+
+    // Owned by the scheduler, under the level's lock
+    uint8_t activations;
+    bool queued;             // In the ready queue or running
+    uint32_t activated_us;   // Ready since (activation or end of the last run)
+    uint32_t runs;
+    BasicJob *next;
+};
+
+struct JobLevelConfig
+{
+    const char *name;
+    uint32_t priority;   // FreeRTOS priority of the level's task
+    uint32_t stack_size; // Bytes in ESP32, shared by every job of the level
+};
+
+struct JobLevelStats
+{
+    uint32_t dispatched;
+    uint32_t rejected;     // activate() found max_activations pending
+    uint32_t max_ready;    // Most jobs in the ready queue at once
+    uint32_t max_run_us;
+    LogHistogram ready_us; // Ready until started
+};
+
+class JobScheduler
+{
+public:
+    static const uint32_t MAX_LEVELS = 4;
+
+    JobScheduler();
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler &) = delete;
+    JobScheduler &operator=(const JobScheduler &) = delete;
+
+    // Set up a job object; it starts idle
+    static void initJob(BasicJob *job,
+                        JobFunction_t function,
+                        void *parameters,
+                        uint32_t level,
+                        uint8_t priority = 0,
+                        uint8_t max_activations = 1,
+                        const char *name = nullptr);
+
+#if defined(ARDUINO)
+    // One task per level, all pinned to core. On failure no level is left
+    // running.
+    bool begin(const JobLevelConfig *levels, uint32_t num_levels, BaseType_t core);
+#else
+    bool begin(const JobLevelConfig *levels, uint32_t num_levels);
+
+    // Stop and join the level threads; pending activations are not run
+    void end();
+#endif
+
+    // False if the job already has max_activations pending
+    bool activate(BasicJob *job);
+
+#if defined(ARDUINO)
+    bool activateFromISR(BasicJob *job, BaseType_t *task_woken);
+
+    // Bytes of the level's stack never used so far
+    uint32_t stackHighWater(uint32_t level) const;
+#endif
+
+    // Activations not yet run, including the running one
+    uint32_t pending(const BasicJob *job) const;
+
+    // Only consistent while the level is idle
+    const JobLevelStats &stats(uint32_t level) const
+    {
+        return levels_[level].stats;
+    }
+
+    // One line per level, plus a header
+    void printStats(LogHistogram::LineWriter write) const;
+
+private:
+    struct Level
+    {
+        JobLevelConfig config;
+        BasicJob *head; // Ready queue, by priority
+        uint32_t ready;
+        JobLevelStats stats;
+        JobScheduler *scheduler;
+#if defined(ARDUINO)
+        mutable portMUX_TYPE lock;
+        TaskHandle_t task;
+#else
+        mutable std::mutex lock;
+        std::condition_variable cond;
+        bool signaled;
+        std::thread thread;
+#endif
+    };
+
+    bool queue(Level &level, BasicJob *job, bool *wake);
+    void insert(Level &level, BasicJob *job);
+    BasicJob *next(Level &level);
+    void run(Level &level, BasicJob *job);
+    void levelLoop(Level &level);
+
+#if defined(ARDUINO)
+    static void levelTask(void *parameters);
+#endif
+
+    Level levels_[MAX_LEVELS];
+    uint32_t num_levels_;
+
+#if !defined(ARDUINO)
+    std::atomic<bool> stopping_; // Read by every level thread
+#endif
+};
+
+#endif // JOB_SCHEDULER_H
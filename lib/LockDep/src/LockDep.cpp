@@ -0,0 +1,91 @@
+#include "LockDep.h"
+
+#include <PortUtils.h>
+
+#if defined(ARDUINO)
+
+// Mutex handle -> lock class, open addressing with linear probing
+static const uint32_t registry_slots = 128; // Power of two, > 2 * MAX_CLASSES
+
+struct RegistrySlot
+{
+    SemaphoreHandle_t mutex;
+    int32_t cls;
+};
+
+static LockOrderGraph graph;
+static RegistrySlot registry[registry_slots];
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static PORT_FORCE_INLINE uint32_t slotOf(SemaphoreHandle_t mutex)
+{
+    // Heap pointers: drop the alignment bits, then mix
+    uint32_t h = (uint32_t)(uintptr_t)mutex >> 3;
+    return (h * 2654435761u) >> 25; // Top 7 bits: 0..127
+}
+
+static int32_t classOf(SemaphoreHandle_t mutex)
+{
+    // Slots are only ever filled, never cleared: safe to read without the lock
+    for (uint32_t i = 0, slot = slotOf(mutex); i < registry_slots; i++, slot = (slot + 1) & (registry_slots - 1))
+    {
+        if (registry[slot].mutex == mutex)
+        {
+            return registry[slot].cls;
+        }
+        if (registry[slot].mutex == nullptr)
+        {
+            break;
+        }
+    }
+    return LockOrderGraph::NO_CLASS;
+}
+
+LockOrderGraph &lockdepGraph()
+{
+    return graph;
+}
+
+bool lockdepRegister(SemaphoreHandle_t mutex, const char *name)
+{
+    if (mutex == nullptr || classOf(mutex) != LockOrderGraph::NO_CLASS)
+    {
+        return mutex != nullptr;
+    }
+    int32_t cls = graph.addClass(name);
+    if (cls == LockOrderGraph::NO_CLASS)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&registry_lock);
+    uint32_t slot = slotOf(mutex);
+    while (registry[slot].mutex != nullptr)
+    {
+        slot = (slot + 1) & (registry_slots - 1);
+    }
+    registry[slot].cls = cls;
+    registry[slot].mutex = mutex;
+    portEXIT_CRITICAL(&registry_lock);
+    return true;
+}
+
+BaseType_t lockdepTakeChecked(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+    int32_t cls = classOf(mutex);
+    graph.beforeAcquire(cls, pcTaskGetName(NULL));
+    BaseType_t taken = xSemaphoreTake(mutex, ticks);
+    if (taken == pdTRUE)
+    {
+        graph.acquired(cls);
+    }
+    return taken;
+}
+
+BaseType_t lockdepGiveChecked(SemaphoreHandle_t mutex)
+{
+    graph.released(classOf(mutex));
+    return xSemaphoreGive(mutex);
+}
+
+#endif // ARDUINO
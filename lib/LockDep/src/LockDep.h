@@ -0,0 +1,56 @@
+#ifndef LOCKDEP_H
+#define LOCKDEP_H
+
+// Lock-order validation for FreeRTOS mutexes
+//
+// Register each mutex once with a name, then take and give it through
+// lockdepTake() / lockdepGive(). Every "held A while taking B" order is
+// recorded; the first acquisition that closes a cycle is reported over
+// Serial with the task names involved, whether or not the tasks actually
+// deadlock this time. The take itself still goes ahead.
+//
+// Opt-in: with LOCKDEP defined to 1 (build_flags = -D LOCKDEP=1 in
+// platformio.ini, or #define before including this header) the wrappers
+// check; otherwise they are plain xSemaphoreTake() / xSemaphoreGive().
+// Task context only, not from ISRs.
+
+#include "LockOrderGraph.h"
+
+#if defined(ARDUINO)
+
+#ifndef LOCKDEP
+#define LOCKDEP 0
+#endif
+
+// Shared by all registered mutexes
+LockOrderGraph &lockdepGraph();
+
+// Name must stay valid. Returns false when the class table is full (the
+// mutex then works but is not checked).
+bool lockdepRegister(SemaphoreHandle_t mutex, const char *name);
+
+// Always-checked versions, what the wrappers call with LOCKDEP on
+BaseType_t lockdepTakeChecked(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t lockdepGiveChecked(SemaphoreHandle_t mutex);
+
+static inline BaseType_t lockdepTake(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+#if LOCKDEP
+    return lockdepTakeChecked(mutex, ticks);
+#else
+    return xSemaphoreTake(mutex, ticks);
+#endif
+}
+
+static inline BaseType_t lockdepGive(SemaphoreHandle_t mutex)
+{
+#if LOCKDEP
+    return lockdepGiveChecked(mutex);
+#else
+    return xSemaphoreGive(mutex);
+#endif
+}
+
+#endif // ARDUINO
+
+#endif // LOCKDEP_H
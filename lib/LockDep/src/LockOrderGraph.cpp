@@ -0,0 +1,324 @@
+#include "LockOrderGraph.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <PortUtils.h>
+
+// Locks held by the calling thread, in acquisition order
+struct HeldLocks
+{
+    uint8_t cls[LockOrderGraph::MAX_HELD];
+    uint32_t depth; // May exceed MAX_HELD; those entries are not tracked
+};
+
+static thread_local HeldLocks held_locks = {{0}, 0};
+
+static void defaultReporter(const char *line)
+{
+#if defined(ARDUINO)
+    Serial.println(line);
+#else
+    printf("%s\n", line);
+#endif
+}
+
+static PORT_FORCE_INLINE bool testBit(const std::atomic<uint32_t> *set, uint32_t bit)
+{
+    return (set[bit >> 5].load(std::memory_order_relaxed) >> (bit & 31)) & 1;
+}
+
+LockOrderGraph::LockOrderGraph()
+    : num_classes_(0), num_witnesses_(0), acquisitions_(0), new_edges_(0), violations_(0), overflows_(0),
+      reporter_(defaultReporter)
+{
+#if defined(ARDUINO)
+    lock_ = portMUX_INITIALIZER_UNLOCKED;
+#endif
+    clearEdges();
+}
+
+void LockOrderGraph::lock()
+{
+#if defined(ARDUINO)
+    portENTER_CRITICAL(&lock_);
+#else
+    lock_.lock();
+#endif
+}
+
+void LockOrderGraph::unlock()
+{
+#if defined(ARDUINO)
+    portEXIT_CRITICAL(&lock_);
+#else
+    lock_.unlock();
+#endif
+}
+
+int32_t LockOrderGraph::addClass(const char *name)
+{
+    lock();
+    uint32_t cls = num_classes_.load(std::memory_order_relaxed);
+    if (cls < MAX_CLASSES)
+    {
+        names_[cls] = name;
+        num_classes_.store(cls + 1, std::memory_order_release);
+    }
+    unlock();
+    return (cls < MAX_CLASSES) ? (int32_t)cls : NO_CLASS;
+}
+
+const char *LockOrderGraph::className(int32_t cls) const
+{
+    if (cls < 0 || (uint32_t)cls >= num_classes_.load(std::memory_order_acquire))
+    {
+        return "?";
+    }
+    return names_[cls];
+}
+
+bool LockOrderGraph::hasEdge(int32_t from, int32_t to) const
+{
+    if (from < 0 || to < 0 || (uint32_t)from >= MAX_CLASSES || (uint32_t)to >= MAX_CLASSES)
+    {
+        return false;
+    }
+    return testBit(edges_[from], (uint32_t)to);
+}
+
+void LockOrderGraph::clearEdges()
+{
+    lock();
+    for (uint32_t i = 0; i < MAX_CLASSES; i++)
+    {
+        edges_[i][0].store(0, std::memory_order_relaxed);
+        edges_[i][1].store(0, std::memory_order_relaxed);
+        reported_[i][0] = 0;
+        reported_[i][1] = 0;
+    }
+    num_witnesses_ = 0;
+    unlock();
+    new_edges_.store(0);
+    violations_.store(0);
+}
+
+LockOrderStats LockOrderGraph::stats() const
+{
+    LockOrderStats s;
+    s.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+    s.new_edges = new_edges_.load(std::memory_order_relaxed);
+    s.violations = violations_.load(std::memory_order_relaxed);
+    s.overflows = overflows_.load(std::memory_order_relaxed);
+    return s;
+}
+
+//*****************************************************************************
+// Acquire / release
+
+bool LockOrderGraph::beforeAcquire(int32_t cls, const char *thread)
+{
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    if (cls < 0)
+    {
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    HeldLocks &held = held_locks;
+    uint32_t depth = (held.depth < MAX_HELD) ? held.depth : MAX_HELD;
+    bool ok = true;
+    for (uint32_t i = 0; i < depth; i++)
+    {
+        // Fast path: the order was seen (and checked) before
+        if (held.cls[i] == (uint32_t)cls || !testBit(edges_[held.cls[i]], (uint32_t)cls))
+        {
+            ok = checkEdge(held.cls[i], (uint32_t)cls, thread) && ok;
+        }
+    }
+    return ok;
+}
+
+void LockOrderGraph::acquired(int32_t cls)
+{
+    HeldLocks &held = held_locks;
+    if (cls >= 0 && held.depth < MAX_HELD)
+    {
+        held.cls[held.depth] = (uint8_t)cls;
+    }
+    else if (cls >= 0)
+    {
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+    }
+    held.depth++;
+}
+
+void LockOrderGraph::released(int32_t cls)
+{
+    HeldLocks &held = held_locks;
+    if (held.depth == 0)
+    {
+        return;
+    }
+    if (held.depth > MAX_HELD || cls < 0)
+    {
+        held.depth--;
+        return;
+    }
+
+    // Usually the top entry, but locks may be given back in any order
+    for (uint32_t i = held.depth; i-- > 0;)
+    {
+        if (held.cls[i] == (uint32_t)cls)
+        {
+            memmove(&held.cls[i], &held.cls[i + 1], held.depth - i - 1);
+            held.depth--;
+            return;
+        }
+    }
+}
+
+//*****************************************************************************
+// Slow path: a new edge
+
+bool LockOrderGraph::checkEdge(uint32_t from, uint32_t to, const char *thread)
+{
+    uint8_t path[MAX_CLASSES];
+    uint32_t len = 0;
+
+    lock();
+    if (from != to && testBit(edges_[from], to))
+    {
+        // Another thread added it meanwhile
+        unlock();
+        return true;
+    }
+    if ((reported_[from][to >> 5] >> (to & 31)) & 1)
+    {
+        unlock();
+        return false;
+    }
+
+    if (from != to)
+    {
+        len = findPath(to, from, path);
+    }
+    if (from == to || len > 0)
+    {
+        reported_[from][to >> 5] |= 1u << (to & 31);
+        unlock();
+        violations_.fetch_add(1, std::memory_order_relaxed);
+        report(from, to, thread, path, len);
+        return false;
+    }
+
+    if (num_witnesses_ < MAX_WITNESSES)
+    {
+        Witness &w = witnesses_[num_witnesses_++];
+        w.from = (uint8_t)from;
+        w.to = (uint8_t)to;
+        strncpy(w.thread, thread ? thread : "?", NAME_LEN - 1);
+        w.thread[NAME_LEN - 1] = '\0';
+    }
+    // Witness first: a reader that sees the bit finds its witness
+    edges_[from][to >> 5].fetch_or(1u << (to & 31), std::memory_order_release);
+    unlock();
+    new_edges_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Breadth-first search over the bit matrix. Returns the number of nodes on
+// the shortest path from -> ... -> to (0 if none), written to path.
+uint32_t LockOrderGraph::findPath(uint32_t from, uint32_t to, uint8_t *path) const
+{
+    uint8_t parent[MAX_CLASSES];
+    uint8_t queue[MAX_CLASSES];
+    uint32_t visited[2] = {0, 0};
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t n = num_classes_.load(std::memory_order_relaxed);
+
+    queue[tail++] = (uint8_t)from;
+    visited[from >> 5] |= 1u << (from & 31);
+    while (head < tail)
+    {
+        uint32_t node = queue[head++];
+        // Unvisited successors, 32 classes at a time
+        for (uint32_t word = 0; word < 2; word++)
+        {
+            uint32_t next = edges_[node][word].load(std::memory_order_relaxed) & ~visited[word];
+            visited[word] |= next;
+            while (next != 0)
+            {
+                uint32_t bit = (uint32_t)__builtin_ctz(next);
+                next &= next - 1;
+                uint32_t succ = word * 32 + bit;
+                if (succ >= n)
+                {
+                    continue;
+                }
+                parent[succ] = (uint8_t)node;
+                if (succ == to)
+                {
+                    // Walk back and reverse into path
+                    uint32_t len = 0;
+                    for (uint32_t at = to; at != from; at = parent[at])
+                    {
+                        path[len++] = (uint8_t)at;
+                    }
+                    path[len++] = (uint8_t)from;
+                    for (uint32_t i = 0; i < len / 2; i++)
+                    {
+                        uint8_t t = path[i];
+                        path[i] = path[len - 1 - i];
+                        path[len - 1 - i] = t;
+                    }
+                    return len;
+                }
+                queue[tail++] = (uint8_t)succ;
+            }
+        }
+    }
+    return 0;
+}
+
+const char *LockOrderGraph::witnessOf(uint32_t from, uint32_t to) const
+{
+    for (uint32_t i = 0; i < num_witnesses_; i++)
+    {
+        if (witnesses_[i].from == from && witnesses_[i].to == to)
+        {
+            return witnesses_[i].thread;
+        }
+    }
+    return "?";
+}
+
+void LockOrderGraph::report(uint32_t held, uint32_t taking, const char *thread, const uint8_t *path, uint32_t len) const
+{
+    char line[160];
+    if (reporter_ == nullptr)
+    {
+        return;
+    }
+    thread = thread ? thread : "?";
+
+    if (held == taking)
+    {
+        reporter_("LOCKDEP: possible deadlock, lock taken twice");
+        snprintf(line, sizeof(line), "  %s takes \"%s\" while already holding it", thread, names_[taking]);
+        reporter_(line);
+        return;
+    }
+
+    reporter_("LOCKDEP: possible deadlock, lock order inversion");
+    snprintf(line, sizeof(line), "  %s takes \"%s\" while holding \"%s\"", thread, names_[taking], names_[held]);
+    reporter_(line);
+    reporter_("  but this order was seen before:");
+    for (uint32_t i = 0; i + 1 < len; i++)
+    {
+        snprintf(line, sizeof(line), "    \"%s\" -> \"%s\" (%s)", names_[path[i]], names_[path[i + 1]],
+                 witnessOf(path[i], path[i + 1]));
+        reporter_(line);
+    }
+}
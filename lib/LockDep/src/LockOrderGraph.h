@@ -0,0 +1,115 @@
+#ifndef LOCK_ORDER_GRAPH_H
+#define LOCK_ORDER_GRAPH_H
+
+// Lock-order validator ("lockdep") core, independent of the RTOS
+//
+// Every lock belongs to a class (usually one class per mutex). Whenever a
+// thread takes lock B while it holds lock A, the edge A -> B is recorded in
+// a 64 x 64 bit matrix. An acquisition that would add an edge closing a
+// cycle (B already reaches A, directly or through other locks) is a lock
+// order inversion: two threads can deadlock on it even if they never have.
+// It is reported once, with the thread that first established each edge of
+// the existing chain, and the edge is not added.
+//
+// Cost per acquisition: one bit test per held lock. Only an edge seen for
+// the first time takes the internal lock and runs a breadth-first search
+// over the bit matrix (at most MAX_CLASSES steps of 64-bit ORs).
+//
+// Held locks are tracked per thread (thread_local, which ESP-IDF supports
+// for FreeRTOS tasks), up to MAX_HELD deep. Use one graph per program.
+
+#include <atomic>
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <mutex>
+#endif
+
+struct LockOrderStats
+{
+    uint32_t acquisitions;
+    uint32_t new_edges;
+    uint32_t violations;
+    uint32_t overflows; // Held stack full or class table full: not checked
+};
+
+class LockOrderGraph
+{
+public:
+    static const uint32_t MAX_CLASSES = 64;
+    static const uint32_t MAX_HELD = 8;
+    static const uint32_t MAX_WITNESSES = 128;
+    static const uint32_t NAME_LEN = 16;
+    static const int32_t NO_CLASS = -1;
+
+    // Receives the report, one line at a time (no trailing newline)
+    typedef void (*Reporter)(const char *line);
+
+    LockOrderGraph();
+
+    void setReporter(Reporter reporter)
+    {
+        reporter_ = reporter;
+    }
+
+    // New lock class; name must stay valid. Returns NO_CLASS when full.
+    int32_t addClass(const char *name);
+
+    const char *className(int32_t cls) const;
+
+    // Call before blocking on a lock of class cls. Returns false if taking it
+    // now inverts an order seen before (the report has been written).
+    bool beforeAcquire(int32_t cls, const char *thread);
+
+    // The lock was taken / given back by this thread
+    void acquired(int32_t cls);
+    void released(int32_t cls);
+
+    // True if the edge from -> to has been recorded
+    bool hasEdge(int32_t from, int32_t to) const;
+
+    LockOrderStats stats() const;
+
+    // Forget all edges and violations (classes stay)
+    void clearEdges();
+
+private:
+    struct Witness
+    {
+        uint8_t from;
+        uint8_t to;
+        char thread[NAME_LEN];
+    };
+
+    void lock();
+    void unlock();
+    bool checkEdge(uint32_t from, uint32_t to, const char *thread);
+    uint32_t findPath(uint32_t from, uint32_t to, uint8_t *path) const;
+    void report(uint32_t held, uint32_t taking, const char *thread, const uint8_t *path, uint32_t len) const;
+    const char *witnessOf(uint32_t from, uint32_t to) const;
+
+    // edges_[a] bit b: a held while taking b. Written under the lock, read
+    // without it: bits only ever go from 0 to 1.
+    std::atomic<uint32_t> edges_[MAX_CLASSES][2];
+    uint32_t reported_[MAX_CLASSES][2]; // Inversions already reported, never added
+    const char *names_[MAX_CLASSES];
+    std::atomic<uint32_t> num_classes_;
+    Witness witnesses_[MAX_WITNESSES];
+    uint32_t num_witnesses_;
+
+    std::atomic<uint32_t> acquisitions_;
+    std::atomic<uint32_t> new_edges_;
+    std::atomic<uint32_t> violations_;
+    std::atomic<uint32_t> overflows_;
+    Reporter reporter_;
+
+#if defined(ARDUINO)
+    portMUX_TYPE lock_; // Spinlock: usable before the scheduler starts and from any core
+#else
+    std::mutex lock_;
+#endif
+};
+
+#endif // LOCK_ORDER_GRAPH_H
@@ -0,0 +1,205 @@
+#include "MedianFilter.h"
+
+#include <new>
+#include <string.h>
+
+//*****************************************************************************
+// SlidingMedian
+
+SlidingMedian::SlidingMedian()
+    : tree_(nullptr),
+      ring_(nullptr),
+      size_(0),
+      top_bit_(0),
+      window_(0),
+      head_(0),
+      fill_(0)
+{
+}
+
+SlidingMedian::~SlidingMedian()
+{
+    delete[] tree_;
+    delete[] ring_;
+}
+
+bool SlidingMedian::begin(uint32_t window, uint32_t value_bits)
+{
+    if (window < MIN_WINDOW || window > MAX_WINDOW || value_bits == 0 || value_bits > MAX_VALUE_BITS || tree_ != nullptr)
+    {
+        return false;
+    }
+
+    size_ = 1u << value_bits;
+    tree_ = new (std::nothrow) uint16_t[size_ + 1];
+    ring_ = new (std::nothrow) uint16_t[window];
+    if (tree_ == nullptr || ring_ == nullptr)
+    {
+        return false;
+    }
+    top_bit_ = size_;
+    window_ = window;
+    reset();
+    return true;
+}
+
+void SlidingMedian::reset()
+{
+    memset(tree_, 0, sizeof(uint16_t) * (size_ + 1));
+    head_ = 0;
+    fill_ = 0;
+}
+
+void SlidingMedian::treeAdd(uint32_t value, int32_t delta)
+{
+    for (uint32_t i = value + 1; i <= size_; i += i & (0u - i))
+    {
+        tree_[i] = (uint16_t)(tree_[i] + delta);
+    }
+}
+
+uint32_t SlidingMedian::prefixCount(int32_t value) const
+{
+    if (value < 0)
+    {
+        return 0;
+    }
+    uint32_t i = ((uint32_t)value >= size_) ? size_ : (uint32_t)value + 1;
+    uint32_t count = 0;
+    for (; i > 0; i -= i & (0u - i))
+    {
+        count += tree_[i];
+    }
+    return count;
+}
+
+uint32_t SlidingMedian::countRange(int32_t lo, int32_t hi) const
+{
+    if (hi < lo)
+    {
+        return 0;
+    }
+    return prefixCount(hi) - prefixCount(lo - 1);
+}
+
+uint16_t SlidingMedian::push(uint16_t sample)
+{
+    if (sample >= size_)
+    {
+        sample = (uint16_t)(size_ - 1);
+    }
+
+    if (fill_ == window_)
+    {
+        treeAdd(ring_[head_], -1);
+    }
+    else
+    {
+        fill_++;
+    }
+    ring_[head_] = sample;
+    treeAdd(sample, 1);
+    head_ = (head_ + 1 == window_) ? 0 : head_ + 1;
+
+    return median();
+}
+
+uint16_t SlidingMedian::kth(uint32_t k) const
+{
+    // Walk down the tree: find the largest prefix holding fewer than k samples
+    uint32_t pos = 0;
+    for (uint32_t step = top_bit_; step > 0; step >>= 1)
+    {
+        if (pos + step <= size_ && tree_[pos + step] < k)
+        {
+            pos += step;
+            k -= tree_[pos];
+        }
+    }
+    return (uint16_t)pos; // Index pos + 1 holds the value pos
+}
+
+uint16_t SlidingMedian::median() const
+{
+    if (fill_ == 0)
+    {
+        return 0;
+    }
+    return kth((fill_ + 1) / 2);
+}
+
+uint16_t SlidingMedian::mad(uint16_t center) const
+{
+    if (fill_ == 0)
+    {
+        return 0;
+    }
+
+    // Smallest d with at least half the samples within center +/- d
+    uint32_t need = (fill_ + 1) / 2;
+    uint32_t lo = 0;
+    uint32_t hi = size_ - 1;
+    while (lo < hi)
+    {
+        uint32_t d = (lo + hi) / 2;
+        if (countRange((int32_t)center - (int32_t)d, (int32_t)center + (int32_t)d) >= need)
+        {
+            hi = d;
+        }
+        else
+        {
+            lo = d + 1;
+        }
+    }
+    return (uint16_t)lo;
+}
+
+//*****************************************************************************
+// HampelFilter
+
+HampelFilter::HampelFilter()
+    : threshold_q8_(0),
+      outliers_(0),
+      last_outlier_(false)
+{
+}
+
+bool HampelFilter::begin(uint32_t window, float k, uint32_t value_bits)
+{
+    if (k <= 0.0f || !median_.begin(window, value_bits))
+    {
+        return false;
+    }
+    threshold_q8_ = (uint32_t)(k * 1.4826f * 256.0f + 0.5f);
+    return true;
+}
+
+uint16_t HampelFilter::filter(uint16_t sample)
+{
+    uint16_t med = median_.push(sample);
+    last_outlier_ = false;
+    if (median_.fill() < SlidingMedian::MIN_WINDOW)
+    {
+        return sample;
+    }
+
+    // A window of identical values has MAD 0; treat one LSB as the noise
+    // floor so quantisation steps are not all flagged as outliers
+    uint32_t mad = median_.mad(med);
+    mad = (mad == 0) ? 1 : mad;
+    uint32_t deviation = (sample > med) ? sample - med : med - sample;
+    if ((deviation << 8) > threshold_q8_ * mad)
+    {
+        last_outlier_ = true;
+        outliers_++;
+        return med;
+    }
+    return sample;
+}
+
+void HampelFilter::reset()
+{
+    median_.reset();
+    outliers_ = 0;
+    last_outlier_ = false;
+}
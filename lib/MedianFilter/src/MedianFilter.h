@@ -0,0 +1,114 @@
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+// Sliding-window median and Hampel outlier filter for ADC streams
+//
+// Instead of sorting the window for every sample, SlidingMedian keeps a
+// Fenwick (binary indexed) tree of counts over the sample value range
+// (4096 entries for 12-bit ADC values) plus a ring of the window's samples.
+// Adding a sample and dropping the oldest are O(log V) count updates, and
+// the median is found by walking down the tree in log2(V) steps, whatever
+// the window length (3 to 1023). V is the value range, not the window, so a
+// 1023-sample window costs the same as a 3-sample one.
+//
+// The median absolute deviation (MAD) needed by the Hampel filter comes from
+// the same tree: a binary search for the smallest d with at least half the
+// window inside [median - d, median + d], O(log^2 V).
+//
+// HampelFilter replaces a sample by the window median when it lies more than
+// k * 1.4826 * MAD from it (1.4826 scales MAD to a standard deviation for
+// Gaussian noise). The filter is causal: the window ends at the current
+// sample. Not thread safe; use from one task.
+
+#include <stdint.h>
+
+class SlidingMedian
+{
+public:
+    static const uint32_t MIN_WINDOW = 3;
+    static const uint32_t MAX_WINDOW = 1023;
+    static const uint32_t MAX_VALUE_BITS = 16;
+
+    SlidingMedian();
+    ~SlidingMedian();
+
+    // Samples are clamped to [0, 2^value_bits - 1]. Allocates once.
+    bool begin(uint32_t window, uint32_t value_bits = 12);
+
+    // Add a sample (dropping the oldest once the window is full) and return
+    // the median of the window
+    uint16_t push(uint16_t sample);
+
+    // Lower median of the samples currently in the window
+    uint16_t median() const;
+
+    // Median absolute deviation about the given center
+    uint16_t mad(uint16_t center) const;
+
+    // k-th smallest sample in the window, k = 1..fill()
+    uint16_t kth(uint32_t k) const;
+
+    // Samples in the window with lo <= value <= hi
+    uint32_t countRange(int32_t lo, int32_t hi) const;
+
+    uint32_t fill() const
+    {
+        return fill_;
+    }
+
+    uint32_t window() const
+    {
+        return window_;
+    }
+
+    void reset();
+
+private:
+    void treeAdd(uint32_t value, int32_t delta);
+    uint32_t prefixCount(int32_t value) const; // Samples <= value
+
+    uint16_t *tree_; // Fenwick tree, 1-based, size_ + 1 entries
+    uint16_t *ring_;
+    uint32_t size_;  // Number of distinct values (2^value_bits)
+    uint32_t top_bit_;
+    uint32_t window_;
+    uint32_t head_;
+    uint32_t fill_;
+};
+
+class HampelFilter
+{
+public:
+    HampelFilter();
+
+    // k: threshold in (scaled) MADs, typically 3
+    bool begin(uint32_t window, float k = 3.0f, uint32_t value_bits = 12);
+
+    // Returns the sample, or the window median if the sample is an outlier
+    uint16_t filter(uint16_t sample);
+
+    bool lastWasOutlier() const
+    {
+        return last_outlier_;
+    }
+
+    uint32_t outliers() const
+    {
+        return outliers_;
+    }
+
+    const SlidingMedian &window() const
+    {
+        return median_;
+    }
+
+    void reset();
+
+private:
+    SlidingMedian median_;
+    uint32_t threshold_q8_; // k * 1.4826 in Q8
+    uint32_t outliers_;
+    bool last_outlier_;
+};
+
+#endif // MEDIAN_FILTER_H
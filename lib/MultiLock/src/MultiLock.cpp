@@ -0,0 +1,201 @@
+#include "MultiLock.h"
+
+#include <PortUtils.h>
+
+#if !defined(ARDUINO)
+#include <chrono>
+#include <thread>
+#endif
+
+const MultiLockBackoff MultiLock::DEFAULT_BACKOFF = {100, 20000};
+
+//*****************************************************************************
+// Platform
+
+static bool takeHandle(MultiLockHandle lock, uint32_t timeout_us)
+{
+#if defined(ARDUINO)
+    TickType_t ticks = portMAX_DELAY;
+    if (timeout_us != MULTI_LOCK_FOREVER)
+    {
+        ticks = (TickType_t)(((uint64_t)timeout_us * configTICK_RATE_HZ + 999999) / 1000000);
+    }
+    return xSemaphoreTake(lock, ticks) == pdTRUE;
+#else
+    if (timeout_us == MULTI_LOCK_FOREVER)
+    {
+        lock->lock();
+        return true;
+    }
+    return (timeout_us == 0) ? lock->try_lock() : lock->try_lock_for(std::chrono::microseconds(timeout_us));
+#endif
+}
+
+static void giveHandle(MultiLockHandle lock)
+{
+#if defined(ARDUINO)
+    xSemaphoreGive(lock);
+#else
+    lock->unlock();
+#endif
+}
+
+// Backoff sleep; at least one tick on the target so lower priorities run
+static void sleepUs(uint32_t us)
+{
+#if defined(ARDUINO)
+    TickType_t ticks = (TickType_t)((uint64_t)us * configTICK_RATE_HZ / 1000000);
+    vTaskDelay(ticks > 0 ? ticks : 1);
+#else
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+#endif
+}
+
+//*****************************************************************************
+// MultiLock
+
+MultiLock::MultiLock(std::initializer_list<MultiLockHandle> locks)
+{
+    acquire(locks.begin(), (uint32_t)locks.size(), MULTI_LOCK_ORDERED, MULTI_LOCK_FOREVER, DEFAULT_BACKOFF);
+}
+
+MultiLock::MultiLock(std::initializer_list<MultiLockHandle> locks,
+                     MultiLockMode mode,
+                     uint32_t timeout_us,
+                     const MultiLockBackoff &backoff)
+{
+    acquire(locks.begin(), (uint32_t)locks.size(), mode, timeout_us, backoff);
+}
+
+MultiLock::MultiLock(const MultiLockHandle *locks,
+                     uint32_t count,
+                     MultiLockMode mode,
+                     uint32_t timeout_us,
+                     const MultiLockBackoff &backoff)
+{
+    acquire(locks, count, mode, timeout_us, backoff);
+}
+
+void MultiLock::acquire(const MultiLockHandle *locks,
+                        uint32_t count,
+                        MultiLockMode mode,
+                        uint32_t timeout_us,
+                        const MultiLockBackoff &backoff)
+{
+    owned_ = false;
+    attempts_ = 0;
+    count_ = 0;
+    seed_ = cpuCycleCount() ^ (uint32_t)(uintptr_t)this;
+    if (seed_ == 0)
+    {
+        seed_ = 1;
+    }
+
+    if (count > MAX_LOCKS)
+    {
+        return; // Refuse rather than lock a subset
+    }
+
+    // Insertion sort by rank (address), dropping duplicates
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t pos = count_;
+        while (pos > 0 && (uintptr_t)locks_[pos - 1] > (uintptr_t)locks[i])
+        {
+            pos--;
+        }
+        if (pos > 0 && locks_[pos - 1] == locks[i])
+        {
+            continue;
+        }
+        for (uint32_t j = count_; j > pos; j--)
+        {
+            locks_[j] = locks_[j - 1];
+        }
+        locks_[pos] = locks[i];
+        count_++;
+    }
+    owned_ = (mode == MULTI_LOCK_TRY_ALL) ? takeAllOrNone(timeout_us, backoff) : takeOrdered(timeout_us);
+}
+
+bool MultiLock::takeOrdered(uint32_t timeout_us)
+{
+    attempts_ = 1;
+    uint64_t start = monotonicMicros();
+    for (uint32_t i = 0; i < count_; i++)
+    {
+        uint32_t left = MULTI_LOCK_FOREVER;
+        if (timeout_us != MULTI_LOCK_FOREVER)
+        {
+            uint64_t spent = monotonicMicros() - start;
+            left = (spent < timeout_us) ? (uint32_t)(timeout_us - spent) : 0;
+        }
+        if (!takeHandle(locks_[i], left))
+        {
+            giveFirst(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MultiLock::takeAllOrNone(uint32_t timeout_us, const MultiLockBackoff &backoff)
+{
+    uint64_t start = monotonicMicros();
+    uint32_t window = backoff.initial_us > 0 ? backoff.initial_us : 1;
+    while (1)
+    {
+        attempts_++;
+        uint32_t taken = 0;
+        while (taken < count_ && takeHandle(locks_[taken], 0))
+        {
+            taken++;
+        }
+        if (taken == count_)
+        {
+            return true;
+        }
+        giveFirst(taken);
+
+        uint64_t spent = monotonicMicros() - start;
+        if (timeout_us != MULTI_LOCK_FOREVER && spent >= timeout_us)
+        {
+            return false;
+        }
+        // Random in [window / 2, window): spread retries apart but keep
+        // the expected wait growing with contention
+        uint32_t pause = window / 2 + random() % (window - window / 2);
+        if (timeout_us != MULTI_LOCK_FOREVER && spent + pause > timeout_us)
+        {
+            pause = (uint32_t)(timeout_us - spent);
+        }
+        sleepUs(pause);
+        window = (window < backoff.max_us / 2) ? window * 2 : backoff.max_us;
+    }
+}
+
+void MultiLock::giveFirst(uint32_t n)
+{
+    while (n > 0)
+    {
+        giveHandle(locks_[--n]);
+    }
+}
+
+void MultiLock::unlock()
+{
+    if (owned_)
+    {
+        giveFirst(count_);
+        owned_ = false;
+    }
+}
+
+uint32_t MultiLock::random()
+{
+    // xorshift32
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
@@ -0,0 +1,114 @@
+#ifndef MULTI_LOCK_H
+#define MULTI_LOCK_H
+
+// Scoped acquisition of several mutexes at once, like std::scoped_lock for
+// SemaphoreHandle_t
+//
+//   {
+//       MultiLock lock({mutex_2, mutex_1});   // Any order at the call site
+//       ...                                   // Both held
+//   }                                         // Both given back
+//
+// Two ways to take the set, both deadlock-free:
+//
+//   ordered   sort by rank and take one after the other, blocking. The rank
+//             is the handle's address, stable for the mutex's lifetime, so
+//             every MultiLock in the program agrees on the order without a
+//             hand-maintained hierarchy. An optional timeout gives up (and
+//             gives back) if the whole set is not held in time.
+//   try-all   take every mutex without waiting; if one is busy give back
+//             the ones taken, sleep a random time below the current backoff
+//             (doubled each failure, capped) and retry until the timeout.
+//             Nothing is ever held while waiting.
+//
+// Mutexes must not be held already by the calling task (not recursive).
+// Check owns() when a timeout was given.
+
+#include <initializer_list>
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+typedef SemaphoreHandle_t MultiLockHandle;
+#else
+#include <mutex>
+typedef std::timed_mutex *MultiLockHandle;
+#endif
+
+static const uint32_t MULTI_LOCK_FOREVER = UINT32_MAX;
+
+struct MultiLockBackoff
+{
+    uint32_t initial_us;
+    uint32_t max_us;
+};
+
+enum MultiLockMode
+{
+    MULTI_LOCK_ORDERED = 0,
+    MULTI_LOCK_TRY_ALL
+};
+
+class MultiLock
+{
+public:
+    static const uint32_t MAX_LOCKS = 8;
+    static const MultiLockBackoff DEFAULT_BACKOFF;
+
+    // Ordered, wait forever
+    MultiLock(std::initializer_list<MultiLockHandle> locks);
+
+    MultiLock(std::initializer_list<MultiLockHandle> locks,
+              MultiLockMode mode,
+              uint32_t timeout_us = MULTI_LOCK_FOREVER,
+              const MultiLockBackoff &backoff = DEFAULT_BACKOFF);
+
+    // Same from an array, for sets built at runtime
+    MultiLock(const MultiLockHandle *locks,
+              uint32_t count,
+              MultiLockMode mode = MULTI_LOCK_ORDERED,
+              uint32_t timeout_us = MULTI_LOCK_FOREVER,
+              const MultiLockBackoff &backoff = DEFAULT_BACKOFF);
+
+    ~MultiLock()
+    {
+        unlock();
+    }
+
+    MultiLock(const MultiLock &) = delete;
+    MultiLock &operator=(const MultiLock &) = delete;
+
+    // True if every mutex of the set is held
+    bool owns() const
+    {
+        return owned_;
+    }
+
+    // Rounds of try-all (1 for ordered)
+    uint32_t attempts() const
+    {
+        return attempts_;
+    }
+
+    // Give everything back early, in reverse rank order
+    void unlock();
+
+private:
+    void acquire(const MultiLockHandle *locks,
+                 uint32_t count,
+                 MultiLockMode mode,
+                 uint32_t timeout_us,
+                 const MultiLockBackoff &backoff);
+    bool takeOrdered(uint32_t timeout_us);
+    bool takeAllOrNone(uint32_t timeout_us, const MultiLockBackoff &backoff);
+    void giveFirst(uint32_t n);
+    uint32_t random();
+
+    MultiLockHandle locks_[MAX_LOCKS];
+    uint32_t count_;
+    bool owned_;
+    uint32_t attempts_;
+    uint32_t seed_;
+};
+
+#endif // MULTI_LOCK_H
@@ -0,0 +1,62 @@
+#include "PeriodicSchedule.h"
+
+PeriodicSchedule::PeriodicSchedule()
+    : release_us_(0),
+      period_us_(1),
+      pending_period_us_(1),
+      releases_(0),
+      overruns_(0),
+      skipped_(0)
+{
+}
+
+void PeriodicSchedule::start(uint64_t now_us, uint32_t period_us)
+{
+    release_us_ = now_us;
+    period_us_ = (period_us > 0) ? period_us : 1;
+    pending_period_us_ = period_us_;
+    resetStats();
+}
+
+void PeriodicSchedule::jobStarted(uint64_t now_us)
+{
+    releases_++;
+    jitter_.record((now_us > release_us_) ? (uint32_t)(now_us - release_us_) : 0);
+}
+
+uint64_t PeriodicSchedule::jobFinished(uint64_t now_us)
+{
+    uint64_t deadline = release_us_ + period_us_;
+    if (now_us > deadline)
+    {
+        overruns_++;
+        lateness_.record((uint32_t)(now_us - deadline));
+    }
+
+    // A period change takes effect at the boundary of the current period
+    uint32_t pending = pending_period_us_;
+    if (pending > 0)
+    {
+        period_us_ = pending;
+    }
+
+    // Next release on the absolute timeline; skip the ones we ran past
+    uint64_t next = deadline;
+    if (now_us >= next + period_us_)
+    {
+        uint64_t missed = (now_us - next) / period_us_;
+        next += missed * period_us_;
+        skipped_ += (uint32_t)missed;
+    }
+    release_us_ = next;
+    return next;
+}
+
+void PeriodicSchedule::resetStats()
+{
+    jitter_.reset();
+    lateness_.reset();
+    releases_ = 0;
+    overruns_ = 0;
+    skipped_ = 0;
+}
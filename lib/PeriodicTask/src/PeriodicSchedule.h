@@ -0,0 +1,93 @@
+#ifndef PERIODIC_SCHEDULE_H
+#define PERIODIC_SCHEDULE_H
+
+// Absolute release-time bookkeeping for periodic jobs
+//
+// Release n happens at anchor + sum of the periods before it, never at
+// "end of last job + period", so the loop body's execution time does not
+// accumulate as drift the way it does with vTaskDelay(). The schedule only
+// does arithmetic on microsecond timestamps handed to it, which lets the
+// FreeRTOS PeriodicTask and the host simulation share it.
+//
+// Per job it records:
+//   jitter   - start time minus nominal release time
+//   lateness - completion time minus deadline (release + period), recorded
+//              only for overruns; on-time jobs just count as on time
+// When a job overruns so far that whole later periods have already elapsed,
+// those releases are skipped (and counted); the schedule stays phase aligned
+// and the release still in progress runs immediately.
+
+#include <stdint.h>
+
+#include <Histogram.h>
+
+class PeriodicSchedule
+{
+public:
+    PeriodicSchedule();
+
+    // First release is at now_us
+    void start(uint64_t now_us, uint32_t period_us);
+
+    // New period, applied from the next release onwards
+    void setPeriod(uint32_t period_us)
+    {
+        pending_period_us_ = period_us;
+    }
+
+    uint32_t period() const
+    {
+        return period_us_;
+    }
+
+    // Nominal time of the current (or upcoming) release
+    uint64_t release() const
+    {
+        return release_us_;
+    }
+
+    // Call when the job body starts
+    void jobStarted(uint64_t now_us);
+
+    // Call when the job body returns. Returns the next absolute release time.
+    uint64_t jobFinished(uint64_t now_us);
+
+    void resetStats();
+
+    const LogHistogram &jitter() const
+    {
+        return jitter_;
+    }
+
+    const LogHistogram &lateness() const
+    {
+        return lateness_;
+    }
+
+    uint32_t releases() const
+    {
+        return releases_;
+    }
+
+    uint32_t overruns() const
+    {
+        return overruns_;
+    }
+
+    uint32_t skipped() const
+    {
+        return skipped_;
+    }
+
+private:
+    uint64_t release_us_;
+    uint32_t period_us_;
+    volatile uint32_t pending_period_us_;
+    LogHistogram jitter_;
+    LogHistogram lateness_;
+    uint32_t releases_;
+    uint32_t overruns_;
+    uint32_t skipped_;
+};
+
+#endif // PERIODIC_SCHEDULE_H
@@ -0,0 +1,217 @@
+#include "PeriodicTask.h"
+
+#if defined(ARDUINO)
+
+#include <PortUtils.h>
+#include <string.h>
+
+// Globals
+static PeriodicTask *registry = nullptr;
+static portMUX_TYPE registry_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const uint32_t tick_us = 1000000u / configTICK_RATE_HZ;
+
+static void writeLine(const char *line)
+{
+    Serial.println(line);
+}
+
+// The task may be preempted mid-update by a reader on its own core; after a
+// few tries let it run
+static void readerBackoff(uint32_t attempt)
+{
+    if (attempt > 4)
+    {
+        vTaskDelay(1);
+    }
+}
+
+PeriodicTask::PeriodicTask()
+    : name_(""),
+      job_(nullptr),
+      parameters_(nullptr),
+      handle_(NULL),
+      period_ticks_(1),
+      reset_requested_(false),
+      sequence_(0),
+      next_(nullptr)
+{
+}
+
+bool PeriodicTask::begin(const char *name,
+                         PeriodicJobFunction_t job,
+                         void *parameters,
+                         uint32_t period_ms,
+                         uint32_t stack_size,
+                         UBaseType_t priority,
+                         BaseType_t core)
+{
+    name_ = name;
+    job_ = job;
+    parameters_ = parameters;
+    period_ticks_ = pdMS_TO_TICKS(period_ms) ? pdMS_TO_TICKS(period_ms) : 1;
+
+    portENTER_CRITICAL(&registry_mux);
+    next_ = registry;
+    registry = this;
+    portEXIT_CRITICAL(&registry_mux);
+
+    return xTaskCreatePinnedToCore(taskEntry, name, stack_size, this, priority, &handle_, core) == pdPASS;
+}
+
+void PeriodicTask::setPeriod(uint32_t period_ms)
+{
+    TickType_t ticks = pdMS_TO_TICKS(period_ms) ? pdMS_TO_TICKS(period_ms) : 1;
+    schedule_.setPeriod(ticks * tick_us);
+}
+
+void PeriodicTask::resetStats()
+{
+    // The task owns the statistics; it clears them at its next release
+    reset_requested_.store(true, std::memory_order_release);
+}
+
+void PeriodicTask::beginWrite()
+{
+    uint32_t seq = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void PeriodicTask::endWrite()
+{
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void PeriodicTask::snapshot(PeriodicSchedule *out) const
+{
+    for (uint32_t attempt = 0;; attempt++)
+    {
+        uint32_t before = sequence_.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+            *out = schedule_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before)
+            {
+                return;
+            }
+        }
+        readerBackoff(attempt);
+    }
+}
+
+void PeriodicTask::taskEntry(void *parameters)
+{
+    ((PeriodicTask *)parameters)->run();
+}
+
+void PeriodicTask::run()
+{
+    // Start right after a tick edge so that tick n maps onto anchor + n ticks
+    vTaskDelay(1);
+    TickType_t last_wake = xTaskGetTickCount();
+    uint64_t anchor_us = monotonicMicros();
+    uint64_t release_us = anchor_us;
+
+    beginWrite();
+    schedule_.start(anchor_us, period_ticks_ * tick_us);
+    endWrite();
+
+    while (1)
+    {
+        // The job itself runs outside the write, so readers never wait on it
+        beginWrite();
+        if (reset_requested_.exchange(false, std::memory_order_acquire))
+        {
+            schedule_.resetStats();
+        }
+        schedule_.jobStarted(monotonicMicros());
+        endWrite();
+
+        job_(parameters_);
+
+        beginWrite();
+        uint64_t next_us = schedule_.jobFinished(monotonicMicros());
+        endWrite();
+
+        // Convert the absolute release back onto the tick timeline. Periods
+        // are whole ticks, so this is exact and nothing accumulates.
+        TickType_t advance = (TickType_t)((next_us - release_us) / tick_us);
+        release_us = next_us;
+        if (advance > 0)
+        {
+            xTaskDelayUntil(&last_wake, advance);
+        }
+    }
+}
+
+void PeriodicTask::printStats() const
+{
+    PeriodicSchedule snap;
+    snapshot(&snap);
+    Serial.printf("%s: period=%lu us releases=%lu overruns=%lu skipped=%lu\n",
+                  name_,
+                  (unsigned long)snap.period(),
+                  (unsigned long)snap.releases(),
+                  (unsigned long)snap.overruns(),
+                  (unsigned long)snap.skipped());
+    snap.jitter().printTo(writeLine, "  jitter", "us");
+    snap.lateness().printTo(writeLine, "  lateness", "us");
+}
+
+void PeriodicTask::printAllStats()
+{
+    for (PeriodicTask *task = registry; task != nullptr; task = task->next_)
+    {
+        task->printStats();
+    }
+}
+
+bool PeriodicTask::handleCommand(const char *line)
+{
+    static const char prefix[] = "periodic ";
+    if (strncmp(line, prefix, sizeof(prefix) - 1) != 0)
+    {
+        return false;
+    }
+    const char *args = line + sizeof(prefix) - 1;
+
+    if (strcmp(args, "stats") == 0)
+    {
+        printAllStats();
+        return true;
+    }
+
+    if (strcmp(args, "reset") == 0)
+    {
+        for (PeriodicTask *task = registry; task != nullptr; task = task->next_)
+        {
+            task->resetStats();
+        }
+        Serial.println("Periodic task statistics cleared");
+        return true;
+    }
+
+    // "<name> <ms>": the name may contain spaces, the period is the last word
+    const char *space = strrchr(args, ' ');
+    int period_ms = (space != nullptr) ? atoi(space + 1) : 0;
+    if (period_ms > 0)
+    {
+        size_t name_len = (size_t)(space - args);
+        for (PeriodicTask *task = registry; task != nullptr; task = task->next_)
+        {
+            if (strlen(task->name_) == name_len && strncmp(task->name_, args, name_len) == 0)
+            {
+                task->setPeriod((uint32_t)period_ms);
+                Serial.printf("%s period set to %d ms\n", task->name_, period_ms);
+                return true;
+            }
+        }
+    }
+
+    Serial.println("Usage: periodic stats | periodic reset | periodic <name> <ms>");
+    return true;
+}
+
+#endif // ARDUINO
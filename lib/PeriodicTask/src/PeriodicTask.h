@@ -0,0 +1,96 @@
+#ifndef PERIODIC_TASK_H
+#define PERIODIC_TASK_H
+
+// Drift-free periodic FreeRTOS task with jitter statistics
+//
+// Runs a job function on absolute release times (xTaskDelayUntil() on the
+// tick timeline, measured against esp_timer in microseconds). The period can
+// be changed at runtime, overruns are detected and every task keeps jitter
+// and lateness histograms (see PeriodicSchedule.h).
+//
+// All PeriodicTask objects register themselves so a serial command handler
+// can list and tune them:
+//   periodic stats              print statistics for every periodic task
+//   periodic reset              clear all statistics
+//   periodic <name> <ms>        change the period of one task
+
+#include "PeriodicSchedule.h"
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+
+#include <atomic>
+
+typedef void (*PeriodicJobFunction_t)(void *parameters);
+
+class PeriodicTask
+{
+public:
+    PeriodicTask();
+
+    // Create the task. period_ms is rounded to whole ticks.
+    bool begin(const char *name,
+               PeriodicJobFunction_t job,
+               void *parameters,
+               uint32_t period_ms,
+               uint32_t stack_size,
+               UBaseType_t priority,
+               BaseType_t core);
+
+    // Applied at the next release
+    void setPeriod(uint32_t period_ms);
+
+    const char *name() const
+    {
+        return name_;
+    }
+
+    TaskHandle_t handle() const
+    {
+        return handle_;
+    }
+
+    // Statistics are updated by the task itself; only the task may read
+    // them here, other tasks take a snapshot()
+    const PeriodicSchedule &schedule() const
+    {
+        return schedule_;
+    }
+
+    // Any task: consistent copy of the schedule and its statistics
+    void snapshot(PeriodicSchedule *out) const;
+
+    // Any task: the task clears its statistics at its next release
+    void resetStats();
+
+    // Print statistics for this task to Serial
+    void printStats() const;
+
+    // Print statistics for every registered periodic task
+    static void printAllStats();
+
+    // Handle a "periodic ..." command line. Returns false if the line is not
+    // a periodic command so the caller can try its own commands.
+    static bool handleCommand(const char *line);
+
+private:
+    static void taskEntry(void *parameters);
+    void run();
+    void beginWrite();
+    void endWrite();
+
+    const char *name_;
+    PeriodicJobFunction_t job_;
+    void *parameters_;
+    TaskHandle_t handle_;
+    TickType_t period_ticks_;
+    std::atomic<bool> reset_requested_;
+    std::atomic<uint32_t> sequence_; // Odd while the task updates schedule_
+    PeriodicSchedule schedule_;
+    PeriodicTask *next_; // Registry of all periodic tasks
+};
+
+#endif // ARDUINO
+
+#endif // PERIODIC_TASK_H
@@ -0,0 +1,94 @@
+#ifndef PORT_UTILS_H
+#define PORT_UTILS_H
+
+// Small portability layer shared by the libraries in lib/.
+//
+// On the ESP32 (ARDUINO defined) the helpers map onto the CPU cycle counter,
+// esp_timer and the FreeRTOS core id. On the host they fall back to
+// clock_gettime() so the same library code and benchmarks build with plain g++.
+// On the host one "cycle" is one nanosecond (cpuMhz() returns 1000).
+//
+// The ESP32 cycle counters of the two cores are not synchronised: only
+// subtract cpuCycleCount() values taken on the same core. Use
+// monotonicMicros() for timestamps that cross cores.
+
+#include <stdint.h>
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <esp_cpu.h>
+#include <esp_timer.h>
+
+#define PORT_NUM_CORES portNUM_PROCESSORS
+#define PORT_IRAM IRAM_ATTR
+
+static inline uint32_t cpuCycleCount()
+{
+    return esp_cpu_get_cycle_count();
+}
+
+static inline uint32_t cpuMhz()
+{
+    return getCpuFrequencyMhz();
+}
+
+static inline uint32_t cpuCoreId()
+{
+    return (uint32_t)xPortGetCoreID();
+}
+
+static inline uint64_t monotonicMicros()
+{
+    return (uint64_t)esp_timer_get_time();
+}
+
+#else // Host build
+
+#include <sched.h>
+#include <time.h>
+
+#define PORT_NUM_CORES 2
+#define PORT_IRAM
+
+static inline uint64_t monotonicNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint32_t cpuCycleCount()
+{
+    return (uint32_t)monotonicNanos();
+}
+
+static inline uint32_t cpuMhz()
+{
+    return 1000;
+}
+
+static inline uint32_t cpuCoreId()
+{
+    int cpu = sched_getcpu();
+    return (cpu < 0) ? 0 : (uint32_t)cpu % PORT_NUM_CORES;
+}
+
+static inline uint64_t monotonicMicros()
+{
+    return monotonicNanos() / 1000u;
+}
+
+#endif // ARDUINO
+
+// For small helpers used from IRAM interrupt handlers: forcing the inline keeps
+// the code in the caller's IRAM section instead of a flash-resident copy.
+#define PORT_FORCE_INLINE inline __attribute__((always_inline))
+
+// Convert a cycle delta to nanoseconds for printing
+static inline uint32_t cyclesToNs(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000u) / cpuMhz());
+}
+
+#endif // PORT_UTILS_H
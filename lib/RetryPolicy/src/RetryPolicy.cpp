@@ -0,0 +1,109 @@
+#include "RetryPolicy.h"
+
+const char *retryKindName(RetryKind kind)
+{
+    switch (kind)
+    {
+    case RETRY_FIXED:
+        return "fixed";
+    case RETRY_EXPONENTIAL:
+        return "exponential";
+    case RETRY_FULL_JITTER:
+        return "full jitter";
+    case RETRY_DECORRELATED:
+        return "decorrelated";
+    default:
+        return "?";
+    }
+}
+
+RetryPolicy::RetryPolicy(const RetryConfig &config, uint32_t seed)
+    : config_(config), failures_(0), previous_us_(config.base_us), seed_(seed ? seed : 1)
+{
+}
+
+uint32_t RetryPolicy::random()
+{
+    // xorshift32
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
+
+uint32_t RetryPolicy::nextDelayUs()
+{
+    uint32_t base = config_.base_us;
+    uint32_t cap = config_.max_us;
+    uint32_t n = failures_++;
+
+    // base * 2^n without overflow
+    uint32_t ceiling = cap;
+    if (n < 32 && base <= (cap >> n))
+    {
+        ceiling = base << n;
+    }
+
+    switch (config_.kind)
+    {
+    case RETRY_FIXED:
+        return base;
+    case RETRY_EXPONENTIAL:
+        return ceiling;
+    case RETRY_FULL_JITTER:
+        return (ceiling > 0) ? random() % ceiling : 0;
+    default:
+    {
+        uint64_t upper = (uint64_t)previous_us_ * 3;
+        if (upper > cap)
+        {
+            upper = cap;
+        }
+        uint32_t span = (upper > base) ? (uint32_t)(upper - base) : 1;
+        previous_us_ = base + random() % span;
+        return previous_us_;
+    }
+    }
+}
+
+//*****************************************************************************
+// FreeRTOS helpers
+
+#if defined(ARDUINO)
+
+void retryDelay(uint32_t delay_us)
+{
+    TickType_t ticks = (TickType_t)((uint64_t)delay_us * configTICK_RATE_HZ / 1000000);
+    vTaskDelay(ticks > 0 ? ticks : 1);
+}
+
+BaseType_t retryTake(SemaphoreHandle_t sem,
+                     TickType_t timeout,
+                     RetryPolicy &policy,
+                     uint32_t max_attempts,
+                     LivelockDetector *detector)
+{
+    for (uint32_t attempt = 0; attempt < max_attempts; attempt++)
+    {
+        if (xSemaphoreTake(sem, timeout) == pdTRUE)
+        {
+            policy.reset();
+            if (detector != nullptr)
+            {
+                detector->progress();
+            }
+            return pdTRUE;
+        }
+        if (detector != nullptr)
+        {
+            detector->failure();
+        }
+        if (attempt + 1 < max_attempts)
+        {
+            retryDelay(policy.nextDelayUs());
+        }
+    }
+    return pdFALSE;
+}
+
+#endif // ARDUINO
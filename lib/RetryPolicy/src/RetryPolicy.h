@@ -0,0 +1,142 @@
+#ifndef RETRY_POLICY_H
+#define RETRY_POLICY_H
+
+// Retry delays for timed takes, and a livelock detector
+//
+// part10_deadlock_timeout.cpp retries after a fixed sleep. Two tasks with
+// the same timeout and sleep that collide once keep colliding: they time
+// out on the same tick, sleep the same time and come back together. A
+// RetryPolicy decides how long to wait after each failed attempt:
+//
+//   RETRY_FIXED         always base_us
+//   RETRY_EXPONENTIAL   base_us * 2^n, capped at max_us (no randomness)
+//   RETRY_FULL_JITTER   random in [0, base_us * 2^n), capped
+//   RETRY_DECORRELATED  random in [base_us, 3 * previous), capped
+//                       ("decorrelated jitter")
+//
+// reset() after a success starts the sequence again. Each policy has its
+// own random state; seed tasks differently.
+//
+// LivelockDetector is shared by the tasks that contend: every failure
+// counts, any success clears the count. threshold failures in a row with
+// no success anywhere is reported as a livelock episode (once per episode).
+
+#include <atomic>
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+enum RetryKind
+{
+    RETRY_FIXED = 0,
+    RETRY_EXPONENTIAL,
+    RETRY_FULL_JITTER,
+    RETRY_DECORRELATED,
+    NUM_RETRY_KINDS
+};
+
+struct RetryConfig
+{
+    RetryKind kind;
+    uint32_t base_us;
+    uint32_t max_us;
+};
+
+const char *retryKindName(RetryKind kind);
+
+class RetryPolicy
+{
+public:
+    RetryPolicy(const RetryConfig &config, uint32_t seed);
+
+    // Delay before the next attempt, after a failure
+    uint32_t nextDelayUs();
+
+    // After a success
+    void reset()
+    {
+        failures_ = 0;
+        previous_us_ = config_.base_us;
+    }
+
+    uint32_t failures() const
+    {
+        return failures_;
+    }
+
+    const RetryConfig &config() const
+    {
+        return config_;
+    }
+
+private:
+    uint32_t random();
+
+    RetryConfig config_;
+    uint32_t failures_;
+    uint32_t previous_us_;
+    uint32_t seed_;
+};
+
+class LivelockDetector
+{
+public:
+    explicit LivelockDetector(uint32_t threshold) : threshold_(threshold), streak_(0), episodes_(0)
+    {
+    }
+
+    // True the first time the streak of failures reaches the threshold
+    bool failure()
+    {
+        uint32_t streak = streak_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (streak == threshold_)
+        {
+            episodes_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void progress()
+    {
+        streak_.store(0, std::memory_order_relaxed);
+    }
+
+    // Failures since the last success, by anyone
+    uint32_t streak() const
+    {
+        return streak_.load(std::memory_order_relaxed);
+    }
+
+    bool livelocked() const
+    {
+        return streak() >= threshold_;
+    }
+
+    uint32_t episodes() const
+    {
+        return episodes_.load(std::memory_order_relaxed);
+    }
+
+private:
+    uint32_t threshold_;
+    std::atomic<uint32_t> streak_;
+    std::atomic<uint32_t> episodes_;
+};
+
+#if defined(ARDUINO)
+// xSemaphoreTake() with timeout per attempt, retried after policy delays
+// until max_attempts. Resets the policy and reports progress on success.
+BaseType_t retryTake(SemaphoreHandle_t sem,
+                     TickType_t timeout,
+                     RetryPolicy &policy,
+                     uint32_t max_attempts,
+                     LivelockDetector *detector = nullptr);
+
+// Sleep for a policy delay, at least one tick
+void retryDelay(uint32_t delay_us);
+#endif
+
+#endif // RETRY_POLICY_H
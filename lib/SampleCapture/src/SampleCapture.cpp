@@ -0,0 +1,343 @@
+#include "SampleCapture.h"
+
+static const uint8_t MAGIC_0 = 0xA5;
+static const uint8_t MAGIC_1 = 0x5C;
+
+//*****************************************************************************
+// Byte helpers
+
+static inline void put16(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, v);
+    put16(p + 2, v >> 16);
+}
+
+static inline uint32_t get16(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | (get16(p + 2) << 16);
+}
+
+static inline uint32_t zigzag(int32_t delta)
+{
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+//*****************************************************************************
+// CRC-32, 16-entry table: small enough for the target, 2 lookups per byte
+
+static const uint32_t crc_nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t captureCrc32(const uint8_t *data, size_t len, uint32_t crc)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc_nibble_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_nibble_table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+//*****************************************************************************
+// Encoder
+
+static uint32_t encodeVarint(const uint16_t *x, uint32_t count, uint8_t *out)
+{
+    uint8_t *p = out;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        uint32_t v = zigzag((int32_t)x[i] - (int32_t)x[i - 1]);
+        while (v >= 0x80)
+        {
+            *p++ = (uint8_t)(v | 0x80);
+            v >>= 7;
+        }
+        *p++ = (uint8_t)v;
+    }
+    return (uint32_t)(p - out);
+}
+
+static uint32_t encodePacked(const uint16_t *x, uint32_t count, uint32_t width, uint8_t *out)
+{
+    uint8_t *p = out;
+    uint32_t acc = 0; // Bits not yet written, LSB first
+    uint32_t bits = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        acc |= zigzag((int32_t)x[i] - (int32_t)x[i - 1]) << bits;
+        bits += width;
+        while (bits >= 8)
+        {
+            *p++ = (uint8_t)acc;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    if (bits > 0)
+    {
+        *p++ = (uint8_t)acc;
+    }
+    return (uint32_t)(p - out);
+}
+
+static uint32_t encodeRaw(const uint16_t *x, uint32_t count, uint8_t *out)
+{
+    for (uint32_t i = 1; i < count; i++)
+    {
+        put16(out + 2 * (i - 1), x[i]);
+    }
+    return 2 * (count - 1);
+}
+
+static inline uint32_t varintBytes(uint32_t v)
+{
+    return (v < 0x80) ? 1 : ((v < 0x4000) ? 2 : 3);
+}
+
+uint32_t encodeCaptureBlock(const uint16_t *samples, uint32_t count, uint32_t sequence, uint64_t first_us,
+                            uint8_t *out, uint32_t capacity, CaptureEncoding encoding)
+{
+    if (count == 0 || count > CAPTURE_MAX_SAMPLES)
+    {
+        return 0;
+    }
+
+    // One pass sizes every encoding; widest zigzag value gives the bit width
+    uint32_t varint_bytes = 0;
+    uint32_t widest = 0;
+    if (encoding != CAPTURE_RAW)
+    {
+        for (uint32_t i = 1; i < count; i++)
+        {
+            uint32_t v = zigzag((int32_t)samples[i] - (int32_t)samples[i - 1]);
+            varint_bytes += varintBytes(v);
+            widest |= v;
+        }
+    }
+    uint32_t width = (widest == 0) ? 0 : 32 - (uint32_t)__builtin_clz(widest);
+    uint32_t packed_bytes = ((count - 1) * width + 7) / 8;
+    uint32_t raw_bytes = 2 * (count - 1);
+
+    if (encoding == CAPTURE_AUTO)
+    {
+        encoding = CAPTURE_VARINT;
+        uint32_t best = varint_bytes;
+        if (packed_bytes < best)
+        {
+            encoding = CAPTURE_PACKED;
+            best = packed_bytes;
+        }
+        if (raw_bytes < best)
+        {
+            encoding = CAPTURE_RAW;
+        }
+    }
+
+    uint32_t payload_bytes = (encoding == CAPTURE_VARINT) ? varint_bytes : ((encoding == CAPTURE_PACKED) ? packed_bytes : raw_bytes);
+    uint32_t total = CAPTURE_HEADER_BYTES + payload_bytes + CAPTURE_CRC_BYTES;
+    if (total > capacity || payload_bytes > 0xFFFF)
+    {
+        return 0;
+    }
+
+    out[0] = MAGIC_0;
+    out[1] = MAGIC_1;
+    out[2] = (uint8_t)encoding;
+    out[3] = (encoding == CAPTURE_PACKED) ? (uint8_t)width : 0;
+    put16(out + 4, count);
+    put16(out + 6, payload_bytes);
+    put32(out + 8, sequence);
+    put32(out + 12, (uint32_t)first_us);
+    put32(out + 16, (uint32_t)(first_us >> 32));
+    put16(out + 20, samples[0]);
+
+    uint8_t *payload = out + CAPTURE_HEADER_BYTES;
+    if (encoding == CAPTURE_VARINT)
+    {
+        encodeVarint(samples, count, payload);
+    }
+    else if (encoding == CAPTURE_PACKED)
+    {
+        encodePacked(samples, count, width, payload);
+    }
+    else
+    {
+        encodeRaw(samples, count, payload);
+    }
+
+    put32(out + CAPTURE_HEADER_BYTES + payload_bytes, captureCrc32(out, CAPTURE_HEADER_BYTES + payload_bytes));
+    return total;
+}
+
+//*****************************************************************************
+// Decoder
+
+static bool decodeVarint(const uint8_t *in, uint32_t len, uint16_t *x, uint32_t count)
+{
+    uint32_t pos = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        uint32_t v = 0;
+        uint32_t shift = 0;
+        uint8_t byte;
+        do
+        {
+            if (pos >= len || shift > 14)
+            {
+                return false;
+            }
+            byte = in[pos++];
+            v |= (uint32_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        x[i] = (uint16_t)(x[i - 1] + unzigzag(v));
+    }
+    return pos == len;
+}
+
+static bool decodePacked(const uint8_t *in, uint32_t len, uint32_t width, uint16_t *x, uint32_t count)
+{
+    if (width > 17 || ((count - 1) * width + 7) / 8 != len)
+    {
+        return false;
+    }
+    uint32_t mask = (width == 0) ? 0 : (1u << width) - 1;
+    uint32_t acc = 0;
+    uint32_t bits = 0;
+    uint32_t pos = 0;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        while (bits < width)
+        {
+            acc |= (uint32_t)in[pos++] << bits;
+            bits += 8;
+        }
+        x[i] = (uint16_t)(x[i - 1] + unzigzag(acc & mask));
+        acc >>= width;
+        bits -= width;
+    }
+    return true;
+}
+
+static bool decodeRaw(const uint8_t *in, uint32_t len, uint16_t *x, uint32_t count)
+{
+    if (len != 2 * (count - 1))
+    {
+        return false;
+    }
+    for (uint32_t i = 1; i < count; i++)
+    {
+        x[i] = (uint16_t)get16(in + 2 * (i - 1));
+    }
+    return true;
+}
+
+int32_t decodeCaptureBlock(const uint8_t *in, uint32_t len, CaptureBlockInfo *info,
+                           uint16_t *samples, uint32_t max_samples)
+{
+    if (len < 2)
+    {
+        return CAPTURE_NEED_MORE;
+    }
+    if (in[0] != MAGIC_0 || in[1] != MAGIC_1)
+    {
+        return CAPTURE_BAD_HEADER;
+    }
+    if (len < CAPTURE_HEADER_BYTES)
+    {
+        return CAPTURE_NEED_MORE;
+    }
+
+    uint32_t count = get16(in + 4);
+    uint32_t payload_bytes = get16(in + 6);
+    if (count == 0 || count > max_samples || in[2] > CAPTURE_PACKED)
+    {
+        return CAPTURE_BAD_HEADER;
+    }
+    uint32_t total = CAPTURE_HEADER_BYTES + payload_bytes + CAPTURE_CRC_BYTES;
+    if (len < total)
+    {
+        return CAPTURE_NEED_MORE;
+    }
+    if (captureCrc32(in, CAPTURE_HEADER_BYTES + payload_bytes) != get32(in + CAPTURE_HEADER_BYTES + payload_bytes))
+    {
+        return CAPTURE_BAD_CRC;
+    }
+
+    const uint8_t *payload = in + CAPTURE_HEADER_BYTES;
+    samples[0] = (uint16_t)get16(in + 20);
+    bool ok;
+    if (in[2] == CAPTURE_VARINT)
+    {
+        ok = decodeVarint(payload, payload_bytes, samples, count);
+    }
+    else if (in[2] == CAPTURE_PACKED)
+    {
+        ok = decodePacked(payload, payload_bytes, in[3], samples, count);
+    }
+    else
+    {
+        ok = decodeRaw(payload, payload_bytes, samples, count);
+    }
+    if (!ok)
+    {
+        return CAPTURE_BAD_HEADER;
+    }
+
+    info->sequence = get32(in + 8);
+    info->first_us = (uint64_t)get32(in + 12) | ((uint64_t)get32(in + 16) << 32);
+    info->count = count;
+    info->encoding = in[2];
+    info->bit_width = in[3];
+    info->bytes = total;
+    return (int32_t)total;
+}
+
+uint32_t findCaptureBlock(const uint8_t *in, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (in[i] == MAGIC_0 && (i + 1 == len || in[i + 1] == MAGIC_1))
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+const char *captureEncodingName(uint8_t encoding)
+{
+    switch (encoding)
+    {
+    case CAPTURE_RAW:
+        return "raw";
+    case CAPTURE_VARINT:
+        return "varint";
+    case CAPTURE_PACKED:
+        return "packed";
+    case CAPTURE_AUTO:
+        return "auto";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SAMPLE_CAPTURE_H
+#define SAMPLE_CAPTURE_H
+
+// Compact binary capture format for 16-bit sample streams
+//
+// A capture is a plain concatenation of self-contained blocks, so it can be
+// streamed over a UART or appended to a file and cut anywhere. Each block:
+//
+//   offset size
+//        0    2  magic 0xA5 0x5C
+//        2    1  encoding (CaptureEncoding)
+//        3    1  bit width (packed encoding only, else 0)
+//        4    2  sample count n (>= 1)
+//        6    2  payload bytes
+//        8    4  sequence number (gaps = lost blocks)
+//       12    8  timestamp of the first sample, us
+//       20    2  first sample
+//       22    -  payload: the n - 1 deltas x[i] - x[i-1], zigzag mapped
+//   22+payload 4 CRC-32 (IEEE) over everything before it
+//
+// All fields little endian. Payload encodings:
+//
+//   varint - LEB128, 7 bits per byte: ADC noise of a few LSB takes 1 byte
+//   packed - every delta in the block with the same bit width (the widest
+//            one), bits packed LSB first
+//   raw    - the samples themselves, 2 bytes each
+//
+// CAPTURE_AUTO picks whichever is smallest for the block. Encoding and
+// decoding need no allocation and run on the target as well as the host.
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum CaptureEncoding
+{
+    CAPTURE_RAW = 0,
+    CAPTURE_VARINT = 1,
+    CAPTURE_PACKED = 2,
+    CAPTURE_AUTO = 0xFF // Encoder only
+};
+
+struct CaptureBlockInfo
+{
+    uint32_t sequence;
+    uint64_t first_us;
+    uint32_t count;
+    uint8_t encoding;
+    uint8_t bit_width;
+    uint32_t bytes; // Whole block including header and CRC
+};
+
+static const uint32_t CAPTURE_HEADER_BYTES = 22;
+static const uint32_t CAPTURE_CRC_BYTES = 4;
+static const uint32_t CAPTURE_MAX_SAMPLES = 21845; // Payload length must fit 16 bits
+
+// decodeCaptureBlock() results below zero
+static const int32_t CAPTURE_NEED_MORE = 0;
+static const int32_t CAPTURE_BAD_HEADER = -1;
+static const int32_t CAPTURE_BAD_CRC = -2;
+
+// Upper bound of an encoded block of count samples, any encoding
+static constexpr uint32_t captureMaxBlockBytes(uint32_t count)
+{
+    return CAPTURE_HEADER_BYTES + 3 * count + CAPTURE_CRC_BYTES;
+}
+
+// CRC-32 (IEEE 802.3), continue with crc = previous result
+uint32_t captureCrc32(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+// Encode one block. Returns the bytes written, or 0 if count is 0 or too
+// large, or capacity is too small for the chosen encoding.
+uint32_t encodeCaptureBlock(const uint16_t *samples, uint32_t count, uint32_t sequence, uint64_t first_us,
+                            uint8_t *out, uint32_t capacity, CaptureEncoding encoding = CAPTURE_AUTO);
+
+// Decode the block at the start of in. Returns the bytes it occupies,
+// CAPTURE_NEED_MORE if len does not hold all of it yet, or a negative error:
+// skip a byte (or use findCaptureBlock()) and try again. samples must hold
+// max_samples; larger blocks are reported as CAPTURE_BAD_HEADER.
+int32_t decodeCaptureBlock(const uint8_t *in, uint32_t len, CaptureBlockInfo *info,
+                           uint16_t *samples, uint32_t max_samples);
+
+// Offset of the next possible block start (magic) in in, or len if none
+uint32_t findCaptureBlock(const uint8_t *in, uint32_t len);
+
+const char *captureEncodingName(uint8_t encoding);
+
+#endif // SAMPLE_CAPTURE_H
@@ -0,0 +1,254 @@
+#include "ContinuousAdcSource.h"
+
+#if defined(ARDUINO)
+
+#include <new>
+
+#include <PortUtils.h>
+
+// Result layout differs between chip generations
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_RESULT_CHANNEL(p) ((p)->type1.channel)
+#define ADC_RESULT_DATA(p) ((p)->type1.data)
+#else
+#define ADC_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_RESULT_CHANNEL(p) ((p)->type2.channel)
+#define ADC_RESULT_DATA(p) ((p)->type2.data)
+#endif
+
+ContinuousAdcSource::ContinuousAdcSource()
+    : handle_(nullptr),
+      channel_(0),
+      rate_hz_(0),
+      frame_bytes_(0),
+      raw_(nullptr),
+      samples_buf_(nullptr),
+      running_(false),
+      anchor_us_(0),
+      anchor_index_(0),
+      next_index_(0),
+      seen_overruns_(0),
+      samples_(0),
+      blocks_(0),
+      interrupts_(0),
+      overruns_(0)
+{
+}
+
+ContinuousAdcSource::~ContinuousAdcSource()
+{
+    stop();
+    if (handle_ != nullptr)
+    {
+        adc_continuous_deinit(handle_);
+    }
+    delete[] raw_;
+    delete[] samples_buf_;
+}
+
+bool ContinuousAdcSource::begin(uint8_t pin, uint32_t sample_rate_hz, uint32_t block_size, uint32_t pool_blocks)
+{
+    int8_t channel = digitalPinToAnalogChannel(pin);
+    if (handle_ != nullptr || channel < 0 || channel >= SOC_ADC_MAX_CHANNEL_NUM || block_size == 0 || pool_blocks == 0)
+    {
+        return false;
+    }
+    if (sample_rate_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW || sample_rate_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH)
+    {
+        return false;
+    }
+
+    // Frame size must be a whole number of DMA conversions
+    uint32_t frame_bytes = block_size * SOC_ADC_DIGI_RESULT_BYTES;
+    uint32_t align = SOC_ADC_DIGI_DATA_BYTES_PER_CONV;
+    frame_bytes = ((frame_bytes + align - 1) / align) * align;
+
+    raw_ = new (std::nothrow) uint8_t[frame_bytes];
+    samples_buf_ = new (std::nothrow) uint16_t[frame_bytes / SOC_ADC_DIGI_RESULT_BYTES];
+    if (raw_ == nullptr || samples_buf_ == nullptr)
+    {
+        return false;
+    }
+
+    adc_continuous_handle_cfg_t handle_config = {};
+    handle_config.max_store_buf_size = frame_bytes * pool_blocks;
+    handle_config.conv_frame_size = frame_bytes;
+    if (adc_continuous_new_handle(&handle_config, &handle_) != ESP_OK)
+    {
+        handle_ = nullptr;
+        return false;
+    }
+
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_conv_done = onConversionDone;
+    callbacks.on_pool_ovf = onPoolOverflow;
+
+    channel_ = (uint32_t)channel;
+    if (adc_continuous_register_event_callbacks(handle_, &callbacks, this) != ESP_OK ||
+        !configure(sample_rate_hz))
+    {
+        adc_continuous_deinit(handle_);
+        handle_ = nullptr;
+        return false;
+    }
+
+    frame_bytes_ = frame_bytes;
+    return true;
+}
+
+bool ContinuousAdcSource::configure(uint32_t sample_rate_hz)
+{
+    adc_digi_pattern_config_t pattern = {};
+    pattern.atten = ADC_ATTEN_DB_12;
+    pattern.channel = (uint8_t)channel_;
+    pattern.unit = ADC_UNIT_1;
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+
+    adc_continuous_config_t config = {};
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = sample_rate_hz;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_OUTPUT_FORMAT;
+
+    if (adc_continuous_config(handle_, &config) != ESP_OK)
+    {
+        return false;
+    }
+    rate_hz_ = sample_rate_hz;
+    return true;
+}
+
+bool ContinuousAdcSource::setSampleRate(uint32_t sample_rate_hz)
+{
+    if (handle_ == nullptr ||
+        sample_rate_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW || sample_rate_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH)
+    {
+        return false;
+    }
+    if (sample_rate_hz == rate_hz_)
+    {
+        return true;
+    }
+
+    bool was_running = running_;
+    stop();
+
+    // Frames still queued were taken at the old rate
+    adc_continuous_flush_pool(handle_);
+
+    bool ok = configure(sample_rate_hz);
+    if (!ok)
+    {
+        configure(rate_hz_);
+    }
+    if (was_running)
+    {
+        start();
+    }
+    return ok;
+}
+
+bool ContinuousAdcSource::start()
+{
+    if (handle_ == nullptr || running_)
+    {
+        return false;
+    }
+    anchor_index_ = 0;
+    next_index_ = 0;
+    seen_overruns_ = overruns_;
+    anchor_us_ = monotonicMicros();
+    if (adc_continuous_start(handle_) != ESP_OK)
+    {
+        return false;
+    }
+    running_ = true;
+    return true;
+}
+
+void ContinuousAdcSource::stop()
+{
+    if (running_)
+    {
+        adc_continuous_stop(handle_);
+        running_ = false;
+    }
+}
+
+// Both callbacks run in the DMA interrupt. Neither wakes a task itself:
+// adc_continuous_read() blocks on the driver's ring buffer.
+bool IRAM_ATTR ContinuousAdcSource::onConversionDone(adc_continuous_handle_t handle,
+                                                     const adc_continuous_evt_data_t *edata,
+                                                     void *user_data)
+{
+    ContinuousAdcSource *source = (ContinuousAdcSource *)user_data;
+    source->interrupts_ = source->interrupts_ + 1;
+    return false;
+}
+
+bool IRAM_ATTR ContinuousAdcSource::onPoolOverflow(adc_continuous_handle_t handle,
+                                                   const adc_continuous_evt_data_t *edata,
+                                                   void *user_data)
+{
+    ContinuousAdcSource *source = (ContinuousAdcSource *)user_data;
+    source->overruns_ = source->overruns_ + 1;
+    return false;
+}
+
+const SampleBlock *ContinuousAdcSource::read(uint32_t timeout_ms)
+{
+    if (!running_)
+    {
+        return nullptr;
+    }
+
+    uint32_t got = 0;
+    if (adc_continuous_read(handle_, raw_, frame_bytes_, &got, timeout_ms) != ESP_OK)
+    {
+        return nullptr;
+    }
+    uint64_t now_us = monotonicMicros();
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= got; i += SOC_ADC_DIGI_RESULT_BYTES)
+    {
+        adc_digi_output_data_t *result = (adc_digi_output_data_t *)&raw_[i];
+        if (ADC_RESULT_CHANNEL(result) == channel_)
+        {
+            samples_buf_[count++] = ADC_RESULT_DATA(result);
+        }
+    }
+
+    // Dropped frames break the nominal timeline: re-anchor so that the last
+    // sample of this block was taken just now
+    uint32_t overruns = overruns_;
+    if (overruns != seen_overruns_)
+    {
+        seen_overruns_ = overruns;
+        anchor_index_ = next_index_;
+        anchor_us_ = now_us - ((uint64_t)count * 1000000u) / rate_hz_;
+    }
+
+    current_.samples = samples_buf_;
+    current_.count = count;
+    current_.sequence = blocks_ + overruns;
+    current_.first_us = anchor_us_ + ((next_index_ - anchor_index_) * 1000000u) / rate_hz_;
+    next_index_ += count;
+    samples_ += count;
+    blocks_++;
+    return &current_;
+}
+
+SampleSourceStats ContinuousAdcSource::stats() const
+{
+    SampleSourceStats out;
+    out.samples = samples_;
+    out.blocks = blocks_;
+    out.interrupts = interrupts_;
+    out.overruns = overruns_;
+    return out;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,81 @@
+#ifndef CONTINUOUS_ADC_SOURCE_H
+#define CONTINUOUS_ADC_SOURCE_H
+
+// SampleSource on the ESP-IDF ADC continuous (DMA) driver
+//
+// The ADC converts on its own clock and DMA writes the results into frames
+// of block_size samples. The CPU takes one interrupt per frame instead of one
+// per sample, and read() returns a whole frame. ADC1 pins only (ADC2 has no
+// DMA mode on the ESP32). The sample rate must lie within the range the chip
+// supports in continuous mode (20 kHz - 2 MHz on the ESP32).
+//
+// Timestamps follow the nominal sample clock from start(). After an overrun
+// (the driver pool was full and a frame was dropped) the timeline is
+// re-anchored to the time the block was read.
+//
+// The driver only accepts a new sample rate while stopped, so
+// setSampleRate() on a running source stops it, drops the frames still
+// queued at the old rate and restarts with a fresh timeline.
+
+#include "SampleSource.h"
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <esp_adc/adc_continuous.h>
+
+class ContinuousAdcSource : public SampleSource
+{
+public:
+    ContinuousAdcSource();
+    ~ContinuousAdcSource();
+
+    // pool_blocks: frames the driver may buffer before it drops data
+    bool begin(uint8_t pin, uint32_t sample_rate_hz, uint32_t block_size, uint32_t pool_blocks = 4);
+
+    const char *name() const override
+    {
+        return "continuous ADC (DMA)";
+    }
+
+    uint32_t sampleRate() const override
+    {
+        return rate_hz_;
+    }
+
+    bool start() override;
+    void stop() override;
+    bool setSampleRate(uint32_t sample_rate_hz) override;
+    const SampleBlock *read(uint32_t timeout_ms) override;
+    SampleSourceStats stats() const override;
+
+private:
+    static bool onConversionDone(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data);
+    static bool onPoolOverflow(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data);
+
+    // Apply pattern and rate to the (stopped) driver
+    bool configure(uint32_t sample_rate_hz);
+
+    adc_continuous_handle_t handle_;
+    uint32_t channel_;
+    uint32_t rate_hz_;
+    uint32_t frame_bytes_;
+    uint8_t *raw_;
+    uint16_t *samples_buf_;
+    bool running_;
+
+    SampleBlock current_;
+    uint64_t anchor_us_;       // Time of sample anchor_index_
+    uint64_t anchor_index_;
+    uint64_t next_index_;      // Index of the next sample read()
+    uint32_t seen_overruns_;
+
+    uint32_t samples_;
+    uint32_t blocks_;
+    volatile uint32_t interrupts_;
+    volatile uint32_t overruns_;
+};
+
+#endif // ARDUINO
+
+#endif // CONTINUOUS_ADC_SOURCE_H
@@ -0,0 +1,204 @@
+#include "ReplaySampleSource.h"
+
+#if !defined(ARDUINO)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <PortUtils.h>
+
+static bool hasSuffix(const char *path, const char *suffix)
+{
+    size_t len = strlen(path);
+    size_t n = strlen(suffix);
+    return len >= n && strcmp(path + len - n, suffix) == 0;
+}
+
+static void sleepUntilMicros(uint64_t us)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(us / 1000000u);
+    ts.tv_nsec = (long)(us % 1000000u) * 1000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0)
+    {
+    }
+}
+
+ReplaySampleSource::ReplaySampleSource()
+    : rate_hz_(0),
+      block_size_(0),
+      pool_blocks_(0),
+      loop_(false),
+      running_(false),
+      position_(0),
+      next_index_(0),
+      anchor_index_(0),
+      anchor_us_(0)
+{
+    memset(&current_, 0, sizeof(current_));
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+bool ReplaySampleSource::load(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    data_.clear();
+
+    if (hasSuffix(path, ".bin") || hasSuffix(path, ".raw"))
+    {
+        uint8_t bytes[2];
+        while (fread(bytes, 1, 2, file) == 2)
+        {
+            data_.push_back((uint16_t)(bytes[0] | (bytes[1] << 8)));
+        }
+    }
+    else
+    {
+        char line[64];
+        while (fgets(line, sizeof(line), file) != nullptr)
+        {
+            char *end;
+            unsigned long value = strtoul(line, &end, 10);
+            if (end != line)
+            {
+                data_.push_back((uint16_t)value);
+            }
+        }
+    }
+    fclose(file);
+    return !data_.empty();
+}
+
+bool ReplaySampleSource::loadSamples(const uint16_t *samples, uint32_t count)
+{
+    data_.assign(samples, samples + count);
+    return !data_.empty();
+}
+
+bool ReplaySampleSource::begin(uint32_t sample_rate_hz, uint32_t block_size, uint32_t pool_blocks, bool loop)
+{
+    if (block_size == 0 || pool_blocks == 0)
+    {
+        return false;
+    }
+    rate_hz_ = sample_rate_hz;
+    block_size_ = block_size;
+    pool_blocks_ = pool_blocks;
+    loop_ = loop;
+    return true;
+}
+
+bool ReplaySampleSource::start()
+{
+    if (data_.empty() || block_size_ == 0)
+    {
+        return false;
+    }
+    position_ = 0;
+    next_index_ = 0;
+    memset(&stats_, 0, sizeof(stats_));
+    anchor_index_ = 0;
+    anchor_us_ = monotonicMicros();
+    running_ = true;
+    return true;
+}
+
+void ReplaySampleSource::stop()
+{
+    running_ = false;
+}
+
+bool ReplaySampleSource::setSampleRate(uint32_t sample_rate_hz)
+{
+    if (running_)
+    {
+        // Samples before next_index_ keep their old times; an unpaced
+        // replay has no clock to continue, so the new one starts now
+        uint64_t next_us = (rate_hz_ == 0) ? monotonicMicros() : sampleTimeUs(next_index_);
+        anchor_index_ = next_index_;
+        anchor_us_ = next_us;
+    }
+    rate_hz_ = sample_rate_hz;
+    return true;
+}
+
+uint64_t ReplaySampleSource::sampleTimeUs(uint64_t index) const
+{
+    return anchor_us_ + ((index - anchor_index_) * 1000000u) / rate_hz_;
+}
+
+void ReplaySampleSource::advance(uint32_t count)
+{
+    position_ += count;
+    next_index_ += count;
+    if (loop_ && position_ >= data_.size())
+    {
+        position_ = 0;
+    }
+}
+
+const SampleBlock *ReplaySampleSource::read(uint32_t timeout_ms)
+{
+    if (!running_ || finished())
+    {
+        return nullptr;
+    }
+
+    uint32_t count = (uint32_t)((data_.size() - position_ < block_size_) ? data_.size() - position_ : block_size_);
+    uint64_t now_us = monotonicMicros();
+
+    if (rate_hz_ == 0)
+    {
+        current_.first_us = now_us;
+    }
+    else
+    {
+        // Drop whatever the pool could not have held while the reader was away
+        uint64_t pool_us = ((uint64_t)pool_blocks_ * block_size_ * 1000000u) / rate_hz_;
+        while (sampleTimeUs(next_index_ + count) + pool_us < now_us)
+        {
+            advance(count);
+            stats_.overruns++;
+            if (finished())
+            {
+                return nullptr;
+            }
+            count = (uint32_t)((data_.size() - position_ < block_size_) ? data_.size() - position_ : block_size_);
+        }
+
+        uint64_t ready_us = sampleTimeUs(next_index_ + count);
+        if (ready_us > now_us)
+        {
+            if (ready_us - now_us > (uint64_t)timeout_ms * 1000u)
+            {
+                sleepUntilMicros(now_us + (uint64_t)timeout_ms * 1000u);
+                return nullptr;
+            }
+            sleepUntilMicros(ready_us);
+        }
+        current_.first_us = sampleTimeUs(next_index_);
+    }
+
+    current_.samples = &data_[position_];
+    current_.count = count;
+    current_.sequence = stats_.blocks + stats_.overruns;
+    advance(count);
+
+    stats_.samples += count;
+    stats_.blocks++;
+    stats_.interrupts++;
+    return &current_;
+}
+
+SampleSourceStats ReplaySampleSource::stats() const
+{
+    return stats_;
+}
+
+#endif // !ARDUINO
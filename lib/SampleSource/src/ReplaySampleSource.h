@@ -0,0 +1,85 @@
+#ifndef REPLAY_SAMPLE_SOURCE_H
+#define REPLAY_SAMPLE_SOURCE_H
+
+// Host SampleSource that replays a recorded capture
+//
+// File formats:
+//   text   - one sample per line, as printed by Serial.println(sample) and
+//            captured from the monitor; blank lines and '#' comments skipped
+//   binary - raw little-endian uint16 (files ending in .bin or .raw)
+//
+// Blocks are released on the sample clock: a block becomes readable once its
+// last sample "has been taken". If the reader falls further behind than
+// pool_blocks blocks, the oldest blocks are dropped and counted as overruns,
+// like the DMA driver pool on the ESP32. One wake-up per block is counted as
+// an interrupt (the DMA frame interrupt). A sample rate of 0 replays as fast
+// as the reader asks for blocks. setSampleRate() while running continues the
+// sample clock from the next unread sample at the new rate.
+
+#include "SampleSource.h"
+
+#if !defined(ARDUINO)
+
+#include <stddef.h>
+#include <vector>
+
+class ReplaySampleSource : public SampleSource
+{
+public:
+    ReplaySampleSource();
+
+    bool load(const char *path);
+    bool loadSamples(const uint16_t *samples, uint32_t count);
+
+    bool begin(uint32_t sample_rate_hz, uint32_t block_size, uint32_t pool_blocks = 4, bool loop = false);
+
+    const char *name() const override
+    {
+        return "file replay";
+    }
+
+    uint32_t sampleRate() const override
+    {
+        return rate_hz_;
+    }
+
+    bool start() override;
+    void stop() override;
+    bool setSampleRate(uint32_t sample_rate_hz) override;
+    const SampleBlock *read(uint32_t timeout_ms) override;
+    SampleSourceStats stats() const override;
+
+    // True once a non-looping replay has delivered the whole capture
+    bool finished() const
+    {
+        return !loop_ && position_ >= data_.size();
+    }
+
+    uint32_t loadedSamples() const
+    {
+        return (uint32_t)data_.size();
+    }
+
+private:
+    uint64_t sampleTimeUs(uint64_t index) const;
+    void advance(uint32_t count);
+
+    std::vector<uint16_t> data_;
+    uint32_t rate_hz_;
+    uint32_t block_size_;
+    uint32_t pool_blocks_;
+    bool loop_;
+    bool running_;
+
+    size_t position_;     // Next sample in data_
+    uint64_t next_index_; // Samples elapsed on the sample clock since start()
+    uint64_t anchor_index_;
+    uint64_t anchor_us_;  // Time of sample anchor_index_
+
+    SampleBlock current_;
+    SampleSourceStats stats_;
+};
+
+#endif // !ARDUINO
+
+#endif // REPLAY_SAMPLE_SOURCE_H
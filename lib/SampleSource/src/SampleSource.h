@@ -0,0 +1,78 @@
+#ifndef SAMPLE_SOURCE_H
+#define SAMPLE_SOURCE_H
+
+// Block-oriented sample source
+//
+// Processing code reads blocks of samples through this interface and does
+// not care where they come from:
+//
+//   TimerAdcSource      - analogRead() in a hardware timer ISR (the part9
+//                         pattern), one interrupt per sample (ESP32)
+//   ContinuousAdcSource - ADC continuous (DMA) mode, one interrupt per frame
+//                         of samples (ESP32)
+//   ReplaySampleSource  - replays a recorded file at a configurable rate,
+//                         so the same processing runs on Linux (host)
+//
+// Every source counts the interrupts (or wake-ups) it needed, so the cost of
+// acquisition can be compared as interrupts per 1,000 samples.
+
+#include <stdint.h>
+
+struct SampleBlock
+{
+    const uint16_t *samples;
+    uint32_t count;    // Valid samples
+    uint32_t sequence; // Block number since start(), counts dropped blocks
+    uint64_t first_us; // Timestamp of the first sample (monotonicMicros)
+};
+
+struct SampleSourceStats
+{
+    uint32_t samples;    // Delivered to the reader
+    uint32_t blocks;     // Delivered to the reader
+    uint32_t interrupts; // Interrupts / wake-ups spent acquiring
+    uint32_t overruns;   // Blocks lost because the reader fell behind
+};
+
+class SampleSource
+{
+public:
+    virtual ~SampleSource()
+    {
+    }
+
+    virtual const char *name() const = 0;
+    virtual uint32_t sampleRate() const = 0;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+
+    // Change the sample rate, also while running. Returns false if the
+    // backend cannot run at that rate (the old rate stays in effect).
+    virtual bool setSampleRate(uint32_t sample_rate_hz) = 0;
+
+    // Wait up to timeout_ms for the next block. Returns nullptr on timeout or
+    // when the source has ended. The block stays valid until the next read()
+    // or stop(); read from one task only.
+    virtual const SampleBlock *read(uint32_t timeout_ms) = 0;
+
+    virtual SampleSourceStats stats() const = 0;
+};
+
+// The tracked acquisition cost metric
+static inline uint32_t interruptsPer1000Samples(const SampleSourceStats &stats)
+{
+    if (stats.samples == 0)
+    {
+        return 0;
+    }
+    return (uint32_t)(((uint64_t)stats.interrupts * 1000u + stats.samples / 2) / stats.samples);
+}
+
+// Timestamp of sample i in a block
+static inline uint64_t sampleTimeUs(const SampleBlock &block, uint32_t i, uint32_t sample_rate_hz)
+{
+    return block.first_us + ((uint64_t)i * 1000000u) / sample_rate_hz;
+}
+
+#endif // SAMPLE_SOURCE_H
@@ -0,0 +1,138 @@
+#include "TimerAdcSource.h"
+
+#if defined(ARDUINO)
+
+static const uint32_t timer_frequency_hz = 1000000; // 1 MHz timer tick (1 us per tick)
+
+TimerAdcSource::TimerAdcSource()
+    : pin_(0),
+      rate_hz_(0),
+      watermark_(0),
+      timer_(nullptr),
+      holding_(false),
+      samples_(0),
+      blocks_(0),
+      interrupts_(0)
+{
+}
+
+TimerAdcSource::~TimerAdcSource()
+{
+    stop();
+    if (timer_ != nullptr)
+    {
+        timerEnd(timer_);
+    }
+}
+
+bool TimerAdcSource::begin(uint8_t pin, uint32_t sample_rate_hz, uint32_t block_size, uint32_t num_blocks)
+{
+    if (sample_rate_hz == 0 || sample_rate_hz > timer_frequency_hz || timer_ != nullptr)
+    {
+        return false;
+    }
+    if (!buffer_.begin(block_size, num_blocks))
+    {
+        return false;
+    }
+
+    timer_ = timerBegin(timer_frequency_hz);
+    if (timer_ == nullptr)
+    {
+        return false;
+    }
+    pin_ = pin;
+    timerAttachInterruptArg(timer_, onTimer, this);
+    timerStop(timer_);
+    return setSampleRate(sample_rate_hz);
+}
+
+bool TimerAdcSource::setSampleRate(uint32_t sample_rate_hz)
+{
+    if (timer_ == nullptr || sample_rate_hz == 0 || sample_rate_hz > timer_frequency_hz)
+    {
+        return false;
+    }
+
+    // The new alarm value takes effect from the next alarm
+    rate_hz_ = sample_rate_hz;
+    timerAlarm(timer_, timer_frequency_hz / sample_rate_hz, true, 0);
+    return true;
+}
+
+bool TimerAdcSource::start()
+{
+    if (timer_ == nullptr)
+    {
+        return false;
+    }
+    timerWrite(timer_, 0);
+    timerStart(timer_);
+    return true;
+}
+
+void TimerAdcSource::stop()
+{
+    if (timer_ != nullptr)
+    {
+        timerStop(timer_);
+    }
+    if (holding_)
+    {
+        buffer_.release();
+        holding_ = false;
+    }
+}
+
+void IRAM_ATTR TimerAdcSource::onTimer(void *arg)
+{
+    TimerAdcSource *source = (TimerAdcSource *)arg;
+    source->interrupts_ = source->interrupts_ + 1;
+    if (!source->buffer_.push(analogRead(source->pin_)))
+    {
+        uint32_t watermark = source->watermark_;
+        if (watermark != 0 && source->buffer_.pending() >= watermark)
+        {
+            source->buffer_.publish();
+        }
+    }
+}
+
+const SampleBlock *TimerAdcSource::read(uint32_t timeout_ms)
+{
+    if (holding_)
+    {
+        buffer_.release();
+        holding_ = false;
+    }
+
+    // The reader may change between runs; cheap enough to refresh each call
+    buffer_.setConsumerTask(xTaskGetCurrentTaskHandle());
+
+    const BlockBuffer<uint16_t>::Block *block = buffer_.acquire(pdMS_TO_TICKS(timeout_ms));
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+    holding_ = true;
+
+    current_.samples = block->samples;
+    current_.count = block->count;
+    current_.sequence = block->sequence;
+    current_.first_us = block->first_us;
+    samples_ += block->count;
+    blocks_++;
+    return &current_;
+}
+
+SampleSourceStats TimerAdcSource::stats() const
+{
+    SampleSourceStats out;
+    out.samples = samples_;
+    out.blocks = blocks_;
+    out.interrupts = interrupts_;
+    out.overruns = buffer_.overruns();
+    return out;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,72 @@
+#ifndef TIMER_ADC_SOURCE_H
+#define TIMER_ADC_SOURCE_H
+
+// SampleSource that calls analogRead() from a hardware timer ISR, as the
+// part9 sketches do. Kept as the baseline: it costs one interrupt per
+// sample. Samples are handed to the reader through a BlockBuffer, so the
+// reader is only woken once per block, or once per watermark samples when a
+// watermark below the block size is set (bounding latency at low rates).
+
+#include "SampleSource.h"
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+#include <BlockBuffer.h>
+
+class TimerAdcSource : public SampleSource
+{
+public:
+    TimerAdcSource();
+    ~TimerAdcSource();
+
+    // num_blocks is 2 (ping-pong) or 3 (triple), see BlockBuffer
+    bool begin(uint8_t pin, uint32_t sample_rate_hz, uint32_t block_size, uint32_t num_blocks = 2);
+
+    const char *name() const override
+    {
+        return "timer ISR analogRead";
+    }
+
+    uint32_t sampleRate() const override
+    {
+        return rate_hz_;
+    }
+
+    bool start() override;
+    void stop() override;
+    bool setSampleRate(uint32_t sample_rate_hz) override;
+
+    // Hand over a partial block once it holds this many samples (0: full
+    // blocks only). Safe to change while running.
+    void setWatermark(uint32_t samples)
+    {
+        watermark_ = samples;
+    }
+
+    uint32_t watermark() const
+    {
+        return watermark_;
+    }
+
+    const SampleBlock *read(uint32_t timeout_ms) override;
+    SampleSourceStats stats() const override;
+
+private:
+    static void onTimer(void *arg);
+
+    uint8_t pin_;
+    volatile uint32_t rate_hz_;
+    volatile uint32_t watermark_;
+    hw_timer_t *timer_;
+    BlockBuffer<uint16_t> buffer_;
+    bool holding_;
+    SampleBlock current_;
+    uint32_t samples_;
+    uint32_t blocks_;
+    volatile uint32_t interrupts_;
+};
+
+#endif // ARDUINO
+
+#endif // TIMER_ADC_SOURCE_H
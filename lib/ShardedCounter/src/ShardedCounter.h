@@ -0,0 +1,112 @@
+#ifndef SHARDED_COUNTER_H
+#define SHARDED_COUNTER_H
+
+// Event counter that never disables interrupts.
+//
+// Each core increments its own shard with a lock-free atomic add, so an ISR
+// on core 1 never contends with a task on core 0 and no portENTER_CRITICAL
+// spinlock is needed. read() sums the shards. Consumers remove events through
+// tryDecrement(), which never lets the aggregate value drop below zero; this
+// is the "print then decrement while > 0" pattern from printValue().
+//
+// All methods are safe to call from ISR and task context.
+
+#include <atomic>
+#include <stdint.h>
+
+#include <PortUtils.h>
+
+class ShardedCounter
+{
+public:
+    ShardedCounter()
+    {
+        reset();
+    }
+
+    // Count n events on the calling core's shard
+    PORT_FORCE_INLINE void add(uint32_t n = 1)
+    {
+        shards_[cpuCoreId()].added.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // Aggregate value: everything added minus everything consumed
+    PORT_FORCE_INLINE int32_t read() const
+    {
+        return (int32_t)(addedTotal() - consumed_.load(std::memory_order_acquire));
+    }
+
+    // Remove n events if at least n are pending. Returns false (and changes
+    // nothing) if that would take the counter below zero.
+    PORT_FORCE_INLINE bool tryDecrement(uint32_t n = 1)
+    {
+        uint32_t consumed = consumed_.load(std::memory_order_acquire);
+        do
+        {
+            if ((int32_t)(addedTotal() - consumed) < (int32_t)n)
+            {
+                return false;
+            }
+        } while (!consumed_.compare_exchange_weak(consumed, consumed + n,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire));
+        return true;
+    }
+
+    // Remove up to max events, returning how many were removed
+    PORT_FORCE_INLINE uint32_t drain(uint32_t max = UINT32_MAX)
+    {
+        uint32_t consumed = consumed_.load(std::memory_order_acquire);
+        uint32_t take;
+        do
+        {
+            int32_t pending = (int32_t)(addedTotal() - consumed);
+            if (pending <= 0)
+            {
+                return 0;
+            }
+            take = ((uint32_t)pending < max) ? (uint32_t)pending : max;
+        } while (!consumed_.compare_exchange_weak(consumed, consumed + take,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire));
+        return take;
+    }
+
+    // Number of events ever added on one core (wraps at 2^32)
+    uint32_t shardValue(uint32_t core) const
+    {
+        return shards_[core].added.load(std::memory_order_relaxed);
+    }
+
+    // Not atomic with respect to concurrent add(); call while quiescent
+    void reset()
+    {
+        for (uint32_t i = 0; i < PORT_NUM_CORES; i++)
+        {
+            shards_[i].added.store(0, std::memory_order_relaxed);
+        }
+        consumed_.store(0, std::memory_order_release);
+    }
+
+private:
+    // Keep shards on separate cache lines on targets that have a data cache
+    struct alignas(32) Shard
+    {
+        std::atomic<uint32_t> added;
+    };
+
+    PORT_FORCE_INLINE uint32_t addedTotal() const
+    {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < PORT_NUM_CORES; i++)
+        {
+            total += shards_[i].added.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    Shard shards_[PORT_NUM_CORES];
+    std::atomic<uint32_t> consumed_;
+};
+
+#endif // SHARDED_COUNTER_H
@@ -0,0 +1,213 @@
+#include "StreamingStats.h"
+
+#include <math.h>
+#include <new>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <sched.h>
+#endif
+
+// A reader that keeps finding the writer mid-update must let it finish; when
+// both run on one core the writer may have lower priority, so sleep a tick
+static void readerBackoff(uint32_t attempt)
+{
+#if defined(ARDUINO)
+    if (attempt > 4)
+    {
+        vTaskDelay(1);
+    }
+#else
+    if (attempt > 4)
+    {
+        sched_yield();
+    }
+#endif
+}
+
+//*****************************************************************************
+// Snapshot values
+
+float StreamingStats::Snapshot::mean() const
+{
+    if (count == 0)
+    {
+        return 0.0f;
+    }
+    return (float)origin + (float)((double)sum_d / (double)count);
+}
+
+float StreamingStats::Snapshot::variance() const
+{
+    if (count < 2)
+    {
+        return 0.0f;
+    }
+    // Exact integer moments: sum((x - o)^2) - sum(x - o)^2 / n
+    double n = (double)count;
+    double m2 = (double)sumsq_d - ((double)sum_d * (double)sum_d) / n;
+    return (float)((m2 > 0.0) ? m2 / (n - 1.0) : 0.0);
+}
+
+float StreamingStats::Snapshot::stddev() const
+{
+    return sqrtf(variance());
+}
+
+float StreamingStats::Snapshot::ema() const
+{
+    return (float)ema_q16 / (float)(1u << FRACTION_BITS);
+}
+
+uint32_t StreamingStats::Snapshot::windowFill(uint32_t i) const
+{
+    if (i >= num_windows)
+    {
+        return 0;
+    }
+    return (count < window_length[i]) ? (uint32_t)count : window_length[i];
+}
+
+float StreamingStats::Snapshot::windowMean(uint32_t i) const
+{
+    uint32_t n = windowFill(i);
+    return (n == 0) ? 0.0f : (float)window_sum[i] / (float)n;
+}
+
+float StreamingStats::Snapshot::windowVariance(uint32_t i) const
+{
+    uint32_t n = windowFill(i);
+    if (n < 2)
+    {
+        return 0.0f;
+    }
+    double sum = (double)window_sum[i];
+    double m2 = (double)window_sumsq[i] - sum * sum / n;
+    return (float)((m2 > 0.0) ? m2 / (n - 1.0) : 0.0);
+}
+
+//*****************************************************************************
+// StreamingStats
+
+StreamingStats::StreamingStats()
+    : ring_(nullptr),
+      ring_mask_(0),
+      head_(0),
+      ema_shift_(0),
+      sequence_(0),
+      reset_requested_(false)
+{
+    memset(&state_, 0, sizeof(state_));
+}
+
+StreamingStats::~StreamingStats()
+{
+    delete[] ring_;
+}
+
+bool StreamingStats::begin(const uint32_t *window_lengths, uint32_t num_windows, uint32_t ema_shift)
+{
+    if (num_windows > MAX_WINDOWS || ema_shift >= FRACTION_BITS || ring_ != nullptr)
+    {
+        return false;
+    }
+
+    uint32_t longest = 1;
+    for (uint32_t i = 0; i < num_windows; i++)
+    {
+        if (window_lengths[i] == 0 || window_lengths[i] > MAX_WINDOW_LENGTH)
+        {
+            return false;
+        }
+        longest = (window_lengths[i] > longest) ? window_lengths[i] : longest;
+    }
+
+    // Power-of-two ring so the history index is a mask
+    uint32_t ring_size = 1;
+    while (ring_size < longest)
+    {
+        ring_size <<= 1;
+    }
+    ring_ = new (std::nothrow) uint16_t[ring_size];
+    if (ring_ == nullptr)
+    {
+        return false;
+    }
+    ring_mask_ = ring_size - 1;
+    ema_shift_ = ema_shift;
+
+    clear();
+    state_.num_windows = num_windows;
+    for (uint32_t i = 0; i < num_windows; i++)
+    {
+        state_.window_length[i] = window_lengths[i];
+    }
+    return true;
+}
+
+void StreamingStats::clear()
+{
+    uint32_t num_windows = state_.num_windows;
+    uint32_t lengths[MAX_WINDOWS];
+    memcpy(lengths, state_.window_length, sizeof(lengths));
+
+    memset(&state_, 0, sizeof(state_));
+    state_.num_windows = num_windows;
+    memcpy(state_.window_length, lengths, sizeof(lengths));
+    head_ = 0;
+}
+
+void StreamingStats::beginWrite()
+{
+    uint32_t seq = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (reset_requested_.load(std::memory_order_acquire))
+    {
+        reset_requested_.store(false, std::memory_order_relaxed);
+        clear();
+    }
+}
+
+void StreamingStats::endWrite()
+{
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void StreamingStats::add(uint16_t sample)
+{
+    beginWrite();
+    update(sample);
+    endWrite();
+}
+
+void StreamingStats::addBlock(const uint16_t *samples, uint32_t count)
+{
+    beginWrite();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        update(samples[i]);
+    }
+    endWrite();
+}
+
+void StreamingStats::snapshot(Snapshot *out) const
+{
+    for (uint32_t attempt = 0;; attempt++)
+    {
+        uint32_t before = sequence_.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+            memcpy(out, &state_, sizeof(*out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before)
+            {
+                return;
+            }
+        }
+        readerBackoff(attempt);
+    }
+}
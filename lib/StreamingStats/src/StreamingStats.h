@@ -0,0 +1,132 @@
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+// O(1) streaming statistics for sampled signals
+//
+// One writer (the sampling task) feeds samples with add() or addBlock().
+// Per sample the cost is constant: integer adds, one multiply per moment and
+// a shift for the EMA, plus the same for each sliding window. Nothing is
+// re-summed. Kept since the last reset:
+//
+//   count, min, max
+//   mean and variance  - exact integer moments about the first sample
+//                        (no per-sample divide, no cancellation)
+//   EMA                - Q16 fixed point, alpha = 2^-ema_shift
+//   sliding windows    - up to MAX_WINDOWS lengths over one shared history
+//                        ring, each with its own running sum / sum of squares
+//
+// Any task may call snapshot() while the writer runs: the writer publishes
+// through a sequence lock, and the reader retries until it copied a state
+// that was not being modified. Floating point is only used when a snapshot
+// is turned into mean/variance values.
+//
+// Samples must be below 32768 (the ADC produces 12-bit values).
+
+#include <atomic>
+#include <stdint.h>
+
+#include <PortUtils.h>
+
+class StreamingStats
+{
+public:
+    static const uint32_t MAX_WINDOWS = 4;
+    static const uint32_t MAX_WINDOW_LENGTH = 65536;
+    static const uint32_t FRACTION_BITS = 16;
+
+    // Raw accumulators, copied consistently; values computed on demand
+    struct Snapshot
+    {
+        uint64_t count;
+        uint16_t min;
+        uint16_t max;
+        uint16_t origin; // First sample; moments are taken about it
+        int64_t sum_d;
+        uint64_t sumsq_d;
+        int32_t ema_q16;
+        uint32_t num_windows;
+        uint32_t window_length[MAX_WINDOWS];
+        uint32_t window_sum[MAX_WINDOWS];
+        uint64_t window_sumsq[MAX_WINDOWS];
+
+        float mean() const;
+        float variance() const; // Sample variance (n - 1)
+        float stddev() const;
+        float ema() const;
+
+        // Samples currently in window i (less than the length until filled)
+        uint32_t windowFill(uint32_t i) const;
+        float windowMean(uint32_t i) const;
+        float windowVariance(uint32_t i) const;
+    };
+
+    StreamingStats();
+    ~StreamingStats();
+
+    // Window lengths 1..MAX_WINDOW_LENGTH. Allocates the history ring once.
+    bool begin(const uint32_t *window_lengths, uint32_t num_windows, uint32_t ema_shift);
+
+    // Writer: one sequence-lock round per call
+    void add(uint16_t sample);
+    void addBlock(const uint16_t *samples, uint32_t count);
+
+    // Any task: consistent copy of the current state
+    void snapshot(Snapshot *out) const;
+
+    // Any task: the writer clears everything before its next sample
+    void requestReset()
+    {
+        reset_requested_.store(true, std::memory_order_release);
+    }
+
+private:
+    PORT_FORCE_INLINE void update(uint16_t x)
+    {
+        if (state_.count == 0)
+        {
+            state_.origin = x;
+            state_.min = x;
+            state_.max = x;
+            state_.ema_q16 = (int32_t)x << FRACTION_BITS;
+        }
+        state_.count++;
+
+        int32_t d = (int32_t)x - (int32_t)state_.origin;
+        state_.sum_d += d;
+        state_.sumsq_d += (uint32_t)(d * d);
+        state_.min = (x < state_.min) ? x : state_.min;
+        state_.max = (x > state_.max) ? x : state_.max;
+        state_.ema_q16 += (((int32_t)x << FRACTION_BITS) - state_.ema_q16) >> ema_shift_;
+
+        // Slide every window: the sample leaving window i is i.length back
+        for (uint32_t i = 0; i < state_.num_windows; i++)
+        {
+            uint32_t length = state_.window_length[i];
+            state_.window_sum[i] += x;
+            state_.window_sumsq[i] += (uint32_t)x * x;
+            if (state_.count > length)
+            {
+                uint32_t old = ring_[(head_ - length) & ring_mask_];
+                state_.window_sum[i] -= old;
+                state_.window_sumsq[i] -= old * old;
+            }
+        }
+        ring_[head_] = x;
+        head_ = (head_ + 1) & ring_mask_;
+    }
+
+    void beginWrite();
+    void endWrite();
+    void clear();
+
+    Snapshot state_;
+    uint16_t *ring_;
+    uint32_t ring_mask_;
+    uint32_t head_;
+    uint32_t ema_shift_;
+
+    std::atomic<uint32_t> sequence_; // Odd while the writer is updating
+    std::atomic<bool> reset_requested_;
+};
+
+#endif // STREAMING_STATS_H
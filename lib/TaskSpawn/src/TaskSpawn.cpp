@@ -0,0 +1,98 @@
+#include "TaskSpawn.h"
+
+#include <stdio.h>
+
+#if !defined(ARDUINO)
+#include <system_error>
+#include <thread>
+#endif
+
+#if defined(ARDUINO)
+static const size_t name_len = configMAX_TASK_NAME_LEN;
+#else
+static const size_t name_len = 16; // pthread_setname_np() limit
+#endif
+
+bool spawnRaw(SpawnEntry entry, void *block, const SpawnConfig &config, uint32_t index, SpawnHandle *handle)
+{
+    char name[name_len];
+    if (index == SPAWN_NO_INDEX)
+    {
+        snprintf(name, sizeof(name), "%s", config.name);
+    }
+    else
+    {
+        snprintf(name, sizeof(name), "%s %lu", config.name, (unsigned long)index);
+    }
+
+#if defined(ARDUINO)
+    BaseType_t core = (config.core == SPAWN_ANY_CORE) ? tskNO_AFFINITY : (BaseType_t)config.core;
+    TaskHandle_t task = NULL;
+    if (xTaskCreatePinnedToCore(entry, name, config.stack_size, block, config.priority, &task, core) != pdPASS)
+    {
+        return false;
+    }
+    if (handle != nullptr)
+    {
+        *handle = task;
+    }
+#else
+    try
+    {
+        std::thread thread(entry, block);
+        pthread_setname_np(thread.native_handle(), name);
+        if (handle != nullptr)
+        {
+            *handle = thread.native_handle();
+        }
+        thread.detach();
+    }
+    catch (const std::system_error &)
+    {
+        return false;
+    }
+#endif
+    return true;
+}
+
+void spawnExit()
+{
+#if defined(ARDUINO)
+    vTaskDelete(NULL);
+#endif
+}
+
+//*****************************************************************************
+// Batch
+
+#if defined(ARDUINO)
+
+SpawnBatch::SpawnBatch(const SpawnConfig &config) : saved_priority_(uxTaskPriorityGet(NULL)), raised_(false)
+{
+    UBaseType_t above = config.priority + 1;
+    if (above > saved_priority_ && above < configMAX_PRIORITIES)
+    {
+        vTaskPrioritySet(NULL, above);
+        raised_ = true;
+    }
+}
+
+SpawnBatch::~SpawnBatch()
+{
+    if (raised_)
+    {
+        vTaskPrioritySet(NULL, saved_priority_); // The batch starts here on this core
+    }
+}
+
+#else
+
+SpawnBatch::SpawnBatch(const SpawnConfig &) : saved_priority_(0), raised_(false)
+{
+}
+
+SpawnBatch::~SpawnBatch()
+{
+}
+
+#endif // ARDUINO
@@ -0,0 +1,166 @@
+#ifndef TASK_SPAWN_H
+#define TASK_SPAWN_H
+
+// Create tasks with a typed argument passed by value
+//
+// src/main.cpp and the part10 challenge sketches pass (void *)&i to each
+// new task and block on bin_sem until the task has copied i, because i
+// changes right after xTaskCreate() returns. Each task costs the creator a
+// round trip through the scheduler before the next one can be created.
+//
+// Here the argument is copied into a block the new task owns. The task
+// copies it onto its own stack and frees the block before calling the
+// function, so the creator never waits for it:
+//
+//   void eat(const int &num) { ... }
+//
+//   spawnTask(eat, i, config);                 // One task, named config.name
+//   spawnTasks(eat, seats, NUM_TASKS, config); // One per element, "<name> <i>"
+//   spawnIndexed(run, NUM_TASKS, config);      // Argument is the index
+//
+// While a batch call creates its tasks, the creator is raised above
+// config.priority (if the priority allows). That only holds back tasks on
+// the creator's own core: with config.core set to that core, none of them
+// runs until the batch is complete. Tasks pinned to another core, or
+// created with SPAWN_ANY_CORE on a dual-core target, may start as soon as
+// they are created. The batch calls return how many tasks were created; on
+// failure the ones already created keep running.
+//
+// Returning from the function ends the task; vTaskDelete(NULL) inside it is
+// fine too. On the host tasks are detached threads and stack_size, priority
+// and core are ignored.
+
+#include <new>
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+typedef TaskHandle_t SpawnHandle;
+#else
+#include <pthread.h>
+typedef pthread_t SpawnHandle;
+#endif
+
+static const int SPAWN_ANY_CORE = -1;
+static const uint32_t SPAWN_NO_INDEX = UINT32_MAX;
+
+struct SpawnConfig
+{
+    const char *name;
+    uint32_t stack_size; // Bytes in ESP32, words in vanilla FreeRTOS
+    uint32_t priority;
+    int core;            // SPAWN_ANY_CORE for no affinity
+};
+
+typedef void (*SpawnEntry)(void *block);
+
+// Start entry(block) as a task named config.name, with " <index>" appended
+// unless index is SPAWN_NO_INDEX. Used by the templates below.
+bool spawnRaw(SpawnEntry entry, void *block, const SpawnConfig &config, uint32_t index, SpawnHandle *handle);
+
+// End the calling task after its function returned
+void spawnExit();
+
+// Keeps the new tasks of a batch on the creator's core from starting while
+// it is created
+class SpawnBatch
+{
+public:
+    explicit SpawnBatch(const SpawnConfig &config);
+    ~SpawnBatch();
+
+    SpawnBatch(const SpawnBatch &) = delete;
+    SpawnBatch &operator=(const SpawnBatch &) = delete;
+
+private:
+    uint32_t saved_priority_;
+    bool raised_;
+};
+
+//*****************************************************************************
+// Typed spawn
+
+template <typename T>
+struct SpawnSame
+{
+    typedef T type;
+};
+
+template <typename Arg>
+struct SpawnBlock
+{
+    void (*fn)(const Arg &);
+    Arg arg;
+};
+
+template <typename Arg>
+void spawnTrampoline(void *parameters)
+{
+    SpawnBlock<Arg> *block = (SpawnBlock<Arg> *)parameters;
+    void (*fn)(const Arg &) = block->fn;
+    Arg arg(block->arg);
+    delete block;
+
+    fn(arg);
+    spawnExit();
+}
+
+template <typename Arg>
+bool spawnOne(void (*fn)(const Arg &), const Arg &arg, const SpawnConfig &config, uint32_t index, SpawnHandle *handle)
+{
+    SpawnBlock<Arg> *block = new (std::nothrow) SpawnBlock<Arg>{fn, arg};
+    if (block == nullptr)
+    {
+        return false;
+    }
+    if (!spawnRaw(spawnTrampoline<Arg>, block, config, index, handle))
+    {
+        delete block;
+        return false;
+    }
+    return true;
+}
+
+template <typename Arg>
+bool spawnTask(void (*fn)(const Arg &),
+               const typename SpawnSame<Arg>::type &arg,
+               const SpawnConfig &config,
+               SpawnHandle *handle = nullptr)
+{
+    return spawnOne(fn, arg, config, SPAWN_NO_INDEX, handle);
+}
+
+// handles, if given, has count entries
+template <typename Arg>
+uint32_t spawnTasks(void (*fn)(const Arg &),
+                    const typename SpawnSame<Arg>::type *args,
+                    uint32_t count,
+                    const SpawnConfig &config,
+                    SpawnHandle *handles = nullptr)
+{
+    SpawnBatch batch(config);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!spawnOne(fn, args[i], config, i, (handles != nullptr) ? &handles[i] : nullptr))
+        {
+            return i;
+        }
+    }
+    return count;
+}
+
+template <typename Index>
+uint32_t spawnIndexed(void (*fn)(const Index &), uint32_t count, const SpawnConfig &config, SpawnHandle *handles = nullptr)
+{
+    SpawnBatch batch(config);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!spawnOne(fn, (Index)i, config, i, (handles != nullptr) ? &handles[i] : nullptr))
+        {
+            return i;
+        }
+    }
+    return count;
+}
+
+#endif // TASK_SPAWN_H
@@ -0,0 +1,316 @@
+#include "Telemetry.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+//*****************************************************************************
+// CRC-16 and COBS
+
+uint16_t telemetryCrc16(const uint8_t *data, size_t len, uint16_t crc)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint32_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint32_t cobsEncode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+    uint32_t code_pos = 0; // Where the current block's length byte goes
+    uint32_t pos = 1;
+    uint8_t code = 1;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (in[i] != 0)
+        {
+            out[pos++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF)
+        {
+            out[code_pos] = code;
+            code_pos = pos++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return pos;
+}
+
+int32_t cobsDecode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+    uint32_t pos = 0;
+    uint32_t written = 0;
+    while (pos < len)
+    {
+        uint8_t code = in[pos++];
+        if (code == 0 || pos + code - 1 > len)
+        {
+            return -1;
+        }
+        for (uint32_t i = 1; i < code; i++)
+        {
+            if (in[pos] == 0)
+            {
+                return -1;
+            }
+            out[written++] = in[pos++];
+        }
+        if (code != 0xFF && pos < len)
+        {
+            out[written++] = 0;
+        }
+    }
+    return (int32_t)written;
+}
+
+//*****************************************************************************
+// Parser
+
+bool TelemetryParser::take(uint32_t n)
+{
+    if (!ok_ || len_ - pos_ < n)
+    {
+        ok_ = false;
+        return false;
+    }
+    return true;
+}
+
+uint8_t TelemetryParser::u8()
+{
+    return take(1) ? data_[pos_++] : 0;
+}
+
+uint16_t TelemetryParser::u16()
+{
+    if (!take(2))
+    {
+        return 0;
+    }
+    uint16_t v = (uint16_t)(data_[pos_] | (data_[pos_ + 1] << 8));
+    pos_ += 2;
+    return v;
+}
+
+uint32_t TelemetryParser::u32()
+{
+    if (!take(4))
+    {
+        return 0;
+    }
+    uint32_t v = (uint32_t)data_[pos_] | ((uint32_t)data_[pos_ + 1] << 8) |
+                 ((uint32_t)data_[pos_ + 2] << 16) | ((uint32_t)data_[pos_ + 3] << 24);
+    pos_ += 4;
+    return v;
+}
+
+float TelemetryParser::f32()
+{
+    uint32_t bits = u32();
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+//*****************************************************************************
+// Writer
+
+TelemetryWriter::TelemetryWriter()
+    : sink_(nullptr), context_(nullptr), seq_(0), frames_(0), bytes_(0)
+#if defined(ARDUINO)
+      ,
+      lock_(nullptr)
+#endif
+{
+}
+
+bool TelemetryWriter::begin(Sink sink, void *context)
+{
+#if defined(ARDUINO)
+    if (lock_ == nullptr)
+    {
+        lock_ = xSemaphoreCreateMutex();
+        if (lock_ == nullptr)
+        {
+            return false;
+        }
+    }
+#endif
+    sink_ = sink;
+    context_ = context;
+    return sink != nullptr;
+}
+
+bool TelemetryWriter::send(uint8_t type, const uint8_t *payload, uint32_t len)
+{
+    if (sink_ == nullptr || len > TELEMETRY_MAX_PAYLOAD)
+    {
+        return false;
+    }
+
+    uint8_t frame[TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD];
+    uint8_t wire[TELEMETRY_MAX_WIRE_BYTES];
+    frame[1] = type;
+    memcpy(frame + 2, payload, len);
+
+    // The sequence number must match the order on the wire: take the lock
+    // before numbering, build and write the frame under it
+#if defined(ARDUINO)
+    xSemaphoreTake(lock_, portMAX_DELAY);
+#else
+    std::lock_guard<std::mutex> guard(lock_);
+#endif
+    frame[0] = seq_++;
+    uint16_t crc = telemetryCrc16(frame, len + 2);
+    frame[len + 2] = (uint8_t)crc;
+    frame[len + 3] = (uint8_t)(crc >> 8);
+
+    wire[0] = 0;
+    uint32_t n = 1 + cobsEncode(frame, len + TELEMETRY_FRAME_OVERHEAD, wire + 1);
+    wire[n++] = 0;
+    bool ok = sink_(wire, n, context_) == n;
+    frames_++;
+    bytes_ += n;
+#if defined(ARDUINO)
+    xSemaphoreGive(lock_);
+#endif
+    return ok;
+}
+
+bool TelemetryWriter::print(const char *text)
+{
+    size_t len = strlen(text);
+    return send(TELEM_TEXT, (const uint8_t *)text, (uint32_t)((len > TELEMETRY_MAX_PAYLOAD) ? TELEMETRY_MAX_PAYLOAD : len));
+}
+
+bool TelemetryWriter::printf(const char *format, ...)
+{
+    char text[TELEMETRY_MAX_PAYLOAD + 1];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return print(text);
+}
+
+//*****************************************************************************
+// Receiver
+
+TelemetryReceiver::TelemetryReceiver()
+    : on_record_(nullptr), on_noise_(nullptr), context_(nullptr), fill_(0), overflowed_(false),
+      have_seq_(false), next_seq_(0)
+{
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+void TelemetryReceiver::begin(RecordHandler on_record, NoiseHandler on_noise, void *context)
+{
+    on_record_ = on_record;
+    on_noise_ = on_noise;
+    context_ = context;
+    fill_ = 0;
+    overflowed_ = false;
+    have_seq_ = false;
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+static bool isText(const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        uint8_t c = data[i];
+        if ((c < 0x20 || c > 0x7E) && c != '\r' && c != '\n' && c != '\t')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TelemetryReceiver::feed(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] == 0)
+        {
+            endFrame();
+            continue;
+        }
+        if (fill_ == BUFFER_BYTES)
+        {
+            // Too long for a frame: hand it on as text and keep going
+            if (!overflowed_)
+            {
+                stats_.oversize++;
+                overflowed_ = true;
+            }
+            stats_.noise_bytes += fill_;
+            if (on_noise_ != nullptr)
+            {
+                on_noise_(buf_, fill_, context_);
+            }
+            fill_ = 0;
+        }
+        buf_[fill_++] = data[i];
+    }
+}
+
+void TelemetryReceiver::endFrame()
+{
+    uint32_t n = fill_;
+    bool overflowed = overflowed_;
+    fill_ = 0;
+    overflowed_ = false;
+    if (n == 0)
+    {
+        return;
+    }
+
+    if (!overflowed)
+    {
+        uint8_t frame[BUFFER_BYTES];
+        int32_t len = cobsDecode(buf_, n, frame);
+        if (len >= (int32_t)TELEMETRY_FRAME_OVERHEAD &&
+            telemetryCrc16(frame, len - 2) == (uint16_t)(frame[len - 2] | (frame[len - 1] << 8)))
+        {
+            uint8_t seq = frame[0];
+            if (have_seq_ && seq != next_seq_)
+            {
+                stats_.lost += (uint8_t)(seq - next_seq_);
+            }
+            have_seq_ = true;
+            next_seq_ = seq + 1;
+            stats_.records++;
+
+            TelemetryRecord record;
+            record.seq = seq;
+            record.type = frame[1];
+            record.payload = frame + 2;
+            record.len = (uint32_t)len - TELEMETRY_FRAME_OVERHEAD;
+            if (on_record_ != nullptr)
+            {
+                on_record_(record, context_);
+            }
+            return;
+        }
+    }
+
+    if (overflowed || isText(buf_, n))
+    {
+        stats_.noise_bytes += n;
+        if (on_noise_ != nullptr)
+        {
+            on_noise_(buf_, n, context_);
+        }
+    }
+    else
+    {
+        stats_.bad_crc++;
+    }
+}
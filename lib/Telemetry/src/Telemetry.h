@@ -0,0 +1,276 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// Typed binary telemetry records, COBS framed, over a byte stream (UART)
+//
+// A record is a type byte and up to MAX_PAYLOAD bytes of little-endian
+// payload. Each one goes out as one frame:
+//
+//   0x00  COBS( seq  type  payload...  crc16 )  0x00
+//
+//   seq    - 8-bit counter per writer; gaps tell the receiver frames were lost
+//   crc16  - CRC-16/CCITT-FALSE over seq, type and payload, little endian
+//
+// COBS removes every 0x00 from the frame, so 0x00 only ever marks a frame
+// boundary and the receiver resynchronises at the next one after any
+// corruption. The leading 0x00 separates the frame from plain Serial.print()
+// text written before it: that text reaches the receiver as "noise" and can
+// still be shown, so old text output and telemetry can share the UART while
+// code is being converted. Text can also be sent as TELEM_TEXT records.
+//
+// Record layouts used by the sketches (payload, little endian):
+//
+//   TELEM_TEXT          char[n], no terminator
+//   TELEM_ADC_AVERAGE   f32 average, u32 samples averaged
+//   TELEM_TIMER_COUNT   u32 count
+//   TELEM_REMAINING_MS  u32 ms
+//   TELEM_STATS         u32 count, u16 min, u16 max, f32 mean, f32 stddev
+//   TELEM_SAMPLES       u32 index of the first sample, u16 samples[n]
+//
+// TelemetryWriter::send() may be called from several tasks (not from ISRs):
+// frames are built on the caller's stack and written under a lock.
+// TelemetryReceiver is fed raw bytes by one reader and runs on target or host.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <mutex>
+#endif
+
+enum TelemetryType
+{
+    TELEM_TEXT = 1,
+    TELEM_ADC_AVERAGE = 2,
+    TELEM_TIMER_COUNT = 3,
+    TELEM_REMAINING_MS = 4,
+    TELEM_STATS = 5,
+    TELEM_SAMPLES = 6,
+};
+
+static const uint32_t TELEMETRY_MAX_PAYLOAD = 240;
+static const uint32_t TELEMETRY_FRAME_OVERHEAD = 4; // seq, type, crc16
+// COBS adds one byte per 254 plus one; two delimiters
+static const uint32_t TELEMETRY_MAX_WIRE_BYTES = TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD + 2 + 2;
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+uint16_t telemetryCrc16(const uint8_t *data, size_t len, uint16_t crc = 0xFFFF);
+
+// COBS encode len bytes into out (room for len + len / 254 + 1). Returns the
+// encoded length; out contains no 0x00.
+uint32_t cobsEncode(const uint8_t *in, uint32_t len, uint8_t *out);
+
+// COBS decode; out may equal in (decoding in place). Returns the decoded
+// length, or -1 if the input is not valid COBS.
+int32_t cobsDecode(const uint8_t *in, uint32_t len, uint8_t *out);
+
+//*****************************************************************************
+// Payload building and parsing
+
+class TelemetryPayload
+{
+public:
+    TelemetryPayload() : len_(0), overflow_(false)
+    {
+    }
+
+    TelemetryPayload &u8(uint8_t v)
+    {
+        return bytes(&v, 1);
+    }
+
+    TelemetryPayload &u16(uint16_t v)
+    {
+        uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+        return bytes(b, 2);
+    }
+
+    TelemetryPayload &u32(uint32_t v)
+    {
+        uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+        return bytes(b, 4);
+    }
+
+    TelemetryPayload &f32(float v)
+    {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        return u32(bits);
+    }
+
+    TelemetryPayload &bytes(const void *data, uint32_t n)
+    {
+        if (len_ + n > TELEMETRY_MAX_PAYLOAD)
+        {
+            overflow_ = true;
+            return *this;
+        }
+        memcpy(buf_ + len_, data, n);
+        len_ += n;
+        return *this;
+    }
+
+    const uint8_t *data() const
+    {
+        return buf_;
+    }
+
+    uint32_t size() const
+    {
+        return len_;
+    }
+
+    // True if something did not fit; send() refuses such a payload
+    bool overflow() const
+    {
+        return overflow_;
+    }
+
+private:
+    uint8_t buf_[TELEMETRY_MAX_PAYLOAD];
+    uint32_t len_;
+    bool overflow_;
+};
+
+// Reads fields back in order; reading past the end yields 0 and sets ok() false
+class TelemetryParser
+{
+public:
+    TelemetryParser(const uint8_t *data, uint32_t len) : data_(data), len_(len), pos_(0), ok_(true)
+    {
+    }
+
+    uint8_t u8();
+    uint16_t u16();
+    uint32_t u32();
+    float f32();
+
+    uint32_t remaining() const
+    {
+        return len_ - pos_;
+    }
+
+    const uint8_t *rest() const
+    {
+        return data_ + pos_;
+    }
+
+    bool ok() const
+    {
+        return ok_;
+    }
+
+private:
+    bool take(uint32_t n);
+
+    const uint8_t *data_;
+    uint32_t len_;
+    uint32_t pos_;
+    bool ok_;
+};
+
+//*****************************************************************************
+// Writer
+
+class TelemetryWriter
+{
+public:
+    // Writes bytes to the link (Serial.write on the target). Returns bytes taken.
+    typedef size_t (*Sink)(const uint8_t *data, size_t len, void *context);
+
+    TelemetryWriter();
+
+    bool begin(Sink sink, void *context);
+
+    bool send(uint8_t type, const uint8_t *payload, uint32_t len);
+
+    bool send(uint8_t type, const TelemetryPayload &payload)
+    {
+        return !payload.overflow() && send(type, payload.data(), payload.size());
+    }
+
+    // TELEM_TEXT record, truncated to MAX_PAYLOAD
+    bool print(const char *text);
+    bool printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    uint32_t framesSent() const
+    {
+        return frames_;
+    }
+
+    uint32_t bytesSent() const
+    {
+        return bytes_;
+    }
+
+private:
+    Sink sink_;
+    void *context_;
+    uint8_t seq_;
+    uint32_t frames_;
+    uint32_t bytes_;
+#if defined(ARDUINO)
+    SemaphoreHandle_t lock_;
+#else
+    std::mutex lock_;
+#endif
+};
+
+//*****************************************************************************
+// Receiver
+
+struct TelemetryRecord
+{
+    uint8_t seq;
+    uint8_t type;
+    const uint8_t *payload; // Valid during the handler call only
+    uint32_t len;
+};
+
+struct TelemetryReceiverStats
+{
+    uint32_t records;
+    uint32_t bad_crc;     // Binary runs that failed the COBS or CRC check
+    uint32_t lost;        // Missing sequence numbers
+    uint32_t oversize;    // Runs longer than any frame (passed on as noise)
+    uint32_t noise_bytes; // Printable text between frames
+};
+
+class TelemetryReceiver
+{
+public:
+    typedef void (*RecordHandler)(const TelemetryRecord &record, void *context);
+    // Printable text between frames, e.g. Serial.print() output. Runs longer
+    // than a frame arrive in pieces.
+    typedef void (*NoiseHandler)(const uint8_t *data, uint32_t len, void *context);
+
+    TelemetryReceiver();
+
+    void begin(RecordHandler on_record, NoiseHandler on_noise, void *context);
+    void feed(const uint8_t *data, size_t len);
+
+    const TelemetryReceiverStats &stats() const
+    {
+        return stats_;
+    }
+
+private:
+    static const uint32_t BUFFER_BYTES = TELEMETRY_MAX_PAYLOAD + TELEMETRY_FRAME_OVERHEAD + 2;
+
+    void endFrame();
+
+    RecordHandler on_record_;
+    NoiseHandler on_noise_;
+    void *context_;
+    uint8_t buf_[BUFFER_BYTES];
+    uint32_t fill_;
+    bool overflowed_;
+    bool have_seq_;
+    uint8_t next_seq_;
+    TelemetryReceiverStats stats_;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,243 @@
+#include "TimingWheel.h"
+
+// Level marker for timers sitting on the expired batch list
+static const uint8_t LEVEL_EXPIRED = 0xFF;
+
+static inline void listInit(WheelLink *head)
+{
+    head->prev = head;
+    head->next = head;
+}
+
+static inline bool listEmpty(const WheelLink *head)
+{
+    return head->next == head;
+}
+
+static inline void listPushBack(WheelLink *head, WheelLink *node)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static inline void listRemove(WheelLink *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+}
+
+// Move every node of src to the end of dst, leaving src empty
+static inline void listSplice(WheelLink *dst, WheelLink *src)
+{
+    if (listEmpty(src))
+    {
+        return;
+    }
+    src->next->prev = dst->prev;
+    dst->prev->next = src->next;
+    src->prev->next = dst;
+    dst->prev = src->prev;
+    listInit(src);
+}
+
+TimingWheel::TimingWheel(uint32_t now)
+    : now_(now), active_count_(0)
+{
+    for (uint32_t level = 0; level < LEVELS; level++)
+    {
+        for (uint32_t slot = 0; slot < SLOTS; slot++)
+        {
+            listInit(&slots_[level][slot]);
+        }
+        occupied_[level] = 0;
+    }
+    listInit(&expired_);
+}
+
+void TimingWheel::initTimer(WheelTimer *timer,
+                            const char *name,
+                            uint32_t period,
+                            bool auto_reload,
+                            void *id,
+                            WheelTimerCallbackFunction_t callback)
+{
+    listInit(&timer->link);
+    timer->name = name;
+    timer->id = id;
+    timer->callback = callback;
+    timer->period = period;
+    timer->expiry = 0;
+    timer->auto_reload = auto_reload;
+    timer->active = false;
+    timer->level = 0;
+    timer->slot = 0;
+}
+
+void TimingWheel::start(WheelTimer *timer)
+{
+    startAt(timer, now_ + timer->period);
+}
+
+void TimingWheel::startAt(WheelTimer *timer, uint32_t expiry)
+{
+    stop(timer);
+
+    // Anything due now or in the past fires on the next processed tick
+    if ((int32_t)(expiry - now_) <= 0)
+    {
+        expiry = now_ + 1;
+    }
+    timer->expiry = expiry;
+    timer->active = true;
+    active_count_++;
+    insert(timer);
+}
+
+void TimingWheel::stop(WheelTimer *timer)
+{
+    if (!timer->active)
+    {
+        return;
+    }
+    unlink(timer);
+    timer->active = false;
+    active_count_--;
+}
+
+// Place a timer in the level that matches its distance from now_
+void TimingWheel::insert(WheelTimer *timer)
+{
+    uint32_t delta = timer->expiry - now_;
+    uint32_t key = timer->expiry;
+    uint32_t level = 0;
+
+    if (delta > MAX_DELAY)
+    {
+        // Park in the top level; it is re-cascaded until it fits
+        key = now_ + MAX_DELAY;
+        level = LEVELS - 1;
+    }
+    else
+    {
+        while (level < LEVELS - 1 && delta >= (1u << (SLOT_BITS * (level + 1))))
+        {
+            level++;
+        }
+    }
+
+    uint32_t slot = (key >> (SLOT_BITS * level)) & (SLOTS - 1);
+    timer->level = (uint8_t)level;
+    timer->slot = (uint8_t)slot;
+    listPushBack(&slots_[level][slot], &timer->link);
+    occupied_[level] |= (uint64_t)1 << slot;
+}
+
+void TimingWheel::unlink(WheelTimer *timer)
+{
+    listRemove(&timer->link);
+    if (timer->level != LEVEL_EXPIRED && listEmpty(&slots_[timer->level][timer->slot]))
+    {
+        occupied_[timer->level] &= ~((uint64_t)1 << timer->slot);
+    }
+}
+
+// Redistribute the current slot of a level into the levels below it
+void TimingWheel::cascade(uint32_t level)
+{
+    uint32_t slot = (now_ >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+    // The level above wraps first so its timers are redistributed too
+    if (slot == 0 && level + 1 < LEVELS)
+    {
+        cascade(level + 1);
+    }
+
+    WheelLink pending;
+    listInit(&pending);
+    listSplice(&pending, &slots_[level][slot]);
+    occupied_[level] &= ~((uint64_t)1 << slot);
+
+    while (!listEmpty(&pending))
+    {
+        WheelTimer *timer = (WheelTimer *)pending.next;
+        listRemove(&timer->link);
+        insert(timer);
+    }
+}
+
+uint32_t TimingWheel::advance(uint32_t now)
+{
+    uint32_t fired = 0;
+
+    while ((int32_t)(now - now_) > 0)
+    {
+        now_++;
+        uint32_t slot = now_ & (SLOTS - 1);
+
+        if (slot == 0)
+        {
+            cascade(1);
+        }
+
+        if (!(occupied_[0] & ((uint64_t)1 << slot)))
+        {
+            continue;
+        }
+
+        // Take the whole slot as one batch, then fire one timer at a time so
+        // callbacks can stop timers that are still waiting in the batch
+        listSplice(&expired_, &slots_[0][slot]);
+        occupied_[0] &= ~((uint64_t)1 << slot);
+        for (WheelLink *node = expired_.next; node != &expired_; node = node->next)
+        {
+            ((WheelTimer *)node)->level = LEVEL_EXPIRED;
+        }
+
+        while (!listEmpty(&expired_))
+        {
+            WheelTimer *timer = (WheelTimer *)expired_.next;
+            stop(timer);
+
+            if (timer->auto_reload)
+            {
+                // Reload from the nominal expiry so periodic timers do not drift
+                startAt(timer, timer->expiry + (timer->period ? timer->period : 1));
+            }
+
+            if (timer->callback != nullptr)
+            {
+                timer->callback(timer);
+            }
+            fired++;
+        }
+    }
+
+    return fired;
+}
+
+uint32_t TimingWheel::ticksUntilNext() const
+{
+    if (active_count_ == 0)
+    {
+        return NO_EXPIRY;
+    }
+
+    // Next occupied level-0 slot ahead of now_ in this rotation
+    uint32_t base = (now_ + 1) & (SLOTS - 1);
+    uint64_t bits = occupied_[0];
+    uint64_t rotated = base ? ((bits >> base) | (bits << (SLOTS - base))) : bits;
+    uint32_t to_boundary = SLOTS - (now_ & (SLOTS - 1));
+
+    if (rotated != 0)
+    {
+        uint32_t ahead = (uint32_t)__builtin_ctzll(rotated) + 1;
+        return (ahead < to_boundary) ? ahead : to_boundary;
+    }
+
+    // Otherwise wake at the next cascade point
+    return to_boundary;
+}
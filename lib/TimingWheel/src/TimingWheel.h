@@ -0,0 +1,106 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+// Hierarchical timing wheel
+//
+// Four levels of 64 slots each cover 2^24 ticks (about 4.6 hours at 1 kHz);
+// longer delays are parked in the top level and re-cascaded until they fit.
+// start(), stop() and restart() are O(1) list operations, unlike the sorted
+// active list used by the FreeRTOS timer daemon where an insert walks past
+// every timer that expires earlier.
+//
+// The wheel itself is single-threaded and knows nothing about FreeRTOS, so it
+// can be driven from a host benchmark. WheelTimerService.h wraps it in a
+// daemon task for use on the ESP32.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct WheelTimer;
+typedef WheelTimer *WheelTimerHandle_t;
+
+// Same shape as TimerCallbackFunction_t
+typedef void (*WheelTimerCallbackFunction_t)(WheelTimerHandle_t xTimer);
+
+// Intrusive doubly linked list node; slot heads are bare nodes
+struct WheelLink
+{
+    WheelLink *prev;
+    WheelLink *next;
+};
+
+struct WheelTimer
+{
+    WheelLink link; // Must stay first: a WheelLink * is cast back to WheelTimer *
+
+    const char *name;
+    void *id;
+    WheelTimerCallbackFunction_t callback;
+    uint32_t period;  // Ticks
+    uint32_t expiry;  // Absolute tick of the next expiry
+    bool auto_reload;
+    bool active;
+    uint8_t level;
+    uint8_t slot;
+};
+
+class TimingWheel
+{
+public:
+    static const uint32_t SLOT_BITS = 6;
+    static const uint32_t SLOTS = 1u << SLOT_BITS;
+    static const uint32_t LEVELS = 4;
+    static const uint32_t MAX_DELAY = (1u << (SLOT_BITS * LEVELS)) - 1;
+    static const uint32_t NO_EXPIRY = UINT32_MAX;
+
+    explicit TimingWheel(uint32_t now = 0);
+
+    // Set up a timer object; it starts dormant
+    static void initTimer(WheelTimer *timer,
+                          const char *name,
+                          uint32_t period,
+                          bool auto_reload,
+                          void *id,
+                          WheelTimerCallbackFunction_t callback);
+
+    // Arm (or re-arm) a timer to expire period ticks from now. O(1).
+    void start(WheelTimer *timer);
+
+    // Arm a timer for an absolute tick. O(1).
+    void startAt(WheelTimer *timer, uint32_t expiry);
+
+    // Disarm a timer. O(1). Safe to call on dormant timers.
+    void stop(WheelTimer *timer);
+
+    // Process every tick up to and including now, firing callbacks in expiry
+    // order. Callbacks may start or stop any timer, including the caller.
+    // Returns the number of callbacks run.
+    uint32_t advance(uint32_t now);
+
+    // Ticks until the next tick that needs processing (an expiry or a cascade
+    // that may produce one), or NO_EXPIRY when the wheel is empty.
+    uint32_t ticksUntilNext() const;
+
+    uint32_t now() const
+    {
+        return now_;
+    }
+
+    uint32_t activeCount() const
+    {
+        return active_count_;
+    }
+
+private:
+    void insert(WheelTimer *timer);
+    void unlink(WheelTimer *timer);
+    void cascade(uint32_t level);
+
+    uint32_t now_;
+    uint32_t active_count_;
+    WheelLink slots_[LEVELS][SLOTS]; // Heads of circular slot lists
+    WheelLink expired_;              // Batch being fired by advance()
+    uint64_t occupied_[LEVELS];      // One bit per non-empty slot
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,181 @@
+#include "WheelTimerService.h"
+
+#if defined(ARDUINO)
+
+#include <new>
+
+// Globals
+static TimingWheel *wheel = nullptr;
+static SemaphoreHandle_t wheel_lock = nullptr; // Recursive: callbacks may re-arm timers
+static TaskHandle_t daemon_task = nullptr;
+static volatile TickType_t planned_wake = 0;
+static WheelTimerServiceStats stats = {0, 0, 0};
+
+//*****************************************************************************
+// Daemon task
+
+static void wheelTimerDaemon(void *parameters)
+{
+    while (1)
+    {
+        xSemaphoreTakeRecursive(wheel_lock, portMAX_DELAY);
+        TickType_t now = xTaskGetTickCount();
+        uint32_t fired = wheel->advance(now);
+        uint32_t wait = wheel->ticksUntilNext();
+        planned_wake = (wait == TimingWheel::NO_EXPIRY) ? now + INT32_MAX : now + wait;
+
+        stats.wakeups++;
+        stats.fired += fired;
+        if (fired > stats.max_batch)
+        {
+            stats.max_batch = fired;
+        }
+        xSemaphoreGiveRecursive(wheel_lock);
+
+        // Sleep until the next occupied slot, or until an earlier timer is armed
+        ulTaskNotifyTake(pdTRUE, (wait == TimingWheel::NO_EXPIRY) ? portMAX_DELAY : wait);
+    }
+}
+
+//*****************************************************************************
+// Public API
+
+bool wheelTimerServiceBegin(UBaseType_t priority, BaseType_t core)
+{
+    if (wheel != nullptr)
+    {
+        return true;
+    }
+
+    wheel = new (std::nothrow) TimingWheel(xTaskGetTickCount());
+    wheel_lock = xSemaphoreCreateRecursiveMutex();
+    if (wheel == nullptr || wheel_lock == nullptr)
+    {
+        return false;
+    }
+
+    return xTaskCreatePinnedToCore(wheelTimerDaemon,
+                                   "Wheel Timer",
+                                   4096,
+                                   NULL,
+                                   priority,
+                                   &daemon_task,
+                                   core) == pdPASS;
+}
+
+WheelTimerHandle_t wheelTimerCreate(const char *name,
+                                    TickType_t period,
+                                    UBaseType_t auto_reload,
+                                    void *id,
+                                    WheelTimerCallbackFunction_t callback)
+{
+    WheelTimer *timer = new (std::nothrow) WheelTimer;
+    if (timer != nullptr)
+    {
+        TimingWheel::initTimer(timer, name, period, auto_reload != pdFALSE, id, callback);
+    }
+    return timer;
+}
+
+BaseType_t wheelTimerStart(WheelTimerHandle_t timer)
+{
+    if (wheel == nullptr || timer == nullptr)
+    {
+        return pdFAIL;
+    }
+
+    xSemaphoreTakeRecursive(wheel_lock, portMAX_DELAY);
+    TickType_t expiry = xTaskGetTickCount() + timer->period;
+    wheel->startAt(timer, expiry);
+
+    // Only wake the daemon if it would otherwise sleep past this expiry
+    bool wake = (int32_t)(expiry - planned_wake) < 0;
+    if (wake)
+    {
+        planned_wake = expiry;
+    }
+    xSemaphoreGiveRecursive(wheel_lock);
+
+    if (wake && xTaskGetCurrentTaskHandle() != daemon_task)
+    {
+        xTaskNotifyGive(daemon_task);
+    }
+    return pdPASS;
+}
+
+BaseType_t wheelTimerReset(WheelTimerHandle_t timer)
+{
+    return wheelTimerStart(timer);
+}
+
+BaseType_t wheelTimerStop(WheelTimerHandle_t timer)
+{
+    if (wheel == nullptr || timer == nullptr)
+    {
+        return pdFAIL;
+    }
+
+    xSemaphoreTakeRecursive(wheel_lock, portMAX_DELAY);
+    wheel->stop(timer);
+    xSemaphoreGiveRecursive(wheel_lock);
+    return pdPASS;
+}
+
+BaseType_t wheelTimerChangePeriod(WheelTimerHandle_t timer, TickType_t period)
+{
+    if (wheel == nullptr || timer == nullptr)
+    {
+        return pdFAIL;
+    }
+
+    xSemaphoreTakeRecursive(wheel_lock, portMAX_DELAY);
+    timer->period = period;
+    BaseType_t result = wheelTimerStart(timer);
+    xSemaphoreGiveRecursive(wheel_lock);
+    return result;
+}
+
+void wheelTimerDelete(WheelTimerHandle_t timer)
+{
+    if (timer == nullptr)
+    {
+        return;
+    }
+    wheelTimerStop(timer);
+    delete timer;
+}
+
+BaseType_t wheelTimerIsTimerActive(WheelTimerHandle_t timer)
+{
+    return (timer != nullptr && timer->active) ? pdTRUE : pdFALSE;
+}
+
+void *wheelTimerGetTimerID(WheelTimerHandle_t timer)
+{
+    return timer->id;
+}
+
+TickType_t wheelTimerGetExpiryTime(WheelTimerHandle_t timer)
+{
+    return timer->expiry;
+}
+
+uint32_t wheelTimerActiveCount()
+{
+    return (wheel != nullptr) ? wheel->activeCount() : 0;
+}
+
+void wheelTimerGetStats(WheelTimerServiceStats *out)
+{
+    if (wheel == nullptr || wheel_lock == nullptr)
+    {
+        *out = {0, 0, 0};
+        return;
+    }
+
+    xSemaphoreTakeRecursive(wheel_lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGiveRecursive(wheel_lock);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,55 @@
+#ifndef WHEEL_TIMER_SERVICE_H
+#define WHEEL_TIMER_SERVICE_H
+
+// FreeRTOS daemon task driving a TimingWheel
+//
+// The API mirrors xTimerCreate()/xTimerStart()/xTimerStop(), but start, stop
+// and reset update the wheel directly under a mutex instead of posting a
+// command to the timer daemon queue, and cost O(1) regardless of how many
+// timers are active. The daemon sleeps until the next occupied slot and fires
+// all timers of a tick as one batch. Callbacks run in the daemon task and may
+// call any of the functions below. Task context only (no FromISR variants).
+
+#include "TimingWheel.h"
+
+#if defined(ARDUINO)
+
+#include <Arduino.h>
+
+struct WheelTimerServiceStats
+{
+    uint32_t wakeups;   // Times the daemon ran
+    uint32_t fired;     // Callbacks executed
+    uint32_t max_batch; // Most callbacks fired in one wakeup
+};
+
+// Start the daemon task. Call once before creating timers.
+bool wheelTimerServiceBegin(UBaseType_t priority, BaseType_t core);
+
+WheelTimerHandle_t wheelTimerCreate(const char *name,
+                                    TickType_t period,
+                                    UBaseType_t auto_reload,
+                                    void *id,
+                                    WheelTimerCallbackFunction_t callback);
+
+// Start, or restart if already running (same as wheelTimerReset)
+BaseType_t wheelTimerStart(WheelTimerHandle_t timer);
+BaseType_t wheelTimerReset(WheelTimerHandle_t timer);
+BaseType_t wheelTimerStop(WheelTimerHandle_t timer);
+
+// Set a new period and (re)start the timer, like xTimerChangePeriod()
+BaseType_t wheelTimerChangePeriod(WheelTimerHandle_t timer, TickType_t period);
+
+// Stop and free a timer created by wheelTimerCreate()
+void wheelTimerDelete(WheelTimerHandle_t timer);
+
+BaseType_t wheelTimerIsTimerActive(WheelTimerHandle_t timer);
+void *wheelTimerGetTimerID(WheelTimerHandle_t timer);
+TickType_t wheelTimerGetExpiryTime(WheelTimerHandle_t timer);
+uint32_t wheelTimerActiveCount();
+
+void wheelTimerGetStats(WheelTimerServiceStats *stats);
+
+#endif // ARDUINO
+
+#endif // WHEEL_TIMER_SERVICE_H
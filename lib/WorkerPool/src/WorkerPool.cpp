@@ -0,0 +1,284 @@
+#include "WorkerPool.h"
+
+#include <new>
+
+// Handles carry the slot generation so a stale handle never matches a reused slot
+static inline WorkerJobHandle_t makeHandle(uint16_t index, uint16_t generation)
+{
+    return ((WorkerJobHandle_t)generation << 16) | (WorkerJobHandle_t)(index + 1);
+}
+
+static inline uint16_t handleGeneration(WorkerJobHandle_t handle)
+{
+    return (uint16_t)(handle >> 16);
+}
+
+// Job::word layout
+static const uint32_t STATE_MASK = 0xFF;
+static const uint32_t CANCEL_REQUESTED = 0x100;
+
+static inline uint32_t packWord(uint16_t generation, uint32_t state)
+{
+    return ((uint32_t)generation << 16) | state;
+}
+
+static inline uint16_t wordGeneration(uint32_t word)
+{
+    return (uint16_t)(word >> 16);
+}
+
+static inline uint32_t wordState(uint32_t word)
+{
+    return word & STATE_MASK;
+}
+
+WorkerPool::WorkerPool()
+    : jobs_(nullptr),
+      max_jobs_(0),
+      free_slots_(NULL),
+      completed_(0),
+      rejected_(0)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        queues_[core] = NULL;
+    }
+}
+
+bool WorkerPool::begin(uint32_t workers_per_core,
+                       uint32_t stack_size,
+                       UBaseType_t priority,
+                       uint32_t max_jobs)
+{
+    if (max_jobs == 0 || max_jobs > 0xFFFF)
+    {
+        return false;
+    }
+
+    jobs_ = new (std::nothrow) Job[max_jobs];
+    free_slots_ = xQueueCreate(max_jobs, sizeof(uint16_t));
+    if (jobs_ == nullptr || free_slots_ == NULL)
+    {
+        return false;
+    }
+    max_jobs_ = max_jobs;
+
+    for (uint32_t i = 0; i < max_jobs; i++)
+    {
+        uint16_t index = (uint16_t)i;
+        jobs_[i].word.store(packWord(0, JOB_FREE));
+        xQueueSend(free_slots_, &index, 0);
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        queues_[core] = xQueueCreate(max_jobs, sizeof(uint16_t));
+        if (queues_[core] == NULL)
+        {
+            return false;
+        }
+        args_[core].pool = this;
+        args_[core].queue = queues_[core];
+
+        for (uint32_t w = 0; w < workers_per_core; w++)
+        {
+            if (xTaskCreatePinnedToCore(workerTask, "Worker", stack_size, &args_[core], priority, NULL, core) != pdPASS)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+BaseType_t WorkerPool::pickCore(BaseType_t core, bool from_isr) const
+{
+    if (core >= 0 && core < portNUM_PROCESSORS)
+    {
+        return core;
+    }
+
+    // No affinity: shortest queue wins
+    BaseType_t best = 0;
+    UBaseType_t best_waiting = from_isr ? uxQueueMessagesWaitingFromISR(queues_[0])
+                                        : uxQueueMessagesWaiting(queues_[0]);
+    for (int c = 1; c < portNUM_PROCESSORS; c++)
+    {
+        UBaseType_t waiting = from_isr ? uxQueueMessagesWaitingFromISR(queues_[c])
+                                       : uxQueueMessagesWaiting(queues_[c]);
+        if (waiting < best_waiting)
+        {
+            best = c;
+            best_waiting = waiting;
+        }
+    }
+    return best;
+}
+
+WorkerJobHandle_t WorkerPool::prepare(uint16_t index, WorkerJobFunction_t function, void *parameters)
+{
+    Job *job = &jobs_[index];
+    job->function = function;
+    job->parameters = parameters;
+
+    // The slot came off the free list, so nothing else changes its word now;
+    // the new generation invalidates handles from its previous use
+    uint16_t generation = wordGeneration(job->word.load()) + 1;
+    job->word.store(packWord(generation, JOB_PENDING));
+    return makeHandle(index, generation);
+}
+
+// The job never reached a worker queue; its handle was not handed out
+void WorkerPool::unprepare(uint16_t index)
+{
+    Job *job = &jobs_[index];
+    job->word.store(packWord(wordGeneration(job->word.load()), JOB_FREE));
+}
+
+WorkerJobHandle_t WorkerPool::submit(WorkerJobFunction_t function, void *parameters, BaseType_t core)
+{
+    uint16_t index;
+    if (xQueueReceive(free_slots_, &index, 0) != pdTRUE)
+    {
+        rejected_++;
+        return WORKER_JOB_INVALID;
+    }
+
+    WorkerJobHandle_t handle = prepare(index, function, parameters);
+
+    // Queues hold max_jobs entries, so this should never fail; if it does
+    // the slot goes back rather than leaving a handle that never runs
+    if (xQueueSend(queues_[pickCore(core, false)], &index, 0) != pdTRUE)
+    {
+        unprepare(index);
+        release(index);
+        rejected_++;
+        return WORKER_JOB_INVALID;
+    }
+    return handle;
+}
+
+WorkerJobHandle_t WorkerPool::submitFromISR(WorkerJobFunction_t function,
+                                            void *parameters,
+                                            BaseType_t core,
+                                            BaseType_t *higher_priority_task_woken)
+{
+    uint16_t index;
+    if (xQueueReceiveFromISR(free_slots_, &index, higher_priority_task_woken) != pdTRUE)
+    {
+        rejected_++;
+        return WORKER_JOB_INVALID;
+    }
+
+    WorkerJobHandle_t handle = prepare(index, function, parameters);
+
+    if (xQueueSendFromISR(queues_[pickCore(core, true)], &index, higher_priority_task_woken) != pdTRUE)
+    {
+        unprepare(index);
+        xQueueSendFromISR(free_slots_, &index, higher_priority_task_woken);
+        rejected_++;
+        return WORKER_JOB_INVALID;
+    }
+    return handle;
+}
+
+// Only checks the index; callers compare the generation inside the word
+WorkerPool::Job *WorkerPool::lookup(WorkerJobHandle_t handle) const
+{
+    uint32_t index = (handle & 0xFFFF);
+    if (index == 0 || index > max_jobs_)
+    {
+        return nullptr;
+    }
+    return &jobs_[index - 1];
+}
+
+bool WorkerPool::cancel(WorkerJobHandle_t handle)
+{
+    Job *job = lookup(handle);
+    if (job == nullptr)
+    {
+        return false;
+    }
+    uint16_t generation = handleGeneration(handle);
+
+    // The worker drops a cancelled job and frees its slot when it dequeues it
+    uint32_t expected = packWord(generation, JOB_PENDING);
+    if (job->word.compare_exchange_strong(expected, packWord(generation, JOB_CANCELLED)))
+    {
+        return true;
+    }
+
+    // Running under this handle: flag it, unless it finished in between
+    expected = packWord(generation, JOB_RUNNING);
+    job->word.compare_exchange_strong(expected, packWord(generation, JOB_RUNNING | CANCEL_REQUESTED));
+    return false;
+}
+
+bool WorkerPool::cancelRequested(WorkerJobHandle_t handle) const
+{
+    Job *job = lookup(handle);
+    if (job == nullptr)
+    {
+        return false;
+    }
+    uint32_t word = job->word.load();
+    return wordGeneration(word) == handleGeneration(handle) && (word & CANCEL_REQUESTED) != 0;
+}
+
+WorkerJobState WorkerPool::status(WorkerJobHandle_t handle) const
+{
+    Job *job = lookup(handle);
+    if (job == nullptr)
+    {
+        return JOB_FREE;
+    }
+    uint32_t word = job->word.load();
+    if (wordGeneration(word) != handleGeneration(handle))
+    {
+        return JOB_FREE;
+    }
+    return (WorkerJobState)wordState(word);
+}
+
+uint32_t WorkerPool::pending() const
+{
+    uint32_t total = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        total += uxQueueMessagesWaiting(queues_[core]);
+    }
+    return total;
+}
+
+// Slot goes back to the free list; the final state stays readable until reuse
+void WorkerPool::release(uint16_t index)
+{
+    xQueueSend(free_slots_, &index, 0);
+}
+
+void WorkerPool::workerTask(void *parameters)
+{
+    WorkerArgs *args = (WorkerArgs *)parameters;
+    WorkerPool *pool = args->pool;
+    uint16_t index;
+
+    while (1)
+    {
+        xQueueReceive(args->queue, &index, portMAX_DELAY);
+        Job *job = &pool->jobs_[index];
+
+        // The slot stays ours until release(), so its generation is stable
+        uint32_t word = job->word.load();
+        uint16_t generation = wordGeneration(word);
+        if (wordState(word) == JOB_PENDING &&
+            job->word.compare_exchange_strong(word, packWord(generation, JOB_RUNNING)))
+        {
+            job->function(job->parameters, makeHandle(index, generation));
+            job->word.store(packWord(generation, JOB_DONE));
+            pool->completed_++;
+        }
+
+        pool->release(index);
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+// Fixed-size pool of worker tasks fed by job queues
+//
+// Instead of xTaskCreatePinnedToCore() + vTaskDelete(NULL) per event, jobs
+// are posted to long-lived workers. Each core has its own job queue served
+// by its pinned workers; jobs submitted without affinity go to the core
+// with the shortest queue. Job slots come from a fixed table, so submitting
+// never touches the heap and a full pool is reported instead of blocking.
+//
+// A pending job can be cancelled before it starts. A running job is only
+// asked to stop: it should poll WorkerPool::cancelRequested().
+
+#include <Arduino.h>
+#include <atomic>
+
+typedef uint32_t WorkerJobHandle_t;
+typedef void (*WorkerJobFunction_t)(void *parameters, WorkerJobHandle_t job);
+
+static const WorkerJobHandle_t WORKER_JOB_INVALID = 0;
+
+enum WorkerJobState
+{
+    JOB_FREE = 0,
+    JOB_PENDING,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_CANCELLED
+};
+
+class WorkerPool
+{
+public:
+    WorkerPool();
+
+    // Create workers_per_core workers on every core and a table of max_jobs
+    // job slots. Returns false if any allocation fails.
+    bool begin(uint32_t workers_per_core,
+               uint32_t stack_size,
+               UBaseType_t priority,
+               uint32_t max_jobs);
+
+    // Queue a job. core is a core number or tskNO_AFFINITY.
+    // Returns WORKER_JOB_INVALID if every job slot is in use or the job
+    // could not be queued.
+    WorkerJobHandle_t submit(WorkerJobFunction_t function, void *parameters, BaseType_t core = tskNO_AFFINITY);
+
+    // Same as submit() for use inside an ISR
+    WorkerJobHandle_t submitFromISR(WorkerJobFunction_t function,
+                                    void *parameters,
+                                    BaseType_t core,
+                                    BaseType_t *higher_priority_task_woken);
+
+    // Cancel a job. Returns true if it had not started and never will; false
+    // if it is already running (cancelRequested() now returns true) or done.
+    bool cancel(WorkerJobHandle_t job);
+
+    // For use inside a running job
+    bool cancelRequested(WorkerJobHandle_t job) const;
+
+    // JOB_DONE / JOB_CANCELLED are reported until the slot is reused
+    WorkerJobState status(WorkerJobHandle_t job) const;
+
+    uint32_t pending() const;
+
+    uint32_t completed() const
+    {
+        return completed_.load();
+    }
+
+    uint32_t rejected() const
+    {
+        return rejected_.load();
+    }
+
+private:
+    struct Job
+    {
+        WorkerJobFunction_t function;
+        void *parameters;
+
+        // Generation (high 16 bits), cancel request and WorkerJobState in one
+        // word, so every transition is a single CAS against the handle's
+        // generation and a stale handle can never touch a reused slot
+        std::atomic<uint32_t> word;
+    };
+
+    struct WorkerArgs
+    {
+        WorkerPool *pool;
+        QueueHandle_t queue;
+    };
+
+    static void workerTask(void *parameters);
+    WorkerJobHandle_t prepare(uint16_t index, WorkerJobFunction_t function, void *parameters);
+    Job *lookup(WorkerJobHandle_t job) const;
+    BaseType_t pickCore(BaseType_t core, bool from_isr) const;
+    void unprepare(uint16_t index);
+    void release(uint16_t index);
+
+    Job *jobs_;
+    uint32_t max_jobs_;
+    QueueHandle_t free_slots_; // Indices of unused job slots
+    QueueHandle_t queues_[portNUM_PROCESSORS];
+    WorkerArgs args_[portNUM_PROCESSORS];
+    std::atomic<uint32_t> completed_;
+    std::atomic<uint32_t> rejected_;
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,327 @@
+/**
+ * Host benchmark: a thread per component vs actors on a few workers
+ *
+ * A producer sends rounds of messages, one to every component per round,
+ * like the timer ISR in part9_isr_challenge.cpp feeding its tasks. Each
+ * component checks the message sequence and spins a little to simulate a
+ * handler. Compared for 3 and 100 components:
+ *
+ *   threads  every component owns a thread and a bounded queue
+ *            (mutex + condition variable), the task-per-component layout
+ *   actors   every component is an Actor; ActorSystem runs them on one
+ *            worker per core
+ *
+ * Reported: send-to-handler latency (p50/p99/max, us) and memory: the
+ * stacks the threads reserve vs the actors' objects and mailboxes plus the
+ * workers' stacks. On the ESP32 each thread is a task with a 4096 B stack,
+ * see progress/part9_isr_actors.cpp.
+ *
+ * Prints PASS/FAIL: every message handled, in send order per component,
+ * and never two handlers of one component at once.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/Histogram/src -Ilib/ActorSystem/src \
+ *       progress/host/actor_bench.cpp lib/ActorSystem/src/ActorSystem.cpp \
+ *       -o actor_bench && ./actor_bench
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ActorSystem.h>
+#include <Histogram.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t rounds = 300;
+static const uint32_t round_gap_us = 500;
+static const uint32_t mailbox_size = 16;
+static const uint32_t handler_spins = 200;
+static const uint32_t workers_per_core = 1;
+
+static const uint16_t MSG_SAMPLE = 1;
+
+// What every component does with a message, in both layouts
+struct Component
+{
+    uint32_t expected = 0;
+    uint32_t errors = 0;
+    std::atomic<uint32_t> handled{0};
+    std::atomic<uint32_t> inside{0};
+    LogHistogram latency_us;
+
+    void handle(uint32_t value, uint32_t sent_us)
+    {
+        latency_us.record((uint32_t)monotonicMicros() - sent_us);
+        if (inside.fetch_add(1) != 0)
+        {
+            errors++; // Two handlers at once
+        }
+        if (value != expected)
+        {
+            errors++;
+        }
+        expected = value + 1;
+
+        volatile uint32_t sink = value;
+        for (uint32_t i = 0; i < handler_spins; i++)
+        {
+            sink = sink * 31 + i;
+        }
+        inside.fetch_sub(1);
+        handled.fetch_add(1);
+    }
+};
+
+struct Result
+{
+    LogHistogram latency_us;
+    uint32_t handled = 0;
+    uint32_t errors = 0;
+    uint32_t retries = 0; // Sends repeated because a queue was full
+    size_t memory = 0;
+};
+
+static void summarize(const std::vector<Component> &components, Result *result)
+{
+    for (size_t i = 0; i < components.size(); i++)
+    {
+        result->latency_us.merge(components[i].latency_us);
+        result->handled += components[i].handled.load();
+        result->errors += components[i].errors;
+    }
+}
+
+static size_t defaultStack()
+{
+    pthread_attr_t attr;
+    size_t stack = 0;
+    pthread_attr_init(&attr);
+    pthread_attr_getstacksize(&attr, &stack);
+    pthread_attr_destroy(&attr);
+    return stack;
+}
+
+static void roundGap()
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(round_gap_us));
+}
+
+//*****************************************************************************
+// Thread per component
+
+struct Sample
+{
+    uint32_t value;
+    uint32_t sent_us;
+};
+
+class ComponentThread
+{
+public:
+    explicit ComponentThread(Component *component)
+        : component_(component), queue_(mailbox_size), head_(0), count_(0), stopping_(false)
+    {
+        thread_ = std::thread(&ComponentThread::loop, this);
+    }
+
+    ~ComponentThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            cond_.notify_one();
+        }
+        thread_.join();
+    }
+
+    bool send(uint32_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == queue_.size())
+        {
+            return false;
+        }
+        queue_[(head_ + count_) % queue_.size()] = {value, (uint32_t)monotonicMicros()};
+        count_++;
+        cond_.notify_one();
+        return true;
+    }
+
+private:
+    void loop()
+    {
+        while (1)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] { return count_ > 0 || stopping_; });
+            if (count_ == 0)
+            {
+                return;
+            }
+            Sample sample = queue_[head_];
+            head_ = (head_ + 1) % queue_.size();
+            count_--;
+            lock.unlock();
+            component_->handle(sample.value, sample.sent_us);
+        }
+    }
+
+    Component *component_;
+    std::vector<Sample> queue_;
+    size_t head_;
+    size_t count_;
+    bool stopping_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+};
+
+static Result runThreads(uint32_t n)
+{
+    Result result;
+    std::vector<Component> components(n);
+    {
+        std::vector<ComponentThread *> threads;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            threads.push_back(new ComponentThread(&components[i]));
+        }
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                while (!threads[i]->send(r))
+                {
+                    result.retries++;
+                    std::this_thread::yield();
+                }
+            }
+            roundGap();
+        }
+        for (uint32_t i = 0; i < n; i++)
+        {
+            delete threads[i]; // Drains its queue first
+        }
+    }
+    summarize(components, &result);
+    result.memory = n * (defaultStack() + sizeof(ComponentThread) + mailbox_size * sizeof(Sample));
+    return result;
+}
+
+//*****************************************************************************
+// Actors
+
+class ComponentActor : public Actor
+{
+public:
+    ComponentActor() : Actor("component"), component_(nullptr)
+    {
+    }
+
+    Component *component_;
+
+protected:
+    void receive(const ActorMessage &message) override
+    {
+        component_->handle(message.value, message.sent_us);
+    }
+};
+
+static Result runActors(uint32_t n)
+{
+    Result result;
+    std::vector<Component> components(n);
+    std::vector<ComponentActor> actors(n);
+    {
+        ActorSystem system;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            actors[i].component_ = &components[i];
+            if (!system.attach(&actors[i], mailbox_size))
+            {
+                result.errors++;
+                return result;
+            }
+        }
+        system.begin(workers_per_core);
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                while (!system.send(&actors[i], MSG_SAMPLE, r))
+                {
+                    result.retries++;
+                    std::this_thread::yield();
+                }
+            }
+            roundGap();
+        }
+
+        // end() discards queued messages, so wait for the workers to drain
+        for (uint32_t i = 0; i < n; i++)
+        {
+            while (components[i].handled.load() < rounds)
+            {
+                roundGap();
+            }
+        }
+        system.end();
+
+        if (n <= 3)
+        {
+            system.printStats([](const char *line) { printf("  %s\n", line); });
+        }
+    }
+    summarize(components, &result);
+    result.memory = n * (sizeof(ComponentActor) + mailbox_size * sizeof(ActorMessage)) +
+                    workers_per_core * PORT_NUM_CORES * defaultStack() + sizeof(ActorSystem);
+    return result;
+}
+
+//*****************************************************************************
+// Main
+
+static bool report(const char *label, uint32_t n, const Result &result)
+{
+    bool ok = result.handled == n * rounds && result.errors == 0;
+    printf("%-8s %4lu components: p50 %5lu us  p99 %5lu us  max %6lu us  mem %9lu B  full %5lu  %s\n",
+           label,
+           (unsigned long)n,
+           (unsigned long)result.latency_us.percentile(50),
+           (unsigned long)result.latency_us.percentile(99),
+           (unsigned long)result.latency_us.max(),
+           (unsigned long)result.memory,
+           (unsigned long)result.retries,
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main()
+{
+    static const uint32_t sizes[] = {3, 100};
+    bool ok = true;
+
+    printf("=== %lu rounds, one message per component every %lu us ===\n",
+           (unsigned long)rounds, (unsigned long)round_gap_us);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        uint32_t n = sizes[s];
+        Result threads = runThreads(n);
+        Result actors = runActors(n);
+        ok = report("threads", n, threads) && ok;
+        ok = report("actors", n, actors) && ok;
+        printf("memory saved by actors: %.1f%%\n\n",
+               100.0 * (1.0 - (double)actors.memory / (double)threads.memory));
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
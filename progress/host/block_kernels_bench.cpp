@@ -0,0 +1,196 @@
+/**
+ * Host benchmark: block kernels, scalar vs SWAR vs SSE2/AVX2
+ *
+ * For block sizes 16 to 4096 the program times every kernel of every
+ * variant (ns per sample) and checks that each result equals the scalar
+ * reference. The check also covers unaligned buffers, full-range 16-bit
+ * values (which force the SWAR fallback) and odd lengths. Prints PASS/FAIL.
+ *
+ * Build and run from the repository root (add -mavx2 for the AVX2 path):
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/BlockKernels/src \
+ *       progress/host/block_kernels_bench.cpp lib/BlockKernels/src/BlockKernels.cpp \
+ *       lib/BlockKernels/src/BlockKernelsSimd.cpp -o block_kernels_bench && ./block_kernels_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include <BlockKernels.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t block_sizes[] = {16, 64, 256, 1024, 4096};
+static const uint32_t samples_per_case = 1 << 22;
+static const uint16_t offset = 2048;
+static const int16_t gain_q15 = 26214; // 0.8
+static const uint16_t threshold = 2500;
+
+static volatile uint64_t sink = 0;
+
+enum Kernel
+{
+    KERNEL_SUM = 0,
+    KERNEL_MINMAX,
+    KERNEL_SCALE,
+    KERNEL_DOT,
+    KERNEL_COUNT,
+    NUM_KERNELS
+};
+
+static const char *kernel_names[NUM_KERNELS] = {"sum", "min/max", "scale+offset", "dot", "count>t"};
+
+struct Buffers
+{
+    std::vector<uint16_t> in;
+    std::vector<int16_t> a;
+    std::vector<int16_t> b;
+    std::vector<int16_t> out;
+};
+
+// One kernel call; the result folded into a number so variants can be compared
+static uint64_t runKernel(const BlockKernelSet *set, Kernel kernel, Buffers &buf, uint32_t start, uint32_t n)
+{
+    switch (kernel)
+    {
+    case KERNEL_SUM:
+        return set->sum(&buf.in[start], n);
+    case KERNEL_MINMAX:
+    {
+        BlockMinMax mm = set->minMax(&buf.in[start], n);
+        return ((uint64_t)mm.min << 16) | mm.max;
+    }
+    case KERNEL_SCALE:
+    {
+        set->scaleOffset(&buf.in[start], &buf.out[0], n, offset, gain_q15);
+        uint64_t hash = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            hash = hash * 31 + (uint16_t)buf.out[i];
+        }
+        return hash;
+    }
+    case KERNEL_DOT:
+        return (uint64_t)set->dot(&buf.a[start], &buf.b[start], n);
+    case KERNEL_COUNT:
+        return set->countAbove(&buf.in[start], n, threshold);
+    default:
+        return 0;
+    }
+}
+
+static double nsPerSample(const BlockKernelSet *set, Kernel kernel, Buffers &buf, uint32_t n)
+{
+    uint32_t calls = samples_per_case / n;
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t c = 0; c < calls; c++)
+    {
+        switch (kernel)
+        {
+        case KERNEL_SUM:
+            sink = sink + set->sum(&buf.in[0], n);
+            break;
+        case KERNEL_MINMAX:
+            sink = sink + set->minMax(&buf.in[0], n).max;
+            break;
+        case KERNEL_SCALE:
+            set->scaleOffset(&buf.in[0], &buf.out[0], n, offset, gain_q15);
+            sink = sink + buf.out[n - 1];
+            break;
+        case KERNEL_DOT:
+            sink = sink + set->dot(&buf.a[0], &buf.b[0], n);
+            break;
+        case KERNEL_COUNT:
+            sink = sink + set->countAbove(&buf.in[0], n, threshold);
+            break;
+        default:
+            break;
+        }
+    }
+    return (double)(monotonicNanos() - t0) / ((double)calls * n);
+}
+
+static void fill(Buffers &buf, uint32_t n, bool full_range)
+{
+    buf.in.resize(n + 8);
+    buf.a.resize(n + 8);
+    buf.b.resize(n + 8);
+    buf.out.resize(n + 8);
+    for (uint32_t i = 0; i < n + 8; i++)
+    {
+        buf.in[i] = full_range ? (uint16_t)rand() : (uint16_t)(2048 + (rand() % 2048) - 1024);
+        buf.a[i] = (int16_t)((rand() % 65535) - 32767);
+        buf.b[i] = (int16_t)((rand() % 65535) - 32767);
+    }
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    std::vector<const BlockKernelSet *> sets = {&block_kernels_scalar, &block_kernels_swar};
+    if (blockKernelsSimd() != nullptr)
+    {
+        sets.push_back(blockKernelsSimd());
+    }
+    printf("Variants:");
+    for (const BlockKernelSet *set : sets)
+    {
+        printf(" %s", set->name);
+    }
+    printf(" (best: %s)\n", blockKernelsBest()->name);
+
+    // Correctness: odd lengths, unaligned starts, 12-bit and full-range data
+    bool ok = true;
+    Buffers buf;
+    for (int full_range = 0; full_range < 2; full_range++)
+    {
+        fill(buf, 4096, full_range != 0);
+        for (uint32_t n = 0; n <= 300; n += 7)
+        {
+            for (uint32_t start = 0; start < 4; start++)
+            {
+                for (int k = 0; k < NUM_KERNELS; k++)
+                {
+                    uint64_t expected = runKernel(&block_kernels_scalar, (Kernel)k, buf, start, n);
+                    for (const BlockKernelSet *set : sets)
+                    {
+                        if (runKernel(set, (Kernel)k, buf, start, n) != expected)
+                        {
+                            printf("MISMATCH %s %s n=%lu start=%lu full_range=%d\n",
+                                   set->name, kernel_names[k], (unsigned long)n, (unsigned long)start, full_range);
+                            ok = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Timing: ns per sample, 12-bit ADC-like data
+    for (int k = 0; k < NUM_KERNELS; k++)
+    {
+        printf("\n%s (ns/sample)\n", kernel_names[k]);
+        for (uint32_t n : block_sizes)
+        {
+            fill(buf, n, false);
+            printf("  n=%4lu", (unsigned long)n);
+            double scalar_ns = 0;
+            for (const BlockKernelSet *set : sets)
+            {
+                double ns = nsPerSample(set, (Kernel)k, buf, n);
+                if (set == &block_kernels_scalar)
+                {
+                    scalar_ns = ns;
+                }
+                printf("  %s=%6.3f (x%4.1f)", set->name, ns, scalar_ns / ns);
+            }
+            printf("\n");
+        }
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
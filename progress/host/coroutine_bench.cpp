@@ -0,0 +1,287 @@
+/**
+ * Host benchmark: CoRuntime coroutines vs threads
+ *
+ *   memory       heap per actor: coroutine frame vs the stack a thread
+ *                reserves (the ESP32 numbers come from
+ *                progress/part10_coroutine_philosophers.cpp)
+ *   switch       ping-pong between two actors through a semaphore, time per
+ *                hand-off: CoSemaphore on one executor vs two threads
+ *   notify       another thread wakes a coroutine with notify(), round trip
+ *   philosophers the src/main.cpp workload on coroutines: N philosophers,
+ *                an arbitrator admitting N-1, chopsticks as CoSemaphores,
+ *                for 5 and 1000 philosophers
+ *
+ * Prints PASS/FAIL: every philosopher eats every meal, every notification
+ * arrives.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++20 -pthread -Ilib/PortUtils/src -Ilib/TimingWheel/src -Ilib/CoRuntime/src \
+ *       progress/host/coroutine_bench.cpp lib/CoRuntime/src/CoRuntime.cpp \
+ *       lib/TimingWheel/src/TimingWheel.cpp -o coroutine_bench && ./coroutine_bench
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <CoRuntime.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t memory_actors = 10000;
+static const uint32_t ping_pongs = 1000000;
+static const uint32_t thread_ping_pongs = 100000;
+static const uint32_t notifications = 1000;
+static const uint32_t meals = 5;
+static const uint32_t eat_ms = 10;
+static const uint32_t max_think_ms = 5;
+
+// Counting semaphore for the thread version
+class Semaphore
+{
+public:
+    void give()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_++;
+        cond_.notify_one();
+    }
+
+    void take()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return count_ > 0; });
+        count_--;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    uint32_t count_ = 0;
+};
+
+//*****************************************************************************
+// Memory
+
+static CoTask idleActor(uint32_t ms)
+{
+    co_await coDelay(ms);
+}
+
+static void measureMemory()
+{
+    CoExecutor executor;
+    size_t before = CoExecutor::frameBytes();
+    for (uint32_t i = 0; i < memory_actors; i++)
+    {
+        executor.spawn(idleActor(1));
+    }
+    size_t frames = CoExecutor::frameBytes() - before;
+    executor.run();
+
+    pthread_attr_t attr;
+    size_t stack = 0;
+    pthread_attr_init(&attr);
+    pthread_attr_getstacksize(&attr, &stack);
+    pthread_attr_destroy(&attr);
+
+    printf("\n=== Memory per actor ===\n");
+    printf("coroutine frame      %6lu B (%lu actors)\n",
+           (unsigned long)(frames / memory_actors), (unsigned long)memory_actors);
+    printf("thread stack         %6lu B reserved (default)\n", (unsigned long)stack);
+    printf("ESP32 task           TCB + 1024-2048 B stack\n");
+}
+
+//*****************************************************************************
+// Switch cost
+
+static CoSemaphore ping_sem(0);
+static CoSemaphore pong_sem(0);
+
+static CoTask pinger(uint32_t rounds)
+{
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        ping_sem.give();
+        co_await pong_sem.take();
+    }
+}
+
+static CoTask ponger(uint32_t rounds)
+{
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        co_await ping_sem.take();
+        pong_sem.give();
+    }
+}
+
+static Semaphore thread_ping;
+static Semaphore thread_pong;
+
+static void threadPonger(uint32_t rounds)
+{
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        thread_ping.take();
+        thread_pong.give();
+    }
+}
+
+static void measureSwitch()
+{
+    CoExecutor executor;
+    executor.spawn(pinger(ping_pongs));
+    executor.spawn(ponger(ping_pongs));
+    uint64_t t0 = monotonicNanos();
+    executor.run();
+    double co_ns = (double)(monotonicNanos() - t0) / (2.0 * ping_pongs);
+
+    std::thread other(threadPonger, thread_ping_pongs);
+    t0 = monotonicNanos();
+    for (uint32_t i = 0; i < thread_ping_pongs; i++)
+    {
+        thread_ping.give();
+        thread_pong.take();
+    }
+    double thread_ns = (double)(monotonicNanos() - t0) / (2.0 * thread_ping_pongs);
+    other.join();
+
+    printf("\n=== Switch (semaphore ping-pong) ===\n");
+    printf("coroutines  %8.1f ns per hand-off (%lu resumes)\n", co_ns, (unsigned long)executor.switches());
+    printf("threads     %8.1f ns per hand-off\n", thread_ns);
+    printf("speedup     %8.1fx\n", thread_ns / co_ns);
+}
+
+//*****************************************************************************
+// Notify from another thread
+
+static std::atomic<uint32_t> received(0);
+
+static CoTask listener(uint32_t count)
+{
+    while (received.load() < count)
+    {
+        uint32_t bits = co_await coNotified(1);
+        if (bits & 1)
+        {
+            received.fetch_add(1);
+        }
+    }
+}
+
+static bool measureNotify()
+{
+    CoExecutor executor;
+    executor.spawn(listener(notifications));
+    received.store(0);
+    uint64_t t0 = 0;
+
+    std::thread sender([&executor, &t0] {
+        t0 = monotonicNanos();
+        for (uint32_t i = 0; i < notifications; i++)
+        {
+            executor.notify(1);
+            while (received.load() == i)
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    executor.run();
+    uint64_t elapsed = monotonicNanos() - t0;
+    sender.join();
+
+    printf("\n=== notify() from another thread ===\n");
+    printf("%lu round trips, %.1f us each\n",
+           (unsigned long)received.load(), (double)elapsed / 1000.0 / notifications);
+    return received.load() == notifications;
+}
+
+//*****************************************************************************
+// Philosophers
+
+struct Table
+{
+    CoSemaphore arbitrator;
+    std::vector<CoSemaphore> chopsticks;
+    uint32_t meals_eaten;
+
+    explicit Table(uint32_t n) : arbitrator(n - 1), chopsticks(n, CoSemaphore(1)), meals_eaten(0)
+    {
+    }
+};
+
+static CoTask philosopher(Table *table, uint32_t num)
+{
+    uint32_t n = table->chopsticks.size();
+    CoSemaphore &left = table->chopsticks[num];
+    CoSemaphore &right = table->chopsticks[(num + 1) % n];
+
+    for (uint32_t meal = 0; meal < meals; meal++)
+    {
+        co_await coDelay(rand() % (max_think_ms + 1)); // Think
+
+        co_await table->arbitrator.take();
+        co_await left.take();
+        co_await coDelay(1); // Force contention, as the sketch does
+        co_await right.take();
+
+        co_await coDelay(eat_ms); // Eat
+        table->meals_eaten++;
+
+        right.give();
+        left.give();
+        table->arbitrator.give();
+    }
+}
+
+static bool runPhilosophers(uint32_t n)
+{
+    Table table(n);
+    CoExecutor executor;
+    size_t before = CoExecutor::frameBytes();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        executor.spawn(philosopher(&table, i));
+    }
+    size_t frames = CoExecutor::frameBytes() - before;
+
+    uint64_t t0 = monotonicMicros();
+    executor.run();
+    uint64_t elapsed_us = monotonicMicros() - t0;
+
+    bool ok = table.meals_eaten == n * meals;
+    printf("%6lu philosophers: %6lu meals in %6.3f s, %5lu B frame each, %8lu resumes -> %s\n",
+           (unsigned long)n,
+           (unsigned long)table.meals_eaten,
+           elapsed_us / 1e6,
+           (unsigned long)(frames / n),
+           (unsigned long)executor.switches(),
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    srand(1);
+    measureMemory();
+    measureSwitch();
+    bool ok = measureNotify();
+
+    printf("\n=== Philosophers (arbitrator, %lu meals each) ===\n", (unsigned long)meals);
+    ok = runPhilosophers(5) && ok;
+    ok = runPhilosophers(1000) && ok;
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/**
+ * Host check and benchmark: wait-for-graph deadlock detector
+ *
+ * Reproduces part10_deadlock.cpp with threads: Task A takes mutex 1, then
+ * mutex 2; Task B takes mutex 2, then mutex 1, with a 1 ms pause in between
+ * so they really deadlock, every round. A monitor thread runs
+ * DeadlockDetector::scan() every interval and the recovery callback aborts
+ * the wait of the lower-priority task (B), which backs off and retries, as
+ * in progress/part10_deadlock_detector.cpp.
+ *
+ * For each scan interval: deadlocks found, time from the deadlock forming
+ * to the report, and whether both tasks finished all rounds. Then the cost
+ * of one scan against the number of waiting tasks. Prints PASS/FAIL.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/DeadlockDetector/src \
+ *       progress/host/deadlock_detector_bench.cpp lib/DeadlockDetector/src/DeadlockDetector.cpp \
+ *       -o deadlock_detector_bench && ./deadlock_detector_bench
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <DeadlockDetector.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t rounds = 5;
+static const uint32_t intervals_ms[] = {5, 20, 100};
+static const uint32_t num_intervals = sizeof(intervals_ms) / sizeof(intervals_ms[0]);
+static const uint32_t work_ms = 2;
+static const uint32_t backoff_ms = 5;
+static const uint32_t poll_us = 200; // How often a blocked thread checks for an abort
+static const uint32_t timing_scans = 20000;
+
+// What a FreeRTOS task handle gives the firmware: name, priority, abort
+struct HostTask
+{
+    const char *name;
+    int priority;
+    std::atomic<bool> abort;
+};
+
+// std::mutex does not know its owner, unlike a FreeRTOS mutex
+struct MonitoredMutex
+{
+    std::timed_mutex mutex;
+    std::atomic<HostTask *> holder;
+};
+
+static void *mutexHolder(void *lock)
+{
+    return ((MonitoredMutex *)lock)->holder.load();
+}
+
+// Globals
+static DeadlockDetector detector(mutexHolder);
+static MonitoredMutex mutex_1;
+static MonitoredMutex mutex_2;
+static std::vector<std::string> report;
+static std::mutex report_lock;
+static std::atomic<uint64_t> formed_ns(0); // Second wait of the round began
+static std::vector<uint64_t> latencies_ns;
+
+static void collectLine(const char *line)
+{
+    std::lock_guard<std::mutex> guard(report_lock);
+    report.push_back(line);
+}
+
+//*****************************************************************************
+// Task side
+
+// DeadlockDetector::take() on the target
+static bool take(HostTask *task, MonitoredMutex *m)
+{
+    if (!m->mutex.try_lock())
+    {
+        int32_t slot = detector.waitBegin(task, task->name, m);
+        bool taken = false;
+        while (!taken && !task->abort.exchange(false))
+        {
+            taken = m->mutex.try_lock_for(std::chrono::microseconds(poll_us));
+        }
+        detector.waitEnd(slot);
+        if (!taken)
+        {
+            return false;
+        }
+    }
+    m->holder.store(task);
+    return true;
+}
+
+static void give(MonitoredMutex *m)
+{
+    m->holder.store(nullptr);
+    m->mutex.unlock();
+}
+
+static void runTask(HostTask *task, MonitoredMutex *first, MonitoredMutex *second, std::atomic<uint32_t> *done)
+{
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        while (1)
+        {
+            take(task, first);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            formed_ns.store(monotonicNanos());
+            if (take(task, second))
+            {
+                break;
+            }
+            give(first);
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(work_ms));
+        give(second);
+        give(first);
+        done->fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(work_ms));
+    }
+}
+
+//*****************************************************************************
+// Monitor side
+
+static void abortLowestPriority(const DeadlockCycle &cycle, void *context)
+{
+    latencies_ns.push_back(monotonicNanos() - formed_ns.load());
+    HostTask *victim = (HostTask *)cycle.tasks[0];
+    for (uint32_t i = 1; i < cycle.length; i++)
+    {
+        HostTask *task = (HostTask *)cycle.tasks[i];
+        victim = (task->priority < victim->priority) ? task : victim;
+    }
+    victim->abort.store(true);
+}
+
+static bool runScenario(uint32_t interval_ms)
+{
+    HostTask task_a = {"Task A", 2, {false}};
+    HostTask task_b = {"Task B", 1, {false}};
+    std::atomic<uint32_t> done_a(0);
+    std::atomic<uint32_t> done_b(0);
+    std::atomic<bool> stop(false);
+    report.clear();
+    latencies_ns.clear();
+    detector.resetStats();
+
+    std::thread monitor([&] {
+        while (!stop.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+            detector.scan();
+        }
+    });
+    std::thread a(runTask, &task_a, &mutex_1, &mutex_2, &done_a);
+    std::thread b(runTask, &task_b, &mutex_2, &mutex_1, &done_b);
+    a.join();
+    b.join();
+    stop.store(true);
+    monitor.join();
+
+    DeadlockDetectorStats s = detector.stats();
+    uint64_t worst = 0;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < latencies_ns.size(); i++)
+    {
+        worst = (latencies_ns[i] > worst) ? latencies_ns[i] : worst;
+        sum += latencies_ns[i];
+    }
+    bool named = report.size() == 3 * s.cycles && s.cycles > 0 &&
+                 (report[1].find("Task A waits for \"mutex 2\", held by Task B") != std::string::npos ||
+                  report[2].find("Task A waits for \"mutex 2\", held by Task B") != std::string::npos);
+    bool ok = done_a == rounds && done_b == rounds && named;
+    printf("%8lu ms %7lu %9lu %14.1f %14.1f %8s\n",
+           (unsigned long)interval_ms,
+           (unsigned long)s.scans,
+           (unsigned long)s.cycles,
+           s.cycles ? sum / 1e6 / s.cycles : 0.0,
+           worst / 1e6,
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+//*****************************************************************************
+// Scan cost
+
+static void *fake_holders[DeadlockDetector::MAX_WAITERS];
+static void *fakeHolder(void *lock)
+{
+    return fake_holders[(uintptr_t)lock - 1];
+}
+
+static void timeScans()
+{
+    static const uint32_t waiter_counts[] = {0, 2, 8, 32};
+    printf("\n%8s %14s %14s\n", "waiters", "chain ns/scan", "cycle ns/scan");
+    for (uint32_t c = 0; c < sizeof(waiter_counts) / sizeof(waiter_counts[0]); c++)
+    {
+        uint32_t n = waiter_counts[c];
+        double ns[2];
+        // Task i waits for lock i + 1, held by task i + 1: a chain, or a
+        // cycle when the last lock is held by task 0
+        for (uint32_t cyclic = 0; cyclic < 2; cyclic++)
+        {
+            DeadlockDetector d(fakeHolder);
+            d.setReporter(nullptr);
+            static uintptr_t tasks[DeadlockDetector::MAX_WAITERS];
+            for (uint32_t i = 0; i < n; i++)
+            {
+                tasks[i] = 0x1000 + 16 * i;
+                fake_holders[i] = (i + 1 < n) ? (void *)(uintptr_t)(0x1000 + 16 * (i + 1)) : (cyclic ? (void *)(uintptr_t)0x1000 : nullptr);
+                d.waitBegin((void *)tasks[i], "task", (void *)(uintptr_t)(i + 1));
+            }
+            uint64_t t0 = monotonicNanos();
+            for (uint32_t s = 0; s < timing_scans; s++)
+            {
+                d.scan();
+            }
+            ns[cyclic] = (double)(monotonicNanos() - t0) / timing_scans;
+        }
+        printf("%8lu %14.0f %14.0f\n", (unsigned long)n, ns[0], ns[1]);
+    }
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    mutex_1.holder.store(nullptr);
+    mutex_2.holder.store(nullptr);
+    detector.addLock(&mutex_1, "mutex 1");
+    detector.addLock(&mutex_2, "mutex 2");
+    detector.setReporter(collectLine);
+    detector.setRecovery(abortLowestPriority, nullptr);
+
+    printf("part10_deadlock, %lu rounds per task\n", (unsigned long)rounds);
+    printf("%11s %7s %9s %14s %14s %8s\n", "interval", "scans", "deadlocks", "avg report ms", "max report ms", "");
+    bool ok = true;
+    for (uint32_t i = 0; i < num_intervals; i++)
+    {
+        ok = runScenario(intervals_ms[i]) && ok;
+    }
+    printf("\nFirst report:\n");
+    for (size_t i = 0; i < report.size() && i < 3; i++)
+    {
+        printf("%s\n", report[i].c_str());
+    }
+
+    timeScans();
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/**
+ * Host build: dining philosophers benchmark across the part10 strategies
+ *
+ * Runs naive, hierarchy, arbitrator, uniform, timeout and waiter (see
+ * lib/DiningPhilosophers/src/DiningStrategy.h) with the same table and
+ * prints meals/s, wait mean / p99 / max, Jain's fairness index, timeouts
+ * and deadlocks, the same table progress/part10_dining_bench.cpp prints on
+ * the ESP32.
+ *
+ *   dining_bench [philosophers] [meals] [think_us] [eat_us] [one|spread|any]
+ *
+ * Naive and uniform may deadlock; that is detected (no meal for stall_ms),
+ * counted and the run aborted. Then the waiter's speedup over the
+ * one-at-a-time arbitrator of src/main.cpp with 5 and 50 philosophers.
+ * PASS if every strategy that cannot deadlock served every meal and the
+ * waiter beats the arbitrator.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/Histogram/src -Ilib/DiningPhilosophers/src \
+ *       progress/host/dining_bench.cpp lib/DiningPhilosophers/src/DiningBench.cpp \
+ *       lib/DiningPhilosophers/src/DiningStrategy.cpp -o dining_bench && ./dining_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <DiningBench.h>
+
+// Settings
+static const uint32_t stall_ms = 1000;
+static const uint32_t naive_pause_us = 1000; // Between chopsticks, as in the sketches
+static const uint32_t timeout_us = 20000;    // Timeout strategy, per chopstick
+static const uint32_t speedup_tables[] = {5, 50};
+
+static void writeLine(const char *line)
+{
+    printf("%s\n", line);
+}
+
+int main(int argc, char **argv)
+{
+    DiningConfig config = diningDefaultConfig();
+    config.stall_ms = stall_ms;
+    if (argc > 1)
+    {
+        config.philosophers = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        config.meals = strtoul(argv[2], NULL, 10);
+    }
+    if (argc > 3)
+    {
+        config.think_us = strtoul(argv[3], NULL, 10);
+    }
+    if (argc > 4)
+    {
+        config.eat_us = strtoul(argv[4], NULL, 10);
+    }
+    if (argc > 5)
+    {
+        config.placement = (strcmp(argv[5], "spread") == 0) ? DINING_SPREAD
+                           : (strcmp(argv[5], "any") == 0)   ? DINING_ANY_CORE
+                                                             : DINING_ONE_CORE;
+    }
+
+    NaiveDining naive(naive_pause_us);
+    HierarchyDining hierarchy;
+    ArbitratorDining arbitrator;
+    UniformDining uniform;
+    TimeoutDining timeout(timeout_us);
+    WaiterDining waiter;
+    DiningStrategy *strategies[] = {&naive, &hierarchy, &arbitrator, &uniform, &timeout, &waiter};
+    bool can_deadlock[] = {true, false, false, true, false, false};
+
+    printf("%lu philosophers, %lu meals each, think %lu us, eat %lu us, %s\n\n",
+           (unsigned long)config.philosophers,
+           (unsigned long)config.meals,
+           (unsigned long)config.think_us,
+           (unsigned long)config.eat_us,
+           diningPlacementName(config.placement));
+    printDiningHeader(writeLine);
+
+    bool ok = true;
+    for (uint32_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++)
+    {
+        DiningResult result;
+        if (!runDiningBench(*strategies[s], config, &result))
+        {
+            printf("%s: failed to set up the table\n", strategies[s]->name());
+            ok = false;
+            continue;
+        }
+        printDiningResult(writeLine, result);
+        if (!can_deadlock[s])
+        {
+            ok = ok && !result.deadlocked && result.meals == config.philosophers * config.meals;
+        }
+    }
+
+    // Waiter vs arbitrator
+    printf("\n%12s %16s %16s %8s\n", "philosophers", "arbitrator m/s", "waiter m/s", "speedup");
+    for (uint32_t t = 0; t < sizeof(speedup_tables) / sizeof(speedup_tables[0]); t++)
+    {
+        DiningConfig table = config;
+        table.philosophers = speedup_tables[t];
+        DiningResult serial;
+        DiningResult parallel;
+        bool ran = runDiningBench(arbitrator, table, &serial) && runDiningBench(waiter, table, &parallel);
+        float speedup = (ran && serial.meals_per_s > 0) ? parallel.meals_per_s / serial.meals_per_s : 0.0f;
+        printf("%12lu %16.1f %16.1f %7.2fx\n",
+               (unsigned long)table.philosophers,
+               serial.meals_per_s,
+               parallel.meals_per_s,
+               speedup);
+        ok = ok && ran && !parallel.deadlocked && speedup > 1.0f;
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+/**
+ * Host harness: timer "ISR" to thread latency, per stage and mechanism
+ *
+ * The Linux counterpart of progress/part9_isr_latency.cpp. A POSIX timer
+ * (CLOCK_MONOTONIC, absolute start, fixed interval) raises a real-time
+ * signal; the signal handler plays the ISR and a waiting thread plays the
+ * task. Stages and histograms come from the same LatencyStages code:
+ *
+ *   entry  - timer expiry to signal handler entry
+ *   signal - the async-signal-safe wake-up call in the handler
+ *   wake   - handler return until the waiting thread runs
+ *   total  - expiry to thread
+ *
+ * The expiry time is known exactly: start + k * period. Mechanisms map onto
+ * the nearest async-signal-safe POSIX primitive:
+ *
+ *   binary semaphore  -> sem_post() / sem_wait()
+ *   task notification -> eventfd counter
+ *   queue             -> POSIX message queue carrying the sequence number
+ *   stream buffer     -> pipe carrying the sequence number as bytes
+ *
+ * Both threads are pinned to one CPU, like the timer ISR and the task on
+ * one ESP32 core, and run SCHED_FIFO with the handler's thread above the
+ * waiter so the handler is never preempted by the thread it wakes. Without
+ * permission for SCHED_FIFO they keep default scheduling and the numbers get
+ * noisier. Expect microseconds to tens of microseconds on a desktop kernel.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/Histogram/src -Ilib/IsrLatency/src \
+ *       progress/host/isr_latency_bench.cpp lib/IsrLatency/src/IsrLatency.cpp \
+ *       -lrt -o isr_latency_bench && ./isr_latency_bench
+ */
+
+#include <fcntl.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include <IsrLatency.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint64_t period_ns = 1000000; // One expiry per ms
+static const uint32_t samples_per_run = 3000;
+static const uint32_t trace_slots = 8;     // Power of two
+static const int alarm_signal_offset = 0;  // SIGRTMIN + offset
+
+enum Mechanism
+{
+    MECH_SEMAPHORE = 0,
+    MECH_NOTIFY,
+    MECH_QUEUE,
+    MECH_STREAM,
+    NUM_MECHANISMS
+};
+
+static const char *const mechanism_names[NUM_MECHANISMS] = {
+    "binary semaphore", "task notification", "queue", "stream buffer"};
+
+// Globals
+static sem_t sem;
+static int event_fd = -1;
+static mqd_t queue = (mqd_t)-1;
+static int stream_fds[2] = {-1, -1};
+static std::atomic<int> mechanism(MECH_SEMAPHORE);
+static int main_cpu = 0;
+
+static uint64_t alarm_base_ns = 0; // Expiry k happens at alarm_base_ns + k * period_ns
+static LatencyTrace traces[trace_slots];
+static std::atomic<uint32_t> published_seq(0);
+static LatencyStages results[NUM_MECHANISMS];
+
+static void writeLine(const char *line)
+{
+    printf("%s\n", line);
+}
+
+//*****************************************************************************
+// "ISR"
+
+static void onAlarm(int signo)
+{
+    uint64_t now = monotonicNanos();
+    uint32_t entry = (uint32_t)now;
+    uint32_t since_alarm = (uint32_t)((now - alarm_base_ns) % period_ns);
+
+    uint32_t seq = published_seq.load(std::memory_order_relaxed) + 1;
+    LatencyTrace *trace = &traces[seq & (trace_slots - 1)];
+    trace->alarm = entry - since_alarm;
+    trace->entry = entry;
+
+    uint64_t one = 1;
+    switch (mechanism.load(std::memory_order_relaxed))
+    {
+    case MECH_SEMAPHORE:
+        sem_post(&sem);
+        break;
+    case MECH_NOTIFY:
+        (void)!write(event_fd, &one, sizeof(one));
+        break;
+    case MECH_QUEUE:
+        mq_send(queue, (const char *)&seq, sizeof(seq), 0);
+        break;
+    default:
+        (void)!write(stream_fds[1], &seq, sizeof(seq));
+        break;
+    }
+    trace->signaled = cpuCycleCount();
+    published_seq.store(seq, std::memory_order_release);
+}
+
+//*****************************************************************************
+// Waiting thread
+
+static void waitForSignal(Mechanism mech)
+{
+    uint32_t seq;
+    uint64_t count;
+    switch (mech)
+    {
+    case MECH_SEMAPHORE:
+        while (sem_wait(&sem) != 0)
+        {
+        }
+        break;
+    case MECH_NOTIFY:
+        (void)!read(event_fd, &count, sizeof(count));
+        break;
+    case MECH_QUEUE:
+        mq_receive(queue, (char *)&seq, sizeof(seq), nullptr);
+        break;
+    default:
+        (void)!read(stream_fds[0], &seq, sizeof(seq));
+        break;
+    }
+}
+
+static void drain()
+{
+    uint32_t seq;
+    uint64_t count;
+    while (sem_trywait(&sem) == 0)
+    {
+    }
+    struct timespec now = {0, 0};
+    while (mq_timedreceive(queue, (char *)&seq, sizeof(seq), nullptr, &now) > 0)
+    {
+    }
+    int flags = fcntl(stream_fds[0], F_GETFL);
+    fcntl(stream_fds[0], F_SETFL, flags | O_NONBLOCK);
+    while (read(stream_fds[0], &seq, sizeof(seq)) > 0)
+    {
+    }
+    fcntl(stream_fds[0], F_SETFL, flags);
+    flags = fcntl(event_fd, F_GETFL);
+    fcntl(event_fd, F_SETFL, flags | O_NONBLOCK);
+    (void)!read(event_fd, &count, sizeof(count));
+    fcntl(event_fd, F_SETFL, flags);
+}
+
+static void armTimer(timer_t timer, bool on)
+{
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (on)
+    {
+        alarm_base_ns = (monotonicNanos() / period_ns + 2) * period_ns;
+        spec.it_value.tv_sec = (time_t)(alarm_base_ns / 1000000000u);
+        spec.it_value.tv_nsec = (long)(alarm_base_ns % 1000000000u);
+        spec.it_interval.tv_nsec = (long)period_ns;
+    }
+    timer_settime(timer, on ? TIMER_ABSTIME : 0, &spec, nullptr);
+}
+
+static uint32_t runMechanism(timer_t timer, Mechanism mech)
+{
+    LatencyStages &stages = results[mech];
+    stages.reset();
+    drain();
+
+    mechanism.store(mech);
+    uint32_t handled = published_seq.load();
+    uint32_t missed = 0;
+    armTimer(timer, true);
+
+    while (stages.stage(LatencyStages::STAGE_TOTAL).count() < samples_per_run)
+    {
+        waitForSignal(mech);
+        uint32_t resumed = cpuCycleCount();
+
+        // Without SCHED_FIFO the waiter may run before the handler returns
+        uint32_t seq = published_seq.load(std::memory_order_acquire);
+        uint64_t spin_start = monotonicNanos();
+        while (seq == handled && monotonicNanos() - spin_start < period_ns)
+        {
+            sched_yield();
+            seq = published_seq.load(std::memory_order_acquire);
+        }
+        if (seq == handled)
+        {
+            continue;
+        }
+        missed += seq - handled - 1;
+        handled = seq;
+
+        LatencyTrace trace = traces[seq & (trace_slots - 1)];
+        trace.resumed = resumed;
+        stages.record(trace);
+    }
+    armTimer(timer, false);
+    return missed;
+}
+
+// Pin to the CPU main() runs on; true if SCHED_FIFO at priority was granted
+static bool makeRealtime(int cpu, int priority)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+    struct sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+static void *waiterThread(void *arg)
+{
+    timer_t timer = *(timer_t *)arg;
+    makeRealtime(main_cpu, sched_get_priority_max(SCHED_FIFO) - 1);
+
+    for (uint32_t m = 0; m < NUM_MECHANISMS; m++)
+    {
+        uint32_t missed = runMechanism(timer, (Mechanism)m);
+        results[m].printTo(writeLine, mechanism_names[m]);
+        printf("missed expiries: %lu\n", (unsigned long)missed);
+    }
+    return nullptr;
+}
+
+static void printComparison()
+{
+    printf("\n=== p50 / p99 / max (ns) ===\n");
+    printf("%-18s", "mechanism");
+    for (uint32_t s = 0; s < LatencyStages::NUM_STAGES; s++)
+    {
+        printf(" %24s", LatencyStages::stageName(s));
+    }
+    printf("\n");
+
+    for (uint32_t m = 0; m < NUM_MECHANISMS; m++)
+    {
+        printf("%-18s", mechanism_names[m]);
+        for (uint32_t s = 0; s < LatencyStages::NUM_STAGES; s++)
+        {
+            const LogHistogram &h = results[m].stage(s);
+            printf(" %7lu/%7lu/%8lu",
+                   (unsigned long)h.percentile(50),
+                   (unsigned long)h.percentile(99),
+                   (unsigned long)h.max());
+        }
+        printf("\n");
+    }
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    int signo = SIGRTMIN + alarm_signal_offset;
+
+    struct mq_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.mq_maxmsg = 4;
+    attr.mq_msgsize = sizeof(uint32_t);
+    char queue_name[32];
+    snprintf(queue_name, sizeof(queue_name), "/isr_latency_%d", (int)getpid());
+    queue = mq_open(queue_name, O_RDWR | O_CREAT | O_EXCL, 0600, &attr);
+    mq_unlink(queue_name);
+
+    if (sem_init(&sem, 0, 0) != 0 || (event_fd = eventfd(0, 0)) < 0 || queue == (mqd_t)-1 || pipe(stream_fds) != 0)
+    {
+        printf("Failed to create signalling objects\n");
+        return 1;
+    }
+
+    // Only the main thread takes the signal, like an ISR interrupting
+    // whatever runs on its core; the waiter blocks it
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, signo);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onAlarm;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(signo, &action, nullptr);
+
+    struct sigevent event;
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = signo;
+    timer_t timer;
+    if (timer_create(CLOCK_MONOTONIC, &event, &timer) != 0)
+    {
+        printf("Failed to create timer\n");
+        return 1;
+    }
+
+    // The handler runs on this thread: pin it and put it above the waiter
+    main_cpu = sched_getcpu() < 0 ? 0 : sched_getcpu();
+    bool realtime = makeRealtime(main_cpu, sched_get_priority_max(SCHED_FIFO));
+    printf("CPU %d, %s\n", main_cpu, realtime ? "SCHED_FIFO" : "default scheduling (no permission for SCHED_FIFO)");
+
+    pthread_t waiter;
+    pthread_create(&waiter, nullptr, waiterThread, &timer);
+    pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+
+    pthread_join(waiter, nullptr);
+    timer_delete(timer);
+    printComparison();
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * Host benchmark: a thread per short-lived job vs JobScheduler
+ *
+ * The workload is the producer of part7_semaphore.cpp with the waiting
+ * taken out: a short body that writes its number and ends. 100 of them are
+ * started at once, over and over:
+ *
+ *   threads  a thread per producer, created, run to completion, joined,
+ *            as xTaskCreatePinnedToCore() + vTaskDelete(NULL) do
+ *   jobs     100 BasicJobs on one JobScheduler level, each activated once
+ *            per round; they all run on the level's thread
+ *
+ * Reported: time per dispatch (start to finished, per job) and memory:
+ * the stacks the threads reserve vs the job objects plus one level stack.
+ * On the ESP32 each producer is a task with a 1024 B stack, see
+ * progress/part10_shared_stack_jobs.cpp.
+ *
+ * Also checked: a level runs its ready jobs by priority, FIFO among
+ * equals, and rejects activations beyond max_activations.
+ *
+ * Prints PASS/FAIL.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/Histogram/src -Ilib/JobScheduler/src \
+ *       progress/host/job_bench.cpp lib/JobScheduler/src/JobScheduler.cpp \
+ *       -o job_bench && ./job_bench
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+
+#include <JobScheduler.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t num_jobs = 100;
+static const uint32_t thread_rounds = 50;
+static const uint32_t job_rounds = 2000;
+static const uint32_t level_stack_size = 4096; // What the ESP32 level would get
+
+static std::atomic<uint32_t> finished(0);
+static std::atomic<uint64_t> checksum(0);
+
+// The producer, minus its waits
+static void producer(void *parameters)
+{
+    uint32_t num = (uint32_t)(uintptr_t)parameters;
+    checksum.fetch_add(num, std::memory_order_relaxed);
+    finished.fetch_add(1, std::memory_order_release);
+}
+
+static size_t defaultStack()
+{
+    pthread_attr_t attr;
+    size_t stack = 0;
+    pthread_attr_init(&attr);
+    pthread_attr_getstacksize(&attr, &stack);
+    pthread_attr_destroy(&attr);
+    return stack;
+}
+
+static void waitFinished(uint32_t count)
+{
+    while (finished.load(std::memory_order_acquire) < count)
+    {
+        std::this_thread::yield();
+    }
+}
+
+//*****************************************************************************
+// Dispatch
+
+static double runThreads()
+{
+    finished.store(0);
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t r = 0; r < thread_rounds; r++)
+    {
+        std::thread threads[num_jobs];
+        for (uint32_t i = 0; i < num_jobs; i++)
+        {
+            threads[i] = std::thread(producer, (void *)(uintptr_t)i);
+        }
+        for (uint32_t i = 0; i < num_jobs; i++)
+        {
+            threads[i].join();
+        }
+    }
+    return (double)(monotonicNanos() - t0) / ((double)thread_rounds * num_jobs);
+}
+
+static double runJobs(JobScheduler &jobs, BasicJob *producers)
+{
+    finished.store(0);
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t r = 0; r < job_rounds; r++)
+    {
+        for (uint32_t i = 0; i < num_jobs; i++)
+        {
+            jobs.activate(&producers[i]);
+        }
+        waitFinished((r + 1) * num_jobs);
+    }
+    return (double)(monotonicNanos() - t0) / ((double)job_rounds * num_jobs);
+}
+
+//*****************************************************************************
+// Ordering and activation limits
+
+static std::atomic<bool> gate_open(false);
+static std::atomic<bool> gate_entered(false);
+static uint32_t run_order[num_jobs + 2]; // Plus the two runs of the repeated job
+static std::atomic<uint32_t> run_count(0);
+
+// Holds the level so the test can queue jobs behind it
+static void gate(void *parameters)
+{
+    gate_entered.store(true);
+    while (!gate_open.load())
+    {
+        std::this_thread::yield();
+    }
+}
+
+static void recordRun(void *parameters)
+{
+    run_order[run_count.fetch_add(1)] = (uint32_t)(uintptr_t)parameters;
+}
+
+static bool checkOrder()
+{
+    static const JobLevelConfig level = {"order", 1, level_stack_size};
+    static BasicJob gate_job;
+    static BasicJob ordered[num_jobs];
+    static BasicJob repeated;
+
+    JobScheduler jobs;
+    jobs.begin(&level, 1);
+    JobScheduler::initJob(&gate_job, gate, nullptr, 0);
+    JobScheduler::initJob(&repeated, recordRun, (void *)(uintptr_t)num_jobs, 0, 0, 2);
+    for (uint32_t i = 0; i < num_jobs; i++)
+    {
+        JobScheduler::initJob(&ordered[i], recordRun, (void *)(uintptr_t)i, 0, (uint8_t)(i % 4));
+    }
+
+    jobs.activate(&gate_job);
+    while (!gate_entered.load())
+    {
+        std::this_thread::yield();
+    }
+    for (uint32_t i = 0; i < num_jobs; i++)
+    {
+        jobs.activate(&ordered[i]);
+    }
+    bool limits = jobs.activate(&repeated) && jobs.activate(&repeated) && !jobs.activate(&repeated);
+    gate_open.store(true);
+    while (jobs.pending(&repeated) > 0 || run_count < num_jobs + 2)
+    {
+        std::this_thread::yield();
+    }
+    jobs.end();
+
+    // Priority 3 first, each priority in activation order; the priority-0
+    // repeated job was activated last, so its runs come last
+    bool ordered_ok = true;
+    uint32_t n = 0;
+    for (int p = 3; p >= 0; p--)
+    {
+        for (uint32_t i = (uint32_t)p; i < num_jobs; i += 4)
+        {
+            ordered_ok = ordered_ok && run_order[n++] == i;
+        }
+    }
+    ordered_ok = ordered_ok && run_order[n] == num_jobs && run_order[n + 1] == num_jobs;
+
+    const JobLevelStats &stats = jobs.stats(0);
+    limits = limits && repeated.runs == 2 && stats.rejected == 1;
+
+    printf("\n=== Ready queue ===\n");
+    printf("%lu jobs queued behind a running one, 4 priorities: %s\n",
+           (unsigned long)num_jobs, ordered_ok ? "run by priority, FIFO among equals" : "WRONG ORDER");
+    printf("3 activations of a job with max_activations 2: %lu runs, %lu rejected -> %s\n",
+           (unsigned long)repeated.runs, (unsigned long)stats.rejected, limits ? "ok" : "FAIL");
+    jobs.printStats([](const char *line) { printf("  %s\n", line); });
+    return ordered_ok && limits;
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    static const JobLevelConfig level = {"producers", 1, level_stack_size};
+    static BasicJob producers[num_jobs];
+
+    JobScheduler jobs;
+    for (uint32_t i = 0; i < num_jobs; i++)
+    {
+        JobScheduler::initJob(&producers[i], producer, (void *)(uintptr_t)i, 0);
+    }
+    jobs.begin(&level, 1);
+
+    double thread_ns = runThreads();
+    bool ok = checksum.load() == (uint64_t)thread_rounds * num_jobs * (num_jobs - 1) / 2;
+    checksum.store(0);
+    double job_ns = runJobs(jobs, producers);
+    ok = ok && checksum.load() == (uint64_t)job_rounds * num_jobs * (num_jobs - 1) / 2;
+    jobs.end();
+
+    size_t thread_bytes = num_jobs * defaultStack();
+    size_t job_bytes = num_jobs * sizeof(BasicJob) + level_stack_size + sizeof(JobScheduler);
+
+    printf("=== %lu concurrent producers ===\n", (unsigned long)num_jobs);
+    printf("thread per job  %8.0f ns per dispatch  %9lu B of stack reserved\n",
+           thread_ns, (unsigned long)thread_bytes);
+    printf("basic jobs      %8.0f ns per dispatch  %9lu B (%lu B per job + one %lu B level stack)\n",
+           job_ns, (unsigned long)job_bytes, (unsigned long)sizeof(BasicJob), (unsigned long)level_stack_size);
+    printf("speedup %.1fx, memory saved %.1f%%\n",
+           thread_ns / job_ns, 100.0 * (1.0 - (double)job_bytes / (double)thread_bytes));
+    jobs.printStats([](const char *line) { printf("  %s\n", line); });
+
+    ok = checkOrder() && ok;
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
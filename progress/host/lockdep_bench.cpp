@@ -0,0 +1,246 @@
+/**
+ * Host check and benchmark: lock-order validator (LockDep)
+ *
+ * Runs the lock orders of the part10 sketches through LockOrderGraph with
+ * std::mutex and threads standing in for FreeRTOS mutexes and tasks:
+ *
+ *   part10_deadlock            Task A takes 1 then 2, later Task B takes 2
+ *                              then 1. The tasks run one after the other, so
+ *                              nothing hangs, and the inversion must still be
+ *                              reported, naming both tasks
+ *   philosophers, naive        each takes its left then right chopstick; the
+ *                              fifth closes the ring and must be reported
+ *   philosophers, hierarchy    lower-numbered chopstick first
+ *                              (part10_deadlock_hierarchy.cpp), all running
+ *                              at once: no report
+ *
+ * Then the cost per lock + unlock pair, nested two deep, with and without
+ * checking. Prints PASS/FAIL.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/LockDep/src \
+ *       progress/host/lockdep_bench.cpp lib/LockDep/src/LockOrderGraph.cpp \
+ *       -o lockdep_bench && ./lockdep_bench
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <LockOrderGraph.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t num_philosophers = 5;
+static const uint32_t meals = 20000;
+static const uint32_t timing_pairs = 2000000;
+
+// Globals
+static LockOrderGraph graph;
+static std::vector<std::string> report;
+
+static void collectLine(const char *line)
+{
+    printf("%s\n", line);
+    report.push_back(line);
+}
+
+static bool reportMentions(const char *text)
+{
+    for (size_t i = 0; i < report.size(); i++)
+    {
+        if (report[i].find(text) != std::string::npos)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// std::mutex with the same hooks lockdepTakeChecked() / lockdepGiveChecked() use
+class CheckedMutex
+{
+public:
+    void init(const char *name)
+    {
+        cls_ = graph.addClass(name);
+    }
+
+    void lock(const char *thread)
+    {
+        graph.beforeAcquire(cls_, thread);
+        mutex_.lock();
+        graph.acquired(cls_);
+    }
+
+    void unlock()
+    {
+        graph.released(cls_);
+        mutex_.unlock();
+    }
+
+    std::mutex &raw()
+    {
+        return mutex_;
+    }
+
+private:
+    std::mutex mutex_;
+    int32_t cls_;
+};
+
+static CheckedMutex mutex_1;
+static CheckedMutex mutex_2;
+static CheckedMutex chopstick[num_philosophers];
+static char chopstick_names[num_philosophers][16];
+
+//*****************************************************************************
+// Scenarios
+
+static bool checkTwoTasks()
+{
+    printf("=== part10_deadlock: two tasks, opposite order ===\n");
+    report.clear();
+    std::thread a([] {
+        mutex_1.lock("Task A");
+        mutex_2.lock("Task A");
+        mutex_2.unlock();
+        mutex_1.unlock();
+    });
+    a.join();
+    std::thread b([] {
+        mutex_2.lock("Task B");
+        mutex_1.lock("Task B");
+        mutex_1.unlock();
+        mutex_2.unlock();
+    });
+    b.join();
+
+    bool ok = graph.stats().violations == 1 && reportMentions("Task B takes \"mutex 1\" while holding \"mutex 2\"") &&
+              reportMentions("(Task A)");
+    printf("-> %s\n\n", ok ? "reported" : "FAIL");
+    return ok;
+}
+
+static void philosopher(uint32_t num, bool hierarchy, uint32_t rounds)
+{
+    char name[24];
+    snprintf(name, sizeof(name), "Philosopher %lu", (unsigned long)num);
+    uint32_t first = num;
+    uint32_t second = (num + 1) % num_philosophers;
+    if (hierarchy && second < first)
+    {
+        first = second;
+        second = num;
+    }
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        chopstick[first].lock(name);
+        chopstick[second].lock(name);
+        chopstick[second].unlock();
+        chopstick[first].unlock();
+    }
+}
+
+static bool checkPhilosophers(bool hierarchy)
+{
+    printf("=== philosophers, %s order ===\n", hierarchy ? "hierarchy" : "naive");
+    report.clear();
+    graph.clearEdges();
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < num_philosophers; i++)
+    {
+        if (hierarchy)
+        {
+            threads.emplace_back(philosopher, i, true, meals);
+        }
+        else
+        {
+            // One at a time: the naive order would really deadlock otherwise
+            std::thread t(philosopher, i, false, 1);
+            t.join();
+        }
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+
+    LockOrderStats stats = graph.stats();
+    bool ok = hierarchy ? stats.violations == 0
+                        : stats.violations == 1 && reportMentions("Philosopher 4 takes \"chopstick 0\" while holding \"chopstick 4\"");
+    printf("%lu edges, %lu violations -> %s\n\n",
+           (unsigned long)stats.new_edges,
+           (unsigned long)stats.violations,
+           ok ? (hierarchy ? "clean" : "reported") : "FAIL");
+    return ok;
+}
+
+//*****************************************************************************
+// Overhead
+
+static double timePlain()
+{
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t i = 0; i < timing_pairs; i++)
+    {
+        chopstick[0].raw().lock();
+        chopstick[1].raw().lock();
+        chopstick[1].raw().unlock();
+        chopstick[0].raw().unlock();
+    }
+    return (double)(monotonicNanos() - t0) / (2.0 * timing_pairs);
+}
+
+static double timeChecked()
+{
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t i = 0; i < timing_pairs; i++)
+    {
+        chopstick[0].lock("bench");
+        chopstick[1].lock("bench");
+        chopstick[1].unlock();
+        chopstick[0].unlock();
+    }
+    return (double)(monotonicNanos() - t0) / (2.0 * timing_pairs);
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    graph.setReporter(collectLine);
+    mutex_1.init("mutex 1");
+    mutex_2.init("mutex 2");
+    for (uint32_t i = 0; i < num_philosophers; i++)
+    {
+        snprintf(chopstick_names[i], sizeof(chopstick_names[i]), "chopstick %lu", (unsigned long)i);
+        chopstick[i].init(chopstick_names[i]);
+    }
+
+    bool ok = checkTwoTasks();
+    ok = checkPhilosophers(false) && ok;
+    ok = checkPhilosophers(true) && ok;
+
+    // Warm up both, then take the better of three runs
+    double plain = 1e9;
+    double checked = 1e9;
+    for (uint32_t run = 0; run < 3; run++)
+    {
+        double p = timePlain();
+        double c = timeChecked();
+        plain = (p < plain) ? p : plain;
+        checked = (c < checked) ? c : checked;
+    }
+    printf("Per lock + unlock, nested 2 deep: plain %.1f ns, checked %.1f ns (+%.1f ns)\n",
+           plain, checked, checked - plain);
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
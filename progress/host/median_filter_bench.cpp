@@ -0,0 +1,173 @@
+/**
+ * Host benchmark: sliding median vs re-sorting the window
+ *
+ * Part 1 measures nanoseconds per sample for window sizes 3 to 1023:
+ *
+ *   sort      - copy the window and std::sort it for every sample
+ *   insertion - keep the window sorted, one insert/remove per sample (O(n))
+ *   fenwick   - SlidingMedian, O(log V) per sample
+ *
+ * Every variant's output is compared with the sort result, and any
+ * mismatch is a FAIL.
+ *
+ * Part 2 runs HampelFilter on a noisy 12-bit signal with known injected
+ * spikes and reports how many spikes were caught and how many clean
+ * samples were wrongly replaced.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/MedianFilter/src \
+ *       progress/host/median_filter_bench.cpp lib/MedianFilter/src/MedianFilter.cpp \
+ *       -o median_filter_bench && ./median_filter_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <MedianFilter.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t num_samples = 100000;
+static const uint32_t windows[] = {3, 7, 15, 63, 255, 1023};
+static const uint32_t spike_every = 97;
+static const uint32_t hampel_window = 15;
+
+static volatile uint32_t sink = 0;
+
+static std::vector<uint16_t> makeSignal(uint32_t count, std::vector<bool> *spikes)
+{
+    std::vector<uint16_t> out(count);
+    if (spikes != nullptr)
+    {
+        spikes->assign(count, false);
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t value = 2048 + (int32_t)(i % 2000) / 4 + (rand() % 17) - 8;
+        if (spikes != nullptr && i % spike_every == spike_every - 1)
+        {
+            value += (rand() % 2) ? 1200 : -1200;
+            (*spikes)[i] = true;
+        }
+        out[i] = (uint16_t)value;
+    }
+    return out;
+}
+
+//*****************************************************************************
+// Reference implementations
+
+// The naive approach: sort a copy of the window for every sample
+static void sortMedians(const std::vector<uint16_t> &in, uint32_t window, std::vector<uint16_t> &out)
+{
+    std::vector<uint16_t> scratch(window);
+    for (uint32_t n = 0; n < in.size(); n++)
+    {
+        uint32_t fill = (n + 1 < window) ? n + 1 : window;
+        memcpy(scratch.data(), &in[n + 1 - fill], fill * sizeof(uint16_t));
+        std::sort(scratch.begin(), scratch.begin() + fill);
+        out[n] = scratch[(fill + 1) / 2 - 1];
+    }
+}
+
+// Sorted window kept up to date with one removal and one insertion
+static void insertionMedians(const std::vector<uint16_t> &in, uint32_t window, std::vector<uint16_t> &out)
+{
+    std::vector<uint16_t> sorted;
+    sorted.reserve(window);
+    for (uint32_t n = 0; n < in.size(); n++)
+    {
+        if (sorted.size() == window)
+        {
+            sorted.erase(std::lower_bound(sorted.begin(), sorted.end(), in[n - window]));
+        }
+        sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), in[n]), in[n]);
+        out[n] = sorted[(sorted.size() + 1) / 2 - 1];
+    }
+}
+
+static void fenwickMedians(const std::vector<uint16_t> &in, uint32_t window, std::vector<uint16_t> &out)
+{
+    SlidingMedian median;
+    median.begin(window);
+    for (uint32_t n = 0; n < in.size(); n++)
+    {
+        out[n] = median.push(in[n]);
+    }
+}
+
+typedef void (*MedianFunction)(const std::vector<uint16_t> &, uint32_t, std::vector<uint16_t> &);
+
+static double nsPerSample(MedianFunction function, const std::vector<uint16_t> &in, uint32_t window, std::vector<uint16_t> &out)
+{
+    uint64_t t0 = monotonicNanos();
+    function(in, window, out);
+    return (double)(monotonicNanos() - t0) / in.size();
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    std::vector<uint16_t> signal = makeSignal(num_samples, nullptr);
+    std::vector<uint16_t> expected(num_samples);
+    std::vector<uint16_t> got(num_samples);
+    bool ok = true;
+
+    printf("Median cost per sample (%lu samples)\n", (unsigned long)num_samples);
+    for (uint32_t window : windows)
+    {
+        double sort_ns = nsPerSample(sortMedians, signal, window, expected);
+        double insertion_ns = nsPerSample(insertionMedians, signal, window, got);
+        bool insertion_ok = (got == expected);
+        double fenwick_ns = nsPerSample(fenwickMedians, signal, window, got);
+        bool fenwick_ok = (got == expected);
+        ok = ok && insertion_ok && fenwick_ok;
+
+        printf("  window=%4lu sort=%9.1f ns  insertion=%7.1f ns%s  fenwick=%6.1f ns%s\n",
+               (unsigned long)window,
+               sort_ns,
+               insertion_ns,
+               insertion_ok ? "" : " (MISMATCH)",
+               fenwick_ns,
+               fenwick_ok ? "" : " (MISMATCH)");
+    }
+
+    std::vector<bool> spikes;
+    std::vector<uint16_t> noisy = makeSignal(num_samples, &spikes);
+    HampelFilter hampel;
+    hampel.begin(hampel_window, 3.0f);
+
+    uint32_t caught = 0;
+    uint32_t missed = 0;
+    uint32_t false_alarms = 0;
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        sink = sink + hampel.filter(noisy[i]);
+        if (spikes[i])
+        {
+            hampel.lastWasOutlier() ? caught++ : missed++;
+        }
+        else if (hampel.lastWasOutlier())
+        {
+            false_alarms++;
+        }
+    }
+    double hampel_ns = (double)(monotonicNanos() - t0) / num_samples;
+
+    printf("\nHampel filter (window=%lu, k=3): %.1f ns/sample, spikes caught=%lu missed=%lu, clean samples replaced=%lu\n",
+           (unsigned long)hampel_window,
+           hampel_ns,
+           (unsigned long)caught,
+           (unsigned long)missed,
+           (unsigned long)false_alarms);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,301 @@
+/**
+ * Host benchmark: MultiLock vs hand-written two-mutex acquisition
+ *
+ * Threads repeatedly take a set of mutexes, touch a counter behind each one
+ * and give them back. Four ways to take the set:
+ *
+ *   hand hierarchy   lower-numbered mutex first (part10_deadlock_hierarchy.cpp)
+ *   hand timeout     own order, timed take; on timeout give back and sleep
+ *                    (part10_deadlock_timeout.cpp, scaled to microseconds)
+ *   MultiLock order  MultiLock, ordered by rank
+ *   MultiLock try    MultiLock, try-all-or-none with randomized backoff
+ *
+ * Two workloads: the part10 pair (Task A wants 1 then 2, Task B 2 then 1)
+ * and a wider one (threads each take 3 random mutexes out of 8). Reports
+ * sets taken per second and checks every counter against the number of
+ * sets taken (a lost update would mean the set was not really held).
+ * Prints PASS/FAIL.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/MultiLock/src \
+ *       progress/host/multi_lock_bench.cpp lib/MultiLock/src/MultiLock.cpp \
+ *       -o multi_lock_bench && ./multi_lock_bench
+ */
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <MultiLock.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t run_ms = 300;
+static const uint32_t num_mutexes = 8;
+static const uint32_t wide_threads = 4;
+static const uint32_t wide_set = 3;
+static const uint32_t hold_ns = 2000;            // Critical section
+static const uint32_t gap_ns = 1000;             // Between sets
+static const uint32_t hand_timeout_us = 1000;    // part10_deadlock_timeout: 1000 ms
+static const uint32_t hand_sleep_us = 500;       // and 500 ms, scaled down
+
+enum Method
+{
+    HAND_HIERARCHY = 0,
+    HAND_TIMEOUT,
+    MULTI_ORDERED,
+    MULTI_TRY_ALL,
+    NUM_METHODS
+};
+
+static const char *const method_names[NUM_METHODS] = {"hand hierarchy", "hand timeout", "MultiLock order", "MultiLock try"};
+
+// Globals
+static std::timed_mutex mutexes[num_mutexes];
+static uint32_t counters[num_mutexes]; // Only touched with the mutex held
+static std::atomic<bool> running(false);
+
+static void spinNs(uint32_t ns)
+{
+    uint64_t end = monotonicNanos() + ns;
+    while (monotonicNanos() < end)
+    {
+    }
+}
+
+//*****************************************************************************
+// One set, four ways
+
+static void criticalSection(const uint32_t *set, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        counters[set[i]] = counters[set[i]] + 1;
+    }
+    spinNs(hold_ns);
+}
+
+static void handHierarchy(const uint32_t *set, uint32_t n)
+{
+    uint32_t sorted[num_mutexes];
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > set[i])
+        {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = set[i];
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        mutexes[sorted[i]].lock();
+    }
+    criticalSection(set, n);
+    for (uint32_t i = n; i-- > 0;)
+    {
+        mutexes[sorted[i]].unlock();
+    }
+}
+
+// False if a take timed out; everything is given back then
+static bool handTimeout(const uint32_t *set, uint32_t n)
+{
+    uint32_t taken = 0;
+    while (taken < n && mutexes[set[taken]].try_lock_for(std::chrono::microseconds(hand_timeout_us)))
+    {
+        taken++;
+    }
+    bool ok = taken == n;
+    if (ok)
+    {
+        criticalSection(set, n);
+    }
+    while (taken > 0)
+    {
+        mutexes[set[--taken]].unlock();
+    }
+    return ok;
+}
+
+static void multiLock(const uint32_t *set, uint32_t n, MultiLockMode mode)
+{
+    MultiLockHandle handles[num_mutexes];
+    for (uint32_t i = 0; i < n; i++)
+    {
+        handles[i] = &mutexes[set[i]];
+    }
+    MultiLock lock(handles, n, mode);
+    criticalSection(set, n);
+}
+
+//*****************************************************************************
+// Workloads
+
+struct Worker
+{
+    Method method;
+    uint32_t first;  // Pair workload: mutex taken first by hand
+    bool wide;
+    uint32_t sets;
+    uint32_t timeouts;
+    uint32_t seed;
+};
+
+static uint32_t nextRandom(uint32_t *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+static void work(Worker *w)
+{
+    while (!running.load())
+    {
+    }
+    while (running.load(std::memory_order_relaxed))
+    {
+        uint32_t set[wide_set];
+        uint32_t n = 2;
+        if (w->wide)
+        {
+            // Distinct random mutexes, in random order
+            n = 0;
+            while (n < wide_set)
+            {
+                uint32_t m = nextRandom(&w->seed) % num_mutexes;
+                bool dup = false;
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    dup = dup || set[i] == m;
+                }
+                if (!dup)
+                {
+                    set[n++] = m;
+                }
+            }
+        }
+        else
+        {
+            set[0] = w->first;
+            set[1] = 1 - w->first;
+        }
+
+        switch (w->method)
+        {
+        case HAND_HIERARCHY:
+            handHierarchy(set, n);
+            break;
+        case HAND_TIMEOUT:
+            if (!handTimeout(set, n))
+            {
+                w->timeouts++;
+                std::this_thread::sleep_for(std::chrono::microseconds(hand_sleep_us));
+                continue;
+            }
+            break;
+        case MULTI_ORDERED:
+            multiLock(set, n, MULTI_LOCK_ORDERED);
+            break;
+        default:
+            multiLock(set, n, MULTI_LOCK_TRY_ALL);
+            break;
+        }
+        w->sets++;
+        spinNs(gap_ns);
+    }
+}
+
+// Returns false if a counter disagrees with the sets taken
+static bool run(Method method, bool wide, uint32_t threads)
+{
+    for (uint32_t i = 0; i < num_mutexes; i++)
+    {
+        counters[i] = 0;
+    }
+    std::vector<Worker> workers(threads);
+    std::vector<std::thread> pool;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers[t].method = method;
+        workers[t].first = t & 1; // Task A: 0 then 1, Task B: 1 then 0
+        workers[t].wide = wide;
+        workers[t].sets = 0;
+        workers[t].timeouts = 0;
+        workers[t].seed = 0x9E3779B9u * (t + 1);
+        pool.emplace_back(work, &workers[t]);
+    }
+    running.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(run_ms));
+    running.store(false);
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        pool[t].join();
+    }
+
+    uint64_t sets = 0;
+    uint64_t timeouts = 0;
+    uint64_t touches = 0;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        sets += workers[t].sets;
+        timeouts += workers[t].timeouts;
+    }
+    for (uint32_t i = 0; i < num_mutexes; i++)
+    {
+        touches += counters[i];
+    }
+    bool ok = touches == sets * (wide ? wide_set : 2);
+    printf("%-16s %12.0f %10llu %s\n",
+           method_names[method],
+           sets * 1000.0 / run_ms,
+           (unsigned long long)timeouts,
+           ok ? "" : "LOST UPDATES");
+    return ok;
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    bool ok = true;
+    printf("part10 pair: Task A takes 1 then 2, Task B 2 then 1\n");
+    printf("%-16s %12s %10s\n", "method", "sets/s", "timeouts");
+    for (uint32_t m = 0; m < NUM_METHODS; m++)
+    {
+        ok = run((Method)m, false, 2) && ok;
+    }
+
+    printf("\n%lu threads, %lu random mutexes out of %lu\n",
+           (unsigned long)wide_threads, (unsigned long)wide_set, (unsigned long)num_mutexes);
+    printf("%-16s %12s %10s\n", "method", "sets/s", "timeouts");
+    for (uint32_t m = 0; m < NUM_METHODS; m++)
+    {
+        ok = run((Method)m, true, wide_threads) && ok;
+    }
+
+    // Try-all with a deadline gives up cleanly while another holds a member
+    mutexes[3].lock();
+    MultiLock lock({&mutexes[2], &mutexes[3]}, MULTI_LOCK_TRY_ALL, 5000);
+    bool gave_up = !lock.owns() && mutexes[2].try_lock();
+    if (gave_up)
+    {
+        mutexes[2].unlock();
+    }
+    mutexes[3].unlock();
+    printf("\nTry-all timeout with one member busy: %s after %lu attempts\n",
+           gave_up ? "gave up, nothing held" : "FAIL",
+           (unsigned long)lock.attempts());
+    ok = ok && gave_up;
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
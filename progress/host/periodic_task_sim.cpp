@@ -0,0 +1,194 @@
+/**
+ * Host simulation: vTaskDelay() loop vs absolute-release PeriodicSchedule
+ *
+ * Part 1 simulates 10,000 periods of a 10 ms task whose body takes 2-8 ms
+ * (with a rare 25 ms spike) and whose wake-up is delayed by a known random
+ * scheduling latency of 0-200 us:
+ *
+ *   relative  - the ledBlinkTask()/task1 pattern: body, then vTaskDelay(period)
+ *   absolute  - PeriodicSchedule, the same arithmetic PeriodicTask runs on
+ *               the ESP32
+ *
+ * Because the injected latency is known, the jitter histogram of the
+ * absolute schedule can be checked: every on-time job must show a jitter of
+ * at most the injected maximum, and the end-of-run drift must stay below one
+ * period. The program prints PASS/FAIL for both checks.
+ *
+ * The relative loop drifts by tens of seconds, far into the histogram's
+ * open-ended last bucket; a separate check records such values and requires
+ * p50 <= p99 <= max.
+ *
+ * Part 2 runs the schedule against the real clock with clock_nanosleep()
+ * (TIMER_ABSTIME) to show the host scheduler's own jitter.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/Histogram/src -Ilib/PeriodicTask/src \
+ *       progress/host/periodic_task_sim.cpp lib/PeriodicTask/src/PeriodicSchedule.cpp \
+ *       -o periodic_task_sim && ./periodic_task_sim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Histogram.h>
+#include <PeriodicSchedule.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t period_us = 10000;
+static const uint32_t num_periods = 10000;
+static const uint32_t body_min_us = 2000;
+static const uint32_t body_max_us = 8000;
+static const uint32_t spike_us = 25000;     // Occasional long job (overrun)
+static const uint32_t spike_every = 500;    // One spike per this many jobs
+static const uint32_t sched_max_us = 200;   // Injected wake-up latency bound
+static const uint32_t real_period_us = 5000;
+static const uint32_t real_periods = 400;
+
+static void writeLine(const char *line)
+{
+    printf("%s\n", line);
+}
+
+static uint32_t randomRange(uint32_t lo, uint32_t hi)
+{
+    return lo + (uint32_t)rand() % (hi - lo + 1);
+}
+
+static uint32_t bodyTime(uint32_t n)
+{
+    return (n % spike_every == spike_every - 1) ? spike_us : randomRange(body_min_us, body_max_us);
+}
+
+//*****************************************************************************
+// Part 1: simulation
+
+static void simulateRelative()
+{
+    LogHistogram jitter;
+    uint64_t now = 0;
+
+    srand(7);
+    for (uint32_t n = 0; n < num_periods; n++)
+    {
+        now += randomRange(0, sched_max_us);
+        // Nominal release of job n on an ideal timeline
+        uint64_t nominal = (uint64_t)n * period_us;
+        jitter.record((uint32_t)(now - nominal));
+        now += bodyTime(n);
+        now += period_us; // vTaskDelay(period) after the body
+    }
+
+    printf("relative (vTaskDelay): drift after %u periods = %llu us\n",
+           num_periods, (unsigned long long)(now - (uint64_t)num_periods * period_us));
+    jitter.printTo(writeLine, "  release error", "us");
+}
+
+static void simulateAbsolute()
+{
+    PeriodicSchedule schedule;
+    uint64_t now = 0;
+    uint32_t max_injected = 0;
+    uint32_t jobs = 0;
+
+    srand(7);
+    schedule.start(0, period_us);
+    for (uint32_t n = 0; jobs < num_periods; n++)
+    {
+        // Sleep until the release (if it is still ahead), then wake late
+        if (schedule.release() > now)
+        {
+            now = schedule.release();
+        }
+        uint32_t latency = randomRange(0, sched_max_us);
+        if (latency > max_injected)
+        {
+            max_injected = latency;
+        }
+        now += latency;
+
+        schedule.jobStarted(now);
+        now += bodyTime(n);
+        schedule.jobFinished(now);
+        jobs++;
+    }
+
+    // Drift: how far the next release is from where an ideal timeline puts it
+    uint64_t ideal = (uint64_t)(schedule.releases() + schedule.skipped()) * period_us;
+    uint64_t drift = schedule.release() - ideal;
+
+    printf("absolute (PeriodicSchedule): drift after %u periods = %llu us, overruns=%u skipped=%u\n",
+           num_periods, (unsigned long long)drift, schedule.overruns(), schedule.skipped());
+    schedule.jitter().printTo(writeLine, "  jitter", "us");
+    schedule.lateness().printTo(writeLine, "  lateness", "us");
+
+    // Jobs released right after an overrun legitimately start late; all
+    // others must see exactly the injected latency
+    uint32_t clean = schedule.releases() - 2 * schedule.overruns();
+    uint32_t within = 0;
+    for (uint32_t b = 0; b < LogHistogram::BUCKETS && LogHistogram::bucketLimit(b) <= 256; b++)
+    {
+        within += schedule.jitter().bucket(b);
+    }
+    printf("check jitter <= injected max (%u us) for on-time jobs: %s (%u of >= %u)\n",
+           max_injected, (within >= clean) ? "PASS" : "FAIL", within, clean);
+    printf("check drift < one period: %s\n", (drift < period_us) ? "PASS" : "FAIL");
+}
+
+// Values past 2^23 land in the last bucket, which has no upper bound
+static void checkOverflowBucket()
+{
+    LogHistogram h;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        h.record(50000000u + i * 100000u);
+    }
+    uint32_t p50 = h.percentile(50);
+    uint32_t p99 = h.percentile(99);
+    bool ok = p99 >= p50 && p99 <= h.max() && p99 >= LogHistogram::bucketLimit(LogHistogram::BUCKETS - 2);
+    printf("check percentiles above 2^23: p50=%u p99=%u max=%u %s\n",
+           p50, p99, h.max(), ok ? "PASS" : "FAIL");
+    h.printTo(writeLine, "  overflow", "us");
+}
+
+//*****************************************************************************
+// Part 2: real clock
+
+static void runRealClock()
+{
+    PeriodicSchedule schedule;
+    struct timespec ts;
+    volatile uint32_t sink = 0;
+
+    schedule.start(monotonicMicros(), real_period_us);
+    for (uint32_t n = 0; n < real_periods; n++)
+    {
+        uint64_t release = schedule.release();
+        ts.tv_sec = (time_t)(release / 1000000u);
+        ts.tv_nsec = (long)((release % 1000000u) * 1000u);
+        // monotonicMicros() is CLOCK_MONOTONIC, so sleep on the same clock
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        schedule.jobStarted(monotonicMicros());
+        for (uint32_t i = 0; i < 20000; i++)
+        {
+            sink = sink + i;
+        }
+        schedule.jobFinished(monotonicMicros());
+    }
+
+    printf("real clock, %u us period, %u releases: overruns=%u\n",
+           real_period_us, schedule.releases(), schedule.overruns());
+    schedule.jitter().printTo(writeLine, "  jitter", "us");
+}
+
+int main()
+{
+    printf("---Periodic Task Simulation (period %u us)---\n", period_us);
+    simulateRelative();
+    simulateAbsolute();
+    checkOverflowBucket();
+    runRealClock();
+    return 0;
+}
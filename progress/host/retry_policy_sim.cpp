@@ -0,0 +1,210 @@
+/**
+ * Host simulation: livelock in part10_deadlock_timeout.cpp and retry policies
+ *
+ * Simulates the two tasks of part10_deadlock_timeout.cpp tick by tick
+ * (1 ms, like the ESP32's FreeRTOS tick): Task A takes mutex 1, waits a
+ * tick, takes mutex 2; Task B the other way round. Every take has a
+ * 1000 ms timeout, the work takes 500 ms and after it both sleep 500 ms.
+ * After a timeout the task gives back what it holds and waits for the
+ * retry policy's delay. The original sketch waits a fixed 500 ms.
+ *
+ * Both tasks start on the same tick (one per core, or equal priorities).
+ * Timeouts are decided at the tick, so when both waits expire together
+ * both fail, even though one of them gives its mutex back right after.
+ * With a fixed delay they come back together and collide again, forever:
+ * a livelock.
+ *
+ * For each policy, over several seeds: work completed per second,
+ * timeouts, and livelock episodes as seen by LivelockDetector (threshold
+ * failures in a row with no success). Prints PASS/FAIL: the fixed delay
+ * must livelock and the jittered policies must not.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/RetryPolicy/src progress/host/retry_policy_sim.cpp \
+ *       lib/RetryPolicy/src/RetryPolicy.cpp -o retry_policy_sim && ./retry_policy_sim
+ */
+
+#include <stdio.h>
+
+#include <RetryPolicy.h>
+
+// Settings (ms, one tick each)
+static const uint32_t mutex_timeout = 1000;
+static const uint32_t work_ms = 500;
+static const uint32_t sleep_ms = 500;
+static const uint32_t sim_seconds = 600;
+static const uint32_t seeds = 20;
+static const uint32_t livelock_threshold = 4;
+static const uint32_t base_ms = 500; // Same as the sketch's sleep for every policy
+static const uint32_t max_ms = 4000;
+
+static const int NO_TASK = -1;
+
+enum SimState
+{
+    SIM_SLEEP = 0,
+    SIM_WAIT_FIRST,
+    SIM_PAUSE,
+    SIM_WAIT_SECOND,
+    SIM_WORK
+};
+
+struct SimTask
+{
+    uint32_t first;
+    uint32_t second;
+    SimState state;
+    uint32_t until; // Wake-up time or timeout deadline
+    uint32_t done;
+    uint32_t timeouts;
+};
+
+struct SimResult
+{
+    double work_per_s;
+    uint32_t timeouts;
+    uint32_t episodes;
+    bool stuck; // Ended in a livelock
+};
+
+//*****************************************************************************
+// Simulation
+
+static SimResult simulate(RetryKind kind, uint32_t seed)
+{
+    RetryConfig config = {kind, base_ms * 1000, max_ms * 1000};
+    RetryPolicy policies[2] = {RetryPolicy(config, seed * 2 + 1), RetryPolicy(config, seed * 2 + 2)};
+    LivelockDetector detector(livelock_threshold);
+    int holder[2] = {NO_TASK, NO_TASK};
+    SimTask tasks[2] = {{0, 1, SIM_SLEEP, 0, 0, 0}, {1, 0, SIM_SLEEP, 0, 0, 0}};
+
+    for (uint32_t now = 0; now < sim_seconds * 1000; now++)
+    {
+        // Tick interrupt: waits that expire on this tick fail, before
+        // either task runs and gives anything back (two cores, or equal
+        // priorities, wake on the same tick)
+        bool expired[2];
+        for (int id = 0; id < 2; id++)
+        {
+            const SimTask &t = tasks[id];
+            uint32_t wanted = (t.state == SIM_WAIT_FIRST) ? t.first : t.second;
+            expired[id] = (t.state == SIM_WAIT_FIRST || t.state == SIM_WAIT_SECOND) && now >= t.until &&
+                          holder[wanted] != NO_TASK;
+        }
+        for (int id = 0; id < 2; id++)
+        {
+            SimTask &t = tasks[id];
+            if (expired[id])
+            {
+                if (t.state == SIM_WAIT_SECOND)
+                {
+                    holder[t.first] = NO_TASK;
+                }
+                t.timeouts++;
+                detector.failure();
+                t.state = SIM_SLEEP;
+                t.until = now + policies[id].nextDelayUs() / 1000;
+            }
+        }
+
+        // Then the tasks run, Task A first (higher priority)
+        for (int id = 0; id < 2; id++)
+        {
+            SimTask &t = tasks[id];
+            if (expired[id])
+            {
+                continue;
+            }
+            if (t.state == SIM_SLEEP && now >= t.until)
+            {
+                t.state = SIM_WAIT_FIRST;
+                t.until = now + mutex_timeout;
+            }
+            if (t.state == SIM_WAIT_FIRST && holder[t.first] == NO_TASK)
+            {
+                holder[t.first] = id;
+                t.state = SIM_PAUSE;
+                t.until = now + 1; // vTaskDelay(1) between the takes
+            }
+            else if (t.state == SIM_PAUSE && now >= t.until)
+            {
+                t.state = SIM_WAIT_SECOND;
+                t.until = now + mutex_timeout;
+            }
+            if (t.state == SIM_WAIT_SECOND && holder[t.second] == NO_TASK)
+            {
+                holder[t.second] = id;
+                t.state = SIM_WORK;
+                t.until = now + work_ms;
+            }
+            else if (t.state == SIM_WORK && now >= t.until)
+            {
+                holder[t.second] = NO_TASK;
+                holder[t.first] = NO_TASK;
+                t.done++;
+                policies[id].reset();
+                detector.progress();
+                t.state = SIM_SLEEP;
+                t.until = now + sleep_ms;
+            }
+        }
+    }
+
+    SimResult result;
+    result.work_per_s = (double)(tasks[0].done + tasks[1].done) / sim_seconds;
+    result.timeouts = tasks[0].timeouts + tasks[1].timeouts;
+    result.episodes = detector.episodes();
+    result.stuck = detector.livelocked();
+    return result;
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    printf("part10_deadlock_timeout: timeout %lu ms, work %lu ms, sleep %lu ms, retry base %lu ms cap %lu ms\n",
+           (unsigned long)mutex_timeout, (unsigned long)work_ms, (unsigned long)sleep_ms,
+           (unsigned long)base_ms, (unsigned long)max_ms);
+    printf("%lu simulated seconds x %lu seeds\n\n", (unsigned long)sim_seconds, (unsigned long)seeds);
+    printf("%-13s %10s %10s %10s %10s %12s\n", "policy", "work/s", "min work/s", "timeouts", "episodes", "stuck runs");
+
+    bool ok = true;
+    for (uint32_t k = 0; k < NUM_RETRY_KINDS; k++)
+    {
+        double sum = 0;
+        double worst = 1e9;
+        uint32_t timeouts = 0;
+        uint32_t episodes = 0;
+        uint32_t stuck = 0;
+        for (uint32_t s = 0; s < seeds; s++)
+        {
+            SimResult r = simulate((RetryKind)k, s);
+            sum += r.work_per_s;
+            worst = (r.work_per_s < worst) ? r.work_per_s : worst;
+            timeouts += r.timeouts;
+            episodes += r.episodes;
+            stuck += r.stuck ? 1 : 0;
+        }
+        printf("%-13s %10.3f %10.3f %10lu %10lu %8lu/%lu\n",
+               retryKindName((RetryKind)k),
+               sum / seeds,
+               worst,
+               (unsigned long)(timeouts / seeds),
+               (unsigned long)(episodes / seeds),
+               (unsigned long)stuck,
+               (unsigned long)seeds);
+
+        if (k == RETRY_FIXED)
+        {
+            ok = ok && stuck == seeds && sum == 0;
+        }
+        else if (k == RETRY_FULL_JITTER || k == RETRY_DECORRELATED)
+        {
+            ok = ok && stuck == 0 && worst > 0;
+        }
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,414 @@
+/**
+ * Host tool: SampleCapture encoder benchmark, decoder and replayer
+ *
+ *   sample_capture_tool bench [samples]        compression ratio, encode and
+ *                                              decode ns/sample, round trip
+ *                                              and corruption checks
+ *   sample_capture_tool encode <samples> <out.cap> [block]
+ *   sample_capture_tool decode <in.cap> [out.txt]
+ *   sample_capture_tool replay <in.cap> <rate_hz> [block]
+ *
+ * <samples> is anything ReplaySampleSource loads: text (one value per line,
+ * as captured from the serial monitor) or raw little-endian .bin/.raw. With
+ * no file, bench uses synthetic 12-bit ADC data: a slow sine plus Gaussian
+ * noise of a few LSB and the odd spike. A capture streamed by
+ * progress/part9_isr_capture.cpp (stream_capture = true) can be saved with
+ * any raw serial logger and decoded here; text before or between blocks is
+ * skipped. replay decodes a capture and feeds it through ReplaySampleSource
+ * at the given rate, in blocks of the capture's block size.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/SampleSource/src -Ilib/SampleCapture/src \
+ *       progress/host/sample_capture_tool.cpp lib/SampleCapture/src/SampleCapture.cpp \
+ *       lib/SampleSource/src/ReplaySampleSource.cpp -o sample_capture_tool && ./sample_capture_tool bench
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <PortUtils.h>
+#include <ReplaySampleSource.h>
+#include <SampleCapture.h>
+
+// Settings
+static const uint32_t default_block = 256;
+static const uint32_t synthetic_samples = 1 << 20;
+static const uint32_t bench_repeats = 8;
+
+struct DecodeResult
+{
+    std::vector<uint16_t> samples;
+    uint32_t blocks = 0;
+    uint32_t bad_crc = 0;
+    uint32_t skipped_bytes = 0;
+    uint32_t lost_blocks = 0; // From sequence gaps
+    uint32_t block_size = 0;  // Largest block seen
+};
+
+//*****************************************************************************
+// Helpers
+
+static std::vector<uint16_t> syntheticAdc(uint32_t n)
+{
+    std::vector<uint16_t> out(n);
+    srand(1);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        // Box-Muller, sigma 4 LSB
+        double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+        double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+        double noise = 4.0 * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+        double value = 2048.0 + 600.0 * sin(2.0 * M_PI * i / 5000.0) + noise;
+        if (rand() % 2000 == 0)
+        {
+            value += 800.0; // Spike
+        }
+        out[i] = (uint16_t)(value < 0 ? 0 : (value > 4095 ? 4095 : value));
+    }
+    return out;
+}
+
+// Samples of a recording, read block by block through ReplaySampleSource
+static bool loadRecording(const char *path, std::vector<uint16_t> &out)
+{
+    ReplaySampleSource source;
+    if (!source.load(path) || !source.begin(0, 4096) || !source.start())
+    {
+        return false;
+    }
+    const SampleBlock *block;
+    while ((block = source.read(0)) != nullptr)
+    {
+        out.insert(out.end(), block->samples, block->samples + block->count);
+    }
+    return true;
+}
+
+static std::vector<uint8_t> encodeAll(const std::vector<uint16_t> &samples, uint32_t block, CaptureEncoding encoding)
+{
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> buf(captureMaxBlockBytes(block));
+    uint32_t sequence = 0;
+    for (size_t start = 0; start < samples.size(); start += block)
+    {
+        uint32_t count = (uint32_t)((samples.size() - start < block) ? samples.size() - start : block);
+        uint32_t bytes = encodeCaptureBlock(&samples[start], count, sequence, (uint64_t)start * 1000,
+                                            buf.data(), (uint32_t)buf.size(), encoding);
+        out.insert(out.end(), buf.begin(), buf.begin() + bytes);
+        sequence++;
+    }
+    return out;
+}
+
+// Decode a whole capture, skipping anything that is not a valid block
+static DecodeResult decodeAll(const std::vector<uint8_t> &data)
+{
+    DecodeResult result;
+    std::vector<uint16_t> block(CAPTURE_MAX_SAMPLES);
+    uint32_t pos = 0;
+    uint32_t next_sequence = 0;
+    while (pos < data.size())
+    {
+        CaptureBlockInfo info;
+        int32_t used = decodeCaptureBlock(&data[pos], (uint32_t)(data.size() - pos), &info, block.data(), CAPTURE_MAX_SAMPLES);
+        if (used == CAPTURE_NEED_MORE)
+        {
+            result.skipped_bytes += (uint32_t)(data.size() - pos); // Truncated tail
+            break;
+        }
+        if (used < 0)
+        {
+            result.bad_crc += (used == CAPTURE_BAD_CRC) ? 1 : 0;
+            uint32_t skip = 1 + findCaptureBlock(&data[pos + 1], (uint32_t)(data.size() - pos - 1));
+            result.skipped_bytes += skip;
+            pos += skip;
+            continue;
+        }
+
+        if (result.blocks > 0 && info.sequence != next_sequence)
+        {
+            result.lost_blocks += info.sequence - next_sequence;
+        }
+        next_sequence = info.sequence + 1;
+        result.samples.insert(result.samples.end(), block.begin(), block.begin() + info.count);
+        result.blocks++;
+        result.block_size = (info.count > result.block_size) ? info.count : result.block_size;
+        pos += (uint32_t)used;
+    }
+    return result;
+}
+
+static bool readFile(const char *path, std::vector<uint8_t> &out)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+    {
+        out.insert(out.end(), buf, buf + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static uint32_t textBytes(const std::vector<uint16_t> &samples)
+{
+    // Serial.println(sample): digits plus "\r\n"
+    uint32_t bytes = 0;
+    for (uint16_t s : samples)
+    {
+        bytes += (s >= 10000) ? 7 : (s >= 1000) ? 6 : (s >= 100) ? 5 : (s >= 10) ? 4 : 3;
+    }
+    return bytes;
+}
+
+//*****************************************************************************
+// Commands
+
+static int bench(const char *path)
+{
+    std::vector<uint16_t> samples;
+    if (path != nullptr)
+    {
+        if (!loadRecording(path, samples))
+        {
+            printf("Cannot load %s\n", path);
+            return 1;
+        }
+        printf("Recording %s: %zu samples\n", path, samples.size());
+    }
+    else
+    {
+        samples = syntheticAdc(synthetic_samples);
+        printf("Synthetic 12-bit ADC data: %zu samples\n", samples.size());
+    }
+
+    bool ok = true;
+    uint32_t text = textBytes(samples);
+    printf("As Serial.println text: %.2f bytes/sample\n\n", (double)text / samples.size());
+    printf("encoding block  bytes/sample  vs raw16  vs text  encode ns/sample  decode ns/sample\n");
+
+    const CaptureEncoding encodings[] = {CAPTURE_RAW, CAPTURE_VARINT, CAPTURE_PACKED, CAPTURE_AUTO};
+    const uint32_t blocks[] = {64, 256, 1024};
+    for (CaptureEncoding encoding : encodings)
+    {
+        for (uint32_t block : blocks)
+        {
+            std::vector<uint8_t> encoded;
+            uint64_t t0 = monotonicNanos();
+            for (uint32_t r = 0; r < bench_repeats; r++)
+            {
+                encoded = encodeAll(samples, block, encoding);
+            }
+            double encode_ns = (double)(monotonicNanos() - t0) / bench_repeats / samples.size();
+
+            DecodeResult decoded;
+            t0 = monotonicNanos();
+            for (uint32_t r = 0; r < bench_repeats; r++)
+            {
+                decoded = decodeAll(encoded);
+            }
+            double decode_ns = (double)(monotonicNanos() - t0) / bench_repeats / samples.size();
+
+            bool match = decoded.samples == samples && decoded.bad_crc == 0 && decoded.skipped_bytes == 0;
+            ok = ok && match;
+            double per_sample = (double)encoded.size() / samples.size();
+            printf("%-8s %5lu  %12.3f  %7.2fx  %6.2fx  %16.2f  %16.2f%s\n",
+                   captureEncodingName(encoding),
+                   (unsigned long)block,
+                   per_sample,
+                   2.0 / per_sample,
+                   (double)text / encoded.size(),
+                   encode_ns,
+                   decode_ns,
+                   match ? "" : "  ROUND TRIP FAILED");
+        }
+    }
+
+    // Corruption: flip a byte in every 10th block and put serial noise in
+    // front; the decoder must reject exactly those blocks and resync
+    std::vector<uint8_t> encoded = encodeAll(samples, default_block, CAPTURE_AUTO);
+    std::vector<uint32_t> starts;
+    std::vector<uint16_t> scratch(default_block);
+    uint32_t pos = 0;
+    while (pos < encoded.size())
+    {
+        CaptureBlockInfo info;
+        int32_t used = decodeCaptureBlock(&encoded[pos], (uint32_t)(encoded.size() - pos), &info, scratch.data(), default_block);
+        if (used <= 0)
+        {
+            break;
+        }
+        starts.push_back(pos);
+        pos += (uint32_t)used;
+    }
+    uint32_t corrupted = 0;
+    for (size_t b = 5; b + 1 < starts.size(); b += 10)
+    {
+        encoded[starts[b] + CAPTURE_HEADER_BYTES - 1] ^= 0x10;
+        corrupted++;
+    }
+    const char noise[] = "boot: rst:0x1 (POWERON_RESET)\r\n";
+    encoded.insert(encoded.begin(), noise, noise + sizeof(noise) - 1);
+
+    DecodeResult damaged = decodeAll(encoded);
+    bool resync = damaged.bad_crc == corrupted && damaged.blocks == starts.size() - corrupted &&
+                  damaged.lost_blocks == corrupted;
+    ok = ok && resync;
+    printf("\nCorruption: %lu blocks damaged, %lu CRC errors, %lu blocks decoded, %lu reported lost -> %s\n",
+           (unsigned long)corrupted,
+           (unsigned long)damaged.bad_crc,
+           (unsigned long)damaged.blocks,
+           (unsigned long)damaged.lost_blocks,
+           resync ? "ok" : "FAIL");
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+static int encode(const char *in_path, const char *out_path, uint32_t block)
+{
+    std::vector<uint16_t> samples;
+    if (!loadRecording(in_path, samples))
+    {
+        printf("Cannot load %s\n", in_path);
+        return 1;
+    }
+    std::vector<uint8_t> encoded = encodeAll(samples, block, CAPTURE_AUTO);
+    FILE *file = fopen(out_path, "wb");
+    if (file == nullptr || fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size())
+    {
+        printf("Cannot write %s\n", out_path);
+        return 1;
+    }
+    fclose(file);
+    printf("%zu samples -> %zu bytes (%.3f bytes/sample)\n",
+           samples.size(), encoded.size(), (double)encoded.size() / samples.size());
+    return 0;
+}
+
+static int decode(const char *in_path, const char *out_path)
+{
+    std::vector<uint8_t> data;
+    if (!readFile(in_path, data))
+    {
+        printf("Cannot read %s\n", in_path);
+        return 1;
+    }
+    DecodeResult result = decodeAll(data);
+    printf("%lu blocks, %zu samples, %lu CRC errors, %lu bytes skipped, %lu blocks lost\n",
+           (unsigned long)result.blocks,
+           result.samples.size(),
+           (unsigned long)result.bad_crc,
+           (unsigned long)result.skipped_bytes,
+           (unsigned long)result.lost_blocks);
+
+    if (out_path != nullptr)
+    {
+        FILE *file = fopen(out_path, "w");
+        if (file == nullptr)
+        {
+            printf("Cannot write %s\n", out_path);
+            return 1;
+        }
+        for (uint16_t s : result.samples)
+        {
+            fprintf(file, "%u\n", s);
+        }
+        fclose(file);
+    }
+    return 0;
+}
+
+static int replay(const char *in_path, uint32_t rate_hz, uint32_t block)
+{
+    std::vector<uint8_t> data;
+    if (!readFile(in_path, data))
+    {
+        printf("Cannot read %s\n", in_path);
+        return 1;
+    }
+    DecodeResult result = decodeAll(data);
+    if (block == 0)
+    {
+        block = result.block_size ? result.block_size : default_block;
+    }
+
+    ReplaySampleSource source;
+    if (!source.loadSamples(result.samples.data(), (uint32_t)result.samples.size()) ||
+        !source.begin(rate_hz, block) || !source.start())
+    {
+        printf("Nothing to replay\n");
+        return 1;
+    }
+
+    uint64_t t0 = monotonicMicros();
+    uint64_t last_report = t0;
+    uint64_t sum = 0;
+    uint32_t count = 0;
+    const SampleBlock *b;
+    while ((b = source.read(1000)) != nullptr || !source.finished())
+    {
+        if (b == nullptr)
+        {
+            continue;
+        }
+        for (uint32_t i = 0; i < b->count; i++)
+        {
+            sum += b->samples[i];
+        }
+        count += b->count;
+
+        uint64_t now = monotonicMicros();
+        if (now - last_report >= 1000000 || source.finished())
+        {
+            SampleSourceStats stats = source.stats();
+            printf("t=%6.2f s avg=%4lu samples=%lu blocks=%lu overruns=%lu\n",
+                   (now - t0) / 1e6,
+                   (unsigned long)(count ? sum / count : 0),
+                   (unsigned long)stats.samples,
+                   (unsigned long)stats.blocks,
+                   (unsigned long)stats.overruns);
+            last_report = now;
+            sum = 0;
+            count = 0;
+        }
+    }
+    return 0;
+}
+
+//*****************************************************************************
+// Main
+
+int main(int argc, char **argv)
+{
+    const char *cmd = (argc > 1) ? argv[1] : "bench";
+    if (strcmp(cmd, "bench") == 0)
+    {
+        return bench((argc > 2) ? argv[2] : nullptr);
+    }
+    if (strcmp(cmd, "encode") == 0 && argc > 3)
+    {
+        return encode(argv[2], argv[3], (argc > 4) ? (uint32_t)atoi(argv[4]) : default_block);
+    }
+    if (strcmp(cmd, "decode") == 0 && argc > 2)
+    {
+        return decode(argv[2], (argc > 3) ? argv[3] : nullptr);
+    }
+    if (strcmp(cmd, "replay") == 0 && argc > 3)
+    {
+        return replay(argv[2], (uint32_t)atoi(argv[3]), (argc > 4) ? (uint32_t)atoi(argv[4]) : 0);
+    }
+    printf("usage: %s bench [samples] | encode <samples> <out.cap> [block] |\n"
+           "       decode <in.cap> [out.txt] | replay <in.cap> <rate_hz> [block]\n",
+           argv[0]);
+    return 1;
+}
@@ -0,0 +1,152 @@
+/**
+ * Host benchmark: block processing on a replayed ADC capture
+ *
+ * The part9 sketches take one timer interrupt per analogRead() at 10 Hz.
+ * This program runs the same kind of processing (block mean/min/max, as in
+ * calcAverage()) on a ReplaySampleSource at rates far above that, and
+ * reports for each rate and block size:
+ *
+ *   rate      - achieved samples per second
+ *   irq/1k    - interrupts (block wake-ups) per 1,000 samples; block size 1
+ *               models the per-sample timer ISR
+ *   overruns  - blocks dropped because processing fell behind
+ *   lag       - mean time from the last sample of a block to its processing
+ *
+ * Pass a capture file (one sample per line, or raw .bin) as the first
+ * argument; without one a synthetic 12-bit signal with spikes is used.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/SampleSource/src \
+ *       progress/host/sample_source_bench.cpp lib/SampleSource/src/ReplaySampleSource.cpp \
+ *       -o sample_source_bench && ./sample_source_bench [capture.txt]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <PortUtils.h>
+#include <ReplaySampleSource.h>
+
+// Settings
+static const uint32_t synthetic_samples = 200000;
+static const uint32_t run_ms = 500;
+static const uint32_t rates_hz[] = {1000, 100000, 1000000, 0}; // 0 = unpaced
+static const uint32_t block_sizes[] = {1, 16, 256};
+
+static volatile uint32_t sink = 0;
+
+static void makeSignal(uint16_t *out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        double value = 2048.0 + 1200.0 * sin(i * 0.01) + (rand() % 64) - 32;
+        if (rand() % 500 == 0)
+        {
+            value = 4095; // Spike
+        }
+        out[i] = (uint16_t)value;
+    }
+}
+
+// The calcAverage() workload, per block
+static void processBlock(const SampleBlock *block)
+{
+    uint32_t sum = 0;
+    uint16_t lo = 0xFFFF;
+    uint16_t hi = 0;
+    for (uint32_t i = 0; i < block->count; i++)
+    {
+        uint16_t s = block->samples[i];
+        sum += s;
+        lo = (s < lo) ? s : lo;
+        hi = (s > hi) ? s : hi;
+    }
+    sink = sink + sum / block->count + lo + hi;
+}
+
+static void runCase(ReplaySampleSource &source, uint32_t rate_hz, uint32_t block_size)
+{
+    // Paced runs last run_ms; unpaced runs replay a fixed number of samples
+    uint64_t target = (rate_hz == 0) ? 20000000ull : (uint64_t)rate_hz * run_ms / 1000u;
+    if (target < block_size * 4u)
+    {
+        target = block_size * 4u;
+    }
+
+    source.begin(rate_hz, block_size, 4, true);
+    source.start();
+
+    uint64_t lag_total_us = 0;
+    uint64_t t0 = monotonicMicros();
+    const SampleBlock *block;
+    while (true)
+    {
+        // Dropped blocks still advance the sample clock
+        SampleSourceStats now_stats = source.stats();
+        if (now_stats.samples + (uint64_t)now_stats.overruns * block_size >= target ||
+            (block = source.read(1000)) == nullptr)
+        {
+            break;
+        }
+
+        uint64_t now = monotonicMicros();
+        if (rate_hz != 0)
+        {
+            uint64_t last_sample_us = sampleTimeUs(*block, block->count - 1, rate_hz);
+            lag_total_us += (now > last_sample_us) ? now - last_sample_us : 0;
+        }
+        processBlock(block);
+    }
+    uint64_t elapsed_us = monotonicMicros() - t0;
+    source.stop();
+
+    SampleSourceStats stats = source.stats();
+    char rate_name[16];
+    if (rate_hz == 0)
+    {
+        snprintf(rate_name, sizeof(rate_name), "unpaced");
+    }
+    else
+    {
+        snprintf(rate_name, sizeof(rate_name), "%lu Hz", (unsigned long)rate_hz);
+    }
+    printf("%-10s block=%4lu rate=%11.0f/s irq/1k=%4lu blocks=%8lu overruns=%5lu lag=%6llu us\n",
+           rate_name,
+           (unsigned long)block_size,
+           elapsed_us ? stats.samples * 1e6 / (double)elapsed_us : 0.0,
+           (unsigned long)interruptsPer1000Samples(stats),
+           (unsigned long)stats.blocks,
+           (unsigned long)stats.overruns,
+           (unsigned long long)(stats.blocks ? lag_total_us / stats.blocks : 0));
+}
+
+int main(int argc, char **argv)
+{
+    ReplaySampleSource source;
+    if (argc > 1)
+    {
+        if (!source.load(argv[1]))
+        {
+            printf("Could not load %s\n", argv[1]);
+            return 1;
+        }
+        printf("Replaying %lu samples from %s\n", (unsigned long)source.loadedSamples(), argv[1]);
+    }
+    else
+    {
+        static uint16_t signal[synthetic_samples];
+        makeSignal(signal, synthetic_samples);
+        source.loadSamples(signal, synthetic_samples);
+        printf("Replaying %lu synthetic samples\n", (unsigned long)synthetic_samples);
+    }
+
+    for (uint32_t r = 0; r < sizeof(rates_hz) / sizeof(rates_hz[0]); r++)
+    {
+        for (uint32_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++)
+        {
+            runCase(source, rates_hz[r], block_sizes[b]);
+        }
+    }
+    return 0;
+}
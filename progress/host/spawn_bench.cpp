@@ -0,0 +1,205 @@
+/**
+ * Host benchmark: spawn with a bin_sem handshake vs batched by-value spawn
+ *
+ * The handshake is the pattern of src/main.cpp and the part10 challenge
+ * sketches: pass &i to the new thread and wait on a semaphore until the
+ * thread has copied it, once per thread. The batch is spawnIndexed() from
+ * TaskSpawn, which copies the index into each thread's own block and does
+ * not wait.
+ *
+ * Measured per run: from the first create until the last thread is running
+ * (has its argument and reached its body), for 5, 50 and 200 threads,
+ * median over the runs. Every thread must see a distinct index in
+ * 0..count-1. Prints PASS/FAIL.
+ *
+ * On Linux creating a thread costs tens of microseconds and a futex
+ * handshake little on top, so expect the two to be close here; this run
+ * mainly checks that every argument arrives intact. The handshake's cost
+ * shows on the ESP32, see progress/part10_spawn_bench.cpp.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/TaskSpawn/src \
+ *       progress/host/spawn_bench.cpp lib/TaskSpawn/src/TaskSpawn.cpp \
+ *       -o spawn_bench && ./spawn_bench
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <PortUtils.h>
+#include <TaskSpawn.h>
+
+// Settings
+static const uint32_t task_counts[] = {5, 50, 200};
+static const uint32_t num_counts = sizeof(task_counts) / sizeof(task_counts[0]);
+static const uint32_t runs = 21;
+
+// Counting semaphore, like xSemaphoreCreateCounting()
+class Semaphore
+{
+public:
+    void give()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_++;
+        cond_.notify_one();
+    }
+
+    void take()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return count_ > 0; });
+        count_--;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    uint32_t count_ = 0;
+};
+
+// Globals
+static Semaphore bin_sem;  // Handshake: parameter copied
+static Semaphore all_sem;  // Last thread running
+static Semaphore done_sem; // Thread about to exit
+static std::mutex release_mutex;
+static std::condition_variable release_cond;
+static bool released = false;
+
+static std::atomic<uint32_t> running(0);
+static uint32_t expected = 0;
+static uint64_t all_running_us = 0;
+static std::vector<uint32_t> seen; // How often each index arrived
+
+//*****************************************************************************
+// Threads
+
+static void arrive(uint32_t index)
+{
+    if (index < seen.size())
+    {
+        __atomic_fetch_add(&seen[index], 1, __ATOMIC_RELAXED);
+    }
+    if (running.fetch_add(1) + 1 == expected)
+    {
+        all_running_us = monotonicMicros();
+        all_sem.give();
+    }
+
+    // Stay alive until every thread is running
+    std::unique_lock<std::mutex> lock(release_mutex);
+    release_cond.wait(lock, [] { return released; });
+    lock.unlock();
+    done_sem.give();
+}
+
+static void handshakeThread(void *parameters)
+{
+    uint32_t num = *(uint32_t *)parameters;
+    bin_sem.give();
+    arrive(num);
+}
+
+static void spawnedThread(const uint32_t &num)
+{
+    arrive(num);
+}
+
+//*****************************************************************************
+// Runs
+
+static void prepare(uint32_t count)
+{
+    running.store(0);
+    expected = count;
+    seen.assign(count, 0);
+    released = false;
+}
+
+static bool finish(uint32_t count)
+{
+    all_sem.take();
+    {
+        std::lock_guard<std::mutex> lock(release_mutex);
+        released = true;
+    }
+    release_cond.notify_all();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        done_sem.take();
+    }
+    return std::count(seen.begin(), seen.end(), 1u) == (long)count;
+}
+
+static bool runHandshake(uint32_t count, uint64_t *elapsed_us)
+{
+    prepare(count);
+    uint64_t t0 = monotonicMicros();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::thread(handshakeThread, (void *)&i).detach();
+        bin_sem.take();
+    }
+    bool ok = finish(count);
+    *elapsed_us = all_running_us - t0;
+    return ok;
+}
+
+static bool runBatch(uint32_t count, uint64_t *elapsed_us)
+{
+    SpawnConfig config = {"Worker", 2048, 1, SPAWN_ANY_CORE};
+    prepare(count);
+    uint64_t t0 = monotonicMicros();
+    if (spawnIndexed(spawnedThread, count, config) != count)
+    {
+        return false;
+    }
+    bool ok = finish(count);
+    *elapsed_us = all_running_us - t0;
+    return ok;
+}
+
+static uint64_t median(std::vector<uint64_t> &values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    printf("Create until all running, median of %lu runs, %u CPUs\n\n",
+           (unsigned long)runs, std::thread::hardware_concurrency());
+    printf("%8s %14s %14s %8s\n", "tasks", "handshake us", "batch us", "speedup");
+
+    bool ok = true;
+    for (uint32_t c = 0; c < num_counts; c++)
+    {
+        uint32_t count = task_counts[c];
+        std::vector<uint64_t> handshake;
+        std::vector<uint64_t> batch;
+        for (uint32_t r = 0; r < runs; r++)
+        {
+            uint64_t us = 0;
+            ok = runHandshake(count, &us) && ok;
+            handshake.push_back(us);
+            ok = runBatch(count, &us) && ok;
+            batch.push_back(us);
+        }
+        uint64_t h = median(handshake);
+        uint64_t b = median(batch);
+        printf("%8lu %14lu %14lu %7.2fx\n",
+               (unsigned long)count, (unsigned long)h, (unsigned long)b, b > 0 ? (double)h / b : 0.0);
+    }
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
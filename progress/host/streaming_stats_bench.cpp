@@ -0,0 +1,237 @@
+/**
+ * Host benchmark: StreamingStats cost per sample and snapshot consistency
+ *
+ * Part 1 measures nanoseconds per sample (one "cycle" per ns on the host,
+ * see PortUtils.h) for:
+ *
+ *   naive     - the calcAverage() approach: re-sum each window for every sample
+ *   add()     - StreamingStats, one sequence-lock round per sample
+ *   addBlock  - StreamingStats, one sequence-lock round per 256-sample block
+ *
+ * Part 2 runs a writer thread feeding a ramp (x_i = i % 4096) while a reader
+ * thread takes snapshots. Because the input is known, every snapshot can be
+ * checked exactly: the count, the moments and each window sum must match
+ * the ramp at that count. A torn snapshot would fail. Prints PASS/FAIL.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -pthread -Ilib/PortUtils/src -Ilib/StreamingStats/src \
+ *       progress/host/streaming_stats_bench.cpp lib/StreamingStats/src/StreamingStats.cpp \
+ *       -o streaming_stats_bench && ./streaming_stats_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <PortUtils.h>
+#include <StreamingStats.h>
+
+// Settings
+static const uint32_t num_samples = 1 << 20;
+static const uint32_t block_size = 256;
+static const uint32_t ema_shift = 4;
+static const uint32_t check_ms = 1000;
+
+struct WindowSet
+{
+    const char *name;
+    uint32_t lengths[StreamingStats::MAX_WINDOWS];
+    uint32_t count;
+};
+
+static const WindowSet window_sets[] = {
+    {"10", {10}, 1},
+    {"10,100,1000", {10, 100, 1000}, 3},
+    {"16,64,256,1023", {16, 64, 256, 1023}, 4},
+};
+
+static volatile uint32_t sink = 0;
+
+static uint16_t rampSample(uint64_t i)
+{
+    return (uint16_t)(i % 4096);
+}
+
+//*****************************************************************************
+// Part 1: cost per sample
+
+static double naiveNsPerSample(const uint16_t *samples, const WindowSet &set)
+{
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t n = 1; n <= num_samples; n++)
+    {
+        for (uint32_t w = 0; w < set.count; w++)
+        {
+            uint32_t length = (set.lengths[w] < n) ? set.lengths[w] : n;
+            uint32_t sum = 0;
+            for (uint32_t i = n - length; i < n; i++)
+            {
+                sum += samples[i];
+            }
+            sink = sink + sum / length;
+        }
+    }
+    return (double)(monotonicNanos() - t0) / num_samples;
+}
+
+static double streamingNsPerSample(const uint16_t *samples, const WindowSet &set, bool blocks)
+{
+    StreamingStats stats;
+    stats.begin(set.lengths, set.count, ema_shift);
+
+    uint64_t t0 = monotonicNanos();
+    if (blocks)
+    {
+        for (uint32_t i = 0; i < num_samples; i += block_size)
+        {
+            stats.addBlock(&samples[i], block_size);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < num_samples; i++)
+        {
+            stats.add(samples[i]);
+        }
+    }
+    uint64_t elapsed = monotonicNanos() - t0;
+
+    StreamingStats::Snapshot snap;
+    stats.snapshot(&snap);
+    sink = sink + (uint32_t)snap.windowMean(0);
+    return (double)elapsed / num_samples;
+}
+
+//*****************************************************************************
+// Part 2: snapshot consistency under a concurrent writer
+
+static bool checkSnapshot(const StreamingStats::Snapshot &snap, const WindowSet &set)
+{
+    uint64_t n = snap.count;
+    if (n == 0)
+    {
+        return true;
+    }
+    if (snap.origin != rampSample(0) || snap.min != 0 || snap.max != ((n >= 4096) ? 4095 : n - 1))
+    {
+        return false;
+    }
+
+    // Running moments about the first sample (0): sum and sum of squares
+    uint64_t full = n / 4096;
+    uint64_t rest = n % 4096;
+    uint64_t period_sum = 4095ull * 4096 / 2;
+    uint64_t period_sumsq = 4095ull * 4096 * 8191 / 6;
+    uint64_t sum = full * period_sum + (rest ? (rest - 1) * rest / 2 : 0);
+    uint64_t sumsq = full * period_sumsq + (rest ? (rest - 1) * rest * (2 * rest - 1) / 6 : 0);
+    if ((uint64_t)snap.sum_d != sum || snap.sumsq_d != sumsq)
+    {
+        return false;
+    }
+
+    for (uint32_t w = 0; w < set.count; w++)
+    {
+        uint32_t fill = snap.windowFill(w);
+        uint32_t window_sum = 0;
+        uint64_t window_sumsq = 0;
+        for (uint64_t i = n - fill; i < n; i++)
+        {
+            uint32_t x = rampSample(i);
+            window_sum += x;
+            window_sumsq += x * x;
+        }
+        if (snap.window_sum[w] != window_sum || snap.window_sumsq[w] != window_sumsq)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool runConsistencyCheck(const WindowSet &set, bool blocks)
+{
+    StreamingStats stats;
+    stats.begin(set.lengths, set.count, ema_shift);
+    std::atomic<bool> stop(false);
+
+    std::thread writer([&]() {
+        std::vector<uint16_t> block(block_size);
+        uint64_t i = 0;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            if (blocks)
+            {
+                for (uint32_t k = 0; k < block_size; k++)
+                {
+                    block[k] = rampSample(i++);
+                }
+                stats.addBlock(block.data(), block_size);
+            }
+            else
+            {
+                stats.add(rampSample(i++));
+            }
+        }
+    });
+
+    uint32_t checked = 0;
+    uint32_t failed = 0;
+    uint64_t last_count = 0;
+    uint64_t t0 = monotonicMicros();
+    while (monotonicMicros() - t0 < check_ms * 1000ull)
+    {
+        StreamingStats::Snapshot snap;
+        stats.snapshot(&snap);
+        if (!checkSnapshot(snap, set) || snap.count < last_count)
+        {
+            failed++;
+        }
+        last_count = snap.count;
+        checked++;
+        std::this_thread::yield(); // Let the writer run on single-CPU hosts
+    }
+    stop.store(true);
+    writer.join();
+
+    printf("  %-8s windows=%-15s snapshots=%7lu last_count=%10llu failed=%lu\n",
+           blocks ? "addBlock" : "add()",
+           set.name,
+           (unsigned long)checked,
+           (unsigned long long)last_count,
+           (unsigned long)failed);
+    return failed == 0 && checked > 0;
+}
+
+//*****************************************************************************
+// Main
+
+int main()
+{
+    std::vector<uint16_t> samples(num_samples);
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        samples[i] = (uint16_t)(2048 + (rand() % 512) - 256);
+    }
+
+    printf("Cost per sample (%lu samples)\n", (unsigned long)num_samples);
+    for (const WindowSet &set : window_sets)
+    {
+        double naive = naiveNsPerSample(samples.data(), set);
+        double single = streamingNsPerSample(samples.data(), set, false);
+        double block = streamingNsPerSample(samples.data(), set, true);
+        printf("  windows=%-15s naive=%8.2f ns  add()=%6.2f ns  addBlock=%6.2f ns\n", set.name, naive, single, block);
+    }
+
+    printf("\nSnapshot consistency (%lu ms per case)\n", (unsigned long)check_ms);
+    bool ok = true;
+    for (const WindowSet &set : window_sets)
+    {
+        ok = runConsistencyCheck(set, false) && ok;
+        ok = runConsistencyCheck(set, true) && ok;
+    }
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
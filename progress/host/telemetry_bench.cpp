@@ -0,0 +1,331 @@
+/**
+ * Host benchmark and receiver: COBS telemetry vs Serial.print text
+ *
+ *   telemetry_bench              throughput at 115200 baud, CPU cost and a
+ *                                corruption / interleaved text check
+ *   telemetry_bench receive <path>
+ *                                decode a live stream or a saved log, e.g.
+ *                                the serial port after
+ *                                "stty -F /dev/ttyUSB0 115200 raw"
+ *
+ * Throughput: the records the sketches print today are encoded both ways and
+ * the bytes on the wire turned into records per second at 115200 baud 8N1
+ * (11,520 bytes/s). The check sends a mix of records with legacy text lines
+ * in between, damages some frames, and verifies that the receiver drops
+ * exactly those, counts them as lost, and hands every text line on intact.
+ * Prints PASS/FAIL.
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/Telemetry/src \
+ *       progress/host/telemetry_bench.cpp lib/Telemetry/src/Telemetry.cpp \
+ *       -o telemetry_bench && ./telemetry_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <PortUtils.h>
+#include <Telemetry.h>
+
+// Settings
+static const uint32_t uart_bytes_per_s = 115200 / 10; // 8N1: 10 bits per byte
+static const uint32_t samples_per_record = 100;
+static const uint32_t check_records = 20000;
+static const uint32_t damage_every = 97;              // Corrupt one frame in this many
+static const uint32_t text_every = 50;                // Legacy text line every this many records
+static const uint32_t timing_records = 200000;
+
+//*****************************************************************************
+// Helpers
+
+static size_t vectorSink(const uint8_t *data, size_t len, void *context)
+{
+    std::vector<uint8_t> *out = (std::vector<uint8_t> *)context;
+    out->insert(out->end(), data, data + len);
+    return len;
+}
+
+static size_t nullSink(const uint8_t *data, size_t len, void *context)
+{
+    return len;
+}
+
+// The record types as the sketches would send them; text is what they print today
+static void buildRecord(uint32_t kind, uint32_t i, uint8_t *type, TelemetryPayload &payload, std::string &text)
+{
+    char line[160];
+    switch (kind)
+    {
+    case 0:
+        *type = TELEM_ADC_AVERAGE;
+        payload.f32(2048.5f + (float)(i % 7)).u32(10);
+        snprintf(line, sizeof(line), ">>> ADC Average (last %d samples): %.2f\r\n", 10, 2048.5 + (i % 7));
+        break;
+    case 1:
+        *type = TELEM_TIMER_COUNT;
+        payload.u32(123456 + i);
+        snprintf(line, sizeof(line), "Timer Count: %lu | LED: %s\r\n", (unsigned long)(123456 + i), (i & 1) ? "ON" : "OFF");
+        break;
+    case 2:
+        *type = TELEM_REMAINING_MS;
+        payload.u32(4500 - (i % 4500));
+        snprintf(line, sizeof(line), "%lu ms\r\n", (unsigned long)(4500 - (i % 4500)));
+        break;
+    case 3:
+        *type = TELEM_STATS;
+        payload.u32(100000 + i).u16(2001).u16(2100).f32(2048.3f).f32(12.3f);
+        snprintf(line, sizeof(line), ">>> Running: mean=%.1f ema=%.1f min=%u max=%u sd=%.1f | last %lu: %.1f\n",
+                 2048.3, 2047.9, 2001, 2100, 12.3, (unsigned long)100, 2049.1);
+        break;
+    default:
+    {
+        *type = TELEM_SAMPLES;
+        payload.u32(i * samples_per_record);
+        text.clear();
+        for (uint32_t s = 0; s < samples_per_record; s++)
+        {
+            uint16_t sample = (uint16_t)(2048 + (rand() % 64) - 32);
+            payload.u16(sample);
+            snprintf(line, sizeof(line), "%u\r\n", sample);
+            text += line;
+        }
+        return;
+    }
+    }
+    text = line;
+}
+
+static const char *const kind_names[] = {"ADC average", "timer count", "remaining ms", "stats", "100 samples"};
+static const uint32_t num_kinds = sizeof(kind_names) / sizeof(kind_names[0]);
+
+//*****************************************************************************
+// Check
+
+struct CheckState
+{
+    std::vector<uint32_t> seen; // Index carried in each record
+    std::string text;
+};
+
+static void onCheckRecord(const TelemetryRecord &record, void *context)
+{
+    CheckState *state = (CheckState *)context;
+    TelemetryParser parser(record.payload, record.len);
+    if (record.type == TELEM_TIMER_COUNT)
+    {
+        state->seen.push_back(parser.u32() - 123456);
+    }
+}
+
+static void onCheckNoise(const uint8_t *data, uint32_t len, void *context)
+{
+    CheckState *state = (CheckState *)context;
+    state->text.append((const char *)data, len);
+}
+
+static bool corruptionCheck()
+{
+    std::vector<uint8_t> wire;
+    TelemetryWriter writer;
+    writer.begin(vectorSink, &wire);
+
+    std::vector<uint32_t> expected;
+    std::string expected_text;
+    uint32_t damaged = 0;
+    for (uint32_t i = 0; i < check_records; i++)
+    {
+        if (i % text_every == 0)
+        {
+            // Plain Serial.print() between frames
+            char line[64];
+            snprintf(line, sizeof(line), "legacy line %lu\r\n", (unsigned long)i);
+            wire.insert(wire.end(), line, line + strlen(line));
+            expected_text += line;
+        }
+
+        size_t start = wire.size();
+        writer.send(TELEM_TIMER_COUNT, TelemetryPayload().u32(123456 + i));
+        if (i % damage_every == damage_every - 1)
+        {
+            wire[start + 3] ^= 0x5A; // Inside the frame, never a delimiter
+            if (wire[start + 3] == 0)
+            {
+                wire[start + 3] = 0x77;
+            }
+            damaged++;
+        }
+        else
+        {
+            expected.push_back(i);
+        }
+    }
+
+    CheckState state;
+    TelemetryReceiver receiver;
+    receiver.begin(onCheckRecord, onCheckNoise, &state);
+    // Feed in odd-sized chunks like a UART driver would
+    for (size_t pos = 0; pos < wire.size(); pos += 37)
+    {
+        receiver.feed(&wire[pos], (wire.size() - pos < 37) ? wire.size() - pos : 37);
+    }
+
+    const TelemetryReceiverStats &stats = receiver.stats();
+    bool ok = state.seen == expected && stats.bad_crc == damaged && stats.lost == damaged && state.text == expected_text;
+    printf("\nCheck: %lu records, %lu damaged -> %lu received, %lu CRC errors, %lu lost, text %s -> %s\n",
+           (unsigned long)check_records,
+           (unsigned long)damaged,
+           (unsigned long)stats.records,
+           (unsigned long)stats.bad_crc,
+           (unsigned long)stats.lost,
+           state.text == expected_text ? "intact" : "DAMAGED",
+           ok ? "ok" : "FAIL");
+    return ok;
+}
+
+//*****************************************************************************
+// Receive
+
+static void printRecord(const TelemetryRecord &record, void *context)
+{
+    TelemetryParser p(record.payload, record.len);
+    switch (record.type)
+    {
+    case TELEM_TEXT:
+        printf("[%3u] text: %.*s\n", record.seq, (int)record.len, (const char *)record.payload);
+        break;
+    case TELEM_ADC_AVERAGE:
+    {
+        float avg = p.f32();
+        printf("[%3u] adc average %.2f over %lu samples\n", record.seq, avg, (unsigned long)p.u32());
+        break;
+    }
+    case TELEM_TIMER_COUNT:
+        printf("[%3u] timer count %lu\n", record.seq, (unsigned long)p.u32());
+        break;
+    case TELEM_REMAINING_MS:
+        printf("[%3u] remaining %lu ms\n", record.seq, (unsigned long)p.u32());
+        break;
+    case TELEM_STATS:
+    {
+        uint32_t count = p.u32();
+        uint16_t lo = p.u16();
+        uint16_t hi = p.u16();
+        float mean = p.f32();
+        printf("[%3u] stats n=%lu min=%u max=%u mean=%.1f sd=%.1f\n",
+               record.seq, (unsigned long)count, lo, hi, mean, p.f32());
+        break;
+    }
+    case TELEM_SAMPLES:
+    {
+        uint32_t first = p.u32();
+        printf("[%3u] samples %lu..%lu:", record.seq, (unsigned long)first, (unsigned long)(first + p.remaining() / 2 - 1));
+        while (p.remaining() >= 2)
+        {
+            printf(" %u", p.u16());
+        }
+        printf("\n");
+        break;
+    }
+    default:
+        printf("[%3u] type %u, %lu bytes\n", record.seq, record.type, (unsigned long)record.len);
+        break;
+    }
+}
+
+static void printNoise(const uint8_t *data, uint32_t len, void *context)
+{
+    fwrite(data, 1, len, stdout);
+}
+
+static int receive(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        printf("Cannot open %s\n", path);
+        return 1;
+    }
+    TelemetryReceiver receiver;
+    receiver.begin(printRecord, printNoise, nullptr);
+    uint8_t buf[256];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+    {
+        receiver.feed(buf, n);
+        fflush(stdout);
+    }
+    fclose(file);
+
+    const TelemetryReceiverStats &stats = receiver.stats();
+    printf("\n%lu records, %lu CRC errors, %lu lost, %lu text bytes\n",
+           (unsigned long)stats.records,
+           (unsigned long)stats.bad_crc,
+           (unsigned long)stats.lost,
+           (unsigned long)stats.noise_bytes);
+    return 0;
+}
+
+//*****************************************************************************
+// Main
+
+int main(int argc, char **argv)
+{
+    if (argc > 2 && strcmp(argv[1], "receive") == 0)
+    {
+        return receive(argv[2]);
+    }
+
+    printf("At 115200 baud 8N1 (%lu bytes/s)\n\n", (unsigned long)uart_bytes_per_s);
+    printf("%-13s %10s %10s %12s %12s %7s\n", "record", "text B", "frame B", "text rec/s", "frame rec/s", "gain");
+    for (uint32_t kind = 0; kind < num_kinds; kind++)
+    {
+        std::vector<uint8_t> wire;
+        TelemetryWriter writer;
+        writer.begin(vectorSink, &wire);
+
+        uint8_t type;
+        TelemetryPayload payload;
+        std::string text;
+        buildRecord(kind, 1, &type, payload, text);
+        writer.send(type, payload);
+
+        printf("%-13s %10zu %10zu %12.0f %12.0f %6.1fx\n",
+               kind_names[kind],
+               text.size(),
+               wire.size(),
+               (double)uart_bytes_per_s / text.size(),
+               (double)uart_bytes_per_s / wire.size(),
+               (double)text.size() / wire.size());
+    }
+
+    // CPU cost per record (timer count) on this machine
+    TelemetryWriter writer;
+    writer.begin(nullSink, nullptr);
+    uint64_t t0 = monotonicNanos();
+    for (uint32_t i = 0; i < timing_records; i++)
+    {
+        writer.send(TELEM_TIMER_COUNT, TelemetryPayload().u32(i));
+    }
+    double send_ns = (double)(monotonicNanos() - t0) / timing_records;
+
+    std::vector<uint8_t> wire;
+    writer.begin(vectorSink, &wire);
+    for (uint32_t i = 0; i < timing_records; i++)
+    {
+        writer.send(TELEM_TIMER_COUNT, TelemetryPayload().u32(i));
+    }
+    TelemetryReceiver receiver;
+    receiver.begin(nullptr, nullptr, nullptr);
+    t0 = monotonicNanos();
+    receiver.feed(wire.data(), wire.size());
+    double receive_ns = (double)(monotonicNanos() - t0) / timing_records;
+    printf("\nCPU: send %.0f ns/record, receive %.0f ns/record\n", send_ns, receive_ns);
+
+    bool ok = corruptionCheck() && receiver.stats().records == timing_records;
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+/**
+ * Host benchmark: TimingWheel vs FreeRTOS-style sorted timer list
+ *
+ * The FreeRTOS timer daemon keeps active timers in a list sorted by expiry
+ * (vListInsert walks the list), so every start/reset is O(n). This program
+ * models that list next to TimingWheel and scales from 10 to 10,000 active
+ * auto-reload timers while random timers are restarted at a rate of
+ * N / restart_divisor per tick, the way per-connection timeouts are refreshed.
+ *
+ * Reported per configuration:
+ *   restart ns   average cost of one restart (remove + insert)
+ *   jitter ns    mean / max delay from the start of a tick to each callback
+ *   late         callbacks that ran on a different tick than their expiry
+ *
+ * Build and run from the repository root:
+ *   g++ -O2 -std=c++17 -Ilib/PortUtils/src -Ilib/TimingWheel/src \
+ *       progress/host/timing_wheel_bench.cpp lib/TimingWheel/src/TimingWheel.cpp \
+ *       -o timing_wheel_bench && ./timing_wheel_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <PortUtils.h>
+#include <TimingWheel.h>
+
+// Settings
+static const uint32_t sim_ticks = 10000;
+static const uint32_t restart_divisor = 500; // Each timer is restarted every ~500 ticks
+static const uint32_t min_period = 10;
+static const uint32_t max_period = 5000;
+
+// Globals shared with the callbacks
+static uint64_t tick_start_ns = 0;
+static uint32_t current_tick = 0;
+static uint64_t jitter_total_ns = 0;
+static uint64_t jitter_max_ns = 0;
+static uint32_t callbacks = 0;
+static uint32_t late = 0;
+
+static void recordCallback(uint32_t expiry)
+{
+    uint64_t delay = monotonicNanos() - tick_start_ns;
+    jitter_total_ns += delay;
+    if (delay > jitter_max_ns)
+    {
+        jitter_max_ns = delay;
+    }
+    if (expiry != current_tick)
+    {
+        late++;
+    }
+    callbacks++;
+}
+
+static void resetStats()
+{
+    jitter_total_ns = 0;
+    jitter_max_ns = 0;
+    callbacks = 0;
+    late = 0;
+}
+
+static uint32_t randomPeriod()
+{
+    return min_period + (uint32_t)rand() % (max_period - min_period);
+}
+
+//*****************************************************************************
+// Sorted list model of the FreeRTOS timer daemon
+
+struct ListTimer
+{
+    ListTimer *prev;
+    ListTimer *next;
+    uint32_t period;
+    uint32_t expiry;
+    bool active;
+};
+
+class SortedTimerList
+{
+public:
+    SortedTimerList()
+    {
+        head_.prev = &head_;
+        head_.next = &head_;
+    }
+
+    void start(ListTimer *timer, uint32_t now)
+    {
+        stop(timer);
+        timer->expiry = now + timer->period;
+        insert(timer);
+    }
+
+    void stop(ListTimer *timer)
+    {
+        if (timer->active)
+        {
+            timer->prev->next = timer->next;
+            timer->next->prev = timer->prev;
+            timer->active = false;
+        }
+    }
+
+    void advance(uint32_t now)
+    {
+        while (head_.next != &head_ && (int32_t)(head_.next->expiry - now) <= 0)
+        {
+            ListTimer *timer = head_.next;
+            stop(timer);
+            uint32_t expiry = timer->expiry;
+            timer->expiry += timer->period;
+            insert(timer);
+            recordCallback(expiry);
+        }
+    }
+
+private:
+    // Same walk as vListInsert(): skip every item that expires no later
+    void insert(ListTimer *timer)
+    {
+        ListTimer *pos = head_.next;
+        while (pos != &head_ && (int32_t)(pos->expiry - timer->expiry) <= 0)
+        {
+            pos = pos->next;
+        }
+        timer->next = pos;
+        timer->prev = pos->prev;
+        pos->prev->next = timer;
+        pos->prev = timer;
+        timer->active = true;
+    }
+
+    ListTimer head_;
+};
+
+//*****************************************************************************
+// Benchmarks
+
+static void wheelCallback(WheelTimerHandle_t timer)
+{
+    // The wheel has already re-armed the timer one period later
+    recordCallback(timer->expiry - timer->period);
+}
+
+static void runWheel(uint32_t num_timers)
+{
+    std::vector<WheelTimer> timers(num_timers);
+    TimingWheel wheel(0);
+    uint64_t restart_ns = 0;
+    uint32_t restart_count = 0;
+    uint32_t restart_budget = 0;
+
+    srand(1);
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        TimingWheel::initTimer(&timers[i], "t", randomPeriod(), true, nullptr, wheelCallback);
+        wheel.start(&timers[i]);
+    }
+
+    resetStats();
+    for (current_tick = 1; current_tick <= sim_ticks; current_tick++)
+    {
+        tick_start_ns = monotonicNanos();
+        wheel.advance(current_tick);
+
+        restart_budget += num_timers;
+        if (restart_budget < restart_divisor)
+        {
+            continue;
+        }
+
+        uint64_t t0 = monotonicNanos();
+        while (restart_budget >= restart_divisor)
+        {
+            wheel.start(&timers[(uint32_t)rand() % num_timers]);
+            restart_budget -= restart_divisor;
+            restart_count++;
+        }
+        restart_ns += monotonicNanos() - t0;
+    }
+
+    printf("  wheel  restart %7.1f ns  jitter mean %8.1f ns max %9llu ns  callbacks %7u late %u\n",
+           restart_count ? (double)restart_ns / restart_count : 0.0,
+           callbacks ? (double)jitter_total_ns / callbacks : 0.0,
+           (unsigned long long)jitter_max_ns,
+           callbacks,
+           late);
+}
+
+static void runSortedList(uint32_t num_timers)
+{
+    std::vector<ListTimer> timers(num_timers);
+    SortedTimerList list;
+    uint64_t restart_ns = 0;
+    uint32_t restart_count = 0;
+    uint32_t restart_budget = 0;
+
+    srand(1);
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        timers[i].active = false;
+        timers[i].period = randomPeriod();
+        list.start(&timers[i], 0);
+    }
+
+    resetStats();
+    for (current_tick = 1; current_tick <= sim_ticks; current_tick++)
+    {
+        tick_start_ns = monotonicNanos();
+        list.advance(current_tick);
+
+        restart_budget += num_timers;
+        if (restart_budget < restart_divisor)
+        {
+            continue;
+        }
+
+        uint64_t t0 = monotonicNanos();
+        while (restart_budget >= restart_divisor)
+        {
+            list.start(&timers[(uint32_t)rand() % num_timers], current_tick);
+            restart_budget -= restart_divisor;
+            restart_count++;
+        }
+        restart_ns += monotonicNanos() - t0;
+    }
+
+    printf("  sorted restart %7.1f ns  jitter mean %8.1f ns max %9llu ns  callbacks %7u late %u\n",
+           restart_count ? (double)restart_ns / restart_count : 0.0,
+           callbacks ? (double)jitter_total_ns / callbacks : 0.0,
+           (unsigned long long)jitter_max_ns,
+           callbacks,
+           late);
+}
+
+int main()
+{
+    static const uint32_t sizes[] = {10, 100, 1000, 10000};
+
+    printf("---Timing Wheel vs Sorted Timer List (%u ticks)---\n", sim_ticks);
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        printf("%u active timers\n", sizes[i]);
+        runSortedList(sizes[i]);
+        runWheel(sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,281 @@
+/**
+ * ESP32 Dining Philosophers on Coroutines
+ *
+ * src/main.cpp with every philosopher a C++20 coroutine instead of a task.
+ * All of them run on one executor task (CoRuntime): the chopsticks and the
+ * arbitrator (admits N-1 philosophers at a time) are CoSemaphores, thinking
+ * and eating are coDelay(). A philosopher costs its coroutine frame instead
+ * of a TCB and a stack, so the table seats hundreds.
+ *
+ * Before dinner the sketch measures, against native tasks:
+ *
+ *   memory  heap per actor: coroutine frames vs tasks with a 2048 B stack
+ *   switch  CPU cycles per hand-off in a semaphore ping-pong: two
+ *           coroutines with CoSemaphores vs two tasks with binary semaphores
+ *
+ * Set NUM_PHILOSOPHERS to 5 to see every step printed as in src/main.cpp.
+ */
+
+#include <Arduino.h>
+#include <CoRuntime.h>
+#include <PortUtils.h>
+
+#include <new>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+enum
+{
+    NUM_PHILOSOPHERS = 500
+};
+static const uint32_t meals = 3;
+static const uint32_t eat_ms = 10;
+static const uint32_t max_think_ms = 5;
+static const uint32_t verbose_max = 5;         // Print every step up to this many philosophers
+static const uint32_t memory_actors = 20;
+static const uint32_t task_stack_size = 2048; // Bytes in ESP32
+static const uint32_t co_ping_pongs = 100000;
+static const uint32_t task_ping_pongs = 10000;
+
+// Globals
+static CoExecutor executor;
+static CoSemaphore arbitrator(NUM_PHILOSOPHERS - 1);
+static CoSemaphore *chopstick[NUM_PHILOSOPHERS];
+static CoSemaphore done_sem(0);
+static uint32_t meals_eaten = 0;
+
+static CoSemaphore co_ping(0);
+static CoSemaphore co_pong(0);
+static SemaphoreHandle_t task_ping;
+static SemaphoreHandle_t task_pong;
+
+//*****************************************************************************
+// Memory
+
+static CoTask idleActor()
+{
+    co_await coDelay(1);
+}
+
+void idleTask(void *parameters)
+{
+    vTaskSuspend(NULL);
+}
+
+static void measureMemory()
+{
+    TaskHandle_t tasks[memory_actors];
+    size_t before = xPortGetFreeHeapSize();
+    uint32_t created = 0;
+    for (uint32_t i = 0; i < memory_actors; i++)
+    {
+        if (xTaskCreatePinnedToCore(idleTask, "Idle", task_stack_size, NULL, 1, &tasks[i], app_cpu) != pdPASS)
+        {
+            break;
+        }
+        created++;
+    }
+    size_t task_bytes = before - xPortGetFreeHeapSize();
+    for (uint32_t i = 0; i < created; i++)
+    {
+        vTaskDelete(tasks[i]);
+    }
+    vTaskDelay(pdMS_TO_TICKS(100)); // The idle task frees them
+
+    size_t co_bytes;
+    size_t frame_bytes;
+    {
+        CoExecutor scratch;
+        before = xPortGetFreeHeapSize();
+        size_t frames = CoExecutor::frameBytes();
+        for (uint32_t i = 0; i < memory_actors; i++)
+        {
+            scratch.spawn(idleActor());
+        }
+        co_bytes = before - xPortGetFreeHeapSize();
+        frame_bytes = CoExecutor::frameBytes() - frames;
+    } // Never run; destroyed with the executor
+
+    Serial.println("Memory per actor (heap):");
+    Serial.printf("  task       %5lu B (%lu B stack)\n",
+                  (unsigned long)(created ? task_bytes / created : 0), (unsigned long)task_stack_size);
+    Serial.printf("  coroutine  %5lu B (%lu B frame)\n",
+                  (unsigned long)(co_bytes / memory_actors), (unsigned long)(frame_bytes / memory_actors));
+}
+
+//*****************************************************************************
+// Switch cost
+
+static CoTask pinger()
+{
+    for (uint32_t i = 0; i < co_ping_pongs; i++)
+    {
+        co_ping.give();
+        co_await co_pong.take();
+    }
+}
+
+static CoTask ponger()
+{
+    for (uint32_t i = 0; i < co_ping_pongs; i++)
+    {
+        co_await co_ping.take();
+        co_pong.give();
+    }
+}
+
+void pongTask(void *parameters)
+{
+    for (uint32_t i = 0; i < task_ping_pongs; i++)
+    {
+        xSemaphoreTake(task_ping, portMAX_DELAY);
+        xSemaphoreGive(task_pong);
+    }
+    vTaskDelete(NULL);
+}
+
+static void measureSwitch()
+{
+    // Runs on this task, like any executor
+    CoExecutor scratch;
+    scratch.spawn(pinger());
+    scratch.spawn(ponger());
+    uint32_t start = cpuCycleCount();
+    scratch.run();
+    float co_cycles = (float)(cpuCycleCount() - start) / (2.0f * co_ping_pongs);
+
+    // Same priority as this task, same core
+    xTaskCreatePinnedToCore(pongTask, "Pong", 2048, NULL, uxTaskPriorityGet(NULL), NULL, xPortGetCoreID());
+    start = cpuCycleCount();
+    for (uint32_t i = 0; i < task_ping_pongs; i++)
+    {
+        xSemaphoreGive(task_ping);
+        xSemaphoreTake(task_pong, portMAX_DELAY);
+    }
+    float task_cycles = (float)(cpuCycleCount() - start) / (2.0f * task_ping_pongs);
+
+    Serial.println("Switch per hand-off (semaphore ping-pong):");
+    Serial.printf("  task       %7.0f cycles\n", task_cycles);
+    Serial.printf("  coroutine  %7.0f cycles (%.1fx faster)\n", co_cycles, task_cycles / co_cycles);
+}
+
+//*****************************************************************************
+// Philosophers
+
+static CoTask philosopher(int num)
+{
+    char buf[50];
+    bool verbose = NUM_PHILOSOPHERS <= verbose_max;
+    CoSemaphore &left = *chopstick[num];
+    CoSemaphore &right = *chopstick[(num + 1) % NUM_PHILOSOPHERS];
+
+    for (uint32_t meal = 0; meal < meals; meal++)
+    {
+        co_await coDelay(random(0, max_think_ms + 1)); // Think
+
+        co_await arbitrator.take();
+
+        // Take left chopstick
+        co_await left.take();
+        if (verbose)
+        {
+            sprintf(buf, "Philosopher %i took chopstick %i", num, num);
+            Serial.println(buf);
+        }
+
+        // Add some delay to force contention
+        co_await coDelay(1);
+
+        // Take right chopstick
+        co_await right.take();
+        if (verbose)
+        {
+            sprintf(buf, "Philosopher %i took chopstick %i", num, (num + 1) % NUM_PHILOSOPHERS);
+            Serial.println(buf);
+            sprintf(buf, "Philosopher %i is eating", num);
+            Serial.println(buf);
+        }
+
+        // Do some eating
+        co_await coDelay(eat_ms);
+        meals_eaten++;
+
+        right.give();
+        left.give();
+        arbitrator.give();
+    }
+    done_sem.give();
+}
+
+static CoTask dinner(uint32_t start_us)
+{
+    for (int i = 0; i < NUM_PHILOSOPHERS; i++)
+    {
+        co_await done_sem.take();
+    }
+    Serial.printf("%lu meals by %d philosophers in %lu ms, %lu resumes, %lu B of frames left\n",
+                  (unsigned long)meals_eaten,
+                  NUM_PHILOSOPHERS,
+                  (unsigned long)((micros() - start_us) / 1000),
+                  (unsigned long)executor.switches(),
+                  (unsigned long)CoExecutor::frameBytes());
+    Serial.println("Done! No deadlock occurred!");
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Dining Philosophers on Coroutines---");
+
+    task_ping = xSemaphoreCreateBinary();
+    task_pong = xSemaphoreCreateBinary();
+    if (task_ping == NULL || task_pong == NULL)
+    {
+        Serial.println("Failed to create semaphores");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    measureMemory();
+    measureSwitch();
+
+    // Seat the philosophers
+    size_t heap_before = xPortGetFreeHeapSize();
+    for (int i = 0; i < NUM_PHILOSOPHERS; i++)
+    {
+        chopstick[i] = new (std::nothrow) CoSemaphore(1);
+        if (chopstick[i] == nullptr || !executor.spawn(philosopher(i)))
+        {
+            Serial.printf("Out of memory at philosopher %d\n", i);
+            while (1)
+                vTaskDelay(pdMS_TO_TICKS(1000));
+        }
+    }
+    executor.spawn(dinner(micros()));
+    Serial.printf("%d philosophers seated in %lu B of heap\n",
+                  NUM_PHILOSOPHERS, (unsigned long)(heap_before - xPortGetFreeHeapSize()));
+
+    if (!executor.start("Executor", 4096, 1, app_cpu))
+    {
+        Serial.println("Failed to start executor");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,225 @@
+/**
+ * ESP32 Deadlock Detector Demo
+ *
+ * part10_deadlock.cpp, which really deadlocks, with a wait-for-graph
+ * monitor in place of the 1 second timeouts of part10_deadlock_timeout.cpp.
+ * Both tasks wait forever (portMAX_DELAY) through DeadlockDetector::take().
+ * A low-priority monitor task scans the waits every interval_ms, reports
+ * the cycle over Serial:
+ *
+ *   DEADLOCK: 2 tasks waiting in a cycle
+ *     Task A waits for "mutex 2", held by Task B
+ *     Task B waits for "mutex 1", held by Task A
+ *
+ * and the recovery callback aborts the wait of the lowest-priority task in
+ * the cycle (xTaskAbortDelay()), which gives its mutex back and retries.
+ *
+ * Serial commands:
+ *   interval <ms>  - change the scan interval
+ *   stats          - scans, cycles found, scan cost and CPU share
+ */
+
+#include <Arduino.h>
+#include <DeadlockDetector.h>
+#include <PortUtils.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t interval_ms = 100;
+static const UBaseType_t monitor_priority = 1;
+static const uint32_t backoff_ms = 50;
+
+// Globals
+static SemaphoreHandle_t mutex_1;
+static SemaphoreHandle_t mutex_2;
+
+static void *mutexHolder(void *lock)
+{
+    return xSemaphoreGetMutexHolder((SemaphoreHandle_t)lock);
+}
+
+static DeadlockDetector detector(mutexHolder);
+
+//*****************************************************************************
+// Recovery
+
+static void abortLowestPriority(const DeadlockCycle &cycle, void *context)
+{
+    TaskHandle_t victim = (TaskHandle_t)cycle.tasks[0];
+    for (uint32_t i = 1; i < cycle.length; i++)
+    {
+        if (uxTaskPriorityGet((TaskHandle_t)cycle.tasks[i]) < uxTaskPriorityGet(victim))
+        {
+            victim = (TaskHandle_t)cycle.tasks[i];
+        }
+    }
+    Serial.printf("Recovery: aborting the wait of %s\n", pcTaskGetName(victim));
+    xTaskAbortDelay(victim);
+}
+
+//*****************************************************************************
+// Tasks
+
+// Take first, then second; on an aborted wait give first back and retry
+static void takeBoth(const char *name, SemaphoreHandle_t first, SemaphoreHandle_t second)
+{
+    while (1)
+    {
+        detector.take(first, portMAX_DELAY);
+        Serial.printf("%s took mutex %d\n", name, first == mutex_1 ? 1 : 2);
+        vTaskDelay(pdMS_TO_TICKS(1));
+
+        if (detector.take(second, portMAX_DELAY) == pdTRUE)
+        {
+            Serial.printf("%s took mutex %d\n", name, second == mutex_1 ? 1 : 2);
+            return;
+        }
+        Serial.printf("%s backing off\n", name);
+        xSemaphoreGive(first);
+        vTaskDelay(pdMS_TO_TICKS(backoff_ms));
+    }
+}
+
+// Task A (high priority)
+void doTaskA(void *parameters)
+{
+    while (1)
+    {
+        takeBoth("Task A", mutex_1, mutex_2);
+
+        Serial.println("Task A doing some work");
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        xSemaphoreGive(mutex_2);
+        xSemaphoreGive(mutex_1);
+
+        Serial.println("Task A going to sleep");
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+// Task B (low priority)
+void doTaskB(void *parameters)
+{
+    while (1)
+    {
+        takeBoth("Task B", mutex_2, mutex_1);
+
+        Serial.println("Task B doing some work");
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        xSemaphoreGive(mutex_1);
+        xSemaphoreGive(mutex_2);
+
+        Serial.println("Task B going to sleep");
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+//*****************************************************************************
+// Console
+
+#define CMD_BUF_SIZE 32
+
+static void printStats()
+{
+    DeadlockDetectorStats s = detector.stats();
+    float avg_us = s.scans ? (float)s.total_scan_cycles / s.scans / cpuMhz() : 0.0f;
+    Serial.printf("Interval %lu ms: %lu scans, %lu cycles, up to %lu waiters, scan avg %.1f us max %.1f us, %.4f%% CPU\n",
+                  (unsigned long)s.interval_ms,
+                  (unsigned long)s.scans,
+                  (unsigned long)s.cycles,
+                  (unsigned long)s.max_waiters,
+                  avg_us,
+                  (float)s.max_scan_cycles / cpuMhz(),
+                  100.0f * avg_us / (s.interval_ms * 1000.0f));
+}
+
+static void handleCommand(char *cmd)
+{
+    if (strncmp(cmd, "interval ", 9) == 0)
+    {
+        detector.setInterval(strtoul(cmd + 9, NULL, 10));
+        detector.resetStats();
+    }
+    else if (strcmp(cmd, "stats") == 0)
+    {
+        printStats();
+    }
+    else
+    {
+        Serial.println("Commands: interval <ms>, stats");
+    }
+}
+
+void consoleTask(void *parameters)
+{
+    char cmd_buf[CMD_BUF_SIZE];
+    uint8_t idx = 0;
+
+    while (1)
+    {
+        while (Serial.available())
+        {
+            char c = Serial.read();
+            if (c == '\r' || c == '\n')
+            {
+                if (idx > 0)
+                {
+                    cmd_buf[idx] = '\0';
+                    Serial.println();
+                    handleCommand(cmd_buf);
+                    idx = 0;
+                }
+            }
+            else if (idx < CMD_BUF_SIZE - 1)
+            {
+                Serial.print(c);
+                cmd_buf[idx++] = c;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Deadlock Detector Demo---");
+
+    mutex_1 = xSemaphoreCreateMutex();
+    mutex_2 = xSemaphoreCreateMutex();
+    detector.addLock(mutex_1, "mutex 1");
+    detector.addLock(mutex_2, "mutex 2");
+    detector.setRecovery(abortLowestPriority, nullptr);
+
+    if (!detector.begin(interval_ms, monitor_priority, app_cpu))
+    {
+        Serial.println("Failed to start deadlock monitor");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    xTaskCreatePinnedToCore(doTaskA, "Task A", 2048, NULL, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(doTaskB, "Task B", 2048, NULL, 1, NULL, app_cpu);
+    xTaskCreatePinnedToCore(consoleTask, "Console", 2048, NULL, 1, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+    // Execution should never get here
+}
@@ -0,0 +1,230 @@
+/**
+ * ESP32 Livelock and Retry Policy Demo
+ *
+ * part10_deadlock_timeout.cpp cures the deadlock with a timed take, but its
+ * two tasks back off by the same fixed 500 ms. Here both tasks have the same
+ * priority, so when their takes time out on the same tick both fail, both
+ * give back, both sleep 500 ms and both collide again: a livelock, the
+ * tasks run but no work gets done.
+ *
+ * After a timeout each task waits the delay of its RetryPolicy. A shared
+ * LivelockDetector counts failures in a row with no work done by anyone and
+ * reports an episode when the streak reaches its threshold. Every
+ * report_ms the sketch prints work per second, timeouts and episodes.
+ *
+ * Commands over Serial (115200, newline terminated):
+ *   fixed | exponential | jitter | decorrelated - switch the retry policy
+ *   stats                                       - print the counters now
+ *
+ * progress/host/retry_policy_sim.cpp runs the same two tasks for every
+ * policy and compares them.
+ */
+
+#include <Arduino.h>
+#include <RetryPolicy.h>
+
+#include <atomic>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const TickType_t mutex_timeout = pdMS_TO_TICKS(1000);
+static const TickType_t work_time = pdMS_TO_TICKS(500);
+static const TickType_t sleep_time = pdMS_TO_TICKS(500);
+static const uint32_t retry_base_us = 500000; // The original fixed sleep
+static const uint32_t retry_max_us = 4000000;
+static const uint32_t livelock_threshold = 4;
+static const uint32_t report_ms = 10000;
+
+#define CMD_BUF_SIZE 32
+
+// Globals
+static SemaphoreHandle_t mutex_1;
+static SemaphoreHandle_t mutex_2;
+static LivelockDetector detector(livelock_threshold);
+static volatile RetryKind retry_kind = RETRY_FIXED;
+static std::atomic<uint32_t> work_done(0);
+static std::atomic<uint32_t> timeouts(0);
+
+struct Worker
+{
+    const char *name;
+    SemaphoreHandle_t *first;
+    SemaphoreHandle_t *second;
+    uint32_t seed;
+};
+
+static Worker worker_a = {"Task A", &mutex_1, &mutex_2, 0x1234};
+static Worker worker_b = {"Task B", &mutex_2, &mutex_1, 0x5678};
+
+//*****************************************************************************
+// Tasks
+
+static void onTimeout(RetryPolicy &policy)
+{
+    timeouts++;
+    if (detector.failure())
+    {
+        Serial.printf("Livelock: %lu timeouts in a row without work (%s policy)\n",
+                      (unsigned long)detector.streak(), retryKindName(policy.config().kind));
+    }
+    retryDelay(policy.nextDelayUs());
+}
+
+void doWorker(void *parameters)
+{
+    Worker *worker = (Worker *)parameters;
+    RetryKind kind = retry_kind;
+    RetryPolicy policy({kind, retry_base_us, retry_max_us}, worker->seed);
+
+    while (1)
+    {
+        if (kind != retry_kind)
+        {
+            kind = retry_kind;
+            policy = RetryPolicy({kind, retry_base_us, retry_max_us}, worker->seed);
+        }
+
+        // Take the first mutex
+        if (xSemaphoreTake(*worker->first, mutex_timeout) != pdTRUE)
+        {
+            onTimeout(policy);
+            continue;
+        }
+        vTaskDelay(1);
+
+        // Take the second mutex
+        if (xSemaphoreTake(*worker->second, mutex_timeout) != pdTRUE)
+        {
+            xSemaphoreGive(*worker->first);
+            onTimeout(policy);
+            continue;
+        }
+
+        // Critical section protected by 2 mutexes
+        vTaskDelay(work_time);
+        work_done++;
+        policy.reset();
+        detector.progress();
+
+        xSemaphoreGive(*worker->second);
+        xSemaphoreGive(*worker->first);
+        vTaskDelay(sleep_time);
+    }
+}
+
+static void printStats(uint32_t elapsed_ms)
+{
+    static uint32_t last_work = 0;
+    uint32_t work = work_done.load();
+    Serial.printf("%-12s work %5.2f/s, %lu done, %lu timeouts, %lu livelock episodes, streak %lu\n",
+                  retryKindName(retry_kind),
+                  elapsed_ms > 0 ? (work - last_work) * 1000.0 / elapsed_ms : 0.0,
+                  (unsigned long)work,
+                  (unsigned long)timeouts.load(),
+                  (unsigned long)detector.episodes(),
+                  (unsigned long)detector.streak());
+    last_work = work;
+}
+
+void reportTask(void *parameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1)
+    {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(report_ms));
+        printStats(report_ms);
+    }
+}
+
+//*****************************************************************************
+// Console
+
+static const char *const command_names[NUM_RETRY_KINDS] = {"fixed", "exponential", "jitter", "decorrelated"};
+
+static void handleCommand(char *cmd)
+{
+    for (uint32_t k = 0; k < NUM_RETRY_KINDS; k++)
+    {
+        if (strcmp(cmd, command_names[k]) == 0)
+        {
+            retry_kind = (RetryKind)k;
+            Serial.printf("Retry policy: %s\n", retryKindName((RetryKind)k));
+            return;
+        }
+    }
+    if (strcmp(cmd, "stats") == 0)
+    {
+        printStats(0);
+    }
+    else
+    {
+        Serial.println("Commands: fixed, exponential, jitter, decorrelated, stats");
+    }
+}
+
+void consoleTask(void *parameters)
+{
+    char buf[CMD_BUF_SIZE];
+    uint8_t idx = 0;
+
+    while (1)
+    {
+        while (Serial.available() > 0)
+        {
+            char c = Serial.read();
+            if (c == '\n' || c == '\r')
+            {
+                if (idx > 0)
+                {
+                    buf[idx] = '\0';
+                    handleCommand(buf);
+                    idx = 0;
+                }
+            }
+            else if (idx < CMD_BUF_SIZE - 1)
+            {
+                buf[idx++] = c;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Livelock and Retry Policy Demo---");
+
+    mutex_1 = xSemaphoreCreateMutex();
+    mutex_2 = xSemaphoreCreateMutex();
+    if (mutex_1 == NULL || mutex_2 == NULL)
+    {
+        Serial.println("Failed to create mutexes");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    // Same priority: both timeouts expire on the same tick and both fail
+    xTaskCreatePinnedToCore(doWorker, worker_a.name, 2048, &worker_a, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(doWorker, worker_b.name, 2048, &worker_b, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(reportTask, "Report", 3072, NULL, 1, NULL, app_cpu);
+    xTaskCreatePinnedToCore(consoleTask, "Console", 3072, NULL, 1, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,222 @@
+/**
+ * ESP32 Dining Philosophers Benchmark
+ *
+ * The part10 dining philosophers solutions as interchangeable strategies
+ * (lib/DiningPhilosophers): naive, hierarchy, arbitrator, uniform
+ * chopsticks, timeout and waiter. Instead of five philosophers printing one meal,
+ * every strategy runs the same configurable table and is measured:
+ * meals/s, mean / p99 / max wait, Jain's fairness index, timeouts and
+ * deadlocks (no meal for stall_ms; the run is then aborted).
+ *
+ * Serial commands:
+ *   n <philosophers>   meals <per philosopher>
+ *   think <us>         eat <us>
+ *   place one|spread|any
+ *   run                run every strategy with the current settings
+ *   speedup            waiter vs the one-at-a-time arbitrator of
+ *                      src/main.cpp, with 5 and 50 philosophers
+ *
+ * progress/host/dining_bench.cpp runs the same table on a PC.
+ */
+
+#include <Arduino.h>
+#include <DiningBench.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t naive_pause_us = 1000; // vTaskDelay(1) between chopsticks, as in the sketches
+static const uint32_t timeout_us = 100000;   // Timeout strategy, per chopstick
+static const uint32_t speedup_tables[] = {5, 50};
+static const uint32_t speedup_stack = 2048;  // 50 tasks must fit in the heap
+
+// Globals
+static DiningConfig config;
+static TaskHandle_t bench_task = nullptr;
+static volatile bool speedup_requested = false;
+
+static void writeLine(const char *line)
+{
+    Serial.println(line);
+}
+
+//*****************************************************************************
+// Tasks
+
+// Runs above the philosophers so the stall watchdog always gets to look
+void benchTask(void *parameters)
+{
+    NaiveDining naive(naive_pause_us);
+    HierarchyDining hierarchy;
+    ArbitratorDining arbitrator;
+    UniformDining uniform;
+    TimeoutDining timeout(timeout_us);
+    WaiterDining waiter;
+    DiningStrategy *strategies[] = {&naive, &hierarchy, &arbitrator, &uniform, &timeout, &waiter};
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (speedup_requested)
+        {
+            speedup_requested = false;
+            Serial.printf("\n%12s %16s %16s %8s\n", "philosophers", "arbitrator m/s", "waiter m/s", "speedup");
+            for (uint32_t t = 0; t < sizeof(speedup_tables) / sizeof(speedup_tables[0]); t++)
+            {
+                DiningConfig table = config;
+                table.philosophers = speedup_tables[t];
+                table.stack_size = speedup_stack;
+                DiningResult serial;
+                DiningResult parallel;
+                bool ran = runDiningBench(arbitrator, table, &serial);
+                vTaskDelay(pdMS_TO_TICKS(100));
+                ran = runDiningBench(waiter, table, &parallel) && ran;
+                vTaskDelay(pdMS_TO_TICKS(100));
+                Serial.printf("%12lu %16.1f %16.1f %7.2fx%s\n",
+                              (unsigned long)table.philosophers,
+                              serial.meals_per_s,
+                              parallel.meals_per_s,
+                              serial.meals_per_s > 0 ? parallel.meals_per_s / serial.meals_per_s : 0.0f,
+                              ran ? "" : "  (failed to create every task)");
+            }
+            continue;
+        }
+
+        Serial.printf("\n%lu philosophers, %lu meals each, think %lu us, eat %lu us, %s\n",
+                      (unsigned long)config.philosophers,
+                      (unsigned long)config.meals,
+                      (unsigned long)config.think_us,
+                      (unsigned long)config.eat_us,
+                      diningPlacementName(config.placement));
+        printDiningHeader(writeLine);
+        for (uint32_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++)
+        {
+            DiningResult result;
+            if (runDiningBench(*strategies[s], config, &result))
+            {
+                printDiningResult(writeLine, result);
+            }
+            else
+            {
+                Serial.printf("%s: failed to set up the table (heap %lu bytes)\n",
+                              strategies[s]->name(),
+                              (unsigned long)xPortGetFreeHeapSize());
+            }
+            // Let aborted philosophers finish deleting themselves
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+}
+
+//*****************************************************************************
+// Console
+
+#define CMD_BUF_SIZE 32
+
+static void handleCommand(char *cmd)
+{
+    if (strncmp(cmd, "n ", 2) == 0)
+    {
+        config.philosophers = strtoul(cmd + 2, NULL, 10);
+    }
+    else if (strncmp(cmd, "meals ", 6) == 0)
+    {
+        config.meals = strtoul(cmd + 6, NULL, 10);
+    }
+    else if (strncmp(cmd, "think ", 6) == 0)
+    {
+        config.think_us = strtoul(cmd + 6, NULL, 10);
+    }
+    else if (strncmp(cmd, "eat ", 4) == 0)
+    {
+        config.eat_us = strtoul(cmd + 4, NULL, 10);
+    }
+    else if (strcmp(cmd, "place one") == 0)
+    {
+        config.placement = DINING_ONE_CORE;
+    }
+    else if (strcmp(cmd, "place spread") == 0)
+    {
+        config.placement = DINING_SPREAD;
+    }
+    else if (strcmp(cmd, "place any") == 0)
+    {
+        config.placement = DINING_ANY_CORE;
+    }
+    else if (strcmp(cmd, "run") == 0)
+    {
+        xTaskNotifyGive(bench_task);
+    }
+    else if (strcmp(cmd, "speedup") == 0)
+    {
+        speedup_requested = true;
+        xTaskNotifyGive(bench_task);
+    }
+    else
+    {
+        Serial.println("Commands: n <count>, meals <count>, think <us>, eat <us>, place one|spread|any, run, speedup");
+    }
+}
+
+void consoleTask(void *parameters)
+{
+    char cmd_buf[CMD_BUF_SIZE];
+    uint8_t idx = 0;
+
+    while (1)
+    {
+        while (Serial.available())
+        {
+            char c = Serial.read();
+            if (c == '\r' || c == '\n')
+            {
+                if (idx > 0)
+                {
+                    cmd_buf[idx] = '\0';
+                    Serial.println();
+                    handleCommand(cmd_buf);
+                    idx = 0;
+                }
+            }
+            else if (idx < CMD_BUF_SIZE - 1)
+            {
+                Serial.print(c);
+                cmd_buf[idx++] = c;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Dining Philosophers Benchmark---");
+
+    config = diningDefaultConfig();
+
+    xTaskCreatePinnedToCore(benchTask, "Bench", 4096, NULL, config.priority + 1, &bench_task, app_cpu);
+    xTaskCreatePinnedToCore(consoleTask, "Console", 2048, NULL, 1, NULL, app_cpu);
+
+    // First run with the defaults
+    xTaskNotifyGive(bench_task);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+    // Execution should never get here
+}
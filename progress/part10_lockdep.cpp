@@ -0,0 +1,164 @@
+/**
+ * ESP32 Lock-Order Validator Demo
+ *
+ * part10_deadlock.cpp with every mutex taken through LockDep. Task B starts
+ * after Task A has been through one round, so the first time it takes
+ * mutex 2 then mutex 1 the tasks do not (yet) deadlock; the validator
+ * reports the inversion anyway, naming both tasks:
+ *
+ *   LOCKDEP: possible deadlock, lock order inversion
+ *     Task B takes "mutex 1" while holding "mutex 2"
+ *     but this order was seen before:
+ *       "mutex 1" -> "mutex 2" (Task A)
+ *
+ * Before the tasks start, the sketch measures what a checked lock + unlock
+ * costs against plain xSemaphoreTake() / xSemaphoreGive(), nested two deep.
+ *
+ * LOCKDEP is defined here for the demo; in other sketches turn the checks on
+ * with build_flags = -D LOCKDEP=1 in platformio.ini.
+ */
+
+#define LOCKDEP 1
+
+#include <Arduino.h>
+#include <LockDep.h>
+#include <PortUtils.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t timing_pairs = 10000;
+static const uint32_t task_b_start_ms = 1500; // After Task A's first round
+
+// Globals
+static SemaphoreHandle_t mutex_1;
+static SemaphoreHandle_t mutex_2;
+
+//*****************************************************************************
+// Overhead
+
+static void benchmarkOverhead()
+{
+    SemaphoreHandle_t outer = xSemaphoreCreateMutex();
+    SemaphoreHandle_t inner = xSemaphoreCreateMutex();
+    lockdepRegister(outer, "bench outer");
+    lockdepRegister(inner, "bench inner");
+
+    uint32_t start = cpuCycleCount();
+    for (uint32_t i = 0; i < timing_pairs; i++)
+    {
+        xSemaphoreTake(outer, portMAX_DELAY);
+        xSemaphoreTake(inner, portMAX_DELAY);
+        xSemaphoreGive(inner);
+        xSemaphoreGive(outer);
+    }
+    uint32_t plain = cpuCycleCount() - start;
+
+    start = cpuCycleCount();
+    for (uint32_t i = 0; i < timing_pairs; i++)
+    {
+        lockdepTakeChecked(outer, portMAX_DELAY);
+        lockdepTakeChecked(inner, portMAX_DELAY);
+        lockdepGiveChecked(inner);
+        lockdepGiveChecked(outer);
+    }
+    uint32_t checked = cpuCycleCount() - start;
+
+    // Per lock + unlock pair; the loop does two
+    float plain_cycles = (float)plain / (2 * timing_pairs);
+    float checked_cycles = (float)checked / (2 * timing_pairs);
+    Serial.printf("Per lock + unlock, nested 2 deep: plain %.0f cycles, checked %.0f cycles (+%.0f cycles, +%.2f us)\n",
+                  plain_cycles,
+                  checked_cycles,
+                  checked_cycles - plain_cycles,
+                  (checked_cycles - plain_cycles) / cpuMhz());
+}
+
+//*****************************************************************************
+// Tasks
+
+// Task A (high priority)
+void doTaskA(void *parameters)
+{
+    while (1)
+    {
+        lockdepTake(mutex_1, portMAX_DELAY);
+        Serial.println("Task A took mutex 1");
+        vTaskDelay(pdMS_TO_TICKS(1));
+
+        lockdepTake(mutex_2, portMAX_DELAY);
+        Serial.println("Task A took mutex 2");
+
+        Serial.println("Task A doing some work");
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        lockdepGive(mutex_2);
+        lockdepGive(mutex_1);
+
+        Serial.println("Task A going to sleep");
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+// Task B (low priority), the opposite order
+void doTaskB(void *parameters)
+{
+    vTaskDelay(pdMS_TO_TICKS(task_b_start_ms));
+
+    while (1)
+    {
+        lockdepTake(mutex_2, portMAX_DELAY);
+        Serial.println("Task B took mutex 2");
+        vTaskDelay(pdMS_TO_TICKS(1));
+
+        lockdepTake(mutex_1, portMAX_DELAY);
+        Serial.println("Task B took mutex 1");
+
+        Serial.println("Task B doing some work");
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        lockdepGive(mutex_1);
+        lockdepGive(mutex_2);
+
+        Serial.println("Task B going to sleep");
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Lock-Order Validator Demo---");
+
+    benchmarkOverhead();
+
+    mutex_1 = xSemaphoreCreateMutex();
+    mutex_2 = xSemaphoreCreateMutex();
+    if (!lockdepRegister(mutex_1, "mutex 1") || !lockdepRegister(mutex_2, "mutex 2"))
+    {
+        Serial.println("Failed to register mutexes");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    xTaskCreatePinnedToCore(doTaskA, "Task A", 2048, NULL, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(doTaskB, "Task B", 2048, NULL, 1, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+    // Execution should never get here
+}
@@ -0,0 +1,216 @@
+/**
+ * ESP32 Multi-Lock Demo
+ *
+ * part10_deadlock.cpp with both mutexes taken through MultiLock: Task A
+ * asks for {mutex_1, mutex_2}, Task B for {mutex_2, mutex_1}, and neither
+ * deadlocks because MultiLock sorts the set by rank before taking it. The
+ * mutexes are given back when the MultiLock goes out of scope.
+ *
+ * Before that the sketch measures sets taken per second under contention,
+ * one task per core hammering the same pair in opposite orders:
+ *
+ *   hand hierarchy   lower-numbered mutex first (part10_deadlock_hierarchy.cpp)
+ *   hand timeout     own order with a timed take, back off on timeout
+ *                    (part10_deadlock_timeout.cpp)
+ *   MultiLock order  ordered by rank
+ *   MultiLock try    try-all-or-none with randomized exponential backoff
+ */
+
+#include <Arduino.h>
+#include <MultiLock.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t bench_ms = 2000;
+static const TickType_t hand_timeout = pdMS_TO_TICKS(10);
+static const TickType_t hand_sleep = pdMS_TO_TICKS(5);
+
+enum Method
+{
+    HAND_HIERARCHY = 0,
+    HAND_TIMEOUT,
+    MULTI_ORDERED,
+    MULTI_TRY_ALL,
+    NUM_METHODS
+};
+
+static const char *const method_names[NUM_METHODS] = {"hand hierarchy", "hand timeout", "MultiLock order", "MultiLock try"};
+
+// Globals
+static SemaphoreHandle_t mutex_1;
+static SemaphoreHandle_t mutex_2;
+static SemaphoreHandle_t done_sem;
+static volatile bool running = false;
+static volatile Method method = HAND_HIERARCHY;
+static volatile uint32_t shared_count = 0; // Protected by both mutexes
+
+//*****************************************************************************
+// Benchmark
+
+struct BenchWorker
+{
+    SemaphoreHandle_t first;
+    SemaphoreHandle_t second;
+    uint32_t sets;
+    uint32_t timeouts;
+};
+
+static bool takeSet(BenchWorker *w)
+{
+    switch (method)
+    {
+    case HAND_HIERARCHY:
+    {
+        // Lower address first, as the hierarchy sketch does by number
+        SemaphoreHandle_t lo = (w->first < w->second) ? w->first : w->second;
+        SemaphoreHandle_t hi = (w->first < w->second) ? w->second : w->first;
+        xSemaphoreTake(lo, portMAX_DELAY);
+        xSemaphoreTake(hi, portMAX_DELAY);
+        shared_count = shared_count + 1;
+        xSemaphoreGive(hi);
+        xSemaphoreGive(lo);
+        return true;
+    }
+    case HAND_TIMEOUT:
+        if (xSemaphoreTake(w->first, hand_timeout) != pdTRUE)
+        {
+            return false;
+        }
+        if (xSemaphoreTake(w->second, hand_timeout) != pdTRUE)
+        {
+            xSemaphoreGive(w->first);
+            return false;
+        }
+        shared_count = shared_count + 1;
+        xSemaphoreGive(w->second);
+        xSemaphoreGive(w->first);
+        return true;
+    default:
+    {
+        MultiLock lock({w->first, w->second}, method == MULTI_ORDERED ? MULTI_LOCK_ORDERED : MULTI_LOCK_TRY_ALL);
+        shared_count = shared_count + 1;
+        return true;
+    }
+    }
+}
+
+void benchWorker(void *parameters)
+{
+    BenchWorker *w = (BenchWorker *)parameters;
+    while (running)
+    {
+        if (takeSet(w))
+        {
+            w->sets++;
+        }
+        else
+        {
+            w->timeouts++;
+            vTaskDelay(hand_sleep);
+        }
+    }
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+static void runBenchmark()
+{
+    Serial.printf("%-16s %10s %10s\n", "method", "sets/s", "timeouts");
+    for (uint32_t m = 0; m < NUM_METHODS; m++)
+    {
+        BenchWorker workers[2] = {{mutex_1, mutex_2, 0, 0}, {mutex_2, mutex_1, 0, 0}};
+        method = (Method)m;
+        shared_count = 0;
+        running = true;
+        // One per core, equal priority: real contention on the pair
+        for (uint32_t t = 0; t < 2; t++)
+        {
+            xTaskCreatePinnedToCore(benchWorker, "Worker", 3072, &workers[t], 1, NULL, (BaseType_t)(t % portNUM_PROCESSORS));
+        }
+        vTaskDelay(pdMS_TO_TICKS(bench_ms));
+        running = false;
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+
+        uint32_t sets = workers[0].sets + workers[1].sets;
+        Serial.printf("%-16s %10lu %10lu%s\n",
+                      method_names[m],
+                      (unsigned long)((uint64_t)sets * 1000 / bench_ms),
+                      (unsigned long)(workers[0].timeouts + workers[1].timeouts),
+                      shared_count == sets ? "" : "  LOST UPDATES");
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+// Task A (high priority)
+void doTaskA(void *parameters)
+{
+    while (1)
+    {
+        {
+            MultiLock lock({mutex_1, mutex_2});
+            Serial.println("Task A took mutex 1 and mutex 2");
+            Serial.println("Task A doing some work");
+            vTaskDelay(pdMS_TO_TICKS(500));
+        }
+
+        Serial.println("Task A going to sleep");
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+// Task B (low priority), the opposite order at the call site
+void doTaskB(void *parameters)
+{
+    while (1)
+    {
+        {
+            MultiLock lock({mutex_2, mutex_1});
+            Serial.println("Task B took mutex 2 and mutex 1");
+            Serial.println("Task B doing some work");
+            vTaskDelay(pdMS_TO_TICKS(500));
+        }
+
+        Serial.println("Task B going to sleep");
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Multi-Lock Demo---");
+
+    mutex_1 = xSemaphoreCreateMutex();
+    mutex_2 = xSemaphoreCreateMutex();
+    done_sem = xSemaphoreCreateCounting(2, 0);
+
+    // Above the workers so it can stop them on time
+    vTaskPrioritySet(NULL, 2);
+    runBenchmark();
+    vTaskPrioritySet(NULL, 1);
+
+    xTaskCreatePinnedToCore(doTaskA, "Task A", 2048, NULL, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(doTaskB, "Task B", 2048, NULL, 1, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+    // Execution should never get here
+}
@@ -0,0 +1,263 @@
+/**
+ * ESP32 Shared-Stack Jobs
+ *
+ * The producers of part7_semaphore.cpp, the philosophers of src/main.cpp and
+ * remainTimeTask in part8_software_timer_challenge.cpp are tasks that run
+ * to completion and vTaskDelete(NULL), each with a stack of its own. Here
+ * the same kind of work is a BasicJob from JobScheduler: every job of a
+ * level runs to completion on the level's one stack.
+ *
+ * With 100 concurrent producers, against a task per producer:
+ *
+ *   memory    heap for 100 tasks with a 1024 B stack vs one level task
+ *             (the jobs themselves are static)
+ *   dispatch  CPU cycles from start to finished per producer: create, run
+ *             and delete a task vs activate and run a job
+ *
+ * Then part7_semaphore.cpp as jobs: 5 producers write their number 3 times
+ * into a 5-slot buffer and a consumer prints it. A producer that finds the
+ * buffer full does not wait; it returns and the consumer activates it
+ * again once it has made room.
+ */
+
+#include <Arduino.h>
+#include <JobScheduler.h>
+#include <PortUtils.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+enum
+{
+    NUM_JOBS = 100,
+    BUF_SIZE = 5,
+    NUM_PRODUCERS = 5
+};
+static const uint32_t rounds = 5;
+static const uint32_t task_stack_size = 1024; // Bytes in ESP32, as in part7_semaphore.cpp
+static const UBaseType_t job_priority = 2;    // Above setup(), so every start runs at once
+static const int num_writes = 3;
+static const JobLevelConfig levels[] = {
+    {"Jobs", job_priority, 2048},
+};
+
+// Globals
+static JobScheduler jobs;
+static SemaphoreHandle_t done_sem;
+static BasicJob bench_jobs[NUM_JOBS];
+
+// Producer/consumer, only touched from jobs of the one level
+static int buf[BUF_SIZE];
+static int write_index = 0;
+static int read_index = 0;
+static int filled = 0;
+static int consumed = 0;
+static int writes_left[NUM_PRODUCERS];
+static bool waiting[NUM_PRODUCERS];
+static BasicJob producer_jobs[NUM_PRODUCERS];
+static BasicJob consumer_job;
+
+//*****************************************************************************
+// Benchmark
+
+static void benchBody()
+{
+    xSemaphoreGive(done_sem);
+}
+
+void benchTask(void *parameters)
+{
+    benchBody();
+    vTaskDelete(NULL);
+}
+
+static void benchJob(void *parameters)
+{
+    benchBody();
+}
+
+static void waitDone(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+    }
+}
+
+// Heap and cycles per producer for a task each
+static bool measureTasks(size_t *bytes, float *cycles)
+{
+    TaskHandle_t tasks[NUM_JOBS];
+    size_t before = xPortGetFreeHeapSize();
+    for (uint32_t i = 0; i < NUM_JOBS; i++)
+    {
+        if (xTaskCreatePinnedToCore(benchTask, "Producer", task_stack_size, (void *)(uintptr_t)i, 0, &tasks[i], app_cpu) != pdPASS)
+        {
+            return false;
+        }
+        vTaskSuspend(tasks[i]);
+    }
+    *bytes = before - xPortGetFreeHeapSize();
+    for (uint32_t i = 0; i < NUM_JOBS; i++)
+    {
+        vTaskDelete(tasks[i]);
+    }
+    vTaskDelay(pdMS_TO_TICKS(100)); // The idle task frees them
+
+    uint64_t total = 0;
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        uint32_t start = cpuCycleCount();
+        for (uint32_t i = 0; i < NUM_JOBS; i++)
+        {
+            xTaskCreatePinnedToCore(benchTask, "Producer", task_stack_size, (void *)(uintptr_t)i, job_priority, NULL, app_cpu);
+        }
+        waitDone(NUM_JOBS);
+        total += cpuCycleCount() - start;
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    *cycles = (float)total / (rounds * NUM_JOBS);
+    return true;
+}
+
+static float measureJobs()
+{
+    for (uint32_t i = 0; i < NUM_JOBS; i++)
+    {
+        JobScheduler::initJob(&bench_jobs[i], benchJob, (void *)(uintptr_t)i, 0);
+    }
+
+    uint64_t total = 0;
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        uint32_t start = cpuCycleCount();
+        for (uint32_t i = 0; i < NUM_JOBS; i++)
+        {
+            jobs.activate(&bench_jobs[i]);
+        }
+        waitDone(NUM_JOBS);
+        total += cpuCycleCount() - start;
+    }
+    return (float)total / (rounds * NUM_JOBS);
+}
+
+//*****************************************************************************
+// Producers and consumer (part7_semaphore.cpp)
+
+static void producer(void *parameters)
+{
+    int num = (int)(intptr_t)parameters;
+    if (filled == BUF_SIZE)
+    {
+        waiting[num] = true; // The consumer activates us again
+        return;
+    }
+    buf[write_index] = num;
+    write_index = (write_index + 1) % BUF_SIZE;
+    filled++;
+    jobs.activate(&consumer_job);
+
+    if (--writes_left[num] > 0)
+    {
+        jobs.activate(&producer_jobs[num]);
+    }
+}
+
+static void consumer(void *parameters)
+{
+    while (filled > 0)
+    {
+        Serial.println(buf[read_index]);
+        read_index = (read_index + 1) % BUF_SIZE;
+        filled--;
+        consumed++;
+    }
+    for (int i = 0; i < NUM_PRODUCERS; i++)
+    {
+        if (waiting[i])
+        {
+            waiting[i] = false;
+            jobs.activate(&producer_jobs[i]);
+        }
+    }
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Shared-Stack Jobs---");
+
+    done_sem = xSemaphoreCreateCounting(NUM_JOBS, 0);
+    if (done_sem == NULL)
+    {
+        Serial.println("Failed to create semaphore");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    size_t task_bytes = 0;
+    float task_cycles = 0;
+    if (!measureTasks(&task_bytes, &task_cycles))
+    {
+        Serial.println("Not enough heap for a task per producer");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    size_t before = xPortGetFreeHeapSize();
+    if (!jobs.begin(levels, sizeof(levels) / sizeof(levels[0]), app_cpu))
+    {
+        Serial.println("Failed to start job levels");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    size_t level_bytes = before - xPortGetFreeHeapSize();
+    float job_cycles = measureJobs();
+    size_t job_bytes = level_bytes + sizeof(bench_jobs);
+
+    Serial.printf("%d concurrent producers:\n", NUM_JOBS);
+    Serial.printf("  task per producer  %6lu B heap  %7.0f cycles per dispatch\n",
+                  (unsigned long)task_bytes, task_cycles);
+    Serial.printf("  jobs on one stack  %6lu B       %7.0f cycles per dispatch (%lu B per job)\n",
+                  (unsigned long)job_bytes, job_cycles, (unsigned long)sizeof(BasicJob));
+    Serial.printf("  %.1f%% less memory, %.1fx faster, %lu B of the level stack never used\n",
+                  100.0f * (1.0f - (float)job_bytes / (float)task_bytes),
+                  task_cycles / job_cycles,
+                  (unsigned long)jobs.stackHighWater(0));
+
+    // The consumer runs before any producer that is ready with it. A
+    // producer activates itself again while it runs, and the running
+    // activation still counts, hence room for two.
+    JobScheduler::initJob(&consumer_job, consumer, NULL, 0, 1);
+    for (int i = 0; i < NUM_PRODUCERS; i++)
+    {
+        writes_left[i] = num_writes;
+        waiting[i] = false;
+        JobScheduler::initJob(&producer_jobs[i], producer, (void *)(intptr_t)i, 0, 0, 2);
+    }
+    for (int i = 0; i < NUM_PRODUCERS; i++)
+    {
+        jobs.activate(&producer_jobs[i]);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.printf("%d of %d values consumed\n", consumed, NUM_PRODUCERS * num_writes);
+    jobs.printStats([](const char *line) { Serial.println(line); });
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
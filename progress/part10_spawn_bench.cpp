@@ -0,0 +1,232 @@
+/**
+ * ESP32 Task Spawn Benchmark
+ *
+ * src/main.cpp and the part10 challenge sketches start each philosopher
+ * with (void *)&i and then wait on bin_sem until the new task has copied i.
+ * Startup is serialized: one round trip through the scheduler per task.
+ *
+ * This sketch measures the time from the first xTaskCreate() until the last
+ * task is running with its argument, for 5, 50 and 200 tasks:
+ *
+ *   handshake  &i plus bin_sem, as in the sketches
+ *   batch      spawnIndexed() from TaskSpawn: the index is copied into each
+ *              task's own block, no handshake, and the whole batch is
+ *              created before any of the new tasks runs (they share the
+ *              creator's core, which SpawnBatch holds back)
+ *
+ * All tasks stay alive until the last one runs, so 200 tasks need about
+ * 200 * (stack + TCB) of heap. Sizes that do not fit are reported and
+ * skipped. Every task must see a distinct index.
+ */
+
+#include <Arduino.h>
+#include <PortUtils.h>
+#include <TaskSpawn.h>
+
+#include <atomic>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+enum
+{
+    MAX_TASKS = 200
+};
+static const uint32_t task_counts[] = {5, 50, MAX_TASKS};
+static const uint32_t num_counts = sizeof(task_counts) / sizeof(task_counts[0]);
+static const uint32_t runs = 5;
+static const uint32_t task_stack_size = 1024; // Bytes in ESP32
+static const UBaseType_t task_priority = 1;   // Same as setup(), like the philosophers
+
+// Globals
+static SemaphoreHandle_t bin_sem;     // Handshake: parameter copied
+static SemaphoreHandle_t all_sem;     // Last task running
+static SemaphoreHandle_t release_sem; // Given once per task when all are running
+static SemaphoreHandle_t done_sem;    // Task about to exit
+
+static std::atomic<uint32_t> running(0);
+static uint32_t expected = 0;
+static uint64_t all_running_us = 0;
+static std::atomic<uint8_t> seen[MAX_TASKS];
+
+//*****************************************************************************
+// Tasks
+
+static void arrive(int num)
+{
+    if (num >= 0 && num < MAX_TASKS)
+    {
+        seen[num].fetch_add(1);
+    }
+    if (running.fetch_add(1) + 1 == expected)
+    {
+        all_running_us = monotonicMicros();
+        xSemaphoreGive(all_sem);
+    }
+
+    // Stay alive until every task is running
+    xSemaphoreTake(release_sem, portMAX_DELAY);
+    xSemaphoreGive(done_sem);
+}
+
+void handshakeTask(void *parameters)
+{
+    int num = *(int *)parameters;
+    xSemaphoreGive(bin_sem);
+    arrive(num);
+    vTaskDelete(NULL);
+}
+
+static void spawnedTask(const int &num)
+{
+    arrive(num);
+}
+
+//*****************************************************************************
+// Runs
+
+static void prepare(uint32_t count)
+{
+    running.store(0);
+    expected = count;
+    for (uint32_t i = 0; i < MAX_TASKS; i++)
+    {
+        seen[i].store(0);
+    }
+}
+
+// Let the tasks go and wait until they are gone; true if all indexes arrived once
+static bool finish(uint32_t created, uint32_t count)
+{
+    if (created == count)
+    {
+        xSemaphoreTake(all_sem, portMAX_DELAY);
+    }
+    for (uint32_t i = 0; i < created; i++)
+    {
+        xSemaphoreGive(release_sem);
+    }
+    for (uint32_t i = 0; i < created; i++)
+    {
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+    }
+    // The idle task frees the deleted tasks' memory
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (seen[i].load() != 1)
+        {
+            return false;
+        }
+    }
+    return created == count;
+}
+
+static bool runHandshake(uint32_t count, uint32_t *elapsed_us)
+{
+    char task_name[20];
+    uint32_t created = 0;
+    prepare(count);
+    uint64_t t0 = monotonicMicros();
+    for (int i = 0; i < (int)count; i++)
+    {
+        sprintf(task_name, "Worker %i", i);
+        if (xTaskCreatePinnedToCore(handshakeTask, task_name, task_stack_size, (void *)&i, task_priority, NULL, app_cpu) != pdPASS)
+        {
+            break;
+        }
+        xSemaphoreTake(bin_sem, portMAX_DELAY);
+        created++;
+    }
+    bool ok = finish(created, count);
+    *elapsed_us = (uint32_t)(all_running_us - t0);
+    return ok;
+}
+
+static bool runBatch(uint32_t count, uint32_t *elapsed_us)
+{
+    SpawnConfig config = {"Worker", task_stack_size, task_priority, app_cpu};
+    prepare(count);
+    uint64_t t0 = monotonicMicros();
+    uint32_t created = spawnIndexed(spawnedTask, count, config);
+    bool ok = finish(created, count);
+    *elapsed_us = (uint32_t)(all_running_us - t0);
+    return ok;
+}
+
+static void runBenchmark()
+{
+    Serial.printf("Create until all running, best of %lu runs\n", (unsigned long)runs);
+    Serial.printf("%8s %14s %14s %8s\n", "tasks", "handshake us", "batch us", "speedup");
+
+    for (uint32_t c = 0; c < num_counts; c++)
+    {
+        uint32_t count = task_counts[c];
+        uint32_t best_handshake = UINT32_MAX;
+        uint32_t best_batch = UINT32_MAX;
+        bool ok = true;
+        for (uint32_t r = 0; r < runs && ok; r++)
+        {
+            uint32_t us = 0;
+            ok = runHandshake(count, &us);
+            if (us < best_handshake)
+            {
+                best_handshake = us;
+            }
+            ok = ok && runBatch(count, &us);
+            if (us < best_batch)
+            {
+                best_batch = us;
+            }
+        }
+        if (!ok)
+        {
+            Serial.printf("%8lu did not fit (free heap %lu bytes)\n",
+                          (unsigned long)count, (unsigned long)xPortGetFreeHeapSize());
+            continue;
+        }
+        Serial.printf("%8lu %14lu %14lu %7.2fx\n",
+                      (unsigned long)count,
+                      (unsigned long)best_handshake,
+                      (unsigned long)best_batch,
+                      (double)best_handshake / best_batch);
+    }
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Task Spawn Benchmark---");
+
+    bin_sem = xSemaphoreCreateBinary();
+    all_sem = xSemaphoreCreateBinary();
+    release_sem = xSemaphoreCreateCounting(MAX_TASKS, 0);
+    done_sem = xSemaphoreCreateCounting(MAX_TASKS, 0);
+    if (bin_sem == NULL || all_sem == NULL || release_sem == NULL || done_sem == NULL)
+    {
+        Serial.println("Failed to create kernel objects");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    runBenchmark();
+    Serial.println("Done");
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
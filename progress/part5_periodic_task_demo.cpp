@@ -0,0 +1,130 @@
+/**
+ * ESP32 Periodic Task Demo
+ *
+ * The LED blink from part5_queue_challenge.cpp rebuilt on PeriodicTask:
+ * releases are absolute (xTaskDelayUntil), so the blink period does not
+ * drift by the loop body's execution time. A second "load" task has a
+ * variable execution time and occasionally overruns its period.
+ *
+ * Serial commands:
+ *   delay <ms>              change the LED blink interval
+ *   periodic stats          jitter / lateness histograms for every task
+ *   periodic reset          clear the statistics
+ *   periodic <name> <ms>    change the period of any periodic task
+ */
+
+#include <Arduino.h>
+#include <BoardConfig.h>
+#include <PeriodicTask.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+#define LED_PIN LED_BUILTIN // Use the built-in LED pin
+#define SERIAL_BUF_SIZE 64  // Size of the serial input buffer
+
+// Settings
+static const uint32_t blink_interval_ms = 500; // LED toggles once per period
+static const uint32_t load_period_ms = 20;     // Period of the load task
+static const uint32_t load_max_us = 25000;     // Worst-case load job (overruns)
+
+// Globals
+static PeriodicTask led_task;
+static PeriodicTask load_task;
+
+//*****************************************************************************
+// Periodic jobs (run once per release, must return)
+
+void ledBlinkJob(void *parameters)
+{
+    static bool ledstate = false;
+    ledstate = !ledstate;
+    digitalWrite(LED_PIN, ledstate ? HIGH : LOW);
+}
+
+// Busy work of varying length; roughly 1 in 50 jobs overruns its period
+void loadJob(void *parameters)
+{
+    uint32_t busy_us = (random(0, 50) == 0) ? load_max_us : (uint32_t)random(1000, 5000);
+    uint32_t start = micros();
+    while (micros() - start < busy_us)
+    {
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+void serialMonitorTask(void *parameters)
+{
+    char buf[SERIAL_BUF_SIZE];
+    size_t len = 0;
+
+    while (1)
+    {
+        while (Serial.available())
+        {
+            char c = Serial.read();
+            if (c == '\n' || c == '\r')
+            {
+                buf[len] = '\0';
+                if (len > 0)
+                {
+                    Serial.println();
+
+                    int value;
+                    if (sscanf(buf, "delay %d", &value) == 1 && value > 0)
+                    {
+                        led_task.setPeriod((uint32_t)value);
+                        Serial.printf("LED delay interval set to %d ms\n", value);
+                    }
+                    else if (!PeriodicTask::handleCommand(buf))
+                    {
+                        Serial.println("Commands: delay <ms> | periodic stats | periodic reset | periodic <name> <ms>");
+                    }
+                }
+                len = 0;
+            }
+            else if (len < SERIAL_BUF_SIZE - 1)
+            {
+                buf[len++] = c;
+                Serial.print(c);
+            }
+        }
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    Serial.println();
+    Serial.println("---FreeRTOS Periodic Task Demo---");
+
+    pinMode(LED_PIN, OUTPUT);
+
+    if (!led_task.begin("LED Blink", ledBlinkJob, NULL, blink_interval_ms, 2048, 2, app_cpu) ||
+        !load_task.begin("Load", loadJob, NULL, load_period_ms, 2048, 1, app_cpu))
+    {
+        Serial.println("Failed to create periodic tasks!");
+        while (1)
+            vTaskDelay(1000);
+    }
+
+    xTaskCreatePinnedToCore(serialMonitorTask, "SerialMonitor", 3072, NULL, 1, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,285 @@
+/**
+ * ESP32 Deadline Timer Benchmark
+ *
+ * doCLI() restarts the LED timer for every received byte. This sketch replays
+ * 1,000 restarts per second (steady, and as pasted 100-byte lines) against:
+ *
+ *   xTimerReset   - one daemon queue command per restart (current pattern)
+ *   DeadlineTimer - touch() moves the deadline in place
+ *
+ * For each run we report the daemon commands posted, caller cost per restart
+ * and CPU left over for a lowest-priority spinner task on each core, compared
+ * to an idle baseline.
+ *
+ * Last, a full daemon queue: the daemon has to re-arm a moved deadline while
+ * a task on the other core keeps every slot of its queue taken. The helper
+ * task must re-arm instead and the callback must still fire on time.
+ */
+
+#include <Arduino.h>
+#include <DeadlineTimer.h>
+#include <PortUtils.h>
+
+// Settings
+static const TickType_t timeout = pdMS_TO_TICKS(50); // Timeout being restarted
+static const uint32_t run_ms = 5000;                 // Duration of each run
+static const uint32_t restarts_per_second = 1000;
+static const uint32_t paste_len = 100; // Bytes per pasted line in burst mode
+static const uint32_t fill_us = 20000;   // How long the queue is kept full
+
+enum Mode
+{
+    MODE_XTIMER = 0,
+    MODE_DEADLINE
+};
+
+// Globals
+static TimerHandle_t rtos_timer = NULL;
+static DeadlineTimer deadline_timer;
+static volatile uint32_t expiries = 0;
+static volatile bool spin_run = false;
+static volatile uint32_t spin_loops[portNUM_PROCESSORS];
+static SemaphoreHandle_t done_sem = nullptr;
+static DeadlineTimer rescue_timer;
+static TimerHandle_t filler_timer = NULL;
+static volatile uint32_t rescue_expiries = 0;
+static volatile TickType_t rescue_fired_at = 0;
+
+//*****************************************************************************
+// Callbacks
+
+void rtosTimerCallback(TimerHandle_t xTimer)
+{
+    expiries = expiries + 1;
+}
+
+void deadlineCallback(DeadlineTimer *timer)
+{
+    expiries = expiries + 1;
+}
+
+void rescueCallback(DeadlineTimer *timer)
+{
+    rescue_fired_at = xTaskGetTickCount();
+    rescue_expiries = rescue_expiries + 1;
+}
+
+void fillerCallback(TimerHandle_t xTimer)
+{
+}
+
+//*****************************************************************************
+// Tasks
+
+// Lowest priority busy loop: whatever it counts is CPU nobody else wanted
+void spinTask(void *parameters)
+{
+    uint32_t core = (uint32_t)(uintptr_t)parameters;
+    while (1)
+    {
+        if (spin_run)
+        {
+            spin_loops[core] = spin_loops[core] + 1;
+        }
+    }
+}
+
+//*****************************************************************************
+// Benchmarks
+
+static void restartOnce(Mode mode)
+{
+    if (mode == MODE_XTIMER)
+    {
+        xTimerReset(rtos_timer, portMAX_DELAY);
+    }
+    else
+    {
+        deadline_timer.touch();
+    }
+}
+
+static void measureSpare(uint32_t *loops)
+{
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        spin_loops[core] = 0;
+    }
+    spin_run = true;
+    vTaskDelay(pdMS_TO_TICKS(run_ms));
+    spin_run = false;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        loops[core] = spin_loops[core];
+    }
+}
+
+// Drive restarts from this task while the spinners measure spare CPU
+struct RunResult
+{
+    uint32_t restarts;
+    uint64_t caller_cycles;
+};
+
+static RunResult result;
+
+void restartTask(void *parameters)
+{
+    Mode mode = (Mode)((uintptr_t)parameters & 0xFF);
+    bool paste = ((uintptr_t)parameters & 0x100) != 0;
+    uint32_t rounds = paste ? (run_ms * restarts_per_second / 1000) / paste_len : run_ms;
+    TickType_t period = paste ? pdMS_TO_TICKS(paste_len * 1000 / restarts_per_second) : 1;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    result.restarts = 0;
+    result.caller_cycles = 0;
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        uint32_t burst = paste ? paste_len : restarts_per_second / configTICK_RATE_HZ;
+        uint32_t t0 = cpuCycleCount();
+        for (uint32_t i = 0; i < burst; i++)
+        {
+            restartOnce(mode);
+        }
+        result.caller_cycles += cpuCycleCount() - t0;
+        result.restarts += burst;
+        vTaskDelayUntil(&last_wake, period);
+    }
+
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+static void runMode(Mode mode, bool paste, const uint32_t *baseline)
+{
+    uint32_t loops[portNUM_PROCESSORS];
+    uint32_t commands_before = deadline_timer.daemonCommands();
+
+    expiries = 0;
+    xTaskCreatePinnedToCore(restartTask,
+                            "Restarter",
+                            2048,
+                            (void *)(uintptr_t)(mode | (paste ? 0x100 : 0)),
+                            2,
+                            NULL,
+                            1);
+    measureSpare(loops);
+    xSemaphoreTake(done_sem, portMAX_DELAY);
+    vTaskDelay(timeout * 2); // Let the final timeout expire
+
+    uint32_t commands = (mode == MODE_XTIMER) ? result.restarts
+                                              : deadline_timer.daemonCommands() - commands_before;
+
+    Serial.printf("%-8s %-6s restarts=%5lu daemon_cmds=%5lu caller=%5lu ns/restart expiries=%lu",
+                  (mode == MODE_XTIMER) ? "xTimer" : "deadline",
+                  paste ? "paste" : "steady",
+                  (unsigned long)result.restarts,
+                  (unsigned long)commands,
+                  (unsigned long)cyclesToNs((uint32_t)(result.caller_cycles / (result.restarts ? result.restarts : 1))),
+                  (unsigned long)expiries);
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        Serial.printf(" cpu%d_used=%.2f%%", core, 100.0f * (1.0f - (float)loops[core] / (float)baseline[core]));
+    }
+    Serial.println();
+}
+
+//*****************************************************************************
+// Full daemon queue
+
+// Fill the queue, let the daemon go, and keep taking every slot it frees
+void fillerTask(void *parameters)
+{
+    TickType_t period = pdMS_TO_TICKS(60000);
+    while (xTimerChangePeriod(filler_timer, period, 0) == pdPASS)
+    {
+    }
+    vTaskResume(xTimerGetTimerDaemonTaskHandle());
+
+    uint64_t end_us = monotonicMicros() + fill_us;
+    while (monotonicMicros() < end_us)
+    {
+        xTimerChangePeriod(filler_timer, period, 0);
+    }
+    vTaskDelete(NULL);
+}
+
+static void runFullQueue()
+{
+    TaskHandle_t daemon = xTimerGetTimerDaemonTaskHandle();
+    BaseType_t daemon_core = xTaskGetCoreID(daemon);
+    if (portNUM_PROCESSORS < 2 || daemon_core == tskNO_AFFINITY)
+    {
+        Serial.println("full queue: skipped, needs the timer daemon pinned on a dual-core chip");
+        return;
+    }
+
+    // The stale start makes the daemon run the expiry straight from its
+    // queue, with the filler refilling the slot that start just freed
+    uint32_t rescues_before = rescue_timer.rescuedRearms();
+    vTaskSuspend(daemon);
+    rescue_timer.touch();
+    xTimerStart(rescue_timer.handle(), 0);
+    vTaskDelay(timeout + 2);
+    rescue_timer.touch(); // Coalesced: the expiry must re-arm for this one
+    TickType_t deadline = rescue_timer.deadline();
+
+    xTaskCreatePinnedToCore(fillerTask, "Filler", 2048, NULL, configMAX_PRIORITIES - 1, NULL, 1 - daemon_core);
+    vTaskDelay(timeout * 3);
+    xTimerStop(filler_timer, portMAX_DELAY);
+
+    uint32_t rescues = rescue_timer.rescuedRearms() - rescues_before;
+    int32_t late = (int32_t)(rescue_fired_at - deadline);
+    bool on_time = rescue_expiries == 1 && late >= 0 && late <= 2;
+    Serial.printf("full queue: rescued re-arms=%lu expiries=%lu late=%ld ticks -> %s\n",
+                  (unsigned long)rescues,
+                  (unsigned long)rescue_expiries,
+                  (long)late,
+                  (rescues == 0) ? "queue had room, not forced" : (on_time ? "PASS" : "FAIL"));
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    uint32_t baseline[portNUM_PROCESSORS];
+
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---Deadline Timer vs xTimerReset---");
+
+    done_sem = xSemaphoreCreateBinary();
+    rtos_timer = xTimerCreate("Plain", timeout, pdFALSE, NULL, rtosTimerCallback);
+    filler_timer = xTimerCreate("Filler", pdMS_TO_TICKS(60000), pdFALSE, NULL, fillerCallback);
+    if (done_sem == nullptr || rtos_timer == NULL || filler_timer == NULL ||
+        !deadline_timer.begin("Deadline", timeout, deadlineCallback) ||
+        !rescue_timer.begin("Rescue", timeout, rescueCallback))
+    {
+        Serial.println("Failed to create timers");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        xTaskCreatePinnedToCore(spinTask, "Spin", 1024, (void *)(uintptr_t)core, tskIDLE_PRIORITY, NULL, core);
+    }
+
+    Serial.println("Measuring idle baseline...");
+    measureSpare(baseline);
+
+    runMode(MODE_XTIMER, false, baseline);
+    runMode(MODE_DEADLINE, false, baseline);
+    runMode(MODE_XTIMER, true, baseline);
+    runMode(MODE_DEADLINE, true, baseline);
+    runFullQueue();
+
+    Serial.println("Done!");
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
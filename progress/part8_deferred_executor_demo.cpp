@@ -0,0 +1,192 @@
+/**
+ * ESP32 Deferred Executor Demo
+ *
+ * A fast 10 ms auto-reload timer shares the timer daemon with a slow 1 s
+ * timer whose callback does ~30 ms of work (like ledTimerCallback() deleting
+ * tasks and printing). A hardware timer ISR also hands work off at 1 kHz.
+ *
+ * Phase 1 (inline): the slow callback does its work inside the daemon, and
+ * the fast timer's lateness shows the damage.
+ * Phase 2 (deferred): callbacks and the ISR post closures to priority lanes;
+ * the daemon stays free and lane statistics show queueing delay, execution
+ * time and budget violations.
+ */
+
+#include <Arduino.h>
+#include <DeferredExecutor.h>
+#include <Histogram.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const TickType_t fast_period = pdMS_TO_TICKS(10);
+static const TickType_t slow_period = pdMS_TO_TICKS(1000);
+static const uint32_t slow_work_us = 30000;
+static const uint32_t phase_ms = 10000;
+static const uint32_t timer_frequency_hz = 1000000; // 1 MHz timer tick (1 us per tick)
+static const uint32_t timer_max_count = 1000;       // 1 kHz ISR
+
+enum
+{
+    LANE_URGENT = 0,
+    LANE_NORMAL,
+    LANE_BACKGROUND,
+    NUM_LANES
+};
+
+static const DeferLaneConfig lanes[NUM_LANES] = {
+    {"Urgent Lane", 4, 32, 200},
+    {"Normal Lane", 3, 16, 2000},
+    {"Background Lane", 1, 8, 50000},
+};
+
+// Globals
+static DeferredExecutor executor;
+static TimerHandle_t fast_timer = NULL;
+static TimerHandle_t slow_timer = NULL;
+static hw_timer_t *timer = nullptr;
+static volatile bool deferred_mode = false;
+static volatile int64_t fast_expected_us = 0;
+static LogHistogram fast_lateness;
+static volatile uint32_t isr_events = 0;
+
+static void writeLine(const char *line)
+{
+    Serial.println(line);
+}
+
+static void busyWait(uint32_t us)
+{
+    uint32_t start = micros();
+    while (micros() - start < us)
+    {
+    }
+}
+
+//*****************************************************************************
+// Deferred work
+
+void countIsrEvent(void *parameters, uint32_t value)
+{
+    isr_events = isr_events + value;
+}
+
+void slowWork(void *parameters, uint32_t value)
+{
+    busyWait(slow_work_us);
+}
+
+// Usually quick, but every 20th call blows the normal lane budget
+void reportWork(void *parameters, uint32_t value)
+{
+    busyWait((value % 20 == 0) ? 5000 : 300);
+}
+
+//*****************************************************************************
+// Callbacks and ISR
+
+void fastTimerCallback(TimerHandle_t xTimer)
+{
+    static uint32_t calls = 0;
+    int64_t now = esp_timer_get_time();
+
+    if (fast_expected_us != 0)
+    {
+        int64_t late = now - fast_expected_us;
+        fast_lateness.record(late > 0 ? (uint32_t)late : 0);
+    }
+    fast_expected_us = now + (int64_t)fast_period * portTICK_PERIOD_MS * 1000;
+
+    calls++;
+    if (deferred_mode)
+    {
+        executor.post(LANE_NORMAL, reportWork, NULL, calls, "reportWork");
+    }
+}
+
+void slowTimerCallback(TimerHandle_t xTimer)
+{
+    if (deferred_mode)
+    {
+        executor.post(LANE_BACKGROUND, slowWork, NULL, 0, "slowWork");
+    }
+    else
+    {
+        slowWork(NULL, 0);
+    }
+}
+
+void IRAM_ATTR onTimer()
+{
+    BaseType_t task_woken = pdFALSE;
+    if (deferred_mode)
+    {
+        executor.postFromISR(LANE_URGENT, countIsrEvent, NULL, 1, "countIsrEvent", &task_woken);
+    }
+    if (task_woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+//*****************************************************************************
+// Main
+
+static void runPhase(bool deferred)
+{
+    deferred_mode = deferred;
+    executor.resetStats();
+    fast_lateness.reset();
+    fast_expected_us = 0;
+
+    vTaskDelay(pdMS_TO_TICKS(phase_ms));
+
+    Serial.printf("\n=== %s ===\n", deferred ? "Deferred to lanes" : "Inline in timer daemon");
+    fast_lateness.printTo(writeLine, "10 ms timer lateness", "us");
+    if (deferred)
+    {
+        executor.printStats();
+        Serial.printf("ISR events handled in urgent lane: %lu\n", (unsigned long)isr_events);
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    Serial.println();
+    Serial.println("---FreeRTOS Deferred Executor Demo---");
+
+    fast_timer = xTimerCreate("Fast Timer", fast_period, pdTRUE, NULL, fastTimerCallback);
+    slow_timer = xTimerCreate("Slow Timer", slow_period, pdTRUE, NULL, slowTimerCallback);
+    timer = timerBegin(timer_frequency_hz);
+    if (fast_timer == NULL || slow_timer == NULL || timer == nullptr || !executor.begin(lanes, NUM_LANES, app_cpu))
+    {
+        Serial.println("Failed to create timers or executor");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    timerAttachInterrupt(timer, &onTimer);
+    timerAlarm(timer, timer_max_count, true, 0);
+    xTimerStart(fast_timer, portMAX_DELAY);
+    xTimerStart(slow_timer, portMAX_DELAY);
+
+    runPhase(false);
+    runPhase(true);
+
+    // Keep running deferred; print lane statistics every phase
+    while (1)
+    {
+        runPhase(true);
+    }
+}
+
+void loop()
+{
+}
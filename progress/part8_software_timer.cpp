@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <DeferredExecutor.h>
 #include <stdint.h>
 
 #if CONFIG_FREERTOS_UNICORE
@@ -11,9 +12,19 @@ static const BaseType_t app_cpu = 1;
 static TimerHandle_t one_shot_timer = NULL;
 static TimerHandle_t auto_reload_timer = NULL;
 
+// Printing is slow, so the timer daemon hands it to an executor task
+static DeferredExecutor executor;
+static const DeferLaneConfig print_lane = {"Print Lane", 1, 8, 5000};
+
 //****************************************
 // Callbacks
 
+// Runs in the executor task, not the timer daemon
+void printMessage(void *parameters, uint32_t value)
+{
+    Serial.println((const char *)parameters);
+}
+
 void myTimerCallback(TimerHandle_t xTimer)
 {
 
@@ -21,13 +32,13 @@ void myTimerCallback(TimerHandle_t xTimer)
     // Print message if timer 0 expired
     if ((uint32_t)pvTimerGetTimerID(xTimer) == 0)
     {
-        Serial.println("One-shot timer expired");
+        executor.post(0, printMessage, (void *)"One-shot timer expired", 0, "one-shot print");
     }
 
     // Print message if timer 1 expired
     if ((uint32_t)pvTimerGetTimerID(xTimer) == 1)
     {
-        Serial.println("Auto-reload timer expired");
+        executor.post(0, printMessage, (void *)"Auto-reload timer expired", 0, "auto-reload print");
     }
 }
 
@@ -41,6 +52,11 @@ void setup()
     Serial.println();
     Serial.println("---FreeRTOS Timer Demo---");
 
+    if (!executor.begin(&print_lane, 1, app_cpu))
+    {
+        Serial.println("Failed to start deferred executor");
+    }
+
     // Create a one-shot timer
     one_shot_timer = xTimerCreate(
         "OneShot Timer",     // Text name for the timer
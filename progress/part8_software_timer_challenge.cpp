@@ -1,6 +1,8 @@
 #include <Arduino.h>
 
 #include <BoardConfig.h>
+#include <DeadlineTimer.h>
+#include <DeferredExecutor.h>
 
 // Use only core 1 for demo purposes
 #if CONFIG_FREERTOS_UNICORE
@@ -17,17 +19,20 @@ static const TickType_t blink_interval = 1000 / portTICK_PERIOD_MS;         // L
 static const TickType_t remain_display_interval = 500 / portTICK_PERIOD_MS; // How often to print remaining time
 
 // Globals
-static TimerHandle_t led_timer = NULL;
+static DeadlineTimer led_timer; // Restarts only move the deadline, no daemon command
 static TaskHandle_t led_blink_task_handle = NULL;
 static TaskHandle_t remain_time_task_handle = NULL;
-static TickType_t timer_end_tick = 0;
 static int remain_time = 0; // Example shared variable
 
+// Keeps the timer daemon callback short: the real work runs in a lane task
+static DeferredExecutor executor;
+static const DeferLaneConfig led_lane = {"LED Lane", 2, 4, 2000};
+
 //*****************************************************************************
 // Callbacks
 
-// Turn off LED when timer expires and stop blinking task
-void ledTimerCallback(TimerHandle_t xTimer)
+// Turn off LED and stop blinking task (runs in the executor lane task)
+void dimLed(void *parameters, uint32_t value)
 {
     // Stop the blinking task
     if (led_blink_task_handle != NULL)
@@ -49,6 +54,12 @@ void ledTimerCallback(TimerHandle_t xTimer)
     Serial.println("LED dimmed OFF after 5 second delay");
 }
 
+// Timer expired: only hand the work off, the daemon serves every other timer
+void ledTimerCallback(DeadlineTimer *timer)
+{
+    executor.post(0, dimLed, NULL, 0, "dimLed");
+}
+
 //*****************************************************************************
 // Tasks
 
@@ -72,8 +83,7 @@ void remainTimeTask(void *parameters)
 {
     while (1)
     {
-        TickType_t now = xTaskGetTickCount();
-        TickType_t remain = (timer_end_tick > now) ? (timer_end_tick - now) : 0;
+        TickType_t remain = led_timer.remainingTicks();
         remain_time = remain;
         Serial.print(remain * portTICK_PERIOD_MS);
         Serial.println(" ms");
@@ -101,11 +111,8 @@ void doCLI(void *parameters)
             // Echo everthing back to the serial port
             c = Serial.read();
             // Serial.print(c);
-            // Start Timer (if timer is already running, reset it )
-            xTimerStart(led_timer, portMAX_DELAY);
-            // Calculate and store timer end tick
-            timer_end_tick = xTaskGetTickCount() + dim_delay;
-            // timer_end_tick = xTimerGetExpiryTime(led_timer);
+            // Start Timer (if timer is already running, just push its deadline)
+            led_timer.touch();
 
             // Start or restart the blink task
             if (led_blink_task_handle == NULL)
@@ -148,15 +155,17 @@ void setup()
     Serial.println();
     Serial.println("---FreeRTOS Timer Solution---");
 
-    // Create a one-shot timer
-    led_timer = xTimerCreate(
-        "LED Dimmer",      // Text name for the timer
-        dim_delay,         // Timer period in ticks
-        pdFALSE,           // No auto-reload
-        (void *)0,         // Timer ID
-        ledTimerCallback); // Callback function
+    if (!executor.begin(&led_lane, 1, app_cpu))
+    {
+        Serial.println("Failed to start deferred executor!");
+        while (1)
+            ; // Halt
+    }
 
-    if (led_timer == NULL)
+    // Create a one-shot deadline timer
+    if (!led_timer.begin("LED Dimmer", // Text name for the timer
+                         dim_delay,    // Timeout in ticks
+                         ledTimerCallback))
     {
         Serial.println("Failed to create LED timer!");
         while (1)
@@ -0,0 +1,239 @@
+/**
+ * ESP32 Timing Wheel Benchmark
+ *
+ * Compare FreeRTOS software timers (xTimerCreate) against WheelTimerService
+ * with 10 to 2,000 active auto-reload timers.
+ *
+ * Restart cost: a burst of restarts is issued and we wait until the timer
+ * daemon has processed all of them (xTimerPendFunctionCall marker), so the
+ * O(n) sorted insert done inside the daemon is included.
+ *
+ * Expiry jitter: every callback computes how late it ran against its nominal
+ * expiry time; jitter is max - min lateness.
+ *
+ * The host version (progress/host/timing_wheel_bench.cpp) scales to 10,000.
+ */
+
+#include <Arduino.h>
+#include <PortUtils.h>
+#include <WheelTimerService.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t run_ms = 3000;        // How long timers run per configuration
+static const uint32_t restart_burst = 200;  // Restarts issued per burst
+static const uint32_t min_period_ms = 100;  // Shortest timer period
+static const uint32_t max_period_ms = 1000; // Longest timer period
+
+// Per-timer bookkeeping (pointed to by the timer ID)
+struct TimerRecord
+{
+    int64_t start_us;
+    uint32_t period_ms;
+    uint32_t fires;
+};
+
+// Globals
+static TimerRecord *records = nullptr;
+static volatile int64_t late_min_us = 0;
+static volatile int64_t late_max_us = 0;
+static volatile int64_t late_sum_us = 0;
+static volatile uint32_t fire_count = 0;
+static volatile bool measuring = false;
+static SemaphoreHandle_t marker_sem = nullptr;
+
+//*****************************************************************************
+// Callbacks
+
+static void recordExpiry(TimerRecord *rec)
+{
+    rec->fires++;
+    if (!measuring)
+    {
+        return;
+    }
+
+    int64_t nominal = rec->start_us + (int64_t)rec->fires * rec->period_ms * 1000;
+    int64_t late = esp_timer_get_time() - nominal;
+    if (fire_count == 0 || late < late_min_us)
+    {
+        late_min_us = late;
+    }
+    if (fire_count == 0 || late > late_max_us)
+    {
+        late_max_us = late;
+    }
+    late_sum_us = late_sum_us + late;
+    fire_count = fire_count + 1;
+}
+
+void rtosTimerCallback(TimerHandle_t xTimer)
+{
+    recordExpiry((TimerRecord *)pvTimerGetTimerID(xTimer));
+}
+
+void wheelCallback(WheelTimerHandle_t xTimer)
+{
+    recordExpiry((TimerRecord *)wheelTimerGetTimerID(xTimer));
+}
+
+// Runs in the timer daemon after every queued restart command
+void markerCallback(void *param, uint32_t ulParam)
+{
+    xSemaphoreGive(marker_sem);
+}
+
+//*****************************************************************************
+// Helpers
+
+static void resetJitter()
+{
+    late_min_us = 0;
+    late_max_us = 0;
+    late_sum_us = 0;
+    fire_count = 0;
+}
+
+static void printResult(const char *name, uint32_t num_timers, uint32_t restart_cycles)
+{
+    Serial.printf("%-6s n=%4lu restart=%6lu ns fires=%5lu late mean=%5ld us jitter=%5ld us\n",
+                  name,
+                  (unsigned long)num_timers,
+                  (unsigned long)cyclesToNs(restart_cycles / restart_burst),
+                  (unsigned long)fire_count,
+                  (long)(fire_count ? late_sum_us / fire_count : 0),
+                  (long)(late_max_us - late_min_us));
+}
+
+static void initRecord(TimerRecord *rec)
+{
+    rec->start_us = esp_timer_get_time();
+    rec->period_ms = min_period_ms + (uint32_t)random(0, max_period_ms - min_period_ms);
+    rec->fires = 0;
+}
+
+//*****************************************************************************
+// Benchmarks
+
+static void benchRtosTimers(uint32_t num_timers)
+{
+    TimerHandle_t *timers = (TimerHandle_t *)pvPortMalloc(num_timers * sizeof(TimerHandle_t));
+
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        initRecord(&records[i]);
+        timers[i] = xTimerCreate("Bench", pdMS_TO_TICKS(records[i].period_ms), pdTRUE, &records[i], rtosTimerCallback);
+        xTimerStart(timers[i], portMAX_DELAY);
+    }
+
+    // Let the initial start commands drain, then measure jitter
+    vTaskDelay(pdMS_TO_TICKS(max_period_ms));
+    resetJitter();
+    measuring = true;
+    vTaskDelay(pdMS_TO_TICKS(run_ms));
+    measuring = false;
+
+    // Restart burst, timed until the daemon has processed every command
+    uint32_t t0 = cpuCycleCount();
+    for (uint32_t i = 0; i < restart_burst; i++)
+    {
+        TimerRecord *rec = &records[(uint32_t)random(0, num_timers)];
+        rec->start_us = esp_timer_get_time();
+        rec->fires = 0;
+        xTimerReset(timers[rec - records], portMAX_DELAY);
+    }
+    xTimerPendFunctionCall(markerCallback, NULL, 0, portMAX_DELAY);
+    xSemaphoreTake(marker_sem, portMAX_DELAY);
+    uint32_t cycles = cpuCycleCount() - t0;
+
+    printResult("xTimer", num_timers, cycles);
+
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        xTimerDelete(timers[i], portMAX_DELAY);
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    vPortFree(timers);
+}
+
+static void benchWheelTimers(uint32_t num_timers)
+{
+    WheelTimerHandle_t *timers = (WheelTimerHandle_t *)pvPortMalloc(num_timers * sizeof(WheelTimerHandle_t));
+
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        initRecord(&records[i]);
+        timers[i] = wheelTimerCreate("Bench", pdMS_TO_TICKS(records[i].period_ms), pdTRUE, &records[i], wheelCallback);
+        wheelTimerStart(timers[i]);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(max_period_ms));
+    resetJitter();
+    measuring = true;
+    vTaskDelay(pdMS_TO_TICKS(run_ms));
+    measuring = false;
+
+    // Restarts complete synchronously, no daemon round trip to wait for
+    uint32_t t0 = cpuCycleCount();
+    for (uint32_t i = 0; i < restart_burst; i++)
+    {
+        TimerRecord *rec = &records[(uint32_t)random(0, num_timers)];
+        rec->start_us = esp_timer_get_time();
+        rec->fires = 0;
+        wheelTimerReset(timers[rec - records]);
+    }
+    uint32_t cycles = cpuCycleCount() - t0;
+
+    printResult("wheel", num_timers, cycles);
+
+    for (uint32_t i = 0; i < num_timers; i++)
+    {
+        wheelTimerDelete(timers[i]);
+    }
+    vPortFree(timers);
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    static const uint32_t sizes[] = {10, 100, 500, 1000, 2000};
+
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Timers vs Timing Wheel---");
+
+    marker_sem = xSemaphoreCreateBinary();
+    records = (TimerRecord *)pvPortMalloc(sizes[4] * sizeof(TimerRecord));
+    if (marker_sem == nullptr || records == nullptr || !wheelTimerServiceBegin(configTIMER_TASK_PRIORITY, app_cpu))
+    {
+        Serial.println("Failed to allocate benchmark resources");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    for (uint32_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        randomSeed(i);
+        benchRtosTimers(sizes[i]);
+        randomSeed(i);
+        benchWheelTimers(sizes[i]);
+        Serial.print("Free heap: ");
+        Serial.println(xPortGetFreeHeapSize());
+    }
+
+    Serial.println("Done!");
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
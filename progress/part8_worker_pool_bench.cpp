@@ -0,0 +1,170 @@
+/**
+ * ESP32 Worker Pool Benchmark
+ *
+ * doCLI() and restartLedTask() create and delete a task per event, and each
+ * part7 producer is a whole task that lives for three writes. This sketch
+ * measures dispatch latency (submit -> job running) under bursty load for:
+ *
+ *   create/delete - xTaskCreatePinnedToCore() per job, vTaskDelete(NULL) at end
+ *   worker pool   - WorkerPool::submit() to long-lived pinned workers
+ *
+ * Bursts of jobs are fired every burst_interval_ms. Each job does a little
+ * work and records its latency into a histogram. The minimum free heap is
+ * reported as well, since task churn also fragments the heap.
+ */
+
+#include <Arduino.h>
+#include <Histogram.h>
+#include <PortUtils.h>
+#include <WorkerPool.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t num_bursts = 50;
+static const uint32_t burst_interval_ms = 20;
+static const uint32_t job_work_us = 50;
+static const uint32_t job_stack = 2048;
+static const UBaseType_t job_priority = 2;
+static const uint32_t burst_sizes[] = {1, 8, 32};
+
+// One record per in-flight job
+struct JobRecord
+{
+    uint32_t submit_cycles;
+};
+
+// Globals
+static WorkerPool pool;
+static JobRecord records[32];
+static LogHistogram latency;
+static portMUX_TYPE latency_mux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t done_sem = nullptr;
+
+//*****************************************************************************
+// Job body shared by both variants
+
+static void runJob(JobRecord *rec)
+{
+    uint32_t waited = cpuCycleCount() - rec->submit_cycles;
+
+    portENTER_CRITICAL(&latency_mux);
+    latency.record(cyclesToNs(waited) / 1000);
+    portEXIT_CRITICAL(&latency_mux);
+
+    uint32_t start = micros();
+    while (micros() - start < job_work_us)
+    {
+    }
+    xSemaphoreGive(done_sem);
+}
+
+// Variant 1: one task per job
+void jobTask(void *parameters)
+{
+    runJob((JobRecord *)parameters);
+    vTaskDelete(NULL);
+}
+
+// Variant 2: pool job
+void poolJob(void *parameters, WorkerJobHandle_t job)
+{
+    runJob((JobRecord *)parameters);
+}
+
+//*****************************************************************************
+// Benchmarks
+
+static void runVariant(bool use_pool, uint32_t burst)
+{
+    latency.reset();
+    size_t heap_before = xPortGetFreeHeapSize();
+    size_t heap_min = heap_before;
+    uint32_t failed = 0;
+    uint32_t t0 = millis();
+
+    for (uint32_t b = 0; b < num_bursts; b++)
+    {
+        for (uint32_t i = 0; i < burst; i++)
+        {
+            records[i].submit_cycles = cpuCycleCount();
+            bool ok;
+            if (use_pool)
+            {
+                ok = pool.submit(poolJob, &records[i], app_cpu) != WORKER_JOB_INVALID;
+            }
+            else
+            {
+                ok = xTaskCreatePinnedToCore(jobTask, "Job", job_stack, &records[i], job_priority, NULL, app_cpu) == pdPASS;
+            }
+            if (!ok)
+            {
+                failed++;
+                xSemaphoreGive(done_sem);
+            }
+        }
+
+        // Heap is at its lowest while the whole burst is alive
+        size_t heap = xPortGetFreeHeapSize();
+        if (heap < heap_min)
+        {
+            heap_min = heap;
+        }
+
+        for (uint32_t i = 0; i < burst; i++)
+        {
+            xSemaphoreTake(done_sem, portMAX_DELAY);
+        }
+        vTaskDelay(pdMS_TO_TICKS(burst_interval_ms));
+    }
+
+    uint32_t elapsed = millis() - t0;
+    Serial.printf("%-13s burst=%2lu jobs=%4lu latency mean=%4lu p99=%4lu max=%4lu us heap_dip=%6lu B failed=%lu time=%lu ms\n",
+                  use_pool ? "worker pool" : "create/delete",
+                  (unsigned long)burst,
+                  (unsigned long)latency.count(),
+                  (unsigned long)latency.mean(),
+                  (unsigned long)latency.percentile(99),
+                  (unsigned long)latency.max(),
+                  (unsigned long)(heap_before - heap_min),
+                  (unsigned long)failed,
+                  (unsigned long)elapsed);
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---Worker Pool vs Task Create/Delete---");
+
+    done_sem = xSemaphoreCreateCounting(32, 0);
+    if (done_sem == nullptr || !pool.begin(4, job_stack, job_priority, 64))
+    {
+        Serial.println("Failed to create worker pool");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    for (uint32_t i = 0; i < sizeof(burst_sizes) / sizeof(burst_sizes[0]); i++)
+    {
+        runVariant(false, burst_sizes[i]);
+        vTaskDelay(pdMS_TO_TICKS(100)); // Let the idle task reclaim deleted TCBs
+        runVariant(true, burst_sizes[i]);
+    }
+
+    Serial.println("Done!");
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,396 @@
+/**
+ * ESP32 Timer + ADC on Actors
+ *
+ * part9_isr_challenge.cpp with its three tasks (timer, average, serial
+ * echo; 4096 B of stack each) turned into actors of an ActorSystem:
+ *
+ *   sampler  (high)    the timer ISR sends it a tick; reads the ADC, keeps
+ *                      the running statistics and hands full blocks on
+ *   average  (normal)  prints the average of each block and the statistics
+ *   console  (low)     a software timer sends it a poll every 20 ms; echoes
+ *                      Serial and runs the commands
+ *
+ * One worker task per core runs every handler to completion, so the three
+ * components share one stack instead of owning one each.
+ *
+ * Before starting, the sketch compares against task-per-component:
+ *
+ *   memory   heap for three 4096 B tasks vs the actor system (workers and
+ *            mailboxes)
+ *   latency  send to handler start, a task blocked on a queue vs an actor
+ *
+ * Commands:
+ *   avg    average the samples collected so far
+ *   stats  per-actor statistics: messages, drops, mailbox depth, latency
+ */
+
+#include <Arduino.h>
+#include <ActorSystem.h>
+#include <BlockKernels.h>
+#include <Histogram.h>
+#include <PortUtils.h>
+#include <ShardedCounter.h>
+#include <StreamingStats.h>
+
+// Use core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t timer_frequency_hz = 10000000; // 1 MHz timer tick (1 us per tick)
+static const uint32_t timer_max_count = 1000000;     // 100,000 us = 100 ms = 10 Hz Sample Rate
+static const int adc_pin = A0;                       // Adjust pin as necessary for your board
+static const uint32_t console_poll_ms = 20;
+static const uint32_t task_stack_size = 4096;        // Bytes in ESP32, as in part9_isr_challenge.cpp
+static const uint32_t worker_stack_size = 4096;
+static const UBaseType_t worker_priority = 2;
+static const uint32_t probes = 200;
+#define ADC_BUF_SIZE 10
+#define CMD_BUF_SIZE 64
+
+enum
+{
+    MSG_TICK = 1,
+    MSG_FLUSH,
+    MSG_BLOCK,
+    MSG_POLL,
+    MSG_PROBE
+};
+
+struct SampleBlock
+{
+    uint16_t samples[ADC_BUF_SIZE];
+    uint32_t count;
+};
+
+//*****************************************************************************
+// Actors
+
+class SamplerActor : public Actor
+{
+public:
+    SamplerActor(Actor *consumer) : Actor("sampler"), consumer_(consumer), fill_(0), flush_requested_(false)
+    {
+        blocks_[0].count = 0;
+        blocks_[1].count = 0;
+    }
+
+protected:
+    void receive(const ActorMessage &message) override;
+
+private:
+    Actor *consumer_;
+    SampleBlock blocks_[2]; // Ping-pong: the average actor reads one while this fills the other
+    uint32_t fill_;
+    bool flush_requested_;
+};
+
+class AverageActor : public Actor
+{
+public:
+    AverageActor() : Actor("average")
+    {
+    }
+
+protected:
+    void receive(const ActorMessage &message) override;
+};
+
+class ConsoleActor : public Actor
+{
+public:
+    ConsoleActor(Actor *sampler) : Actor("console"), sampler_(sampler), idx_(0)
+    {
+    }
+
+protected:
+    void receive(const ActorMessage &message) override;
+
+private:
+    void handleCommand(char *cmd);
+
+    Actor *sampler_;
+    char cmd_buf_[CMD_BUF_SIZE];
+    uint8_t idx_;
+};
+
+class ProbeActor : public Actor
+{
+public:
+    ProbeActor() : Actor("probe")
+    {
+    }
+
+protected:
+    void receive(const ActorMessage &message) override
+    {
+    }
+};
+
+// Globals
+static hw_timer_t *timer = nullptr;
+static TimerHandle_t console_timer = NULL;
+static ShardedCounter timerCount; // Lock-free, per-core shards
+static StreamingStats adc_stats;
+static const uint32_t stats_windows[] = {ADC_BUF_SIZE, 10 * ADC_BUF_SIZE};
+
+static ActorSystem actors;
+static AverageActor average;
+static SamplerActor sampler(&average);
+static ConsoleActor console(&sampler);
+static ProbeActor probe;
+
+static QueueHandle_t probe_queue = NULL;
+static LogHistogram task_latency_us;
+
+//*****************************************************************************
+// Interrupt Service Routine (ISR)
+
+void IRAM_ATTR onTimer()
+{
+    timerCount.add();
+
+    // A full mailbox drops the tick; the sampler's stats count it
+    BaseType_t task_woken = pdFALSE;
+    actors.sendFromISR(&sampler, MSG_TICK, 0, nullptr, &task_woken);
+    if (task_woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void consoleTimer(TimerHandle_t timer_handle)
+{
+    actors.send(&console, MSG_POLL);
+}
+
+//*****************************************************************************
+// Handlers
+
+void SamplerActor::receive(const ActorMessage &message)
+{
+    if (message.type == MSG_FLUSH)
+    {
+        flush_requested_ = true;
+        return;
+    }
+
+    uint16_t raw = analogRead(adc_pin);
+    adc_stats.add(raw);
+
+    SampleBlock &block = blocks_[fill_];
+    block.samples[block.count++] = raw;
+    if (block.count == ADC_BUF_SIZE || flush_requested_)
+    {
+        // The other block was handed on ADC_BUF_SIZE ticks ago and is long done
+        if (actors.send(consumer_, MSG_BLOCK, block.count, &block))
+        {
+            fill_ ^= 1;
+        }
+        blocks_[fill_].count = 0;
+    }
+    flush_requested_ = false;
+}
+
+void AverageActor::receive(const ActorMessage &message)
+{
+    const SampleBlock *block = (const SampleBlock *)message.data;
+    uint32_t sum = blockSum(block->samples, block->count);
+    uint16_t avg = sum / block->count;
+
+    Serial.printf(">>> ADC Average (last %lu samples): %u\n", (unsigned long)block->count, avg);
+
+    // Consistent copy of the running statistics
+    StreamingStats::Snapshot snap;
+    adc_stats.snapshot(&snap);
+    Serial.printf(">>> Running: mean=%.1f ema=%.1f min=%u max=%u sd=%.1f | last %lu: %.1f\n",
+                  snap.mean(),
+                  snap.ema(),
+                  snap.min,
+                  snap.max,
+                  snap.stddev(),
+                  (unsigned long)snap.windowFill(1),
+                  snap.windowMean(1));
+}
+
+static void printLine(const char *line)
+{
+    Serial.println(line);
+}
+
+void ConsoleActor::handleCommand(char *cmd)
+{
+    Serial.println();
+    if (strcmp(cmd, "avg") == 0)
+    {
+        Serial.println("Manual trigger: Calculating average...");
+        actors.send(sampler_, MSG_FLUSH);
+    }
+    else if (strcmp(cmd, "stats") == 0)
+    {
+        actors.printStats(printLine);
+    }
+    else
+    {
+        Serial.println("Commands: avg, stats");
+    }
+}
+
+// Never blocks: takes what Serial has and returns to the worker
+void ConsoleActor::receive(const ActorMessage &message)
+{
+    while (Serial.available())
+    {
+        char c = Serial.read();
+        if (c == '\r' || c == '\n')
+        {
+            if (idx_ > 0)
+            {
+                cmd_buf_[idx_] = '\0';
+                handleCommand(cmd_buf_);
+                idx_ = 0;
+            }
+        }
+        else if (idx_ < CMD_BUF_SIZE - 1)
+        {
+            Serial.print(c);
+            cmd_buf_[idx_++] = c;
+        }
+    }
+}
+
+//*****************************************************************************
+// Comparison with a task per component
+
+void idleTask(void *parameters)
+{
+    vTaskSuspend(NULL);
+}
+
+// Heap that three 4096 B tasks take, as in part9_isr_challenge.cpp
+static size_t measureTasks()
+{
+    TaskHandle_t tasks[3];
+    size_t before = xPortGetFreeHeapSize();
+    uint32_t created = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        if (xTaskCreatePinnedToCore(idleTask, "Idle", task_stack_size, NULL, 1, &tasks[i], app_cpu) != pdPASS)
+        {
+            break;
+        }
+        created++;
+    }
+    size_t bytes = before - xPortGetFreeHeapSize();
+    for (uint32_t i = 0; i < created; i++)
+    {
+        vTaskDelete(tasks[i]);
+    }
+    vTaskDelay(pdMS_TO_TICKS(100)); // The idle task frees them
+    return bytes;
+}
+
+void probeTask(void *parameters)
+{
+    for (uint32_t i = 0; i < probes; i++)
+    {
+        uint32_t sent_us;
+        xQueueReceive(probe_queue, &sent_us, portMAX_DELAY);
+        task_latency_us.record((uint32_t)monotonicMicros() - sent_us);
+    }
+    vTaskDelete(NULL);
+}
+
+// Send to handler start, same priority as the workers, same core
+static void measureLatency()
+{
+    xTaskCreatePinnedToCore(probeTask, "Probe", task_stack_size, NULL, worker_priority, NULL, app_cpu);
+    for (uint32_t i = 0; i < probes; i++)
+    {
+        uint32_t now = (uint32_t)monotonicMicros();
+        xQueueSend(probe_queue, &now, portMAX_DELAY);
+        actors.send(&probe, MSG_PROBE);
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+
+    const LogHistogram &actor_latency_us = probe.stats().latency_us;
+    Serial.println("Latency, send to handler start:");
+    Serial.printf("  task   p50 %4lu us  p99 %4lu us  max %4lu us\n",
+                  (unsigned long)task_latency_us.percentile(50),
+                  (unsigned long)task_latency_us.percentile(99),
+                  (unsigned long)task_latency_us.max());
+    Serial.printf("  actor  p50 %4lu us  p99 %4lu us  max %4lu us\n",
+                  (unsigned long)actor_latency_us.percentile(50),
+                  (unsigned long)actor_latency_us.percentile(99),
+                  (unsigned long)actor_latency_us.max());
+}
+
+//*****************************************************************************
+// Main (runs as its own task with priority 1 on core 1)
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---ESP32 Timer + ADC on Actors---");
+
+    probe_queue = xQueueCreate(1, sizeof(uint32_t));
+    if (probe_queue == NULL || !adc_stats.begin(stats_windows, 2, 3))
+    {
+        Serial.println("Error: Could not create queue or statistics");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    size_t task_bytes = measureTasks();
+
+    // Everything on app_cpu, so the handlers never run in parallel
+    size_t before = xPortGetFreeHeapSize();
+    if (!actors.begin(1, worker_stack_size, worker_priority) ||
+        !actors.attach(&sampler, 4, ACTOR_HIGH, app_cpu) ||
+        !actors.attach(&average, 2, ACTOR_NORMAL, app_cpu) ||
+        !actors.attach(&console, 2, ACTOR_LOW, app_cpu) ||
+        !actors.attach(&probe, 1, ACTOR_NORMAL, app_cpu))
+    {
+        Serial.println("Error: Could not start actors");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    size_t actor_bytes = before - xPortGetFreeHeapSize();
+
+    Serial.println("Heap for the three components:");
+    Serial.printf("  task per component  %6lu B\n", (unsigned long)task_bytes);
+    Serial.printf("  actors              %6lu B (mailboxes, %lu workers of %lu B stack)\n",
+                  (unsigned long)actor_bytes,
+                  (unsigned long)PORT_NUM_CORES,
+                  (unsigned long)worker_stack_size);
+    measureLatency();
+    probe.resetStats();
+
+    console_timer = xTimerCreate("Console", pdMS_TO_TICKS(console_poll_ms), pdTRUE, NULL, consoleTimer);
+    timer = timerBegin(timer_frequency_hz);
+    if (console_timer == NULL || timer == nullptr)
+    {
+        Serial.println("Error: Could not init timers");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    xTimerStart(console_timer, portMAX_DELAY);
+
+    // Attach onTimer function to hardware timer
+    timerAttachInterrupt(timer, &onTimer);
+
+    // Enable Timer to work in autoreload mode
+    timerAlarm(timer, timer_max_count, true, 0);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
@@ -0,0 +1,153 @@
+/**
+ * ESP32 Sample Capture Demo
+ *
+ * part9_isr_challenge.cpp reduces its samples to an average and the raw
+ * stream is lost; printing every sample as text costs about 6 bytes per
+ * sample on the UART. This sketch encodes blocks of real ADC samples in the
+ * SampleCapture format (delta + zigzag, then varint, bit-packed or raw,
+ * CRC-32 per block).
+ *
+ *   stream_capture = false - measure: for each encoding, print bytes per
+ *                            sample and CPU cycles per sample on live ADC
+ *                            noise
+ *   stream_capture = true  - send the capture itself over Serial (binary).
+ *                            Save it with a raw serial logger and decode or
+ *                            replay it with progress/host/sample_capture_tool.cpp
+ *
+ * Leave the pin floating or on a noisy source to see the worst case.
+ */
+
+#include <Arduino.h>
+#include <PortUtils.h>
+#include <SampleCapture.h>
+#include <TimerAdcSource.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const bool stream_capture = false;
+static const uint32_t sample_rate_hz = 1000;
+static const uint32_t block_size = 256;
+static const uint32_t report_blocks = 8;
+
+// Pins
+static const int adc_pin = A0; // GPIO36, ADC1_CH0
+
+// Globals
+static TimerAdcSource source;
+static uint8_t encoded[captureMaxBlockBytes(block_size)];
+
+static const CaptureEncoding encodings[] = {CAPTURE_RAW, CAPTURE_VARINT, CAPTURE_PACKED, CAPTURE_AUTO};
+static const uint32_t num_encodings = sizeof(encodings) / sizeof(encodings[0]);
+
+//*****************************************************************************
+// Tasks
+
+static void streamTask()
+{
+    while (1)
+    {
+        const SampleBlock *block = source.read(1000);
+        if (block == nullptr)
+        {
+            continue;
+        }
+        uint32_t bytes = encodeCaptureBlock(block->samples, block->count, block->sequence, block->first_us,
+                                            encoded, sizeof(encoded));
+        Serial.write(encoded, bytes);
+    }
+}
+
+static void measureTask()
+{
+    uint64_t bytes[num_encodings] = {0};
+    uint64_t cycles[num_encodings] = {0};
+    uint32_t samples = 0;
+    uint32_t blocks = 0;
+
+    while (1)
+    {
+        const SampleBlock *block = source.read(1000);
+        if (block == nullptr)
+        {
+            continue;
+        }
+
+        for (uint32_t e = 0; e < num_encodings; e++)
+        {
+            uint32_t start = cpuCycleCount();
+            uint32_t n = encodeCaptureBlock(block->samples, block->count, block->sequence, block->first_us,
+                                            encoded, sizeof(encoded), encodings[e]);
+            cycles[e] += cpuCycleCount() - start;
+            bytes[e] += n;
+        }
+        samples += block->count;
+        blocks++;
+
+        if (blocks == report_blocks)
+        {
+            Serial.printf("\n%lu samples, text would be ~6.00 bytes/sample\n", (unsigned long)samples);
+            for (uint32_t e = 0; e < num_encodings; e++)
+            {
+                Serial.printf("  %-6s %5.3f bytes/sample (%4.2fx vs raw16)  %5.1f cycles/sample\n",
+                              captureEncodingName(encodings[e]),
+                              (double)bytes[e] / samples,
+                              2.0 * samples / bytes[e],
+                              (double)cycles[e] / samples);
+                bytes[e] = 0;
+                cycles[e] = 0;
+            }
+            samples = 0;
+            blocks = 0;
+        }
+    }
+}
+
+void captureTask(void *parameters)
+{
+    if (!source.start())
+    {
+        Serial.println("Failed to start sample source");
+        vTaskDelete(NULL);
+    }
+    if (stream_capture)
+    {
+        streamTask();
+    }
+    measureTask();
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    if (!stream_capture)
+    {
+        Serial.println();
+        Serial.println("---Sample Capture Format Demo---");
+    }
+
+    if (!source.begin(adc_pin, sample_rate_hz, block_size))
+    {
+        Serial.println("Failed to init sample source");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    xTaskCreatePinnedToCore(captureTask, "Capture", 4096, NULL, 2, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
@@ -1,4 +1,10 @@
 #include <Arduino.h>
+#include <BlockBuffer.h>
+#include <BlockKernels.h>
+#include <ShardedCounter.h>
+#include <StreamingStats.h>
+
+#include <atomic>
 
 // Use core 1 for demo purposes
 #if CONFIG_FREERTOS_UNICORE
@@ -24,25 +30,27 @@ static hw_timer_t *timer = nullptr;
 
 // Synchronization
 static SemaphoreHandle_t timerSem = nullptr;
-static SemaphoreHandle_t avg_sem = nullptr;
+static TaskHandle_t avg_task = nullptr;
 
 // Shared Data (Protected by Mutexes)
-volatile uint32_t timerCount = 0;
-portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
+static ShardedCounter timerCount; // Lock-free, per-core shards
+
+// Ping-pong sample blocks: the producer fills one while the average task
+// reads the other, so no copy and no critical section is needed
+static BlockBuffer<uint16_t> adc_blocks;
+static std::atomic<bool> flush_requested(false); // "avg" command: hand over a partial block
 
-volatile uint16_t adc_buf[ADC_BUF_SIZE] = {0};
-volatile uint8_t adc_count = 0;
-portMUX_TYPE adc_buf_mux = portMUX_INITIALIZER_UNLOCKED;
+// Running statistics, updated in O(1) per sample by the Timer Task
+static StreamingStats adc_stats;
+static const uint32_t stats_windows[] = {ADC_BUF_SIZE, 10 * ADC_BUF_SIZE};
 
 // --------------------------------------------------------------------------
 // Interrupt Service Routine (ISR)
 // --------------------------------------------------------------------------
 void IRAM_ATTR onTimer()
 {
-    // 1. Increment Timer Count safely
-    portENTER_CRITICAL_ISR(&timerMux);
-    timerCount++;
-    portEXIT_CRITICAL_ISR(&timerMux);
+    // 1. Increment Timer Count (no critical section needed)
+    timerCount.add();
 
     // 2. Signal the Timer Task to run
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
@@ -66,25 +74,21 @@ void timerTask(void *pvParameters)
         if (xSemaphoreTake(timerSem, portMAX_DELAY) == pdTRUE)
         {
             // --- Read Timer Count ---
-            portENTER_CRITICAL(&timerMux);
-            currentCount = timerCount;
-            portEXIT_CRITICAL(&timerMux);
+            currentCount = timerCount.read();
             // --- Perform ADC Sampling ---
             uint16_t rawVal = analogRead(adc_pin);
+            adc_stats.add(rawVal);
 
-            // Store in buffer safely
-            portENTER_CRITICAL(&adc_buf_mux);
-            if (adc_count < ADC_BUF_SIZE)
+            // Store in the fill block; a full block wakes the Average Task.
+            // Any block handed over answers a pending "avg", so clear it then.
+            if (adc_blocks.push(rawVal))
             {
-                adc_buf[adc_count++ % ADC_BUF_SIZE] = rawVal;
+                flush_requested.store(false);
             }
-
-            // If buffer is full (10 samples), trigger the Average Task
-            if (adc_count % ADC_BUF_SIZE == 0 && adc_count != 0)
+            else if (flush_requested.exchange(false))
             {
-                xSemaphoreGive(avg_sem);
+                adc_blocks.publish();
             }
-            portEXIT_CRITICAL(&adc_buf_mux);
         }
     }
 }
@@ -94,49 +98,37 @@ void timerTask(void *pvParameters)
 // --------------------------------------------------------------------------
 void calcAverage(void *pvParameters)
 {
-    uint16_t samples[ADC_BUF_SIZE];
-
     while (true)
     {
-        // Wait for signal (from TimerTask OR SerialEchoTask)
-        if (xSemaphoreTake(avg_sem, portMAX_DELAY) == pdTRUE)
+        // Wait for a block from the Timer Task (full, or flushed by "avg")
+        const BlockBuffer<uint16_t>::Block *block = adc_blocks.acquire(portMAX_DELAY);
+        if (block == nullptr)
         {
-            uint8_t count_snapshot = 0;
-
-            // Copy buffer to local array safely
-            portENTER_CRITICAL(&adc_buf_mux);
-            count_snapshot = adc_count;
-            for (uint8_t i = 0; i < ADC_BUF_SIZE; i++)
-            {
-                samples[i] = adc_buf[i];
-            }
-            // Reset buffer count so we can start fresh
-            adc_count = 0;
-            portEXIT_CRITICAL(&adc_buf_mux);
-
-            // Calculate Average
-            if (count_snapshot > 0)
-            {
-                uint32_t sum = 0;
-                // Only average the samples we actually collected
-                uint8_t limit = (count_snapshot < ADC_BUF_SIZE) ? count_snapshot : ADC_BUF_SIZE;
-
-                for (uint8_t i = 0; i < limit; i++)
-                {
-                    sum += samples[i];
-                }
-                uint16_t avg = sum / limit;
-
-                Serial.print(">>> ADC Average (last ");
-                Serial.print(limit);
-                Serial.print(" samples): ");
-                Serial.println(avg);
-            }
-            else
-            {
-                Serial.println(">>> ADC Average: No samples to average.");
-            }
+            continue;
         }
+
+        // Calculate Average directly from the block we now own
+        uint32_t sum = blockSum(block->samples, block->count);
+        uint16_t avg = sum / block->count;
+        uint32_t limit = block->count;
+        adc_blocks.release();
+
+        Serial.print(">>> ADC Average (last ");
+        Serial.print(limit);
+        Serial.print(" samples): ");
+        Serial.println(avg);
+
+        // Consistent copy of the running statistics
+        StreamingStats::Snapshot snap;
+        adc_stats.snapshot(&snap);
+        Serial.printf(">>> Running: mean=%.1f ema=%.1f min=%u max=%u sd=%.1f | last %lu: %.1f\n",
+                      snap.mean(),
+                      snap.ema(),
+                      snap.min,
+                      snap.max,
+                      snap.stddev(),
+                      (unsigned long)snap.windowFill(1),
+                      snap.windowMean(1));
     }
 }
 
@@ -175,7 +167,7 @@ void serialEchoTask(void *pvParameters)
                     {
                         Serial.println();
                         Serial.println("Manual trigger: Calculating average...");
-                        xSemaphoreGive(avg_sem);
+                        flush_requested.store(true);
                     }
 
                     idx = 0; // Reset buffer
@@ -201,20 +193,20 @@ void setup()
 
     Serial.println("--- ESP32 Timer + ADC + Tasks Demo ---");
 
-    // 1. Create Semaphores
+    // 1. Create Semaphore and sample blocks
     timerSem = xSemaphoreCreateBinary();
-    avg_sem = xSemaphoreCreateBinary();
 
-    if (timerSem == nullptr || avg_sem == nullptr)
+    if (timerSem == nullptr || !adc_blocks.begin(ADC_BUF_SIZE, 2) || !adc_stats.begin(stats_windows, 2, 3))
     {
-        Serial.println("Error: Could not create semaphores");
+        Serial.println("Error: Could not create semaphore or sample buffer");
         while (1)
             vTaskDelay(1000);
     }
 
     // 2. Create Tasks
     xTaskCreatePinnedToCore(timerTask, "Timer Task", 4096, NULL, 1, NULL, app_cpu);
-    xTaskCreatePinnedToCore(calcAverage, "Avg Task", 4096, NULL, 1, NULL, app_cpu);
+    xTaskCreatePinnedToCore(calcAverage, "Avg Task", 4096, NULL, 1, &avg_task, app_cpu);
+    adc_blocks.setConsumerTask(avg_task);
     xTaskCreatePinnedToCore(serialEchoTask, "Echo Task", 4096, NULL, 1, NULL, app_cpu);
 
     timer = timerBegin(timer_frequency_hz);
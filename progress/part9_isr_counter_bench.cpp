@@ -0,0 +1,307 @@
+/**
+ * ESP32 Sharded Counter Benchmark
+ *
+ * Compare the portENTER_CRITICAL / mutex counters used in the part6 and part9
+ * sketches against ShardedCounter (per-core lock-free shards).
+ *
+ * 1. ISR cost: a hardware timer increments a counter from its ISR. For the
+ *    spinlock version we time from just before portENTER_CRITICAL_ISR to
+ *    just after portEXIT_CRITICAL_ISR, minus the cost of a bare pair of
+ *    cycle stamps. That covers taking the spinlock (including waiting for
+ *    the other core), the increment and the exit path: an upper bound on
+ *    the time interrupts are disabled.
+ * 2. Throughput: one task per core hammers the same counter for a fixed time.
+ */
+
+#include <Arduino.h>
+#include <PortUtils.h>
+#include <ShardedCounter.h>
+
+// Settings
+static const uint32_t timer_frequency_hz = 1000000; // 1 MHz timer tick (1 us per tick)
+static const uint32_t timer_max_count = 100;        // 100 us = 10 kHz interrupt rate
+static const uint32_t isr_phase_ms = 2000;          // Duration of each ISR run
+static const uint32_t throughput_phase_ms = 1000;   // Duration of each throughput run
+
+enum CounterKind
+{
+    KIND_SPINLOCK = 0,
+    KIND_MUTEX,
+    KIND_SHARDED,
+    KIND_COUNT
+};
+
+static const char *kind_names[KIND_COUNT] = {"spinlock", "mutex", "sharded"};
+
+// Globals
+static hw_timer_t *timer = nullptr;
+static volatile CounterKind isr_kind = KIND_SPINLOCK;
+
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t mutex = nullptr;
+static volatile uint32_t locked_counter = 0;
+static ShardedCounter sharded_counter;
+
+// ISR statistics (only written by the ISR while a phase runs)
+static volatile uint32_t isr_calls = 0;
+static volatile uint64_t isr_cycles_total = 0;
+static volatile uint32_t isr_cycles_max = 0;
+static volatile uint64_t irq_off_cycles_total = 0;
+static volatile uint32_t irq_off_cycles_max = 0;
+static uint32_t stamp_cycles = 0; // Two back-to-back cpuCycleCount() calls
+
+// Throughput run control
+static volatile bool run_flag = false;
+static SemaphoreHandle_t done_sem = nullptr;
+static uint32_t worker_ops[portNUM_PROCESSORS];
+static uint64_t worker_irq_off_cycles[portNUM_PROCESSORS];
+
+//*****************************************************************************
+// Interrupt Service Routines (ISRs)
+
+void IRAM_ATTR onTimer()
+{
+    uint32_t start = cpuCycleCount();
+
+    if (isr_kind == KIND_SPINLOCK)
+    {
+        uint32_t off_start = cpuCycleCount();
+        portENTER_CRITICAL_ISR(&spinlock);
+        locked_counter = locked_counter + 1;
+        portEXIT_CRITICAL_ISR(&spinlock);
+        uint32_t off_cycles = cpuCycleCount() - off_start;
+        off_cycles = (off_cycles > stamp_cycles) ? off_cycles - stamp_cycles : 0;
+
+        irq_off_cycles_total = irq_off_cycles_total + off_cycles;
+        if (off_cycles > irq_off_cycles_max)
+        {
+            irq_off_cycles_max = off_cycles;
+        }
+    }
+    else
+    {
+        sharded_counter.add();
+    }
+
+    uint32_t cycles = cpuCycleCount() - start;
+    isr_calls = isr_calls + 1;
+    isr_cycles_total = isr_cycles_total + cycles;
+    if (cycles > isr_cycles_max)
+    {
+        isr_cycles_max = cycles;
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+// Increment the selected counter as fast as possible until run_flag clears
+void incrementWorker(void *parameters)
+{
+    CounterKind kind = (CounterKind)(uintptr_t)parameters;
+    uint32_t core = cpuCoreId();
+    uint32_t ops = 0;
+    uint64_t off_cycles = 0;
+
+    while (!run_flag)
+    {
+        taskYIELD();
+    }
+
+    while (run_flag)
+    {
+        switch (kind)
+        {
+        case KIND_SPINLOCK:
+        {
+            uint32_t t0 = cpuCycleCount();
+            portENTER_CRITICAL(&spinlock);
+            locked_counter = locked_counter + 1;
+            portEXIT_CRITICAL(&spinlock);
+            off_cycles += cpuCycleCount() - t0 - stamp_cycles;
+            break;
+        }
+        case KIND_MUTEX:
+            xSemaphoreTake(mutex, portMAX_DELAY);
+            locked_counter = locked_counter + 1;
+            xSemaphoreGive(mutex);
+            break;
+        default:
+            sharded_counter.add();
+            break;
+        }
+        ops++;
+
+        // Let the idle task feed the watchdog now and then
+        if ((ops & 0xFFFF) == 0)
+        {
+            vTaskDelay(1);
+        }
+    }
+
+    worker_ops[core] = ops;
+    worker_irq_off_cycles[core] = off_cycles;
+    xSemaphoreGive(done_sem);
+    vTaskDelete(NULL);
+}
+
+//*****************************************************************************
+// Benchmark phases
+
+// Cheapest of a few back-to-back stamps, subtracted from every window
+static void measureStampCost()
+{
+    stamp_cycles = UINT32_MAX;
+    for (int i = 0; i < 16; i++)
+    {
+        uint32_t t0 = cpuCycleCount();
+        uint32_t cycles = cpuCycleCount() - t0;
+        if (cycles < stamp_cycles)
+        {
+            stamp_cycles = cycles;
+        }
+    }
+}
+
+static void runIsrPhase(CounterKind kind)
+{
+    locked_counter = 0;
+    sharded_counter.reset();
+    isr_calls = 0;
+    isr_cycles_total = 0;
+    isr_cycles_max = 0;
+    irq_off_cycles_total = 0;
+    irq_off_cycles_max = 0;
+    isr_kind = kind;
+
+    timerWrite(timer, 0);
+    timerStart(timer);
+    vTaskDelay(pdMS_TO_TICKS(isr_phase_ms));
+    timerStop(timer);
+
+    uint32_t calls = isr_calls;
+    uint32_t count = (kind == KIND_SPINLOCK) ? locked_counter : (uint32_t)sharded_counter.read();
+
+    // Drain the counter the way printValue() does and check nothing is lost
+    uint32_t drained = 0;
+    if (kind == KIND_SHARDED)
+    {
+        while (sharded_counter.tryDecrement())
+        {
+            drained++;
+        }
+    }
+
+    Serial.printf("ISR %-8s calls=%lu count=%lu avg=%lu ns max=%lu ns irq_off avg=%lu ns max=%lu ns",
+                  kind_names[kind],
+                  (unsigned long)calls,
+                  (unsigned long)count,
+                  (unsigned long)cyclesToNs(calls ? (uint32_t)(isr_cycles_total / calls) : 0),
+                  (unsigned long)cyclesToNs(isr_cycles_max),
+                  (unsigned long)cyclesToNs(calls ? (uint32_t)(irq_off_cycles_total / calls) : 0),
+                  (unsigned long)cyclesToNs(irq_off_cycles_max));
+    if (kind == KIND_SHARDED)
+    {
+        Serial.printf(" drained=%lu left=%ld", (unsigned long)drained, (long)sharded_counter.read());
+    }
+    Serial.println();
+}
+
+static void runThroughputPhase(CounterKind kind)
+{
+    locked_counter = 0;
+    sharded_counter.reset();
+    run_flag = false;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        worker_ops[core] = 0;
+        worker_irq_off_cycles[core] = 0;
+        xTaskCreatePinnedToCore(incrementWorker,
+                                "Inc Worker",
+                                2048,
+                                (void *)(uintptr_t)kind,
+                                1,
+                                NULL,
+                                core);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(10));
+    run_flag = true;
+    vTaskDelay(pdMS_TO_TICKS(throughput_phase_ms));
+    run_flag = false;
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+    }
+
+    uint32_t total_ops = 0;
+    uint64_t total_off = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        total_ops += worker_ops[core];
+        total_off += worker_irq_off_cycles[core];
+    }
+    uint32_t count = (kind == KIND_SHARDED) ? (uint32_t)sharded_counter.read() : locked_counter;
+
+    Serial.printf("Tasks %-8s ops/s=%lu count=%lu (%s) irq_off=%lu us per second\n",
+                  kind_names[kind],
+                  (unsigned long)(total_ops * 1000ull / throughput_phase_ms),
+                  (unsigned long)count,
+                  (count == total_ops) ? "ok" : "MISMATCH",
+                  (unsigned long)(total_off / cpuMhz() * 1000ull / throughput_phase_ms));
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    Serial.println();
+    Serial.println("---Sharded Counter Benchmark---");
+    Serial.print("CPU MHz: ");
+    Serial.println(getCpuFrequencyMhz());
+
+    mutex = xSemaphoreCreateMutex();
+    done_sem = xSemaphoreCreateCounting(portNUM_PROCESSORS, 0);
+    if (mutex == nullptr || done_sem == nullptr)
+    {
+        Serial.println("Failed to create semaphores");
+        while (true)
+        {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+        }
+    }
+
+    timer = timerBegin(timer_frequency_hz);
+    if (timer == nullptr)
+    {
+        Serial.println("Failed to init timer");
+        while (true)
+        {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+        }
+    }
+    timerAttachInterrupt(timer, &onTimer);
+    timerAlarm(timer, timer_max_count, true, 0);
+    timerStop(timer);
+
+    measureStampCost();
+    runIsrPhase(KIND_SPINLOCK);
+    runIsrPhase(KIND_SHARDED);
+
+    runThroughputPhase(KIND_SPINLOCK);
+    runThroughputPhase(KIND_MUTEX);
+    runThroughputPhase(KIND_SHARDED);
+
+    Serial.println("Done!");
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
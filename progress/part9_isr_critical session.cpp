@@ -2,9 +2,13 @@
  * ESP32 ISR Critical Section Demo
  *
  * Increment global variable in ISR.
+ *
+ * The counter is a ShardedCounter, so neither the ISR nor the task has to
+ * disable interrupts to update it.
  */
 
 #include <Arduino.h>
+#include <ShardedCounter.h>
 
 // Only use core 1 for demo purposes
 
@@ -21,17 +25,14 @@ static const TickType_t task_delay = 2000 / portTICK_PERIOD_MS; // 2 second dela
 
 // Globals
 static hw_timer_t *timer = NULL;
-static volatile int isr_counter = 0;
-static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static ShardedCounter isr_counter;
 
 //*****************************************************************************
 // Interrupt Service Routines (ISRs)
 
 void IRAM_ATTR onTimer()
 {
-    portENTER_CRITICAL_ISR(&spinlock);
-    isr_counter = isr_counter + 1;
-    portEXIT_CRITICAL_ISR(&spinlock);
+    isr_counter.add();
 }
 
 // *****************************************************************************
@@ -41,12 +42,11 @@ void printValue(void *pvParameters)
 
     while (1)
     {
-        while (isr_counter > 0)
+        int32_t value;
+        while ((value = isr_counter.read()) > 0)
         {
-            Serial.println(isr_counter);
-            portENTER_CRITICAL_ISR(&spinlock);
-            isr_counter = isr_counter - 1;
-            portEXIT_CRITICAL_ISR(&spinlock);
+            Serial.println(value);
+            isr_counter.tryDecrement();
         }
 
         // Wait 2 seconds while ISR increase the counter
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include <BoardConfig.h>
+#include <ShardedCounter.h>
 
 #if CONFIG_FREERTOS_UNICORE
 static const BaseType_t app_cpu = 0;
@@ -18,22 +19,17 @@ static hw_timer_t *timer = nullptr;
 static SemaphoreHandle_t timerSem = nullptr;
 
 // --- Shared Variables ---
-// 'volatile' is mandatory for variables modified inside an ISR
-volatile uint32_t timerCount = 0;
+// Per-core atomic shards: the ISR never has to disable interrupts to count
+static ShardedCounter timerCount;
 volatile bool ledstate = false;
 
-// --- Spinlock for thread safety ---
-portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
-
 //*****************************************************************************
 // Interrupt Service Routine (keep it FAST)
 
 void IRAM_ATTR onTimer()
 {
-    // 1. Enter Critical Section (protect shared variables)
-    portENTER_CRITICAL_ISR(&timerMux);
-    timerCount = timerCount + 1;
-    portEXIT_CRITICAL_ISR(&timerMux);
+    // 1. Count the alarm (lock-free, no critical section)
+    timerCount.add();
 
     // 2. Use a semaphore to tell a task to do the "heavy lifting" (like printing) [7, 8]
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
@@ -59,12 +55,10 @@ void timerTask(void *pvParameters)
         // Wait for signal from ISR
         if (xSemaphoreTake(timerSem, portMAX_DELAY) == pdTRUE)
         {
-            // 1. Read the counter safely inside a critical section
+            // 1. Take a snapshot of the counter
             // We make a local copy so the number doesn't change while we are printing it
-            portENTER_CRITICAL(&timerMux);
-            currentCount = timerCount;
+            currentCount = timerCount.read();
             ledstate = !ledstate; // Toggle LED state
-            portEXIT_CRITICAL(&timerMux);
 
             // 2. Do the heavy I/O work outside the critical section
             digitalWrite(LED_BUILTIN, ledstate ? HIGH : LOW);
@@ -0,0 +1,321 @@
+/**
+ * ESP32 High-Rate Acquisition Demo
+ *
+ * part9_isr_challenge.cpp started out waking a task on every timer alarm,
+ * which is fine at 10 Hz but saturates the core at 10-100 kHz. Here the
+ * sources only wake the processing task when a block is complete (or, for
+ * the timer source, when a watermark of samples is reached), and count an
+ * overrun whenever the task falls so far behind that a block is lost.
+ *
+ * On boot the sketch searches for the highest sample rate each backend
+ * sustains for a second with zero overruns and at least 95% of the expected
+ * samples delivered. Then it keeps acquiring and accepts commands:
+ *
+ *   rate <hz>        change the sample rate while running
+ *   watermark <n>    timer source: wake after n samples (0 = full blocks)
+ *   source timer|dma switch backend
+ *   search           run the throughput search again
+ */
+
+#include <Arduino.h>
+#include <BlockKernels.h>
+#include <ContinuousAdcSource.h>
+#include <SampleSource.h>
+#include <TimerAdcSource.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t block_size = 256;
+static const uint32_t timer_min_hz = 1000;
+static const uint32_t timer_max_hz = 100000;
+static const uint32_t dma_min_hz = 20000;
+static const uint32_t dma_max_hz = 2000000;
+static const uint32_t settle_ms = 200;
+static const uint32_t trial_ms = 1000;
+static const uint32_t report_ms = 1000;
+static const uint32_t min_delivered_pct = 95;
+
+// Pins
+static const int adc_pin = A0; // GPIO36, ADC1_CH0
+
+// Globals
+static TimerAdcSource timer_source;
+static ContinuousAdcSource dma_source;
+static SampleSource *active = &timer_source;
+static volatile uint32_t sink = 0;
+
+// Requests from the console task, applied by the processing task between
+// blocks so only one task ever touches a source
+static volatile uint32_t requested_rate = 0;
+static volatile int32_t requested_watermark = -1;
+static SampleSource *volatile requested_source = nullptr;
+static volatile bool search_requested = true;
+
+//*****************************************************************************
+// Processing
+
+// Stand-in for real work on a block
+static void processBlock(const SampleBlock *block)
+{
+    uint32_t sum = blockSum(block->samples, block->count);
+    BlockMinMax mm = blockMinMax(block->samples, block->count);
+    sink = sink + sum + mm.max - mm.min;
+}
+
+// Run the source at rate_hz for trial_ms. True if it kept up.
+static bool trialRate(SampleSource *source, uint32_t rate_hz)
+{
+    if (!source->setSampleRate(rate_hz) || !source->start())
+    {
+        return false;
+    }
+
+    // Let the first blocks through before measuring
+    uint32_t t0 = millis();
+    while (millis() - t0 < settle_ms)
+    {
+        const SampleBlock *block = source->read(50);
+        if (block != nullptr)
+        {
+            processBlock(block);
+        }
+    }
+
+    SampleSourceStats before = source->stats();
+    t0 = millis();
+    while (millis() - t0 < trial_ms)
+    {
+        const SampleBlock *block = source->read(50);
+        if (block != nullptr)
+        {
+            processBlock(block);
+        }
+    }
+    uint32_t elapsed_ms = millis() - t0;
+    SampleSourceStats after = source->stats();
+    source->stop();
+
+    uint32_t delivered = after.samples - before.samples;
+    uint32_t overruns = after.overruns - before.overruns;
+    uint64_t expected = (uint64_t)rate_hz * elapsed_ms / 1000;
+    bool ok = overruns == 0 && (uint64_t)delivered * 100 >= expected * min_delivered_pct;
+
+    Serial.printf("  %7lu Hz: %7lu samples/s, %5lu wakeups/s, %lu overruns -> %s\n",
+                  (unsigned long)rate_hz,
+                  (unsigned long)((uint64_t)delivered * 1000 / elapsed_ms),
+                  (unsigned long)((after.blocks - before.blocks) * 1000 / elapsed_ms),
+                  (unsigned long)overruns,
+                  ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Bisect for the highest rate in [lo, hi] that passes, to within 2%
+static uint32_t findMaxRate(SampleSource *source, uint32_t lo, uint32_t hi)
+{
+    Serial.printf("\n=== Throughput search: %s, %lu samples per block ===\n",
+                  source->name(),
+                  (unsigned long)block_size);
+
+    if (!trialRate(source, lo))
+    {
+        return 0;
+    }
+    if (trialRate(source, hi))
+    {
+        return hi;
+    }
+    while (hi - lo > lo / 50)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (trialRate(source, mid))
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void runSearch()
+{
+    uint32_t timer_max = findMaxRate(&timer_source, timer_min_hz, timer_max_hz);
+    uint32_t dma_max = findMaxRate(&dma_source, dma_min_hz, dma_max_hz);
+    Serial.printf("\nMax sustainable rate: timer ISR %lu Hz, continuous ADC %lu Hz\n",
+                  (unsigned long)timer_max,
+                  (unsigned long)dma_max);
+
+    // Continue acquiring at a rate both backends handle
+    timer_source.setSampleRate(timer_max ? timer_max / 2 : timer_min_hz);
+    dma_source.setSampleRate(dma_max ? dma_max / 2 : dma_min_hz);
+}
+
+// Apply console requests between blocks
+static void applyRequests()
+{
+    if (requested_source != nullptr)
+    {
+        active->stop();
+        active = requested_source;
+        requested_source = nullptr;
+        active->start();
+        Serial.printf("Source: %s at %lu Hz\n", active->name(), (unsigned long)active->sampleRate());
+    }
+    if (requested_rate != 0)
+    {
+        uint32_t rate = requested_rate;
+        requested_rate = 0;
+        if (!active->setSampleRate(rate))
+        {
+            Serial.printf("%s cannot run at %lu Hz\n", active->name(), (unsigned long)rate);
+        }
+    }
+    if (requested_watermark >= 0)
+    {
+        timer_source.setWatermark((uint32_t)requested_watermark);
+        requested_watermark = -1;
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+void processTask(void *parameters)
+{
+    while (1)
+    {
+        if (search_requested)
+        {
+            active->stop();
+            runSearch();
+            search_requested = false;
+            active->start();
+        }
+
+        SampleSourceStats last = active->stats();
+        uint32_t last_report = millis();
+        while (!search_requested)
+        {
+            applyRequests();
+
+            const SampleBlock *block = active->read(100);
+            if (block != nullptr)
+            {
+                processBlock(block);
+            }
+
+            uint32_t elapsed_ms = millis() - last_report;
+            if (elapsed_ms >= report_ms)
+            {
+                SampleSourceStats now = active->stats();
+                Serial.printf("%s: rate=%lu Hz samples/s=%lu wakeups/s=%lu irq/s=%lu overruns=%lu\n",
+                              active->name(),
+                              (unsigned long)active->sampleRate(),
+                              (unsigned long)((uint64_t)(now.samples - last.samples) * 1000 / elapsed_ms),
+                              (unsigned long)((now.blocks - last.blocks) * 1000 / elapsed_ms),
+                              (unsigned long)((uint64_t)(now.interrupts - last.interrupts) * 1000 / elapsed_ms),
+                              (unsigned long)now.overruns);
+                last = now;
+                last_report = millis();
+            }
+        }
+    }
+}
+
+#define CMD_BUF_SIZE 32
+
+static void handleCommand(char *cmd)
+{
+    if (strncmp(cmd, "rate ", 5) == 0)
+    {
+        requested_rate = strtoul(cmd + 5, NULL, 10);
+    }
+    else if (strncmp(cmd, "watermark ", 10) == 0)
+    {
+        requested_watermark = (int32_t)strtoul(cmd + 10, NULL, 10);
+    }
+    else if (strcmp(cmd, "source timer") == 0)
+    {
+        requested_source = &timer_source;
+    }
+    else if (strcmp(cmd, "source dma") == 0)
+    {
+        requested_source = &dma_source;
+    }
+    else if (strcmp(cmd, "search") == 0)
+    {
+        search_requested = true;
+    }
+    else
+    {
+        Serial.println("Commands: rate <hz>, watermark <n>, source timer|dma, search");
+    }
+}
+
+void consoleTask(void *parameters)
+{
+    char cmd_buf[CMD_BUF_SIZE];
+    uint8_t idx = 0;
+
+    while (1)
+    {
+        while (Serial.available())
+        {
+            char c = Serial.read();
+            if (c == '\r' || c == '\n')
+            {
+                if (idx > 0)
+                {
+                    cmd_buf[idx] = '\0';
+                    Serial.println();
+                    handleCommand(cmd_buf);
+                    idx = 0;
+                }
+            }
+            else if (idx < CMD_BUF_SIZE - 1)
+            {
+                Serial.print(c);
+                cmd_buf[idx++] = c;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS High-Rate Acquisition Demo---");
+
+    // Triple buffering gives the task a full block of slack at high rates
+    if (!timer_source.begin(adc_pin, timer_min_hz, block_size, 3) ||
+        !dma_source.begin(adc_pin, dma_min_hz, block_size))
+    {
+        Serial.println("Failed to init sample sources");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    xTaskCreatePinnedToCore(processTask, "Process", 4096, NULL, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(consoleTask, "Console", 3072, NULL, 1, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
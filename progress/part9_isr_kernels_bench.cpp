@@ -0,0 +1,117 @@
+/**
+ * ESP32 Block Kernel Benchmark
+ *
+ * calcAverage() sums its block with a plain loop. This sketch times the
+ * BlockKernels variants built for the target (scalar and SWAR) for block
+ * sizes 16 to 4096, prints CPU cycles per sample for each kernel, and checks
+ * that the variants agree.
+ */
+
+#include <Arduino.h>
+#include <BlockKernels.h>
+#include <PortUtils.h>
+
+// Settings
+static const uint32_t block_sizes[] = {16, 64, 256, 1024, 4096};
+static const uint32_t max_block = 4096;
+static const uint32_t repeats = 8;
+static const uint16_t offset = 2048;
+static const int16_t gain_q15 = 26214; // 0.8
+static const uint16_t threshold = 2500;
+
+// Globals
+static uint16_t samples[max_block];
+static int16_t coeffs_a[max_block];
+static int16_t coeffs_b[max_block];
+static int16_t scaled[max_block];
+static volatile uint32_t sink = 0;
+static bool all_match = true;
+
+//*****************************************************************************
+// Benchmarks
+
+// Cycles per sample for one kernel; result folded into *check
+static uint32_t timeKernel(const BlockKernelSet *set, uint32_t kernel, uint32_t n, uint64_t *check)
+{
+    uint32_t start = cpuCycleCount();
+    for (uint32_t r = 0; r < repeats; r++)
+    {
+        switch (kernel)
+        {
+        case 0:
+            *check = set->sum(samples, n);
+            break;
+        case 1:
+        {
+            BlockMinMax mm = set->minMax(samples, n);
+            *check = ((uint32_t)mm.min << 16) | mm.max;
+            break;
+        }
+        case 2:
+            set->scaleOffset(samples, scaled, n, offset, gain_q15);
+            *check = (uint16_t)scaled[n - 1];
+            break;
+        case 3:
+            *check = (uint64_t)set->dot(coeffs_a, coeffs_b, n);
+            break;
+        default:
+            *check = set->countAbove(samples, n, threshold);
+            break;
+        }
+    }
+    return (cpuCycleCount() - start) / (repeats * n);
+}
+
+static void runKernel(uint32_t kernel, const char *name)
+{
+    Serial.printf("\n%s (cycles/sample)\n", name);
+    for (uint32_t i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++)
+    {
+        uint32_t n = block_sizes[i];
+        uint64_t scalar_check = 0;
+        uint64_t swar_check = 0;
+        uint32_t scalar_cycles = timeKernel(&block_kernels_scalar, kernel, n, &scalar_check);
+        uint32_t swar_cycles = timeKernel(&block_kernels_swar, kernel, n, &swar_check);
+        bool match = (scalar_check == swar_check);
+        all_match = all_match && match;
+        sink = sink + (uint32_t)scalar_check;
+
+        Serial.printf("  n=%4lu scalar=%3lu swar=%3lu%s\n",
+                      (unsigned long)n,
+                      (unsigned long)scalar_cycles,
+                      (unsigned long)swar_cycles,
+                      match ? "" : "  MISMATCH");
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---Block Kernel Benchmark---");
+    Serial.printf("Best variant on this target: %s\n", blockKernelsBest()->name);
+
+    for (uint32_t i = 0; i < max_block; i++)
+    {
+        samples[i] = (uint16_t)(2048 + random(-1024, 1024));
+        coeffs_a[i] = (int16_t)random(-32767, 32767);
+        coeffs_b[i] = (int16_t)random(-32767, 32767);
+    }
+
+    runKernel(0, "sum");
+    runKernel(1, "min/max");
+    runKernel(2, "scale+offset");
+    runKernel(3, "dot");
+    runKernel(4, "count>t");
+
+    Serial.println(all_match ? "\nAll variants agree" : "\nVariants DISAGREE");
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
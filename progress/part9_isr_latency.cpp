@@ -0,0 +1,260 @@
+/**
+ * ESP32 Timer ISR to Task Latency
+ *
+ * onTimer() in part9_isr_hardware_timer.cpp wakes timerTask with a binary
+ * semaphore. This sketch measures what that costs, stage by stage, with the
+ * CPU cycle counter (see IsrLatency.h):
+ *
+ *   entry  - timer alarm to first ISR instruction
+ *   signal - the FromISR call that wakes the task
+ *   wake   - ISR exit and context switch until the task runs
+ *   total  - alarm to task
+ *
+ * The same measurement runs for four signalling mechanisms: binary
+ * semaphore, direct task notification, queue (the message carries the
+ * sequence number) and stream buffer. Each prints its histograms, then a
+ * comparison table of p50/p99/max per stage.
+ *
+ * The alarm time is reconstructed from the timer counter: with auto-reload
+ * it restarts at 0 on the alarm, so the count read on ISR entry is the time
+ * since the alarm. Timer ISR and task run on the same core, so all stamps of
+ * one trace come from the same cycle counter.
+ *
+ * progress/host/isr_latency_bench.cpp runs the same harness on Linux with a
+ * POSIX timer signal in place of the timer ISR.
+ */
+
+#include <Arduino.h>
+#include <freertos/stream_buffer.h>
+#include <IsrLatency.h>
+#include <PortUtils.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t timer_frequency_hz = 10000000; // 10 MHz: 100 ns resolution for the alarm stamp
+static const uint32_t period_us = 1000;              // One alarm per ms
+static const uint32_t samples_per_run = 5000;
+static const uint32_t trace_slots = 8;               // Power of two
+
+enum Mechanism
+{
+    MECH_SEMAPHORE = 0,
+    MECH_NOTIFY,
+    MECH_QUEUE,
+    MECH_STREAM,
+    NUM_MECHANISMS
+};
+
+static const char *const mechanism_names[NUM_MECHANISMS] = {
+    "binary semaphore", "task notification", "queue", "stream buffer"};
+
+// Globals
+static hw_timer_t *timer = nullptr;
+static SemaphoreHandle_t sem = nullptr;
+static QueueHandle_t queue = nullptr;
+static StreamBufferHandle_t stream = nullptr;
+static TaskHandle_t measure_task = nullptr;
+static volatile Mechanism mechanism = MECH_SEMAPHORE;
+
+static uint32_t cycles_per_tick = 0; // Fixed before the timer starts
+static LatencyTrace traces[trace_slots];
+static volatile uint32_t published_seq = 0;
+static LatencyStages results[NUM_MECHANISMS];
+
+//*****************************************************************************
+// Interrupt Service Routine
+
+void IRAM_ATTR onTimer()
+{
+    uint32_t entry = cpuCycleCount();
+    uint32_t since_alarm = (uint32_t)timerRead(timer);
+
+    uint32_t seq = published_seq + 1;
+    LatencyTrace *trace = &traces[seq & (trace_slots - 1)];
+    trace->alarm = entry - since_alarm * cycles_per_tick;
+    trace->entry = entry;
+
+    BaseType_t task_woken = pdFALSE;
+    switch (mechanism)
+    {
+    case MECH_SEMAPHORE:
+        xSemaphoreGiveFromISR(sem, &task_woken);
+        break;
+    case MECH_NOTIFY:
+        vTaskNotifyGiveFromISR(measure_task, &task_woken);
+        break;
+    case MECH_QUEUE:
+        xQueueSendFromISR(queue, &seq, &task_woken);
+        break;
+    default:
+        xStreamBufferSendFromISR(stream, &seq, sizeof(seq), &task_woken);
+        break;
+    }
+    trace->signaled = cpuCycleCount();
+    published_seq = seq;
+
+    if (task_woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+// Block until the ISR signals with the given mechanism
+static bool waitForSignal(Mechanism mech)
+{
+    uint32_t seq;
+    switch (mech)
+    {
+    case MECH_SEMAPHORE:
+        return xSemaphoreTake(sem, pdMS_TO_TICKS(100)) == pdTRUE;
+    case MECH_NOTIFY:
+        return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100)) != 0;
+    case MECH_QUEUE:
+        return xQueueReceive(queue, &seq, pdMS_TO_TICKS(100)) == pdTRUE;
+    default:
+        return xStreamBufferReceive(stream, &seq, sizeof(seq), pdMS_TO_TICKS(100)) == sizeof(seq);
+    }
+}
+
+static void serialLine(const char *line)
+{
+    Serial.println(line);
+}
+
+static void runMechanism(Mechanism mech)
+{
+    LatencyStages &stages = results[mech];
+    stages.reset();
+
+    // Leave nothing from the previous run behind
+    xSemaphoreTake(sem, 0);
+    ulTaskNotifyTake(pdTRUE, 0);
+    xQueueReset(queue);
+    xStreamBufferReset(stream);
+
+    mechanism = mech;
+    uint32_t handled = published_seq;
+    uint32_t missed = 0;
+    timerWrite(timer, 0);
+    timerStart(timer);
+
+    while (stages.stage(LatencyStages::STAGE_TOTAL).count() < samples_per_run)
+    {
+        if (!waitForSignal(mech))
+        {
+            continue;
+        }
+        uint32_t resumed = cpuCycleCount();
+
+        uint32_t seq = published_seq;
+        if (seq == handled)
+        {
+            continue;
+        }
+        missed += seq - handled - 1;
+        handled = seq;
+
+        LatencyTrace trace = traces[seq & (trace_slots - 1)];
+        trace.resumed = resumed;
+        stages.record(trace);
+    }
+    timerStop(timer);
+
+    stages.printTo(serialLine, mechanism_names[mech]);
+    Serial.printf("missed alarms: %lu\n", (unsigned long)missed);
+}
+
+static void printComparison()
+{
+    Serial.println("\n=== p50 / p99 / max (ns) ===");
+    Serial.printf("%-18s", "mechanism");
+    for (uint32_t s = 0; s < LatencyStages::NUM_STAGES; s++)
+    {
+        Serial.printf(" %22s", LatencyStages::stageName(s));
+    }
+    Serial.println();
+
+    for (uint32_t m = 0; m < NUM_MECHANISMS; m++)
+    {
+        Serial.printf("%-18s", mechanism_names[m]);
+        for (uint32_t s = 0; s < LatencyStages::NUM_STAGES; s++)
+        {
+            const LogHistogram &h = results[m].stage(s);
+            Serial.printf(" %6lu/%7lu/%7lu",
+                          (unsigned long)h.percentile(50),
+                          (unsigned long)h.percentile(99),
+                          (unsigned long)h.max());
+        }
+        Serial.println();
+    }
+}
+
+void measureTask(void *parameters)
+{
+    while (1)
+    {
+        for (uint32_t m = 0; m < NUM_MECHANISMS; m++)
+        {
+            runMechanism((Mechanism)m);
+        }
+        printComparison();
+        vTaskDelay(pdMS_TO_TICKS(10000));
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS ISR Latency Harness---");
+    Serial.printf("CPU MHz: %lu, timer tick %lu ns\n",
+                  (unsigned long)cpuMhz(),
+                  (unsigned long)(1000000000u / timer_frequency_hz));
+
+    cycles_per_tick = cpuMhz() * 1000000u / timer_frequency_hz;
+
+    sem = xSemaphoreCreateBinary();
+    queue = xQueueCreate(4, sizeof(uint32_t));
+    stream = xStreamBufferCreate(4 * sizeof(uint32_t), sizeof(uint32_t));
+    if (sem == nullptr || queue == nullptr || stream == nullptr)
+    {
+        Serial.println("Failed to create signalling objects");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    // The timer interrupt is allocated on the core calling timerBegin();
+    // setup() runs on the same core as measureTask
+    timer = timerBegin(timer_frequency_hz);
+    if (timer == nullptr)
+    {
+        Serial.println("Failed to init timer");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    timerAttachInterrupt(timer, &onTimer);
+    timerAlarm(timer, (uint64_t)period_us * (timer_frequency_hz / 1000000u), true, 0);
+    timerStop(timer);
+
+    xTaskCreatePinnedToCore(measureTask, "Measure", 4096, NULL, configMAX_PRIORITIES - 2, &measure_task, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
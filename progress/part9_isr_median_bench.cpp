@@ -0,0 +1,158 @@
+/**
+ * ESP32 Median Filter Benchmark
+ *
+ * ADC readings from adc_pin are noisy, and averaging lets spikes through.
+ * This sketch measures CPU cycles per sample of a sliding median for window
+ * sizes 3 to 1023:
+ *
+ *   sort    - copy the window and insertion-sort it for every sample
+ *   fenwick - SlidingMedian, O(log V) whatever the window
+ *
+ * It then samples adc_pin at 1 kHz through a HampelFilter, injects a fake
+ * spike every 100 samples, and prints the raw and filtered block range once
+ * per second together with the number of rejected outliers.
+ */
+
+#include <Arduino.h>
+#include <MedianFilter.h>
+#include <PortUtils.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t windows[] = {3, 7, 15, 63, 255, 1023};
+static const uint32_t bench_samples = 2048;
+static const uint32_t hampel_window = 15;
+static const uint32_t spike_every = 100;
+
+// Pins
+static const int adc_pin = A0; // GPIO36, ADC1_CH0
+
+// Globals
+static uint16_t samples[bench_samples];
+static uint16_t scratch[1023];
+static volatile uint32_t sink = 0;
+
+//*****************************************************************************
+// Benchmarks
+
+static uint16_t sortMedian(const uint16_t *window, uint32_t fill)
+{
+    for (uint32_t i = 0; i < fill; i++)
+    {
+        uint16_t value = window[i];
+        uint32_t j = i;
+        while (j > 0 && scratch[j - 1] > value)
+        {
+            scratch[j] = scratch[j - 1];
+            j--;
+        }
+        scratch[j] = value;
+    }
+    return scratch[(fill + 1) / 2 - 1];
+}
+
+static void runBenchmark(uint32_t window)
+{
+    // The sort is O(n^2) per sample: time only a slice of the big windows
+    uint32_t timed = (window > 63) ? 64 : bench_samples - window;
+
+    uint32_t start = cpuCycleCount();
+    for (uint32_t n = window; n < window + timed; n++)
+    {
+        sink = sink + sortMedian(&samples[n - window], window);
+    }
+    uint32_t sort_cycles = (cpuCycleCount() - start) / timed;
+
+    SlidingMedian median;
+    if (!median.begin(window))
+    {
+        Serial.println("Out of memory for median filter");
+        return;
+    }
+    start = cpuCycleCount();
+    for (uint32_t n = 0; n < bench_samples; n++)
+    {
+        sink = sink + median.push(samples[n]);
+    }
+    uint32_t fenwick_cycles = (cpuCycleCount() - start) / bench_samples;
+
+    Serial.printf("window=%4lu sort=%8lu fenwick=%5lu cycles/sample\n",
+                  (unsigned long)window,
+                  (unsigned long)sort_cycles,
+                  (unsigned long)fenwick_cycles);
+}
+
+//*****************************************************************************
+// Tasks
+
+void filterTask(void *parameters)
+{
+    HampelFilter hampel;
+    if (!hampel.begin(hampel_window, 3.0f))
+    {
+        Serial.println("Failed to init Hampel filter");
+        vTaskDelete(NULL);
+    }
+
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t n = 0;
+    uint16_t raw_min = 0xFFFF, raw_max = 0, out_min = 0xFFFF, out_max = 0;
+
+    while (1)
+    {
+        uint16_t raw = analogRead(adc_pin);
+        if (++n % spike_every == 0)
+        {
+            raw = (raw > 2048) ? 0 : 4095; // Fake glitch
+        }
+        uint16_t out = hampel.filter(raw);
+
+        raw_min = (raw < raw_min) ? raw : raw_min;
+        raw_max = (raw > raw_max) ? raw : raw_max;
+        out_min = (out < out_min) ? out : out_min;
+        out_max = (out > out_max) ? out : out_max;
+
+        if (n % 1000 == 0)
+        {
+            Serial.printf("raw %4u..%4u  filtered %4u..%4u  outliers=%lu\n",
+                          raw_min, raw_max, out_min, out_max, (unsigned long)hampel.outliers());
+            raw_min = out_min = 0xFFFF;
+            raw_max = out_max = 0;
+        }
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1));
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---Sliding Median Benchmark---");
+
+    // ADC-like 12-bit samples
+    for (uint32_t i = 0; i < bench_samples; i++)
+    {
+        samples[i] = (uint16_t)(2048 + random(-256, 256));
+    }
+    for (uint32_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++)
+    {
+        runBenchmark(windows[i]);
+    }
+
+    xTaskCreatePinnedToCore(filterTask, "Filter", 4096, NULL, 1, NULL, app_cpu);
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
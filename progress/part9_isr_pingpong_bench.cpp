@@ -0,0 +1,271 @@
+/**
+ * ESP32 ISR Sample Hand-off Benchmark
+ *
+ * calcAverage() in part9_isr_challenge.cpp copies adc_buf element by element
+ * inside portENTER_CRITICAL, so interrupts are off on both cores for the
+ * whole copy. This sketch measures that against BlockBuffer for block sizes
+ * from 10 to 4,000 samples at a 10 kHz sample rate:
+ *
+ *   critical copy - ISR stores under a spinlock, consumer copies under it
+ *   ping-pong     - BlockBuffer with 2 blocks, ownership flips atomically
+ *   triple        - BlockBuffer with 3 blocks, producer never waits
+ *
+ * Reported: ISR cost, consumer interrupt-off time and overruns.
+ */
+
+#include <Arduino.h>
+#include <BlockBuffer.h>
+#include <PortUtils.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t timer_frequency_hz = 1000000; // 1 MHz timer tick (1 us per tick)
+static const uint32_t timer_max_count = 100;        // 100 us = 10 kHz sample rate
+static const uint32_t run_ms = 3000;
+static const uint32_t max_block = 4000;
+static const uint32_t block_sizes[] = {10, 100, 1000, 4000};
+
+enum Mode
+{
+    MODE_CRITICAL_COPY = 0,
+    MODE_PING_PONG,
+    MODE_TRIPLE
+};
+
+static const char *mode_names[] = {"critical copy", "ping-pong", "triple"};
+
+// Globals
+static hw_timer_t *timer = nullptr;
+static volatile Mode mode = MODE_CRITICAL_COPY;
+static volatile uint32_t block_size = 10;
+static TaskHandle_t consumer_task = NULL;
+static volatile bool consumer_run = false;
+
+// Critical-copy variant (the current pattern)
+static uint16_t shared_buf[max_block];
+static volatile uint32_t shared_count = 0;
+static volatile uint32_t copy_overruns = 0;
+static portMUX_TYPE buf_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint16_t local_copy[max_block];
+
+// Block buffer variant
+static BlockBuffer<uint16_t> *volatile blocks = nullptr;
+
+// Measurements
+static volatile uint16_t fake_sample = 0;
+static volatile uint32_t isr_calls = 0;
+static volatile uint64_t isr_cycles = 0;
+static volatile uint32_t isr_max_cycles = 0;
+static uint32_t irq_off_max_cycles = 0;
+static uint64_t irq_off_total_cycles = 0;
+static uint32_t consumed_blocks = 0;
+static volatile uint32_t checksum = 0;
+
+//*****************************************************************************
+// Interrupt Service Routines (ISRs)
+
+void IRAM_ATTR onTimer()
+{
+    uint32_t start = cpuCycleCount();
+    uint16_t sample = fake_sample;
+    fake_sample = sample + 1;
+
+    if (mode == MODE_CRITICAL_COPY)
+    {
+        BaseType_t task_woken = pdFALSE;
+        portENTER_CRITICAL_ISR(&buf_mux);
+        if (shared_count < block_size)
+        {
+            shared_buf[shared_count] = sample;
+            shared_count = shared_count + 1;
+            if (shared_count == block_size)
+            {
+                vTaskNotifyGiveFromISR(consumer_task, &task_woken);
+            }
+        }
+        else
+        {
+            copy_overruns = copy_overruns + 1;
+        }
+        portEXIT_CRITICAL_ISR(&buf_mux);
+        if (task_woken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+    else
+    {
+        blocks->push(sample);
+    }
+
+    uint32_t cycles = cpuCycleCount() - start;
+    isr_calls = isr_calls + 1;
+    isr_cycles = isr_cycles + cycles;
+    if (cycles > isr_max_cycles)
+    {
+        isr_max_cycles = cycles;
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+static void recordIrqOff(uint32_t cycles)
+{
+    irq_off_total_cycles += cycles;
+    if (cycles > irq_off_max_cycles)
+    {
+        irq_off_max_cycles = cycles;
+    }
+}
+
+void consumerTask(void *parameters)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10));
+        if (!consumer_run)
+        {
+            continue;
+        }
+
+        uint32_t sum = 0;
+        if (mode == MODE_CRITICAL_COPY)
+        {
+            uint32_t count = 0;
+            uint32_t start = cpuCycleCount();
+            portENTER_CRITICAL(&buf_mux);
+            if (shared_count == block_size)
+            {
+                count = shared_count;
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    local_copy[i] = shared_buf[i];
+                }
+                shared_count = 0;
+            }
+            portEXIT_CRITICAL(&buf_mux);
+            recordIrqOff(cpuCycleCount() - start);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                sum += local_copy[i];
+            }
+            consumed_blocks += (count > 0) ? 1 : 0;
+        }
+        else
+        {
+            // No critical section: acquire is a single atomic operation
+            const BlockBuffer<uint16_t>::Block *block;
+            while ((block = blocks->acquire()) != nullptr)
+            {
+                for (uint32_t i = 0; i < block->count; i++)
+                {
+                    sum += block->samples[i];
+                }
+                blocks->release();
+                consumed_blocks++;
+            }
+        }
+        checksum = checksum + sum;
+    }
+}
+
+//*****************************************************************************
+// Benchmarks
+
+static void runMode(Mode m, uint32_t size)
+{
+    BlockBuffer<uint16_t> *buffer = nullptr;
+    if (m != MODE_CRITICAL_COPY)
+    {
+        buffer = new BlockBuffer<uint16_t>();
+        if (!buffer->begin(size, (m == MODE_TRIPLE) ? 3 : 2))
+        {
+            Serial.println("Out of memory for block buffer");
+            delete buffer;
+            return;
+        }
+        buffer->setConsumerTask(consumer_task);
+    }
+
+    blocks = buffer;
+    block_size = size;
+    shared_count = 0;
+    copy_overruns = 0;
+    isr_calls = 0;
+    isr_cycles = 0;
+    isr_max_cycles = 0;
+    irq_off_max_cycles = 0;
+    irq_off_total_cycles = 0;
+    consumed_blocks = 0;
+    mode = m;
+    consumer_run = true;
+
+    timerWrite(timer, 0);
+    timerStart(timer);
+    vTaskDelay(pdMS_TO_TICKS(run_ms));
+    timerStop(timer);
+    vTaskDelay(pdMS_TO_TICKS(20));
+    consumer_run = false;
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    uint32_t overruns = (m == MODE_CRITICAL_COPY) ? copy_overruns : buffer->overruns();
+    Serial.printf("%-13s block=%4lu isr avg=%5lu max=%6lu ns | consumer irq_off max=%7lu ns total=%7lu us | blocks=%5lu overruns=%lu\n",
+                  mode_names[m],
+                  (unsigned long)size,
+                  (unsigned long)cyclesToNs(isr_calls ? (uint32_t)(isr_cycles / isr_calls) : 0),
+                  (unsigned long)cyclesToNs(isr_max_cycles),
+                  (unsigned long)cyclesToNs(irq_off_max_cycles),
+                  (unsigned long)(irq_off_total_cycles / cpuMhz()),
+                  (unsigned long)consumed_blocks,
+                  (unsigned long)overruns);
+
+    blocks = nullptr;
+    mode = MODE_CRITICAL_COPY;
+    delete buffer;
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---ISR Sample Hand-off: Critical Copy vs Block Buffer---");
+
+    xTaskCreatePinnedToCore(consumerTask, "Consumer", 4096, NULL, 2, &consumer_task, app_cpu);
+
+    timer = timerBegin(timer_frequency_hz);
+    if (timer == nullptr)
+    {
+        Serial.println("Failed to init timer");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    timerAttachInterrupt(timer, &onTimer);
+    timerAlarm(timer, timer_max_count, true, 0);
+    timerStop(timer);
+
+    for (uint32_t i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++)
+    {
+        runMode(MODE_CRITICAL_COPY, block_sizes[i]);
+        runMode(MODE_PING_PONG, block_sizes[i]);
+        runMode(MODE_TRIPLE, block_sizes[i]);
+    }
+
+    Serial.println("Done!");
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
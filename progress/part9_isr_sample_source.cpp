@@ -0,0 +1,137 @@
+/**
+ * ESP32 Sample Source Demo
+ *
+ * part9_isr_semaphore.cpp calls analogRead() in a timer ISR and wakes a task
+ * for every sample. Here the processing task reads blocks through the
+ * SampleSource interface and does not know which backend it is using:
+ *
+ *   timer ISR  - TimerAdcSource, analogRead() per timer interrupt
+ *   continuous - ContinuousAdcSource, ADC DMA with one interrupt per block
+ *
+ * Each backend runs for a while and the task prints block averages, the
+ * achieved sample rate, interrupts per 1,000 samples and overruns.
+ *
+ * The same processTask() code runs on Linux against a ReplaySampleSource,
+ * see progress/host/sample_source_bench.cpp.
+ */
+
+#include <Arduino.h>
+#include <ContinuousAdcSource.h>
+#include <SampleSource.h>
+#include <TimerAdcSource.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t timer_rate_hz = 1000;       // analogRead() in an ISR cannot go much faster
+static const uint32_t continuous_rate_hz = 20000; // Lowest continuous-mode rate on the ESP32
+static const uint32_t block_size = 256;
+static const uint32_t run_ms = 5000;
+static const uint32_t report_ms = 1000;
+
+// Pins
+static const int adc_pin = A0; // GPIO36, ADC1_CH0
+
+// Globals
+static TimerAdcSource timer_source;
+static ContinuousAdcSource continuous_source;
+
+//*****************************************************************************
+// Tasks
+
+// Processing only sees the SampleSource interface
+static void runSource(SampleSource *source)
+{
+    Serial.printf("\n=== %s at %lu Hz, %lu samples per block ===\n",
+                  source->name(),
+                  (unsigned long)source->sampleRate(),
+                  (unsigned long)block_size);
+
+    if (!source->start())
+    {
+        Serial.println("Failed to start sample source");
+        return;
+    }
+
+    uint32_t t0 = millis();
+    uint32_t last_report = t0;
+    uint32_t report_blocks = 0;
+    uint64_t report_sum = 0;
+    uint32_t report_count = 0;
+
+    while (millis() - t0 < run_ms)
+    {
+        const SampleBlock *block = source->read(100);
+        if (block == nullptr)
+        {
+            continue;
+        }
+
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < block->count; i++)
+        {
+            sum += block->samples[i];
+        }
+        report_sum += sum;
+        report_count += block->count;
+        report_blocks++;
+
+        if (millis() - last_report >= report_ms)
+        {
+            SampleSourceStats stats = source->stats();
+            Serial.printf("avg=%4lu blocks=%3lu samples/s=%6lu irq/1k=%4lu overruns=%lu\n",
+                          (unsigned long)(report_count ? report_sum / report_count : 0),
+                          (unsigned long)report_blocks,
+                          (unsigned long)((uint64_t)report_count * 1000 / (millis() - last_report)),
+                          (unsigned long)interruptsPer1000Samples(stats),
+                          (unsigned long)stats.overruns);
+            last_report = millis();
+            report_blocks = 0;
+            report_sum = 0;
+            report_count = 0;
+        }
+    }
+    source->stop();
+}
+
+void processTask(void *parameters)
+{
+    while (1)
+    {
+        runSource(&timer_source);
+        runSource(&continuous_source);
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Sample Source Demo---");
+
+    if (!timer_source.begin(adc_pin, timer_rate_hz, block_size) ||
+        !continuous_source.begin(adc_pin, continuous_rate_hz, block_size))
+    {
+        Serial.println("Failed to init sample sources");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    xTaskCreatePinnedToCore(processTask, "Process", 4096, NULL, 2, NULL, app_cpu);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
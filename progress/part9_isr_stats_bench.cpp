@@ -0,0 +1,175 @@
+/**
+ * ESP32 Streaming Statistics Benchmark
+ *
+ * calcAverage() in part9_isr_challenge.cpp re-sums its buffer whenever it
+ * needs the mean. This sketch measures CPU cycles per sample for:
+ *
+ *   naive     - re-sum every window for every sample
+ *   add()     - StreamingStats, one sequence-lock round per sample
+ *   addBlock  - StreamingStats, one sequence-lock round per 256-sample block
+ *
+ * It then feeds samples from a task on one core while a task on the other
+ * core takes snapshots, and prints what the reader sees.
+ */
+
+#include <Arduino.h>
+#include <PortUtils.h>
+#include <StreamingStats.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+static const BaseType_t reader_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+static const BaseType_t reader_cpu = 0;
+#endif
+
+// Settings
+static const uint32_t num_samples = 8192;
+static const uint32_t block_size = 256;
+static const uint32_t ema_shift = 4;
+static const uint32_t windows_small[] = {10};
+static const uint32_t windows_large[] = {10, 100, 1000};
+static const uint32_t live_rate_hz = 1000;
+
+// Globals
+static uint16_t samples[num_samples];
+static StreamingStats live_stats;
+static volatile uint32_t sink = 0;
+
+//*****************************************************************************
+// Benchmarks
+
+static uint32_t naiveCyclesPerSample(const uint32_t *lengths, uint32_t num_windows)
+{
+    uint32_t start = cpuCycleCount();
+    for (uint32_t n = 1; n <= num_samples; n++)
+    {
+        for (uint32_t w = 0; w < num_windows; w++)
+        {
+            uint32_t length = (lengths[w] < n) ? lengths[w] : n;
+            uint32_t sum = 0;
+            for (uint32_t i = n - length; i < n; i++)
+            {
+                sum += samples[i];
+            }
+            sink = sink + sum / length;
+        }
+    }
+    return (cpuCycleCount() - start) / num_samples;
+}
+
+static uint32_t streamingCyclesPerSample(const uint32_t *lengths, uint32_t num_windows, bool blocks)
+{
+    StreamingStats stats;
+    if (!stats.begin(lengths, num_windows, ema_shift))
+    {
+        return 0;
+    }
+
+    uint32_t start = cpuCycleCount();
+    if (blocks)
+    {
+        for (uint32_t i = 0; i < num_samples; i += block_size)
+        {
+            stats.addBlock(&samples[i], block_size);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < num_samples; i++)
+        {
+            stats.add(samples[i]);
+        }
+    }
+    return (cpuCycleCount() - start) / num_samples;
+}
+
+static void runBenchmark(const char *name, const uint32_t *lengths, uint32_t num_windows)
+{
+    uint32_t naive = naiveCyclesPerSample(lengths, num_windows);
+    uint32_t single = streamingCyclesPerSample(lengths, num_windows, false);
+    uint32_t block = streamingCyclesPerSample(lengths, num_windows, true);
+    Serial.printf("windows=%-12s naive=%7lu add()=%4lu addBlock=%4lu cycles/sample\n",
+                  name,
+                  (unsigned long)naive,
+                  (unsigned long)single,
+                  (unsigned long)block);
+}
+
+//*****************************************************************************
+// Tasks
+
+// Writer: one noisy sample per millisecond
+void writerTask(void *parameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t i = 0;
+    while (1)
+    {
+        live_stats.add(samples[i++ % num_samples]);
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000 / live_rate_hz));
+    }
+}
+
+// Reader on the other core: consistent snapshots without stopping the writer
+void readerTask(void *parameters)
+{
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+
+        StreamingStats::Snapshot snap;
+        uint32_t start = cpuCycleCount();
+        live_stats.snapshot(&snap);
+        uint32_t cycles = cpuCycleCount() - start;
+
+        Serial.printf("n=%llu mean=%.1f sd=%.1f ema=%.1f min=%u max=%u | win10=%.1f win100=%.1f win1000=%.1f | snapshot %lu cycles\n",
+                      (unsigned long long)snap.count,
+                      snap.mean(),
+                      snap.stddev(),
+                      snap.ema(),
+                      snap.min,
+                      snap.max,
+                      snap.windowMean(0),
+                      snap.windowMean(1),
+                      snap.windowMean(2),
+                      (unsigned long)cycles);
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---Streaming Statistics Benchmark---");
+
+    // ADC-like 12-bit samples
+    for (uint32_t i = 0; i < num_samples; i++)
+    {
+        samples[i] = (uint16_t)(2048 + random(-256, 256));
+    }
+
+    runBenchmark("10", windows_small, 1);
+    runBenchmark("10,100,1000", windows_large, 3);
+
+    if (!live_stats.begin(windows_large, 3, ema_shift))
+    {
+        Serial.println("Failed to init statistics");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    xTaskCreatePinnedToCore(writerTask, "Writer", 2048, NULL, 2, NULL, app_cpu);
+    xTaskCreatePinnedToCore(readerTask, "Reader", 4096, NULL, 1, NULL, reader_cpu);
+
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
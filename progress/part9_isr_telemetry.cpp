@@ -0,0 +1,191 @@
+/**
+ * ESP32 Binary Telemetry Demo
+ *
+ * The ADC averages of part9_isr_challenge.cpp, the timer counts of
+ * part9_isr_hardware_timer.cpp and the remaining-time prints of
+ * part8_software_timer_challenge.cpp all go out as Serial.print() text.
+ * Here the same values are sent as typed Telemetry records: COBS framed,
+ * with a sequence number and CRC, several tasks sharing the UART.
+ *
+ * On boot the sketch measures how many timer-count records per second get
+ * through at 115200 baud as text and as frames, and reports the result as a
+ * TELEM_TEXT record. Then:
+ *
+ *   Timer task  - hardware timer ISR at 1 Hz, sends TELEM_TIMER_COUNT
+ *   ADC task    - 10 Hz analogRead(), sends TELEM_ADC_AVERAGE per 10 samples
+ *                 and TELEM_SAMPLES with the raw values
+ *   Countdown   - TELEM_REMAINING_MS every 500 ms for a 5 s countdown
+ *
+ * Decode with progress/host/telemetry_bench.cpp:
+ *   stty -F /dev/ttyUSB0 115200 raw && ./telemetry_bench receive /dev/ttyUSB0
+ */
+
+#include <Arduino.h>
+#include <ShardedCounter.h>
+#include <Telemetry.h>
+
+// Use only core 1 for demo purposes
+#if CONFIG_FREERTOS_UNICORE
+static const BaseType_t app_cpu = 0;
+#else
+static const BaseType_t app_cpu = 1;
+#endif
+
+// Settings
+static const uint32_t timer_frequency_hz = 1000000; // 1 MHz timer tick
+static const uint32_t timer_max_count = 1000000;    // 1 s
+static const uint32_t bench_ms = 2000;
+static const uint32_t adc_period_ms = 100;
+static const uint32_t adc_block = 10;
+static const uint32_t countdown_ms = 5000;
+static const uint32_t countdown_step_ms = 500;
+
+// Pins
+static const int adc_pin = A0;
+
+// Globals
+static TelemetryWriter telemetry;
+static hw_timer_t *timer = nullptr;
+static TaskHandle_t timer_task = nullptr;
+static ShardedCounter timer_count;
+
+//*****************************************************************************
+// Telemetry link
+
+static size_t serialSink(const uint8_t *data, size_t len, void *context)
+{
+    return Serial.write(data, len);
+}
+
+// Records per second one task gets through the UART, text vs frames
+static void benchmarkLink()
+{
+    Serial.flush();
+    uint32_t text_records = 0;
+    uint32_t t0 = millis();
+    while (millis() - t0 < bench_ms)
+    {
+        Serial.printf("Timer Count: %lu | LED: %s\r\n", (unsigned long)(123456 + text_records), (text_records & 1) ? "ON" : "OFF");
+        text_records++;
+    }
+    Serial.flush();
+    uint32_t text_ms = millis() - t0;
+
+    uint32_t frame_records = 0;
+    t0 = millis();
+    while (millis() - t0 < bench_ms)
+    {
+        telemetry.send(TELEM_TIMER_COUNT, TelemetryPayload().u32(123456 + frame_records));
+        frame_records++;
+    }
+    Serial.flush();
+    uint32_t frame_ms = millis() - t0;
+
+    telemetry.printf("Link benchmark at 115200 baud: text %lu records/s, frames %lu records/s",
+                     (unsigned long)((uint64_t)text_records * 1000 / text_ms),
+                     (unsigned long)((uint64_t)frame_records * 1000 / frame_ms));
+}
+
+//*****************************************************************************
+// Interrupt Service Routine
+
+void IRAM_ATTR onTimer()
+{
+    timer_count.add();
+
+    BaseType_t task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(timer_task, &task_woken);
+    if (task_woken)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+//*****************************************************************************
+// Tasks
+
+void timerTask(void *parameters)
+{
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        telemetry.send(TELEM_TIMER_COUNT, TelemetryPayload().u32(timer_count.read()));
+    }
+}
+
+void adcTask(void *parameters)
+{
+    uint16_t samples[adc_block];
+    uint32_t index = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1)
+    {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < adc_block; i++)
+        {
+            vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(adc_period_ms));
+            samples[i] = analogRead(adc_pin);
+            sum += samples[i];
+        }
+
+        telemetry.send(TELEM_ADC_AVERAGE, TelemetryPayload().f32((float)sum / adc_block).u32(adc_block));
+        // Little endian already, the array goes out as is
+        telemetry.send(TELEM_SAMPLES, TelemetryPayload().u32(index).bytes(samples, sizeof(samples)));
+        index += adc_block;
+    }
+}
+
+void countdownTask(void *parameters)
+{
+    while (1)
+    {
+        for (uint32_t remain = countdown_ms; remain > 0; remain -= countdown_step_ms)
+        {
+            telemetry.send(TELEM_REMAINING_MS, TelemetryPayload().u32(remain));
+            vTaskDelay(pdMS_TO_TICKS(countdown_step_ms));
+        }
+        telemetry.send(TELEM_REMAINING_MS, TelemetryPayload().u32(0));
+        telemetry.print("Countdown expired, restarting");
+    }
+}
+
+//*****************************************************************************
+// Main
+
+void setup()
+{
+    Serial.begin(115200);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    Serial.println();
+    Serial.println("---FreeRTOS Binary Telemetry Demo---"); // Plain text still shows on the receiver
+
+    if (!telemetry.begin(serialSink, nullptr))
+    {
+        Serial.println("Failed to start telemetry");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    benchmarkLink();
+
+    xTaskCreatePinnedToCore(timerTask, "Timer", 3072, NULL, 2, &timer_task, app_cpu);
+    xTaskCreatePinnedToCore(adcTask, "ADC", 3072, NULL, 1, NULL, app_cpu);
+    xTaskCreatePinnedToCore(countdownTask, "Countdown", 3072, NULL, 1, NULL, app_cpu);
+
+    timer = timerBegin(timer_frequency_hz);
+    if (timer == nullptr)
+    {
+        telemetry.print("Failed to init timer");
+        while (1)
+            vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    timerAttachInterrupt(timer, &onTimer);
+    timerAlarm(timer, timer_max_count, true, 0);
+
+    // Delete "setup and loop" task
+    vTaskDelete(NULL);
+}
+
+void loop()
+{
+}
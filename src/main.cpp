@@ -9,6 +9,7 @@
  */
 
 #include <Arduino.h>
+#include <TaskSpawn.h>
 
 // Use only core 1 for demo purposes
 #if CONFIG_FREERTOS_UNICORE
@@ -28,7 +29,6 @@ enum
 }; // Bytes in ESP32, words in vanilla FreeRTOS
 
 // Globals
-static SemaphoreHandle_t bin_sem;  // Wait for parameters to be read
 static SemaphoreHandle_t eat_sem;  // Wait for Arbitrator to give permission to eat
 static SemaphoreHandle_t done_sem; // Notifies main task when done
 static SemaphoreHandle_t chopstick[NUM_TASKS];
@@ -37,15 +37,11 @@ static SemaphoreHandle_t chopstick[NUM_TASKS];
 // Tasks
 
 // The only task: eating
-void eat(void *parameters)
+void eat(const int &num)
 {
 
-    int num;
     char buf[50];
 
-    // Copy parameter and increment semaphore count
-    num = *(int *)parameters;
-    xSemaphoreGive(bin_sem);
     sprintf(buf, "Philosopher %i took eat semaphore.", num);
     Serial.println(buf);
 
@@ -102,7 +98,6 @@ void setup()
     Serial.println("---FreeRTOS Dining Philosophers Challenge---");
 
     // Create kernel objects before starting tasks
-    bin_sem = xSemaphoreCreateBinary();
     done_sem = xSemaphoreCreateCounting(NUM_TASKS, 0);
     eat_sem = xSemaphoreCreateBinary();
     for (int i = 0; i < NUM_TASKS; i++)
@@ -110,18 +105,12 @@ void setup()
         chopstick[i] = xSemaphoreCreateMutex();
     }
 
-    // Have the philosphers start eating
+    // Have the philosphers start eating (i is copied, no need to wait for it)
     for (int i = 0; i < NUM_TASKS; i++)
     {
         sprintf(task_name, "Philosopher %i", i);
-        xTaskCreatePinnedToCore(eat,
-                                task_name,
-                                TASK_STACK_SIZE,
-                                (void *)&i,
-                                1,
-                                NULL,
-                                app_cpu);
-        xSemaphoreTake(bin_sem, portMAX_DELAY);
+        SpawnConfig config = {task_name, TASK_STACK_SIZE, 1, app_cpu};
+        spawnTask(eat, i, config);
         xSemaphoreTake(eat_sem, portMAX_DELAY);
     }
 